@@ -0,0 +1,81 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#pragma once
+
+#import "FileIdentityCache.hpp"
+#import "SFBReplayGainAnalyzer.h"
+#import "loudness_ebur128/ebur128_analyzer.h"
+
+#import <cstddef>
+#import <cstdint>
+#import <memory>
+#import <optional>
+#import <vector>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface SFBReplayGain ()
+- (instancetype)initWithGain:(float)gain peak:(float)peak;
+@end
+
+@interface SFBAlbumReplayGain ()
+- (instancetype)initWithReplayGain:(SFBReplayGain *)replayGain
+                   trackReplayGain:(NSDictionary<NSURL *, SFBReplayGain *> *)trackReplayGain;
+@end
+
+namespace sfb::replay_gain {
+
+/// The `FileIdentityCache` entry kind for cached analyses
+inline constexpr uint32_t analysisCacheKind = 0x4c554653; // 'LUFS'
+/// The file name extension for cached analyses
+inline constexpr const char *analysisCacheExtension = "loudness";
+
+/// Options controlling how a single track is analyzed
+struct TrackAnalysisOptions final {
+    /// Whether to measure true peaks instead of sample peaks
+    bool measureTruePeak_{false};
+    /// The maximum number of segments to analyze concurrently
+    std::size_t maximumSegments_{1};
+    /// The cache of analyses, or `nullptr` for none
+    const FileIdentityCache *_Nullable cache_{nullptr};
+    /// Whether cached analyses are keyed by a hash of the file's contents
+    bool cacheVerifiesFileContents_{false};
+};
+
+/// Returns the analysis of `url` cached in `options.cache_`, or `nullptr` if there is none
+///
+/// If the analysis should be cached once it is performed `identity` is set to the identity of `url`.
+std::unique_ptr<loudness::EbuR128Analyzer> findCachedAnalysis(NSURL *url, const TrackAnalysisOptions &options,
+                                                              std::optional<FileIdentity> &identity) noexcept;
+
+/// Decodes and analyzes the track at `url`, caching the result under `identity` if present
+/// - parameter url: The URL to analyze
+/// - parameter data: The contents of `url` if already read, or `nil` to read from `url`
+/// - parameter options: Analysis options
+/// - parameter identity: The identity returned by `findCachedAnalysis`
+/// - parameter error: A pointer to an `NSError` object to receive error information
+/// - returns: The analyzer or `nullptr` on error
+std::unique_ptr<loudness::EbuR128Analyzer> analyzeTrack(NSURL *url, NSData *_Nullable data,
+                                                        const TrackAnalysisOptions &options,
+                                                        const std::optional<FileIdentity> &identity,
+                                                        NSError *_Nullable *_Nonnull error) noexcept;
+
+/// Returns the peak measured by `analyzer`
+float peak(const loudness::EbuR128Analyzer &analyzer, bool measureTruePeak) noexcept;
+
+/// Returns the replay gain for the track at `url` measured by `analyzer`, or `nil` if the track is too short
+SFBReplayGain *_Nullable trackReplayGain(const loudness::EbuR128Analyzer &analyzer, NSURL *url, bool measureTruePeak,
+                                         NSError **error) noexcept;
+
+/// Returns the replay gain for the album measured by `analyzers`, or `nil` if the album is too short
+SFBReplayGain *_Nullable albumReplayGain(const std::vector<loudness::EbuR128Analyzer *> &analyzers, float peak,
+                                         NSError **error) noexcept;
+
+} /* namespace sfb::replay_gain */
+
+NS_ASSUME_NONNULL_END
@@ -5,16 +5,19 @@
 // Part of https://github.com/sbooth/SFBAudioEngine
 //
 
-#import "SFBReplayGainAnalyzer.h"
+#import "SFBReplayGainAnalyzer+Internal.h"
 
 #import "SFBAudioDecoder.h"
+#import "SFBDataInputSource.h"
 #import "SFBErrorWithLocalizedDescription.h"
 #import "SFBLocalizedNameForURL.h"
-#import "loudness_ebur128/ebur128_analyzer.h"
 
 #import <os/log.h>
 
+#import <algorithm>
+#import <cstring>
 #import <memory>
+#import <optional>
 #import <vector>
 
 // NSError domain for SFBReplayGainAnalyzer
@@ -24,94 +27,523 @@ namespace {
 
 constexpr std::size_t bufferSizeFrames = 2048;
 constexpr float referenceLoudness = -18.f;
+/// The shortest segment worth analyzing separately, in seconds
+constexpr double minimumSegmentDuration = 30;
 
 struct ReplayGainContext {
     NSArray *urls_;
+    sfb::replay_gain::TrackAnalysisOptions options_;
+    std::optional<sfb::FileIdentityCache> cache_;
     std::vector<std::unique_ptr<loudness::EbuR128Analyzer>> analyzers_;
     std::vector<NSError *> errors_;
 };
 
+/// Returns the analyzer sample format matching `asbd`, or `std::nullopt` if the analyzer can't read it directly
+std::optional<loudness::EbuR128Analyzer::SampleFormat>
+directSampleFormat(const AudioStreamBasicDescription &asbd) noexcept {
+    if (asbd.mFormatID != kAudioFormatLinearPCM ||
+        (asbd.mFormatFlags & kAudioFormatFlagIsBigEndian) != kAudioFormatFlagsNativeEndian) {
+        return std::nullopt;
+    }
+
+    if (asbd.mChannelsPerFrame == 0) {
+        return std::nullopt;
+    }
+
+    const auto interleaved = (asbd.mFormatFlags & kAudioFormatFlagIsNonInterleaved) == 0;
+    const auto bytesPerSample = interleaved ? asbd.mBytesPerFrame / asbd.mChannelsPerFrame : asbd.mBytesPerFrame;
+
+    if (asbd.mFormatFlags & kAudioFormatFlagIsFloat) {
+        if (asbd.mBitsPerChannel == 32 && bytesPerSample == 4) {
+            return loudness::EbuR128Analyzer::SampleFormat::FLOAT;
+        }
+        if (asbd.mBitsPerChannel == 64 && bytesPerSample == 8) {
+            return loudness::EbuR128Analyzer::SampleFormat::DOUBLE;
+        }
+        return std::nullopt;
+    }
+
+    if ((asbd.mFormatFlags & kAudioFormatFlagIsSignedInteger) == 0) {
+        return std::nullopt;
+    }
+
+    // Samples narrower than their container are only usable if aligned high, since the analyzer scales by the
+    // container's full range
+    const auto alignedHigh = (asbd.mFormatFlags & kAudioFormatFlagIsAlignedHigh) != 0;
+    if (bytesPerSample == 2 && asbd.mBitsPerChannel == 16) {
+        return loudness::EbuR128Analyzer::SampleFormat::S16;
+    }
+    if (bytesPerSample == 3 && asbd.mBitsPerChannel == 24) {
+        return loudness::EbuR128Analyzer::SampleFormat::S24;
+    }
+    if (bytesPerSample == 4 && (asbd.mBitsPerChannel == 32 || (alignedHigh && asbd.mBitsPerChannel > 0))) {
+        return loudness::EbuR128Analyzer::SampleFormat::S32;
+    }
+    return std::nullopt;
+}
+
+/// A decoder and the objects needed to pass its output to an analyzer
+///
+/// Decoded audio is passed to the analyzer without conversion if the analyzer can read the decoder's processing
+/// format. Otherwise it is converted to deinterleaved float first.
+class AnalysisInput {
+  public:
+    /// Opens `url` for decoding, reading from `data` if it is not `nil`
+    bool open(NSURL *url, NSData *data, NSError **error) noexcept {
+        if (data != nil) {
+            SFBInputSource *inputSource = [[SFBDataInputSource alloc] initWithData:data url:url];
+            decoder_ = [[SFBAudioDecoder alloc] initWithInputSource:inputSource error:error];
+        } else {
+            decoder_ = [[SFBAudioDecoder alloc] initWithURL:url error:error];
+        }
+        if (decoder_ == nil || ![decoder_ openReturningError:error]) {
+            return false;
+        }
+
+        AVAudioFormat *inputFormat = decoder_.processingFormat;
+
+        if (auto sampleFormat = directSampleFormat(*inputFormat.streamDescription); sampleFormat.has_value()) {
+            sampleFormat_ = sampleFormat.value();
+            decodeBuffer_ = [[AVAudioPCMBuffer alloc] initWithPCMFormat:inputFormat frameCapacity:bufferSizeFrames];
+            return decodeBuffer_ != nil && reservePlanes(inputFormat);
+        }
+
+        AVAudioFormat *outputFormat = nil;
+        if (AVAudioChannelLayout *channelLayout = inputFormat.channelLayout; channelLayout != nil) {
+            outputFormat = [[AVAudioFormat alloc] initWithCommonFormat:AVAudioPCMFormatFloat32
+                                                            sampleRate:inputFormat.sampleRate
+                                                           interleaved:NO
+                                                         channelLayout:channelLayout];
+        } else {
+            outputFormat = [[AVAudioFormat alloc] initWithCommonFormat:AVAudioPCMFormatFloat32
+                                                            sampleRate:inputFormat.sampleRate
+                                                              channels:inputFormat.channelCount
+                                                           interleaved:NO];
+        }
+
+        converter_ = [[AVAudioConverter alloc] initFromFormat:inputFormat toFormat:outputFormat];
+        if (converter_ == nil) {
+            return false;
+        }
+
+        sampleFormat_ = loudness::EbuR128Analyzer::SampleFormat::FLOAT;
+        decodeBuffer_ = [[AVAudioPCMBuffer alloc] initWithPCMFormat:converter_.inputFormat
+                                                      frameCapacity:bufferSizeFrames];
+        outputBuffer_ = [[AVAudioPCMBuffer alloc] initWithPCMFormat:converter_.outputFormat
+                                                      frameCapacity:bufferSizeFrames];
+        return decodeBuffer_ != nil && outputBuffer_ != nil && reservePlanes(outputFormat);
+    }
+
+    SFBAudioDecoder *decoder() const noexcept { return decoder_; }
+
+    /// Returns a new analyzer for the decoder's processing format
+    /// - throws: `std::exception`
+    std::unique_ptr<loudness::EbuR128Analyzer> makeAnalyzer(bool measureTruePeak) const {
+        AVAudioFormat *format = decoder_.processingFormat;
+        return std::make_unique<loudness::EbuR128Analyzer>(format.channelCount, loudness::DefaultChannelWeights(),
+                                                            format.sampleRate, measureTruePeak);
+    }
+
+    /// Returns the number of frames in one analysis step, computed as `loudness::EbuR128Analyzer` computes it
+    int64_t stepFrameLength() const noexcept {
+        const auto sampleRate = static_cast<int32_t>(decoder_.processingFormat.sampleRate);
+        return static_cast<int64_t>(loudness::kStepLengthSeconds * static_cast<float>(sampleRate));
+    }
+
+    /// Decodes `frameCount` frames, or all remaining frames if `frameCount` is negative, and passes them to `analyzer`
+    ///
+    /// Returns `NO` with `*error` set to `nil` if fewer than `frameCount` frames remain.
+    bool analyze(AVAudioFramePosition frameCount, loudness::EbuR128Analyzer &analyzer, NSError **error) {
+        *error = nil;
+        while (frameCount != 0) {
+            const auto capacity = static_cast<AVAudioFramePosition>(bufferSizeFrames);
+            const auto frameLength = frameCount < 0 ? capacity : std::min(frameCount, capacity);
+            if (![decoder_ decodeIntoBuffer:decodeBuffer_
+                                frameLength:static_cast<AVAudioFrameCount>(frameLength)
+                                      error:error]) {
+                os_log_error(OS_LOG_DEFAULT, "Error decoding audio: %{public}@", *error);
+                return false;
+            }
+
+            if (decodeBuffer_.frameLength == 0) {
+                return frameCount < 0;
+            }
+
+            AVAudioPCMBuffer *buffer = decodeBuffer_;
+            if (converter_ != nil) {
+                if (![converter_ convertToBuffer:outputBuffer_ fromBuffer:decodeBuffer_ error:error]) {
+                    os_log_error(OS_LOG_DEFAULT, "Error converting audio: %{public}@", *error);
+                    return false;
+                }
+                buffer = outputBuffer_;
+            }
+
+            analyzer.Process(audioData(buffer), buffer.frameLength, sampleFormat_, sampleLayout_);
+
+            if (frameCount > 0) {
+                frameCount -= decodeBuffer_.frameLength;
+            }
+        }
+        return true;
+    }
+
+  private:
+    /// Sets the sample layout for audio in `format` and allocates space for its plane pointers
+    bool reservePlanes(AVAudioFormat *format) noexcept {
+        if (format.isInterleaved) {
+            sampleLayout_ = loudness::EbuR128Analyzer::SampleLayout::INTERLEAVED;
+            return true;
+        }
+
+        sampleLayout_ = loudness::EbuR128Analyzer::SampleLayout::PLANAR_NON_CONTIGUOUS;
+        try {
+            planes_.resize(format.channelCount);
+        } catch (const std::exception &e) {
+            return false;
+        }
+        return true;
+    }
+
+    /// Returns the audio data pointer to pass to the analyzer for `buffer`
+    ///
+    /// Deinterleaved buffers are passed as plane pointers since their planes are `frameCapacity` frames apart, not
+    /// `frameLength`.
+    const void *audioData(AVAudioPCMBuffer *buffer) noexcept {
+        const AudioBufferList *abl = buffer.audioBufferList;
+        if (sampleLayout_ == loudness::EbuR128Analyzer::SampleLayout::INTERLEAVED) {
+            return abl->mBuffers[0].mData;
+        }
+
+        for (UInt32 i = 0; i < abl->mNumberBuffers && i < planes_.size(); ++i) {
+            planes_[i] = abl->mBuffers[i].mData;
+        }
+        return planes_.data();
+    }
+
+    SFBAudioDecoder *decoder_{nil};
+    AVAudioConverter *converter_{nil};
+    AVAudioPCMBuffer *decodeBuffer_{nil};
+    AVAudioPCMBuffer *outputBuffer_{nil};
+    std::vector<const void *> planes_;
+    loudness::EbuR128Analyzer::SampleFormat sampleFormat_{loudness::EbuR128Analyzer::SampleFormat::FLOAT};
+    loudness::EbuR128Analyzer::SampleLayout sampleLayout_{loudness::EbuR128Analyzer::SampleLayout::INTERLEAVED};
+};
+
+struct SegmentContext {
+    NSURL *url_;
+    NSData *data_;
+    bool measureTruePeak_;
+    /// The first frame of each segment; the last segment extends to the end of the file
+    std::vector<AVAudioFramePosition> segmentStarts_;
+    std::vector<std::unique_ptr<loudness::EbuR128Analyzer>> analyzers_;
+};
+
+/// Analyzes one segment of a track, preceded by enough pre-roll to warm up the analyzer
+///
+/// On failure the segment's analyzer is reset.
+void analyzeSegment(void *context, size_t iteration) noexcept {
+    auto ctx = static_cast<SegmentContext *>(context);
+    auto &analyzer = ctx->analyzers_[iteration];
+
+    try {
+        AnalysisInput input;
+        NSError *error = nil;
+        if (!input.open(ctx->url_, ctx->data_, &error)) {
+            return;
+        }
+
+        analyzer = input.makeAnalyzer(ctx->measureTruePeak_);
+
+        const auto segmentStart = ctx->segmentStarts_[iteration];
+        const auto segmentFrames = iteration + 1 < ctx->segmentStarts_.size()
+                                           ? ctx->segmentStarts_[iteration + 1] - segmentStart
+                                           : -1;
+
+        if (segmentStart > 0) {
+            const auto preRoll = std::min<AVAudioFramePosition>(segmentStart, analyzer->segment_pre_roll_samples());
+            if (![input.decoder() seekToFrame:segmentStart - preRoll error:&error] ||
+                input.decoder().framePosition != segmentStart - preRoll || !input.analyze(preRoll, *analyzer, &error) ||
+                !analyzer->StartSegment(segmentStart)) {
+                analyzer.reset();
+                return;
+            }
+        }
+
+        if (!input.analyze(segmentFrames, *analyzer, &error)) {
+            analyzer.reset();
+        }
+    } catch (const std::exception &) {
+        analyzer.reset();
+    }
+}
+
+/// Returns the number of segments the track open in `input` should be split into for parallel analysis
+std::size_t segmentCount(const AnalysisInput &input, std::size_t maximumSegments) noexcept {
+    SFBAudioDecoder *decoder = input.decoder();
+    // Lossless decoders are expected to seek with sample accuracy
+    if (maximumSegments < 2 || !decoder.supportsSeeking || !decoder.decodingIsLossless) {
+        return 1;
+    }
+
+    const auto frameLength = decoder.frameLength;
+    const auto minimumSegmentFrames =
+            static_cast<AVAudioFramePosition>(minimumSegmentDuration * decoder.processingFormat.sampleRate);
+    if (frameLength <= 0 || minimumSegmentFrames <= 0) {
+        return 1;
+    }
+
+    return static_cast<std::size_t>(
+            std::clamp<AVAudioFramePosition>(frameLength / minimumSegmentFrames, 1,
+                                             static_cast<AVAudioFramePosition>(maximumSegments)));
+}
+
+/// Analyzes `url` as `count` segments in parallel and returns the merged analyzer, or `nullptr` on failure
+/// - throws: `std::exception`
+std::unique_ptr<loudness::EbuR128Analyzer> analyzeSegments(NSURL *url, NSData *data, const AnalysisInput &input,
+                                                           std::size_t count, bool measureTruePeak) {
+    const auto stepFrames = input.stepFrameLength();
+    if (stepFrames <= 0) {
+        return nullptr;
+    }
+    const auto segmentFrames = input.decoder().frameLength / static_cast<AVAudioFramePosition>(count) / stepFrames *
+                               stepFrames;
+    if (segmentFrames <= 0) {
+        return nullptr;
+    }
+
+    SegmentContext ctx{};
+    ctx.url_ = url;
+    ctx.data_ = data;
+    ctx.measureTruePeak_ = measureTruePeak;
+    ctx.segmentStarts_.resize(count);
+    ctx.analyzers_.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        ctx.segmentStarts_[i] = static_cast<AVAudioFramePosition>(i) * segmentFrames;
+    }
+
+    dispatch_apply_f(count, DISPATCH_APPLY_AUTO, &ctx, analyzeSegment);
+
+    auto &analyzer = ctx.analyzers_[0];
+    for (std::size_t i = 0; i < count; ++i) {
+        if (ctx.analyzers_[i] == nullptr || (i > 0 && !analyzer->Merge(*ctx.analyzers_[i]))) {
+            return nullptr;
+        }
+    }
+
+    return std::move(analyzer);
+}
+
+/// The header of a cached analysis, followed by the analyzer's serialized results
+struct CachedAnalysis final {
+    uint32_t channelCount_{0};
+    uint32_t measureTruePeak_{0};
+    double sampleRate_{0};
+};
+
+/// Returns the analyzer cached for `identity` in `cache`, or `nullptr` if there is no usable entry
+/// - throws: `std::exception`
+std::unique_ptr<loudness::EbuR128Analyzer> cachedAnalyzer(const sfb::FileIdentityCache &cache,
+                                                          const sfb::FileIdentity &identity, bool measureTruePeak) {
+    const auto entry = cache.find(identity);
+    if (!entry || entry->size() < sizeof(CachedAnalysis)) {
+        return nullptr;
+    }
+
+    CachedAnalysis header;
+    std::memcpy(&header, entry->data(), sizeof header);
+    if (header.measureTruePeak_ != measureTruePeak) {
+        return nullptr;
+    }
+
+    auto analyzer = std::make_unique<loudness::EbuR128Analyzer>(
+            header.channelCount_, loudness::DefaultChannelWeights(), header.sampleRate_, measureTruePeak);
+    const auto results = reinterpret_cast<const char *>(entry->data()) + sizeof header;
+    if (!analyzer->RestoreResults(std::string(results, entry->size() - sizeof header))) {
+        return nullptr;
+    }
+    return analyzer;
+}
+
+/// Stores `analyzer`, which analyzed audio in `format`, as the entry for `identity` in `cache`
+/// - throws: `std::exception`
+void cacheAnalyzer(const sfb::FileIdentityCache &cache, const sfb::FileIdentity &identity,
+                   const loudness::EbuR128Analyzer &analyzer, AVAudioFormat *format, bool measureTruePeak) {
+    CachedAnalysis header;
+    header.channelCount_ = format.channelCount;
+    header.measureTruePeak_ = measureTruePeak;
+    header.sampleRate_ = format.sampleRate;
+
+    auto payload = std::string(reinterpret_cast<const char *>(&header), sizeof header);
+    payload += analyzer.SerializeResults();
+    if (!cache.store(identity, payload.data(), payload.size())) {
+        os_log_info(OS_LOG_DEFAULT, "Unable to cache loudness analysis");
+    }
+}
+
 void analyzeURL(void *context, size_t iteration) noexcept {
     auto ctx = static_cast<ReplayGainContext *>(context);
 
     NSURL *url = [ctx->urls_ objectAtIndex:iteration];
 
-    NSError *error = nil;
-    SFBAudioDecoder *decoder = [[SFBAudioDecoder alloc] initWithURL:url error:&error];
-    if (decoder == nil || ![decoder openReturningError:&error]) {
-        ctx->errors_[iteration] = error;
+    std::optional<sfb::FileIdentity> identity;
+    if (auto analyzer = sfb::replay_gain::findCachedAnalysis(url, ctx->options_, identity); analyzer) {
+        ctx->analyzers_[iteration] = std::move(analyzer);
         return;
     }
 
-    AVAudioFormat *inputFormat = decoder.processingFormat;
-    AVAudioFormat *outputFormat = nil;
-    if (AVAudioChannelLayout *channelLayout = inputFormat.channelLayout; channelLayout != nil) {
-        outputFormat = [[AVAudioFormat alloc] initWithCommonFormat:AVAudioPCMFormatFloat32
-                                                        sampleRate:inputFormat.sampleRate
-                                                       interleaved:NO
-                                                     channelLayout:channelLayout];
-    } else {
-        outputFormat = [[AVAudioFormat alloc] initWithCommonFormat:AVAudioPCMFormatFloat32
-                                                        sampleRate:inputFormat.sampleRate
-                                                          channels:inputFormat.channelCount
-                                                       interleaved:NO];
+    NSError *error = nil;
+    ctx->analyzers_[iteration] = sfb::replay_gain::analyzeTrack(url, nil, ctx->options_, identity, &error);
+    ctx->errors_[iteration] = error;
+}
+
+/// Returns the maximum number of segments per track for the `maximumSegmentsPerTrack` property value `value`
+std::size_t effectiveMaximumSegments(NSUInteger value) noexcept {
+    return value != 0 ? value : NSProcessInfo.processInfo.activeProcessorCount;
+}
+
+/// Sets the analysis options in `ctx` from the properties of `analyzer` and allocates space for `count` results
+bool configureContext(ReplayGainContext &ctx, SFBReplayGainAnalyzer *analyzer, NSUInteger count,
+                      NSError **error) noexcept {
+    ctx.options_.measureTruePeak_ = analyzer.measuresTruePeak;
+    ctx.options_.maximumSegments_ = effectiveMaximumSegments(analyzer.maximumSegmentsPerTrack);
+    ctx.options_.cacheVerifiesFileContents_ = analyzer.cacheVerifiesFileContents;
+    try {
+        if (NSURL *cacheDirectoryURL = analyzer.cacheDirectoryURL; cacheDirectoryURL != nil) {
+            ctx.cache_.emplace(cacheDirectoryURL.fileSystemRepresentation, sfb::replay_gain::analysisCacheKind,
+                               sfb::replay_gain::analysisCacheExtension);
+            ctx.options_.cache_ = &ctx.cache_.value();
+        }
+        ctx.analyzers_.resize(count);
+        ctx.errors_.resize(count);
+    } catch (const std::exception &e) {
+        if (error != nil) {
+            *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:ENOMEM userInfo:nil];
+        }
+        return false;
     }
+    return true;
+}
 
-    AVAudioConverter *converter = [[AVAudioConverter alloc] initFromFormat:decoder.processingFormat
-                                                                  toFormat:outputFormat];
-    if (converter == nil) {
-        return;
+} /* namespace */
+
+std::unique_ptr<loudness::EbuR128Analyzer>
+sfb::replay_gain::findCachedAnalysis(NSURL *url, const TrackAnalysisOptions &options,
+                                     std::optional<FileIdentity> &identity) noexcept {
+    identity.reset();
+    if (options.cache_ == nullptr || !url.isFileURL) {
+        return nullptr;
     }
 
-    AVAudioPCMBuffer *decodeBuffer = [[AVAudioPCMBuffer alloc] initWithPCMFormat:converter.inputFormat
-                                                                   frameCapacity:bufferSizeFrames];
-    AVAudioPCMBuffer *outputBuffer = [[AVAudioPCMBuffer alloc] initWithPCMFormat:converter.outputFormat
-                                                                   frameCapacity:bufferSizeFrames];
+    identity = FileIdentity::forPath(url.fileSystemRepresentation, options.cacheVerifiesFileContents_);
+    if (!identity.has_value()) {
+        return nullptr;
+    }
 
     try {
-        auto channelWeights = loudness::DefaultChannelWeights();
-
-        ctx->analyzers_[iteration] = std::make_unique<loudness::EbuR128Analyzer>(
-                outputFormat.channelCount, channelWeights, outputFormat.sampleRate, false);
-        auto &analyzer = ctx->analyzers_[iteration];
-
-        for (;;) {
-            auto result = [decoder decodeIntoBuffer:decodeBuffer frameLength:decodeBuffer.frameCapacity error:&error];
-            if (!result) {
-                os_log_error(OS_LOG_DEFAULT, "Error decoding audio: %{public}@", error);
-                ctx->analyzers_[iteration].reset();
-                ctx->errors_[iteration] = error;
-                return;
+        return cachedAnalyzer(*options.cache_, *identity, options.measureTruePeak_);
+    } catch (const std::exception &e) {
+        return nullptr;
+    }
+}
+
+std::unique_ptr<loudness::EbuR128Analyzer> sfb::replay_gain::analyzeTrack(NSURL *url, NSData *data,
+                                                                          const TrackAnalysisOptions &options,
+                                                                          const std::optional<FileIdentity> &identity,
+                                                                          NSError **error) noexcept {
+    *error = nil;
+
+    try {
+        AnalysisInput input;
+        if (!input.open(url, data, error)) {
+            if (*error == nil) {
+                *error = SFBErrorWithLocalizedDescription(
+                        SFBReplayGainAnalyzerErrorDomain, SFBReplayGainAnalyzerErrorCodeFileFormatNotSupported,
+                        NSLocalizedString(@"The format of the file “%@” is not supported.", @""), @{
+                            NSLocalizedRecoverySuggestionErrorKey : NSLocalizedString(
+                                    @"The file's format is not supported for replay gain analysis.", @"")
+                        },
+                        SFBLocalizedNameForURL(url));
             }
+            return nullptr;
+        }
 
-            if (decodeBuffer.frameLength == 0) {
-                return;
+        std::unique_ptr<loudness::EbuR128Analyzer> analyzer;
+
+        // Segmented analysis only fails on unexpected input; in that case fall back to a single pass which will
+        // report any real errors
+        if (const auto count = segmentCount(input, options.maximumSegments_); count > 1) {
+            analyzer = analyzeSegments(url, data, input, count, options.measureTruePeak_);
+            if (!analyzer) {
+                os_log_debug(OS_LOG_DEFAULT, "Segmented analysis of %{public}@ failed; analyzing sequentially", url);
             }
+        }
 
-            result = [converter convertToBuffer:outputBuffer fromBuffer:decodeBuffer error:&error];
-            if (!result) {
-                os_log_error(OS_LOG_DEFAULT, "Error converting audio: %{public}@", error);
-                ctx->analyzers_[iteration].reset();
-                ctx->errors_[iteration] = error;
-                return;
+        if (!analyzer) {
+            analyzer = input.makeAnalyzer(options.measureTruePeak_);
+            if (!input.analyze(-1, *analyzer, error)) {
+                return nullptr;
             }
+        }
 
-            analyzer->Process(outputBuffer.floatChannelData[0], outputBuffer.frameLength,
-                              loudness::EbuR128Analyzer::SampleFormat::FLOAT,
-                              loudness::EbuR128Analyzer::SampleLayout::PLANAR_CONTIGUOUS);
+        if (options.cache_ != nullptr && identity.has_value()) {
+            cacheAnalyzer(*options.cache_, *identity, *analyzer, input.decoder().processingFormat,
+                          options.measureTruePeak_);
         }
+
+        return analyzer;
     } catch (const std::exception &e) {
         os_log_error(OS_LOG_DEFAULT, "Error analyzing audio: %{public}s", e.what());
-        ctx->analyzers_[iteration].reset();
-        ctx->errors_[iteration] = [NSError errorWithDomain:NSPOSIXErrorDomain code:EFTYPE userInfo:nil];
+        *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:EFTYPE userInfo:nil];
+        return nullptr;
     }
 }
 
-} /* namespace */
+float sfb::replay_gain::peak(const loudness::EbuR128Analyzer &analyzer, bool measureTruePeak) noexcept {
+    return measureTruePeak ? analyzer.true_peak() : analyzer.digital_peak();
+}
 
-@interface SFBReplayGain ()
-- (instancetype)initWithGain:(float)gain peak:(float)peak;
-@end
+SFBReplayGain *sfb::replay_gain::trackReplayGain(const loudness::EbuR128Analyzer &analyzer, NSURL *url,
+                                                 bool measureTruePeak, NSError **error) noexcept {
+    auto loudness = analyzer.GetRelativeGatedIntegratedLoudness();
+    if (!loudness.has_value()) {
+        if (error != nil) {
+            *error = SFBErrorWithLocalizedDescription(
+                    SFBReplayGainAnalyzerErrorDomain, SFBReplayGainAnalyzerErrorCodeInsufficientSamples,
+                    NSLocalizedString(@"The file “%@” does not contain sufficient audio for analysis.", @""), @{
+                        NSLocalizedRecoverySuggestionErrorKey :
+                                NSLocalizedString(@"The audio duration is too short for replay gain analysis.", @"")
+                    },
+                    SFBLocalizedNameForURL(url));
+        }
+
+        return nil;
+    }
+
+    const auto gain = referenceLoudness - loudness.value();
+    return [[SFBReplayGain alloc] initWithGain:gain peak:peak(analyzer, measureTruePeak)];
+}
+
+SFBReplayGain *sfb::replay_gain::albumReplayGain(const std::vector<loudness::EbuR128Analyzer *> &analyzers,
+                                                 float peak, NSError **error) noexcept {
+    auto loudness = loudness::EbuR128Analyzer::GetRelativeGatedIntegratedLoudness(analyzers);
+    if (!loudness.has_value()) {
+        if (error != nil) {
+            *error = [NSError errorWithDomain:SFBReplayGainAnalyzerErrorDomain
+                                         code:SFBReplayGainAnalyzerErrorCodeInsufficientSamples
+                                     userInfo:@{
+                                         NSLocalizedDescriptionKey : NSLocalizedString(
+                                                 @"The files do not contain sufficient audio for analysis.", @""),
+                                         NSLocalizedRecoverySuggestionErrorKey : NSLocalizedString(
+                                                 @"The audio duration is too short for replay gain analysis.", @"")
+                                     }];
+        }
+
+        return nil;
+    }
+
+    const auto gain = referenceLoudness - loudness.value();
+    return [[SFBReplayGain alloc] initWithGain:gain peak:peak];
+}
 
 @implementation SFBReplayGain
 - (instancetype)initWithGain:(float)gain peak:(float)peak {
@@ -123,11 +555,6 @@ void analyzeURL(void *context, size_t iteration) noexcept {
 }
 @end
 
-@interface SFBAlbumReplayGain ()
-- (instancetype)initWithReplayGain:(SFBReplayGain *)replayGain
-                   trackReplayGain:(NSDictionary<NSURL *, SFBReplayGain *> *)trackReplayGain;
-@end
-
 @implementation SFBAlbumReplayGain
 - (instancetype)initWithReplayGain:(SFBReplayGain *)replayGain
                    trackReplayGain:(NSDictionary<NSURL *, SFBReplayGain *> *)trackReplayGain {
@@ -181,13 +608,7 @@ void analyzeURL(void *context, size_t iteration) noexcept {
 
     ReplayGainContext ctx{};
     ctx.urls_ = @[ url ];
-    try {
-        ctx.analyzers_.resize(1);
-        ctx.errors_.resize(1);
-    } catch (const std::exception &e) {
-        if (error != nil) {
-            *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:ENOMEM userInfo:nil];
-        }
+    if (!configureContext(ctx, self, 1, error)) {
         return nil;
     }
 
@@ -196,40 +617,12 @@ void analyzeURL(void *context, size_t iteration) noexcept {
     auto &analyzer = ctx.analyzers_[0];
     if (analyzer == nullptr) {
         if (error != nil) {
-            if (NSError *err = ctx.errors_[0]; err != nil) {
-                *error = err;
-            } else {
-                *error = SFBErrorWithLocalizedDescription(
-                        SFBReplayGainAnalyzerErrorDomain, SFBReplayGainAnalyzerErrorCodeFileFormatNotSupported,
-                        NSLocalizedString(@"The format of the file “%@” is not supported.", @""), @{
-                            NSLocalizedRecoverySuggestionErrorKey : NSLocalizedString(
-                                    @"The file's format is not supported for replay gain analysis.", @"")
-                        },
-                        SFBLocalizedNameForURL(url));
-            }
-        }
-        return nil;
-    }
-
-    auto loudness = analyzer->GetRelativeGatedIntegratedLoudness();
-    auto digitalPeak = analyzer->digital_peak();
-
-    if (!loudness.has_value()) {
-        if (error != nil) {
-            *error = SFBErrorWithLocalizedDescription(
-                    SFBReplayGainAnalyzerErrorDomain, SFBReplayGainAnalyzerErrorCodeInsufficientSamples,
-                    NSLocalizedString(@"The file “%@” does not contain sufficient audio for analysis.", @""), @{
-                        NSLocalizedRecoverySuggestionErrorKey :
-                                NSLocalizedString(@"The audio duration is too short for replay gain analysis.", @"")
-                    },
-                    SFBLocalizedNameForURL(url));
+            *error = ctx.errors_[0];
         }
-
         return nil;
     }
 
-    const auto gain = referenceLoudness - loudness.value();
-    return [[SFBReplayGain alloc] initWithGain:gain peak:digitalPeak];
+    return sfb::replay_gain::trackReplayGain(*analyzer, url, _measuresTruePeak, error);
 }
 
 - (SFBAlbumReplayGain *)analyzeAlbum:(NSArray<NSURL *> *)urls error:(NSError **)error {
@@ -243,8 +636,6 @@ void analyzeURL(void *context, size_t iteration) noexcept {
     std::vector<loudness::EbuR128Analyzer *> analyzers{};
 
     try {
-        ctx.analyzers_.resize(count);
-        ctx.errors_.resize(count);
         analyzers.resize(count);
     } catch (const std::exception &e) {
         if (error != nil) {
@@ -253,6 +644,10 @@ void analyzeURL(void *context, size_t iteration) noexcept {
         return nil;
     }
 
+    if (!configureContext(ctx, self, count, error)) {
+        return nil;
+    }
+
     dispatch_apply_f(count, DISPATCH_APPLY_AUTO, &ctx, analyzeURL);
 
     NSMutableDictionary *trackReplayGain = [NSMutableDictionary dictionary];
@@ -263,65 +658,27 @@ void analyzeURL(void *context, size_t iteration) noexcept {
         auto &analyzer = ctx.analyzers_[i];
         if (analyzer == nullptr) {
             if (error != nil) {
-                if (NSError *err = ctx.errors_[i]; err != nil) {
-                    *error = err;
-                } else {
-                    *error = SFBErrorWithLocalizedDescription(
-                            SFBReplayGainAnalyzerErrorDomain, SFBReplayGainAnalyzerErrorCodeFileFormatNotSupported,
-                            NSLocalizedString(@"The format of the file “%@” is not supported.", @""), @{
-                                NSLocalizedRecoverySuggestionErrorKey : NSLocalizedString(
-                                        @"The file's format is not supported for replay gain analysis.", @"")
-                            },
-                            SFBLocalizedNameForURL(url));
-                }
+                *error = ctx.errors_[i];
             }
             return nil;
         }
 
         analyzers[i] = analyzer.get();
 
-        auto loudness = analyzer->GetRelativeGatedIntegratedLoudness();
-        auto digitalPeak = analyzer->digital_peak();
-
-        if (!loudness.has_value()) {
-            if (error != nil) {
-                *error = SFBErrorWithLocalizedDescription(
-                        SFBReplayGainAnalyzerErrorDomain, SFBReplayGainAnalyzerErrorCodeInsufficientSamples,
-                        NSLocalizedString(@"The file “%@” does not contain sufficient audio for analysis.", @""), @{
-                            NSLocalizedRecoverySuggestionErrorKey :
-                                    NSLocalizedString(@"The audio duration is too short for replay gain analysis.", @"")
-                        },
-                        SFBLocalizedNameForURL(url));
-            }
-
+        SFBReplayGain *replayGain = sfb::replay_gain::trackReplayGain(*analyzer, url, _measuresTruePeak, error);
+        if (replayGain == nil) {
             return nil;
         }
 
-        albumPeak = std::max(albumPeak, digitalPeak);
-
-        const auto gain = referenceLoudness - loudness.value();
-        [trackReplayGain setObject:[[SFBReplayGain alloc] initWithGain:gain peak:digitalPeak] forKey:url];
+        albumPeak = std::max(albumPeak, replayGain.peak);
+        [trackReplayGain setObject:replayGain forKey:url];
     }
 
-    auto loudness = loudness::EbuR128Analyzer::GetRelativeGatedIntegratedLoudness(analyzers);
-    if (!loudness.has_value()) {
-        if (error != nil) {
-            *error = [NSError errorWithDomain:SFBReplayGainAnalyzerErrorDomain
-                                         code:SFBReplayGainAnalyzerErrorCodeInsufficientSamples
-                                     userInfo:@{
-                                         NSLocalizedDescriptionKey : NSLocalizedString(
-                                                 @"The files do not contain sufficient audio for analysis.", @""),
-                                         NSLocalizedRecoverySuggestionErrorKey : NSLocalizedString(
-                                                 @"The audio duration is too short for replay gain analysis.", @"")
-                                     }];
-        }
-
+    SFBReplayGain *replayGain = sfb::replay_gain::albumReplayGain(analyzers, albumPeak, error);
+    if (replayGain == nil) {
         return nil;
     }
 
-    const auto gain = referenceLoudness - loudness.value();
-
-    SFBReplayGain *replayGain = [[SFBReplayGain alloc] initWithGain:gain peak:albumPeak];
     return [[SFBAlbumReplayGain alloc] initWithReplayGain:replayGain trackReplayGain:trackReplayGain];
 }
 
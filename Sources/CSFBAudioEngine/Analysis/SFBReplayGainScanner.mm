@@ -0,0 +1,386 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#import "SFBReplayGainScanner.h"
+
+#import "SFBReplayGainAnalyzer+Internal.h"
+
+#import <os/log.h>
+
+#import <algorithm>
+#import <atomic>
+#import <deque>
+#import <memory>
+#import <optional>
+#import <vector>
+
+namespace {
+
+constexpr NSUInteger defaultMaximumConcurrentReads = 2;
+constexpr NSUInteger defaultMaximumReadAheadSize = 256 * 1024 * 1024;
+
+/// The results collected for one album
+struct AlbumState final {
+    /// The album's track URLs
+    NSArray<NSURL *> *urls_{nil};
+    /// The number of tracks not yet completed
+    std::size_t remaining_{0};
+    /// The analyzers for completed tracks
+    std::vector<std::shared_ptr<loudness::EbuR128Analyzer>> analyzers_;
+    /// The replay gain of completed tracks
+    NSMutableDictionary<NSURL *, SFBReplayGain *> *trackReplayGain_{nil};
+    /// The largest track peak
+    float peak_{0};
+    /// The first track error
+    NSError *error_{nil};
+};
+
+/// A track read and awaiting analysis
+struct ReadTrack final {
+    NSUInteger trackIndex_{0};
+    NSUInteger albumIndex_{0};
+    /// The file's contents or `nil` if the decoder should read the file
+    NSData *data_{nil};
+    /// The number of bytes of `data_` counted against the read-ahead budget
+    NSUInteger readAheadSize_{0};
+    std::optional<sfb::FileIdentity> identity_;
+};
+
+/// The state of one scan, shared by its stages
+///
+/// Reads and analyses are submitted to `workQueue_` from `scheduleQueue_` only when one of their slots is free, so no
+/// worker thread ever waits for a slot. The album results in `albums_` are only accessed on `resultQueue_`; the track
+/// URLs are immutable once the scan starts.
+struct ScanState final {
+    sfb::replay_gain::TrackAnalysisOptions options_;
+    std::optional<sfb::FileIdentityCache> cache_;
+    NSUInteger maximumReadAheadSize_{0};
+    /// The number of bytes read into memory and not yet analyzed
+    std::atomic<NSUInteger> readAheadSize_{0};
+    NSUInteger maximumReads_{0};
+    NSUInteger maximumAnalyses_{0};
+
+    /// Tracks all outstanding work
+    dispatch_group_t group_{nil};
+    /// The serial queue on which reads and analyses are scheduled
+    dispatch_queue_t scheduleQueue_{nil};
+    /// The queue on which reading and analysis run
+    dispatch_queue_t workQueue_{nil};
+    /// The serial queue on which results are collected and delivered
+    dispatch_queue_t resultQueue_{nil};
+
+    // Scheduling state, only accessed on `scheduleQueue_`
+
+    /// The album of the next track to read
+    NSUInteger nextAlbum_{0};
+    /// The next track to read in `nextAlbum_`
+    NSUInteger nextTrack_{0};
+    /// The number of reads in progress
+    NSUInteger activeReads_{0};
+    /// The number of analyses in progress
+    NSUInteger activeAnalyses_{0};
+    /// Tracks read and awaiting analysis, in order
+    std::deque<ReadTrack> readTracks_;
+
+    std::vector<AlbumState> albums_;
+
+    SFBReplayGainScannerTrackBlock trackBlock_{nil};
+    SFBReplayGainScannerAlbumBlock albumBlock_{nil};
+};
+
+} /* namespace */
+
+@interface SFBReplayGainScanner () {
+  @private
+    /// Whether a scan is in progress
+    std::atomic_bool _scanning;
+    /// Whether the scan in progress has been cancelled
+    std::atomic_bool _cancelled;
+}
+- (void)scheduleWork:(std::shared_ptr<ScanState>)state;
+- (void)readTrack:(NSUInteger)trackIndex ofAlbum:(NSUInteger)albumIndex state:(std::shared_ptr<ScanState>)state;
+- (void)analyzeTrack:(ReadTrack)track state:(std::shared_ptr<ScanState>)state;
+- (void)completeTrack:(NSUInteger)trackIndex
+              ofAlbum:(NSUInteger)albumIndex
+             analyzer:(std::shared_ptr<loudness::EbuR128Analyzer>)analyzer
+                error:(NSError *)error
+                state:(std::shared_ptr<ScanState>)state;
+@end
+
+@implementation SFBReplayGainScanner
+
+- (instancetype)init {
+    if ((self = [super init])) {
+        _maximumConcurrentReads = defaultMaximumConcurrentReads;
+        _maximumReadAheadSize = defaultMaximumReadAheadSize;
+    }
+    return self;
+}
+
+- (BOOL)isScanning {
+    return _scanning.load(std::memory_order_acquire);
+}
+
+- (BOOL)scanAlbums:(NSArray<NSArray<NSURL *> *> *)albums
+           trackBlock:(SFBReplayGainScannerTrackBlock)trackBlock
+           albumBlock:(SFBReplayGainScannerAlbumBlock)albumBlock
+      completionBlock:(SFBReplayGainScannerCompletionBlock)completionBlock {
+    NSParameterAssert(albums != nil);
+    NSParameterAssert(trackBlock != nil);
+
+    if (_scanning.exchange(true, std::memory_order_acq_rel)) {
+        return NO;
+    }
+    _cancelled.store(false, std::memory_order_release);
+
+    const NSUInteger maximumReads = std::max<NSUInteger>(_maximumConcurrentReads, 1);
+    const NSUInteger maximumAnalyses = _maximumConcurrentAnalyses != 0
+                                               ? _maximumConcurrentAnalyses
+                                               : NSProcessInfo.processInfo.activeProcessorCount;
+
+    std::shared_ptr<ScanState> state;
+    try {
+        state = std::make_shared<ScanState>();
+        state->options_.measureTruePeak_ = _measuresTruePeak;
+        // Tracks are analyzed concurrently with each other, not in segments
+        state->options_.maximumSegments_ = 1;
+        state->options_.cacheVerifiesFileContents_ = _cacheVerifiesFileContents;
+        if (_cacheDirectoryURL != nil) {
+            state->cache_.emplace(_cacheDirectoryURL.fileSystemRepresentation, sfb::replay_gain::analysisCacheKind,
+                                  sfb::replay_gain::analysisCacheExtension);
+            state->options_.cache_ = &state->cache_.value();
+        }
+
+        state->albums_.resize(albums.count);
+        for (NSUInteger i = 0; i < albums.count; ++i) {
+            auto &album = state->albums_[i];
+            album.urls_ = [albums objectAtIndex:i];
+            album.remaining_ = album.urls_.count;
+            if (album.urls_.count > 1) {
+                album.analyzers_.resize(album.urls_.count);
+                album.trackReplayGain_ = [NSMutableDictionary dictionaryWithCapacity:album.urls_.count];
+            }
+        }
+    } catch (const std::exception &e) {
+        os_log_error(OS_LOG_DEFAULT, "Unable to allocate memory for scan: %{public}s", e.what());
+        _scanning.store(false, std::memory_order_release);
+        return NO;
+    }
+
+    state->maximumReadAheadSize_ = _maximumReadAheadSize;
+    state->maximumReads_ = maximumReads;
+    state->maximumAnalyses_ = std::max<NSUInteger>(maximumAnalyses, 1);
+    state->group_ = dispatch_group_create();
+    state->scheduleQueue_ = dispatch_queue_create("SFBReplayGainScanner.Schedule", DISPATCH_QUEUE_SERIAL);
+    state->workQueue_ = dispatch_get_global_queue(QOS_CLASS_UTILITY, 0);
+    state->resultQueue_ = dispatch_queue_create("SFBReplayGainScanner.Results", DISPATCH_QUEUE_SERIAL);
+    state->trackBlock_ = trackBlock;
+    state->albumBlock_ = albumBlock;
+
+    // All work is submitted from blocks in the group, so the group empties only once the scan is finished
+    dispatch_group_async(state->group_, state->scheduleQueue_, ^{
+        [self scheduleWork:state];
+    });
+
+    dispatch_group_notify(state->group_, state->resultQueue_, ^{
+        const bool cancelled = self->_cancelled.load(std::memory_order_acquire);
+        self->_scanning.store(false, std::memory_order_release);
+        if (completionBlock != nil) {
+            completionBlock(cancelled);
+        }
+    });
+
+    return YES;
+}
+
+- (void)cancel {
+    _cancelled.store(true, std::memory_order_release);
+}
+
+/// Submits reads and analyses while slots are free
+///
+/// Runs on `scheduleQueue_` whenever a read or analysis finishes. Tracks are read in order, and at most
+/// `maximumReads_ + maximumAnalyses_` tracks are read or analyzed at once. Tracks already read are analyzed first.
+- (void)scheduleWork:(std::shared_ptr<ScanState>)state {
+    if (_cancelled.load(std::memory_order_acquire)) {
+        for (const auto &track : state->readTracks_) {
+            state->readAheadSize_.fetch_sub(track.readAheadSize_, std::memory_order_relaxed);
+        }
+        state->readTracks_.clear();
+        return;
+    }
+
+    while (state->activeAnalyses_ < state->maximumAnalyses_ && !state->readTracks_.empty()) {
+        ReadTrack track = std::move(state->readTracks_.front());
+        state->readTracks_.pop_front();
+        ++state->activeAnalyses_;
+        dispatch_group_async(state->group_, state->workQueue_, ^{
+            [self analyzeTrack:track state:state];
+        });
+    }
+
+    const auto maximumTracks = state->maximumReads_ + state->maximumAnalyses_;
+    while (state->activeReads_ < state->maximumReads_ &&
+           state->activeReads_ + state->readTracks_.size() + state->activeAnalyses_ < maximumTracks) {
+        while (state->nextAlbum_ < state->albums_.size() &&
+               state->nextTrack_ == state->albums_[state->nextAlbum_].urls_.count) {
+            ++state->nextAlbum_;
+            state->nextTrack_ = 0;
+        }
+        if (state->nextAlbum_ == state->albums_.size()) {
+            break;
+        }
+
+        const auto albumIndex = state->nextAlbum_;
+        const auto trackIndex = state->nextTrack_++;
+        ++state->activeReads_;
+        dispatch_group_async(state->group_, state->workQueue_, ^{
+            [self readTrack:trackIndex ofAlbum:albumIndex state:state];
+        });
+    }
+}
+
+/// I/O stage: checks the cache and reads the file into memory
+- (void)readTrack:(NSUInteger)trackIndex ofAlbum:(NSUInteger)albumIndex state:(std::shared_ptr<ScanState>)state {
+    NSURL *url = [state->albums_[albumIndex].urls_ objectAtIndex:trackIndex];
+
+    std::optional<sfb::FileIdentity> identity;
+    if (auto analyzer = sfb::replay_gain::findCachedAnalysis(url, state->options_, identity); analyzer) {
+        dispatch_group_async(state->group_, state->scheduleQueue_, ^{
+            --state->activeReads_;
+            [self scheduleWork:state];
+        });
+        [self completeTrack:trackIndex ofAlbum:albumIndex analyzer:std::move(analyzer) error:nil state:state];
+        return;
+    }
+
+    // Failures here are not fatal; the decoder will read the file itself and report any errors
+    NSData *data = nil;
+    NSUInteger readAheadSize = 0;
+    if (url.isFileURL) {
+        NSNumber *fileSize = nil;
+        if ([url getResourceValue:&fileSize forKey:NSURLFileSizeKey error:nil] && fileSize != nil) {
+            // Files that do not fit in the budget remaining are left for the decoder
+            const NSUInteger size = fileSize.unsignedIntegerValue;
+            NSUInteger reserved = state->readAheadSize_.load(std::memory_order_relaxed);
+            while (size <= state->maximumReadAheadSize_ - std::min(reserved, state->maximumReadAheadSize_)) {
+                if (state->readAheadSize_.compare_exchange_weak(reserved, reserved + size, std::memory_order_relaxed)) {
+                    readAheadSize = size;
+                    break;
+                }
+            }
+        }
+        if (readAheadSize > 0) {
+            data = [NSData dataWithContentsOfURL:url options:NSDataReadingUncached error:nil];
+            if (data == nil) {
+                state->readAheadSize_.fetch_sub(readAheadSize, std::memory_order_relaxed);
+                readAheadSize = 0;
+            }
+        }
+    }
+
+    ReadTrack track{trackIndex, albumIndex, data, readAheadSize, identity};
+    dispatch_group_async(state->group_, state->scheduleQueue_, ^{
+        --state->activeReads_;
+        state->readTracks_.push_back(track);
+        [self scheduleWork:state];
+    });
+}
+
+/// CPU stage: decodes and analyzes the track
+- (void)analyzeTrack:(ReadTrack)track state:(std::shared_ptr<ScanState>)state {
+    std::shared_ptr<loudness::EbuR128Analyzer> analyzer;
+    NSError *error = nil;
+    const bool cancelled = _cancelled.load(std::memory_order_acquire);
+    if (!cancelled) {
+        NSURL *url = [state->albums_[track.albumIndex_].urls_ objectAtIndex:track.trackIndex_];
+        analyzer = sfb::replay_gain::analyzeTrack(url, track.data_, state->options_, track.identity_, &error);
+    }
+    track.data_ = nil;
+    state->readAheadSize_.fetch_sub(track.readAheadSize_, std::memory_order_relaxed);
+
+    dispatch_group_async(state->group_, state->scheduleQueue_, ^{
+        --state->activeAnalyses_;
+        [self scheduleWork:state];
+    });
+
+    if (!cancelled) {
+        [self completeTrack:track.trackIndex_
+                    ofAlbum:track.albumIndex_
+                   analyzer:std::move(analyzer)
+                      error:error
+                      state:state];
+    }
+}
+
+/// Delivers the result for a track and, if it was the last of its album, the album
+- (void)completeTrack:(NSUInteger)trackIndex
+              ofAlbum:(NSUInteger)albumIndex
+             analyzer:(std::shared_ptr<loudness::EbuR128Analyzer>)analyzer
+                error:(NSError *)error
+                state:(std::shared_ptr<ScanState>)state {
+    dispatch_group_async(state->group_, state->resultQueue_, ^{
+        auto &album = state->albums_[albumIndex];
+        NSURL *url = [album.urls_ objectAtIndex:trackIndex];
+        const auto measureTruePeak = state->options_.measureTruePeak_;
+
+        NSError *trackError = error;
+        SFBReplayGain *replayGain = nil;
+        if (analyzer != nullptr) {
+            replayGain = sfb::replay_gain::trackReplayGain(*analyzer, url, measureTruePeak, &trackError);
+        }
+
+        state->trackBlock_(url, replayGain, trackError);
+
+        --album.remaining_;
+        if (album.urls_.count < 2) {
+            return;
+        }
+
+        if (replayGain != nil) {
+            album.analyzers_[trackIndex] = analyzer;
+            album.peak_ = std::max(album.peak_, replayGain.peak);
+            [album.trackReplayGain_ setObject:replayGain forKey:url];
+        } else if (album.error_ == nil) {
+            album.error_ = trackError;
+        }
+
+        if (album.remaining_ > 0) {
+            return;
+        }
+
+        if (state->albumBlock_ != nil) {
+            if (album.error_ != nil) {
+                state->albumBlock_(album.urls_, nil, album.error_);
+            } else {
+                NSError *albumError = nil;
+                SFBAlbumReplayGain *albumReplayGain = nil;
+                try {
+                    std::vector<loudness::EbuR128Analyzer *> analyzers(album.analyzers_.size());
+                    std::transform(album.analyzers_.begin(), album.analyzers_.end(), analyzers.begin(),
+                                   [](const auto &analyzer) { return analyzer.get(); });
+                    if (SFBReplayGain *albumGain = sfb::replay_gain::albumReplayGain(analyzers, album.peak_,
+                                                                                      &albumError);
+                        albumGain != nil) {
+                        albumReplayGain = [[SFBAlbumReplayGain alloc] initWithReplayGain:albumGain
+                                                                          trackReplayGain:album.trackReplayGain_];
+                    }
+                } catch (const std::exception &e) {
+                    albumError = [NSError errorWithDomain:NSPOSIXErrorDomain code:ENOMEM userInfo:nil];
+                }
+                state->albumBlock_(album.urls_, albumReplayGain, albumError);
+            }
+        }
+
+        // Release the album's analyzers as soon as they are no longer needed
+        album.analyzers_.clear();
+        album.analyzers_.shrink_to_fit();
+        album.trackReplayGain_ = nil;
+    });
+}
+
+@end
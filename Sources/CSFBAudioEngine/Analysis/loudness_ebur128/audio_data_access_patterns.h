@@ -48,6 +48,27 @@ namespace loudness {
 using DataPlaneType = const void*;
 using loudness::EbuR128Analyzer;
 
+// Added by sfb 20261015
+// A signed 24-bit integer sample packed in 3 bytes in native byte order.
+struct PackedInt24 {
+  uint8_t bytes[3];
+
+  int32_t value() const {
+    // Assemble the sample in the high 24 bits and sign-extend with a shift.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    const uint32_t high = (uint32_t{bytes[0]} << 24) |
+                          (uint32_t{bytes[1]} << 16) |
+                          (uint32_t{bytes[2]} << 8);
+#else
+    const uint32_t high = (uint32_t{bytes[2]} << 24) |
+                          (uint32_t{bytes[1]} << 16) |
+                          (uint32_t{bytes[0]} << 8);
+#endif
+    return static_cast<int32_t>(high) >> 8;
+  }
+};
+static_assert(sizeof(PackedInt24) == 3);
+
 //
 // GetDataPosition
 //
@@ -121,6 +142,35 @@ GetDataPosition<int32_t, EbuR128Analyzer::PLANAR_NON_CONTIGUOUS>(
          sample_index;
 }
 
+template <>
+/* __attribute__((always_inline)) */ inline const PackedInt24*
+GetDataPosition<PackedInt24, EbuR128Analyzer::INTERLEAVED>(
+    const void* audio_data, int64_t sample_index, int channel_index,
+    int interleaved_stride, int64_t /*planar_stride*/) {
+  return reinterpret_cast<const PackedInt24*>(audio_data) +
+         (sample_index * interleaved_stride) + channel_index;
+}
+
+template <>
+/* __attribute__((always_inline)) */ inline const PackedInt24*
+GetDataPosition<PackedInt24, EbuR128Analyzer::PLANAR_CONTIGUOUS>(
+    const void* audio_data, int64_t sample_index, int channel_index,
+    int /*interleaved_stride*/, int64_t planar_stride) {
+  return (reinterpret_cast<const PackedInt24*>(audio_data)) +
+         (channel_index * planar_stride) + sample_index;
+}
+
+template <>
+/* __attribute__((always_inline)) */ inline const PackedInt24*
+GetDataPosition<PackedInt24, EbuR128Analyzer::PLANAR_NON_CONTIGUOUS>(
+    const void* audio_data, int64_t sample_index, int channel_index,
+    int /*interleaved_stride*/, int64_t /*planar_stride*/) {
+  const DataPlaneType* plane_pointers =
+      reinterpret_cast<const DataPlaneType*>(audio_data);
+  return reinterpret_cast<const PackedInt24*>(plane_pointers[channel_index]) +
+         sample_index;
+}
+
 template <>
 /* __attribute__((always_inline)) */ inline const float*
 GetDataPosition<float, EbuR128Analyzer::INTERLEAVED>(const void* audio_data,
@@ -259,6 +309,43 @@ GetSampleFromOrigin<int32_t, EbuR128Analyzer::PLANAR_NON_CONTIGUOUS>(
              planar_stride))[0];
 }
 
+template <>
+/* __attribute__((always_inline)) */ inline float
+GetSampleFromOrigin<PackedInt24, EbuR128Analyzer::INTERLEAVED>(
+    const void* audio_data, int64_t sample_index, int channel_index,
+    int interleaved_stride, int64_t planar_stride) {
+  return kNorm24 *
+         (GetDataPosition<PackedInt24, EbuR128Analyzer::INTERLEAVED>(
+             audio_data, sample_index, channel_index, interleaved_stride,
+             planar_stride))[0]
+             .value();
+}
+
+template <>
+/* __attribute__((always_inline)) */ inline float
+GetSampleFromOrigin<PackedInt24, EbuR128Analyzer::PLANAR_CONTIGUOUS>(
+    const void* audio_data, int64_t sample_index, int channel_index,
+    int interleaved_stride, int64_t planar_stride) {
+  return kNorm24 *
+         (GetDataPosition<PackedInt24, EbuR128Analyzer::PLANAR_CONTIGUOUS>(
+             audio_data, sample_index, channel_index, interleaved_stride,
+             planar_stride))[0]
+             .value();
+}
+
+template <>
+/* __attribute__((always_inline)) */ inline float
+GetSampleFromOrigin<PackedInt24, EbuR128Analyzer::PLANAR_NON_CONTIGUOUS>(
+    const void* audio_data, int64_t sample_index, int channel_index,
+    int interleaved_stride, int64_t planar_stride) {
+  return kNorm24 *
+         (GetDataPosition<PackedInt24,
+                          EbuR128Analyzer::PLANAR_NON_CONTIGUOUS>(
+             audio_data, sample_index, channel_index, interleaved_stride,
+             planar_stride))[0]
+             .value();
+}
+
 template <>
 /* __attribute__((always_inline)) */ inline float
 GetSampleFromOrigin<float, EbuR128Analyzer::INTERLEAVED>(
@@ -21,11 +21,15 @@
 #include <iterator>
 #include <numeric>
 #include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "audio_data_access_patterns.h"
 #include "ebur128_constants.h"
 #include "k_weighting.h"
+#include "state_serialization.h"
 
 namespace loudness {
 
@@ -45,6 +49,16 @@ float SanitizedConvertToDBFS(float amplitude) {
   return ClampAndSanitizeDBFS(20.0f * log10f(std::fabs(amplitude)));
 }
 
+// Identifies serialized analyzer state. Bump the version whenever the
+// serialized layout changes.
+constexpr uint32_t kStateMagic = 0x45425552;  // 'EBUR'
+constexpr uint32_t kStateVersion = 1;
+
+// Identifies serialized analysis results. Bump the version whenever the
+// serialized layout changes.
+constexpr uint32_t kResultsMagic = 0x45425252;  // 'EBRR'
+constexpr uint32_t kResultsVersion = 1;
+
 // Helper function to increment an index to a circular buffer
 inline int32_t IncrementCircularIndex(int32_t index, int64_t mod) {
   int32_t next_index = index + 1;
@@ -54,6 +68,70 @@ inline int32_t IncrementCircularIndex(int32_t index, int64_t mod) {
   return next_index;
 }
 
+// Computes the max absolute value of the 4x upsampled audio produced by
+// applying the ITU 1770 polyphase FIR filters to num_outputs input samples.
+// input_audio must hold kTruePeakFilterLength - 1 samples of history
+// followed by the num_outputs new samples.
+//
+// Several consecutive outputs are computed at once, one per vector lane. For
+// each output the taps are accumulated oldest sample first, matching the
+// order of the original per-sample circular-buffer implementation.
+float MaxTruePeakOfBlock(const float* input_audio, const int64_t num_outputs) {
+  constexpr int kLast = kTruePeakFilterLength - 1;
+
+  // Broadcast the taps once, in the order they are applied.
+  FloatLanes phase0_taps[kTruePeakFilterLength];
+  FloatLanes phase1_taps[kTruePeakFilterLength];
+  FloatLanes phase2_taps[kTruePeakFilterLength];
+  FloatLanes phase3_taps[kTruePeakFilterLength];
+  for (int j = 0; j < kTruePeakFilterLength; ++j) {
+    phase0_taps[j] = FloatLanes::Broadcast(kTruePeakFilterPhase0[kLast - j]);
+    phase1_taps[j] = FloatLanes::Broadcast(kTruePeakFilterPhase1[kLast - j]);
+    phase2_taps[j] = FloatLanes::Broadcast(kTruePeakFilterPhase2[kLast - j]);
+    phase3_taps[j] = FloatLanes::Broadcast(kTruePeakFilterPhase3[kLast - j]);
+  }
+
+  FloatLanes max_lanes = FloatLanes::Broadcast(0.0f);
+  int64_t i = 0;
+  for (; i + kFloatLaneCount <= num_outputs; i += kFloatLaneCount) {
+    FloatLanes upsampled_phase0 = FloatLanes::Broadcast(0.0f);
+    FloatLanes upsampled_phase1 = FloatLanes::Broadcast(0.0f);
+    FloatLanes upsampled_phase2 = FloatLanes::Broadcast(0.0f);
+    FloatLanes upsampled_phase3 = FloatLanes::Broadcast(0.0f);
+    for (int j = 0; j < kTruePeakFilterLength; ++j) {
+      const FloatLanes x = FloatLanes::Load(input_audio + i + j);
+      upsampled_phase0 = upsampled_phase0 + x * phase0_taps[j];
+      upsampled_phase1 = upsampled_phase1 + x * phase1_taps[j];
+      upsampled_phase2 = upsampled_phase2 + x * phase2_taps[j];
+      upsampled_phase3 = upsampled_phase3 + x * phase3_taps[j];
+    }
+    max_lanes = Max(max_lanes, Max(Max(Abs(upsampled_phase0),
+                                       Abs(upsampled_phase1)),
+                                   Max(Abs(upsampled_phase2),
+                                       Abs(upsampled_phase3))));
+  }
+
+  float max_value = ReduceMax(max_lanes);
+  for (; i < num_outputs; ++i) {
+    float upsampled_phase0 = 0.0f;
+    float upsampled_phase1 = 0.0f;
+    float upsampled_phase2 = 0.0f;
+    float upsampled_phase3 = 0.0f;
+    for (int j = 0; j < kTruePeakFilterLength; ++j) {
+      const float x = input_audio[i + j];
+      upsampled_phase0 += x * kTruePeakFilterPhase0[kLast - j];
+      upsampled_phase1 += x * kTruePeakFilterPhase1[kLast - j];
+      upsampled_phase2 += x * kTruePeakFilterPhase2[kLast - j];
+      upsampled_phase3 += x * kTruePeakFilterPhase3[kLast - j];
+    }
+    max_value = std::max({max_value, std::fabs(upsampled_phase0),
+                          std::fabs(upsampled_phase1),
+                          std::fabs(upsampled_phase2),
+                          std::fabs(upsampled_phase3)});
+  }
+  return max_value;
+}
+
 }  // namespace
 
 std::vector<float> DefaultChannelWeights() {
@@ -66,7 +144,9 @@ std::vector<float> DefaultChannelWeights() {
 EbuR128Analyzer::EbuR128Analyzer(int32_t num_input_channels,
                                  std::vector<float> input_channel_weights,
                                  int32_t sample_rate,
-                                 bool enable_true_peak_measurement)
+                                 bool enable_true_peak_measurement,
+                                 GatingMode gating_mode,
+                                 bool enable_block_history)
     : interleaved_stride_(num_input_channels),
       num_channels_being_measured_(std::min<int32_t>(
           {kMaxNumChannelsMeasured, num_input_channels,
@@ -82,7 +162,9 @@ EbuR128Analyzer::EbuR128Analyzer(int32_t num_input_channels,
           1.0f / static_cast<float>(rms_block_size_samples_)),
       lra_stability_duration_samples_(sample_rate * k3341StableLRASeconds),
       num_samples_per_step_(kStepLengthSeconds * sample_rate),
-      enable_true_peak_measurement_(enable_true_peak_measurement) {
+      enable_true_peak_measurement_(enable_true_peak_measurement),
+      gating_mode_(gating_mode),
+      enable_block_history_(gating_mode == EXACT || enable_block_history) {
   // Set up channel weights. Note that channel_weights_ array may have many
   // unused entries which should be zeroed out.
   channel_weights_.fill(0.0);
@@ -100,37 +182,18 @@ EbuR128Analyzer::EbuR128Analyzer(int32_t num_input_channels,
 
   // Set up momentary, short-term, and rms accumulators to track stats.
   channel_analysis_.fill(ChannelAnalysis());
-}
 
-float EbuR128Analyzer::MaxTruePeakFIR(
-    const std::array<float, kTruePeakFilterLength>& input_audio,
-    int32_t input_audio_circular_index) const {
-  // Simultaneously compute four filtered outputs, i.e. for 4x upsampling.
-  float upsampled_phase0 = 0.0f;
-  float upsampled_phase1 = 0.0f;
-  float upsampled_phase2 = 0.0f;
-  float upsampled_phase3 = 0.0f;
-
-  int i = kTruePeakFilterLength - 1;
-  // Loop from circular index to end of the circular buffer
-  for (int j = input_audio_circular_index; j < kTruePeakFilterLength; ++j) {
-    upsampled_phase0 += input_audio[j] * kTruePeakFilterPhase0[i];
-    upsampled_phase1 += input_audio[j] * kTruePeakFilterPhase1[i];
-    upsampled_phase2 += input_audio[j] * kTruePeakFilterPhase2[i];
-    upsampled_phase3 += input_audio[j] * kTruePeakFilterPhase3[i];
-    --i;
-  }
-  // Wraparound, loop from beginning of circular buffer to the circular index.
-  for (int j = 0; j < input_audio_circular_index; ++j) {
-    upsampled_phase0 += input_audio[j] * kTruePeakFilterPhase0[i];
-    upsampled_phase1 += input_audio[j] * kTruePeakFilterPhase1[i];
-    upsampled_phase2 += input_audio[j] * kTruePeakFilterPhase2[i];
-    upsampled_phase3 += input_audio[j] * kTruePeakFilterPhase3[i];
-    --i;
+  if (gating_mode_ == HISTOGRAM) {
+    momentary_histogram_ =
+        LoudnessHistogram(kAbsoluteThresholdLKFS, kHistogramMaxLKFS,
+                          kHistogramBinWidthLU, /*track_power_sums=*/true);
+    short_term_histogram_ =
+        LoudnessHistogram(kAbsoluteThresholdLKFS, kHistogramMaxLKFS,
+                          kHistogramBinWidthLU, /*track_power_sums=*/false);
+    rms_histogram_ =
+        LoudnessHistogram(kHistogramMinRmsDBFS, kHistogramMaxRmsDBFS,
+                          kHistogramBinWidthLU, /*track_power_sums=*/false);
   }
-
-  return std::max({std::fabs(upsampled_phase0), std::fabs(upsampled_phase1),
-                   std::fabs(upsampled_phase2), std::fabs(upsampled_phase3)});
 }
 
 void EbuR128Analyzer::UpdateAnalysisPerStep() {
@@ -212,14 +275,24 @@ inline void EbuR128Analyzer::UpdateStatsForCurrentMomentaryBlock() {
   const float momentary_power =
       channel_weighted_momentary_sum * one_over_momentary_block_size_samples_;
 
+  const float momentary_lkfs = GetLoudnessForPower(momentary_power);
+  momentary_lkfs_ = momentary_lkfs;
+  ++num_momentary_blocks_;
+
   // Store all momentary measurements, ungated.
-  ungated_momentary_powers_.push_back(momentary_power);
-  ungated_momentary_lkfs_.push_back(GetLoudnessForPower(momentary_power));
+  if (enable_block_history_) {
+    ungated_momentary_powers_.push_back(momentary_power);
+    ungated_momentary_lkfs_.push_back(momentary_lkfs);
+  }
 
   // Accumulate this momentary power to compute absolute gated measurement.
   if (momentary_power > kPowerAbsoluteThreshold) {
     sum_of_abs_gated_momentary_powers_ += momentary_power;
     ++num_abs_gated_momentary_powers_;
+    if (gating_mode_ == HISTOGRAM) {
+      momentary_histogram_.Add(
+          std::fmax(momentary_lkfs, kAbsoluteThresholdLKFS), momentary_power);
+    }
   }
 }
 
@@ -243,10 +316,20 @@ inline void EbuR128Analyzer::UpdateStatsForCurrentShortTermBlock() {
       SanitizedConvertToDBFS(short_term_block_peak_across_channels);
   const float short_term_psr = short_term_peak_dbfs - short_term_lkfs;
 
+  short_term_max_lkfs_ = std::fmax(short_term_max_lkfs_, short_term_lkfs);
+  short_term_lkfs_ = short_term_lkfs;
+
   // Store all short-term measurements, ungated.
-  ungated_short_term_lkfs_.push_back(short_term_lkfs);
-  short_term_peaks_.push_back(short_term_block_peak_across_channels);
-  short_term_psr_.push_back(short_term_psr);
+  if (enable_block_history_) {
+    ungated_short_term_lkfs_.push_back(short_term_lkfs);
+    short_term_peaks_.push_back(short_term_block_peak_across_channels);
+    short_term_psr_.push_back(short_term_psr);
+  }
+
+  // The histogram only needs measurements above the absolute threshold.
+  if (gating_mode_ == HISTOGRAM && short_term_lkfs > kAbsoluteThresholdLKFS) {
+    short_term_histogram_.Add(short_term_lkfs);
+  }
 }
 
 inline void EbuR128Analyzer::UpdateStatsForCurrentRmsBlock() {
@@ -260,67 +343,166 @@ inline void EbuR128Analyzer::UpdateStatsForCurrentRmsBlock() {
       num_channels_being_measured_;
   const float rms_linear = std::sqrt(rms_power);
 
-  rms_dbfs_.push_back(SanitizedConvertToDBFS(rms_linear));
-}
-
-void EbuR128Analyzer::UpdatePerSample(const float unfiltered_sample,
-                                      const int channel_index) {
-  // Update digital-peak
-  abs_digital_peak_ =
-      std::fmax(abs_digital_peak_, std::fabs(unfiltered_sample));
-
-  float* filter_state = filter_memory_all_channels_[channel_index].data();
-  const float s1_wn_minus_1 = filter_state[0];
-  const float s1_wn_minus_2 = filter_state[1];
-  const float s2_wn_minus_1 = filter_state[2];
-  const float s2_wn_minus_2 = filter_state[3];
-
-  // K-weighting Stage 1, "head effect compensation"
-  const float s1_wn_minus_0 = /*  1.0  *  */ unfiltered_sample -
-                              stage1_filter_[0] * s1_wn_minus_1 -
-                              stage1_filter_[1] * s1_wn_minus_2;
-  const float s1_yn_minus_0 = stage1_filter_[2] * s1_wn_minus_0 +
-                              stage1_filter_[3] * s1_wn_minus_1 +
-                              stage1_filter_[4] * s1_wn_minus_2;
-
-  // K-weighting Stage 2, RLB weighting
-  const float s2_wn_minus_0 = /*  1.0  *  */ s1_yn_minus_0 -
-                              stage2_filter_[0] * s2_wn_minus_1 -
-                              stage2_filter_[1] * s2_wn_minus_2;
-  // Optimization: the last 3 coefficients of stage2 biquad are
-  // always (1, -2, 1) when the filter is present.
-  const float s2_yn_minus_0 = /*  1.0  *  */ s2_wn_minus_0 +
-                              -2 * s2_wn_minus_1 +
-                              /*  1.0  *  */ s2_wn_minus_2;
-
-  // Update filter state to work with next sample
-  filter_state[0] = s1_wn_minus_0;
-  filter_state[1] = s1_wn_minus_1;
-  filter_state[2] = s2_wn_minus_0;
-  filter_state[3] = s2_wn_minus_1;
-
-  const float k_weighted_sample = s2_yn_minus_0;
-
-  // Update per-channel filter state and accumulators
-  const float unfiltered_squared = unfiltered_sample * unfiltered_sample;
-  const float k_weighted_squared = k_weighted_sample * k_weighted_sample;
-  ChannelAnalysis& analysis =
-      channel_analysis_[channel_index];  // mutable alias
-  analysis.rms_sst_accumulator += unfiltered_squared;
-  analysis.momentary_sst_accumulator += k_weighted_squared;
-  analysis.short_term_sst_accumulator += k_weighted_squared;
-  analysis.partial_peak =
-      std::fmax(analysis.partial_peak, std::fabs(unfiltered_sample));
-
-  // Update true peak if measurement is enabled.
-  if (enable_true_peak_measurement_) {
-    analysis.true_peak_input_audio[analysis.true_peak_index] =
-        unfiltered_sample;
-    analysis.true_peak_index =
-        IncrementCircularIndex(analysis.true_peak_index, kTruePeakFilterLength);
-    abs_true_peak_ = std::max({abs_true_peak_, abs_digital_peak_,
-                               MaxTruePeakFIR(analysis.true_peak_input_audio,
-                                              analysis.true_peak_index)});
+  const float rms_dbfs = SanitizedConvertToDBFS(rms_linear);
+  ++num_rms_blocks_;
+  rms_max_dbfs_ = std::fmax(rms_max_dbfs_, rms_dbfs);
+  if (enable_block_history_) {
+    rms_dbfs_.push_back(rms_dbfs);
+  }
+  if (gating_mode_ == HISTOGRAM) {
+    rms_histogram_.Add(rms_dbfs);
+  }
+}
+
+void EbuR128Analyzer::UpdateTruePeakForChannel(const int64_t num_frames,
+                                               const int first_channel_index,
+                                               const int lane) {
+  constexpr int kHistoryLength = kTruePeakFilterLength - 1;
+  ChannelAnalysis& analysis = channel_analysis_[first_channel_index + lane];
+
+  // Linearize the channel's history and the run so that every output can be
+  // computed with contiguous loads and no wraparound.
+  float* linear_audio = true_peak_scratch_.data();
+  std::copy(analysis.true_peak_history.begin(),
+            analysis.true_peak_history.end(), linear_audio);
+  const float* scratch = block_scratch_.data() + lane;
+  for (int64_t i = 0; i < num_frames; ++i) {
+    linear_audio[kHistoryLength + i] = scratch[i * kFloatLaneCount];
+  }
+
+  abs_true_peak_ =
+      std::fmax(abs_true_peak_, MaxTruePeakOfBlock(linear_audio, num_frames));
+
+  std::copy(linear_audio + num_frames,
+            linear_audio + num_frames + kHistoryLength,
+            analysis.true_peak_history.begin());
+}
+
+template <typename T, EbuR128Analyzer::SampleLayout LAYOUT>
+void EbuR128Analyzer::LoadChannelGroup(const void* audio_data,
+                                       const int64_t sample_index,
+                                       const int64_t num_frames,
+                                       const int first_channel_index,
+                                       const int64_t num_samples_per_channel) {
+  const int num_lanes_used = std::min(
+      kFloatLaneCount, num_channels_being_measured_ - first_channel_index);
+  float* scratch = block_scratch_.data();
+  for (int64_t i = 0; i < num_frames; ++i) {
+    int lane = 0;
+    for (; lane < num_lanes_used; ++lane) {
+      scratch[lane] = GetSampleFromOrigin<T, LAYOUT>(
+          audio_data, sample_index + i, first_channel_index + lane,
+          interleaved_stride_, num_samples_per_channel);
+    }
+    for (; lane < kFloatLaneCount; ++lane) {
+      scratch[lane] = 0.0f;
+    }
+    scratch += kFloatLaneCount;
+  }
+}
+
+void EbuR128Analyzer::FilterChannelGroup(const int64_t num_frames,
+                                         const int first_channel_index) {
+  const int num_lanes_used = std::min(
+      kFloatLaneCount, num_channels_being_measured_ - first_channel_index);
+
+  // Transpose the group's filter state and accumulators into lanes. This
+  // happens once per run rather than once per sample.
+  alignas(64) float s1_wn_minus_1_lanes[kFloatLaneCount] = {};
+  alignas(64) float s1_wn_minus_2_lanes[kFloatLaneCount] = {};
+  alignas(64) float s2_wn_minus_1_lanes[kFloatLaneCount] = {};
+  alignas(64) float s2_wn_minus_2_lanes[kFloatLaneCount] = {};
+  alignas(64) float rms_sst_lanes[kFloatLaneCount] = {};
+  alignas(64) float k_weighted_sst_lanes[kFloatLaneCount] = {};
+  alignas(64) float partial_peak_lanes[kFloatLaneCount] = {};
+  for (int lane = 0; lane < num_lanes_used; ++lane) {
+    const auto& filter_state =
+        filter_memory_all_channels_[first_channel_index + lane];
+    const ChannelAnalysis& analysis =
+        channel_analysis_[first_channel_index + lane];
+    s1_wn_minus_1_lanes[lane] = filter_state[0];
+    s1_wn_minus_2_lanes[lane] = filter_state[1];
+    s2_wn_minus_1_lanes[lane] = filter_state[2];
+    s2_wn_minus_2_lanes[lane] = filter_state[3];
+    rms_sst_lanes[lane] = analysis.rms_sst_accumulator;
+    // The momentary and short-term accumulators always hold the same partial
+    // sum, so only one of them needs to be carried through the loop.
+    k_weighted_sst_lanes[lane] = analysis.momentary_sst_accumulator;
+    partial_peak_lanes[lane] = analysis.partial_peak;
+  }
+
+  const FloatLanes s1_a1 = FloatLanes::Broadcast(stage1_filter_[0]);
+  const FloatLanes s1_a2 = FloatLanes::Broadcast(stage1_filter_[1]);
+  const FloatLanes s1_b0 = FloatLanes::Broadcast(stage1_filter_[2]);
+  const FloatLanes s1_b1 = FloatLanes::Broadcast(stage1_filter_[3]);
+  const FloatLanes s1_b2 = FloatLanes::Broadcast(stage1_filter_[4]);
+  const FloatLanes s2_a1 = FloatLanes::Broadcast(stage2_filter_[0]);
+  const FloatLanes s2_a2 = FloatLanes::Broadcast(stage2_filter_[1]);
+  const FloatLanes minus_two = FloatLanes::Broadcast(-2.0f);
+
+  FloatLanes s1_wn_minus_1 = FloatLanes::Load(s1_wn_minus_1_lanes);
+  FloatLanes s1_wn_minus_2 = FloatLanes::Load(s1_wn_minus_2_lanes);
+  FloatLanes s2_wn_minus_1 = FloatLanes::Load(s2_wn_minus_1_lanes);
+  FloatLanes s2_wn_minus_2 = FloatLanes::Load(s2_wn_minus_2_lanes);
+  FloatLanes rms_sst = FloatLanes::Load(rms_sst_lanes);
+  FloatLanes k_weighted_sst = FloatLanes::Load(k_weighted_sst_lanes);
+  FloatLanes partial_peak = FloatLanes::Load(partial_peak_lanes);
+
+  // The operations below are ordered exactly as in the original per-sample
+  // implementation so that each channel produces the same results.
+  const float* scratch = block_scratch_.data();
+  for (int64_t i = 0; i < num_frames; ++i) {
+    const FloatLanes unfiltered_sample = FloatLanes::Load(scratch);
+    scratch += kFloatLaneCount;
+
+    // K-weighting Stage 1, "head effect compensation"
+    const FloatLanes s1_wn_minus_0 = unfiltered_sample -
+                                     s1_a1 * s1_wn_minus_1 -
+                                     s1_a2 * s1_wn_minus_2;
+    const FloatLanes s1_yn_minus_0 = s1_b0 * s1_wn_minus_0 +
+                                     s1_b1 * s1_wn_minus_1 +
+                                     s1_b2 * s1_wn_minus_2;
+
+    // K-weighting Stage 2, RLB weighting
+    const FloatLanes s2_wn_minus_0 =
+        s1_yn_minus_0 - s2_a1 * s2_wn_minus_1 - s2_a2 * s2_wn_minus_2;
+    // Optimization: the last 3 coefficients of stage2 biquad are
+    // always (1, -2, 1) when the filter is present.
+    const FloatLanes k_weighted_sample =
+        s2_wn_minus_0 + minus_two * s2_wn_minus_1 + s2_wn_minus_2;
+
+    s1_wn_minus_2 = s1_wn_minus_1;
+    s1_wn_minus_1 = s1_wn_minus_0;
+    s2_wn_minus_2 = s2_wn_minus_1;
+    s2_wn_minus_1 = s2_wn_minus_0;
+
+    rms_sst = rms_sst + unfiltered_sample * unfiltered_sample;
+    k_weighted_sst = k_weighted_sst + k_weighted_sample * k_weighted_sample;
+    partial_peak = Max(partial_peak, Abs(unfiltered_sample));
+  }
+
+  s1_wn_minus_1.Store(s1_wn_minus_1_lanes);
+  s1_wn_minus_2.Store(s1_wn_minus_2_lanes);
+  s2_wn_minus_1.Store(s2_wn_minus_1_lanes);
+  s2_wn_minus_2.Store(s2_wn_minus_2_lanes);
+  rms_sst.Store(rms_sst_lanes);
+  k_weighted_sst.Store(k_weighted_sst_lanes);
+  partial_peak.Store(partial_peak_lanes);
+  for (int lane = 0; lane < num_lanes_used; ++lane) {
+    auto& filter_state =
+        filter_memory_all_channels_[first_channel_index + lane];
+    ChannelAnalysis& analysis = channel_analysis_[first_channel_index + lane];
+    filter_state[0] = s1_wn_minus_1_lanes[lane];
+    filter_state[1] = s1_wn_minus_2_lanes[lane];
+    filter_state[2] = s2_wn_minus_1_lanes[lane];
+    filter_state[3] = s2_wn_minus_2_lanes[lane];
+    analysis.rms_sst_accumulator = rms_sst_lanes[lane];
+    analysis.momentary_sst_accumulator = k_weighted_sst_lanes[lane];
+    analysis.short_term_sst_accumulator = k_weighted_sst_lanes[lane];
+    analysis.partial_peak = partial_peak_lanes[lane];
+
+    // Update digital-peak
+    abs_digital_peak_ = std::fmax(abs_digital_peak_, analysis.partial_peak);
   }
 }
 
@@ -341,18 +523,45 @@ void EbuR128Analyzer::UpdatePerStep() {
 template <typename T, EbuR128Analyzer::SampleLayout LAYOUT>
 void EbuR128Analyzer::ProcessImpl(const void* audio_data,
                                   const int64_t num_samples_per_channel) {
-  for (int i = 0; i < num_samples_per_channel; ++i) {
-    for (int channel_index = 0; channel_index < num_channels_being_measured_;
-         ++channel_index) {
-      float unfiltered_sample = GetSampleFromOrigin<T, LAYOUT>(
-          audio_data, i, channel_index, interleaved_stride_,
-          num_samples_per_channel);
-      UpdatePerSample(unfiltered_sample, channel_index);
+  int64_t sample_index = 0;
+  while (sample_index < num_samples_per_channel) {
+    // Process up to the next step boundary, but no further than the scratch
+    // buffer allows.
+    int64_t num_frames = std::min<int64_t>(
+        num_samples_per_channel - sample_index, kBlockProcessingFrames);
+    const int64_t num_samples_until_step =
+        num_samples_per_step_ - num_samples_processed_this_step_;
+    if (num_samples_until_step > 0) {
+      num_frames = std::min(num_frames, num_samples_until_step);
+    }
+
+    for (int first_channel_index = 0;
+         first_channel_index < num_channels_being_measured_;
+         first_channel_index += kFloatLaneCount) {
+      LoadChannelGroup<T, LAYOUT>(audio_data, sample_index, num_frames,
+                                  first_channel_index,
+                                  num_samples_per_channel);
+      FilterChannelGroup(num_frames, first_channel_index);
+      if (enable_true_peak_measurement_) {
+        const int num_lanes_used =
+            std::min(kFloatLaneCount,
+                     num_channels_being_measured_ - first_channel_index);
+        for (int lane = 0; lane < num_lanes_used; ++lane) {
+          UpdateTruePeakForChannel(num_frames, first_channel_index, lane);
+        }
+      }
+    }
+
+    // The true peak is never less than the digital peak.
+    if (enable_true_peak_measurement_) {
+      abs_true_peak_ = std::fmax(abs_true_peak_, abs_digital_peak_);
     }
 
+    sample_index += num_frames;
+
     // Once we have reached a full block size, and thereafter every step size,
     // we should run the once-per-block update.
-    ++num_samples_processed_this_step_;
+    num_samples_processed_this_step_ += num_frames;
     if (num_samples_processed_this_step_ == num_samples_per_step_) {
       num_samples_processed_this_step_ = 0;
       UpdatePerStep();
@@ -406,6 +615,21 @@ void EbuR128Analyzer::Process(const void* audio_data,
       return;
     }
   }
+  if (sample_fmt == S24) {
+    if (sample_layout == PLANAR_NON_CONTIGUOUS) {
+      ProcessImpl<PackedInt24, PLANAR_NON_CONTIGUOUS>(audio_data,
+                                                      num_samples_per_channel);
+      return;
+    } else if (sample_layout == INTERLEAVED) {
+      ProcessImpl<PackedInt24, INTERLEAVED>(audio_data,
+                                            num_samples_per_channel);
+      return;
+    } else if (sample_layout == PLANAR_CONTIGUOUS) {
+      ProcessImpl<PackedInt24, PLANAR_CONTIGUOUS>(audio_data,
+                                                  num_samples_per_channel);
+      return;
+    }
+  }
   if (sample_fmt == DOUBLE) {
     if (sample_layout == PLANAR_NON_CONTIGUOUS) {
       ProcessImpl<double, PLANAR_NON_CONTIGUOUS>(audio_data,
@@ -422,10 +646,43 @@ void EbuR128Analyzer::Process(const void* audio_data,
   }
 }
 
+void EbuR128Analyzer::GetAbsoluteGatedMomentaryPowers(float* sum,
+                                                      int64_t* count) const {
+  if (gating_mode_ == HISTOGRAM) {
+    // The per-bin power sums are kept in double precision, which avoids the
+    // drift of a single float accumulator over very long captures.
+    *sum = static_cast<float>(momentary_histogram_.PowerSumFromBin(0));
+    *count = momentary_histogram_.count();
+  } else {
+    *sum = sum_of_abs_gated_momentary_powers_;
+    *count = num_abs_gated_momentary_powers_;
+  }
+}
+
+void EbuR128Analyzer::AccumulateGatedMomentaryPowers(
+    const float power_threshold, const float lkfs_threshold, float* sum,
+    int64_t* count) const {
+  if (gating_mode_ == HISTOGRAM) {
+    const int first_bin = momentary_histogram_.FirstBinAbove(lkfs_threshold);
+    *sum += static_cast<float>(momentary_histogram_.PowerSumFromBin(first_bin));
+    *count += momentary_histogram_.CountFromBin(first_bin);
+    return;
+  }
+  for (float ungated_power : ungated_momentary_powers_) {
+    // For quiet signals, relative threshold could potentially be less than
+    // absolute threshold, and so the requirement is that power must be larger
+    // than both thresholds for relative loudness.
+    if (ungated_power > power_threshold) {
+      *sum += ungated_power;
+      ++*count;
+    }
+  }
+}
+
 std::optional<float> EbuR128Analyzer::GetRelativeGatedIntegratedLoudness()
     const {
   // If audio is too short, we cannot meaningfully measure loudness.
-  if (ungated_momentary_powers_.empty()) {
+  if (num_momentary_blocks_ == 0 || gating_mode_ == NONE) {
     return std::nullopt;
   }
 
@@ -433,13 +690,17 @@ std::optional<float> EbuR128Analyzer::GetRelativeGatedIntegratedLoudness()
   // if everything is quieter than the absolute gating threshold, integrated
   // loudness still technically cannot be measured. Instead, indicate that the
   // audio is virtually silent.
-  if (num_abs_gated_momentary_powers_ == 0) {
+  float sum_of_abs_gated_momentary_powers = 0.0f;
+  int64_t num_abs_gated_momentary_powers = 0;
+  GetAbsoluteGatedMomentaryPowers(&sum_of_abs_gated_momentary_powers,
+                                  &num_abs_gated_momentary_powers);
+  if (num_abs_gated_momentary_powers == 0) {
     return kMinLKFS;
   }
 
   // Compute absolute-gated loudness
   const float abs_gated_avg_power =
-      sum_of_abs_gated_momentary_powers_ / num_abs_gated_momentary_powers_;
+      sum_of_abs_gated_momentary_powers / num_abs_gated_momentary_powers;
   const float abs_gated_loudness = GetLoudnessForPower(abs_gated_avg_power);
 
   // Compute relative-gated loudness
@@ -447,18 +708,14 @@ std::optional<float> EbuR128Analyzer::GetRelativeGatedIntegratedLoudness()
   const float rel_power_threshold = GetPowerForLoudness(rel_threshold);
 
   const float effective_power_threshold = std::max(kPowerAbsoluteThreshold, rel_power_threshold);
+  const float effective_threshold =
+      std::max(kAbsoluteThresholdLKFS, rel_threshold);
 
   float sum_of_rel_gated_momentary_powers = 0.0f;
   int64_t num_rel_gated_momentary_powers = 0;
-  for (float ungated_power : ungated_momentary_powers_) {
-    // For quiet signals, relative threshold could potentially be less than
-    // absolute threshold, and so the requirement is that power must be larger
-    // than both thresholds for relative loudness.
-    if (ungated_power > effective_power_threshold) {
-      sum_of_rel_gated_momentary_powers += ungated_power;
-      ++num_rel_gated_momentary_powers;
-    }
-  }
+  AccumulateGatedMomentaryPowers(
+      effective_power_threshold, effective_threshold,
+      &sum_of_rel_gated_momentary_powers, &num_rel_gated_momentary_powers);
 
   if (num_rel_gated_momentary_powers == 0) {
     // Note: We should never get here. If all blocks are pruned by the relative
@@ -481,10 +738,16 @@ std::optional<float> EbuR128Analyzer::GetRelativeGatedIntegratedLoudness(std::ve
   float sum_of_abs_gated_momentary_powers = 0.0f;
   int64_t num_abs_gated_momentary_powers = 0;
   for (const auto *analyzer : analyzers) {
-    all_empty &= analyzer->ungated_momentary_powers_.empty();
-    all_zero &= analyzer->num_abs_gated_momentary_powers_ == 0;
-    sum_of_abs_gated_momentary_powers += analyzer->sum_of_abs_gated_momentary_powers_;
-    num_abs_gated_momentary_powers += analyzer->num_abs_gated_momentary_powers_;
+    float sum = 0.0f;
+    int64_t count = 0;
+    analyzer->GetAbsoluteGatedMomentaryPowers(&sum, &count);
+    if (analyzer->gating_mode_ == NONE) {
+      return std::nullopt;
+    }
+    all_empty &= analyzer->num_momentary_blocks_ == 0;
+    all_zero &= count == 0;
+    sum_of_abs_gated_momentary_powers += sum;
+    num_abs_gated_momentary_powers += count;
   }
 
   if (all_empty) {
@@ -502,16 +765,14 @@ std::optional<float> EbuR128Analyzer::GetRelativeGatedIntegratedLoudness(std::ve
   const float rel_power_threshold = GetPowerForLoudness(rel_threshold);
 
   const float effective_power_threshold = std::max(kPowerAbsoluteThreshold, rel_power_threshold);
+  const float effective_threshold = std::max(kAbsoluteThresholdLKFS, rel_threshold);
 
   float sum_of_rel_gated_momentary_powers = 0.0f;
   int64_t num_rel_gated_momentary_powers = 0;
   for (const auto *analyzer : analyzers) {
-    for (float ungated_power : analyzer->ungated_momentary_powers_) {
-      if (ungated_power > effective_power_threshold) {
-        sum_of_rel_gated_momentary_powers += ungated_power;
-        ++num_rel_gated_momentary_powers;
-      }
-    }
+    analyzer->AccumulateGatedMomentaryPowers(effective_power_threshold, effective_threshold,
+                                             &sum_of_rel_gated_momentary_powers,
+                                             &num_rel_gated_momentary_powers);
   }
 
   if (num_rel_gated_momentary_powers == 0) {
@@ -526,54 +787,83 @@ std::optional<float> EbuR128Analyzer::GetRelativeGatedIntegratedLoudness(std::ve
 std::optional<EbuR128Analyzer::LRAStats> EbuR128Analyzer::GetLoudnessRangeStats(
     bool* is_stable) const {
   // Cannot compute any LRA stats if there are no momentary measurements.
-  if (num_abs_gated_momentary_powers_ == 0) {
+  if (gating_mode_ == NONE) {
+    *is_stable = false;
+    return std::nullopt;
+  }
+  float sum_of_abs_gated_momentary_powers = 0.0f;
+  int64_t num_abs_gated_momentary_powers = 0;
+  GetAbsoluteGatedMomentaryPowers(&sum_of_abs_gated_momentary_powers,
+                                  &num_abs_gated_momentary_powers);
+  if (num_abs_gated_momentary_powers == 0) {
     *is_stable = false;
     return std::nullopt;
   }
 
   // Compute absolute-gated integrated loudness
   const float abs_gated_avg_power =
-      sum_of_abs_gated_momentary_powers_ / num_abs_gated_momentary_powers_;
+      sum_of_abs_gated_momentary_powers / num_abs_gated_momentary_powers;
   const float abs_gated_loudness = GetLoudnessForPower(abs_gated_avg_power);
 
   // Note: for computing LRA, relative threshold is different than 1770.
   const float rel_threshold = abs_gated_loudness + k3342RelativeThresholdLU;
 
   EbuR128Analyzer::LRAStats lra_stats;
-  lra_stats.short_term_max_lkfs = kMinLKFS;
-
-  // Make a sorted list of relative-gated short-term loudness measurements, so
-  // that we can compute percentile. NOTE: if we are OK with some bounded error,
-  // then we should consider maintaining a histogram that will allow us to find
-  // percentiles more asymptotically efficiently.
-  std::vector<float> gated_short_term_values;
-  gated_short_term_values.reserve(ungated_short_term_lkfs_.size());
-  for (float short_term_loudness : ungated_short_term_lkfs_) {
-    lra_stats.short_term_max_lkfs =
-        std::fmax(lra_stats.short_term_max_lkfs, short_term_loudness);
-    if (short_term_loudness > kAbsoluteThresholdLKFS &&
-        short_term_loudness > rel_threshold) {
-      gated_short_term_values.push_back(short_term_loudness);
+  lra_stats.short_term_max_lkfs = short_term_max_lkfs_;
+
+  float short_term_10th_percentile_lkfs = kMinLKFS;
+  float short_term_95th_percentile_lkfs = kMinLKFS;
+  if (gating_mode_ == HISTOGRAM) {
+    // The histogram only holds measurements above the absolute threshold.
+    const int first_bin = short_term_histogram_.FirstBinAbove(rel_threshold);
+    const int64_t num_gated = short_term_histogram_.CountFromBin(first_bin);
+    // Cannot compute any LRA stats if there are no gated short term
+    // measurements.
+    if (num_gated == 0) {
+      *is_stable = false;
+      return std::nullopt;
     }
-  }
-  // Cannot compute any LRA stats if there are no gated short term measurements.
-  if (gated_short_term_values.empty()) {
-    *is_stable = false;
-    return std::nullopt;
-  }
-  std::sort(gated_short_term_values.begin(), gated_short_term_values.end());
 
-  // Determine the array index for 10th percentile and 95th percentile. The
-  // rounding mechanism for computing the index is taken from the Matlab
-  // implementation described in EBU 3342.
-  const std::vector<float>::size_type length_minus_one = gated_short_term_values.size() - 1;
-  const long index_10th = std::lround(length_minus_one * 0.1f);
-  const long index_95th = std::lround(length_minus_one * 0.95f);
+    // Same percentile ranks as the sorted list below.
+    const int64_t length_minus_one = num_gated - 1;
+    short_term_10th_percentile_lkfs = short_term_histogram_.ValueAtRank(
+        first_bin, std::lround(length_minus_one * 0.1f));
+    short_term_95th_percentile_lkfs = short_term_histogram_.ValueAtRank(
+        first_bin, std::lround(length_minus_one * 0.95f));
+  } else {
+    // Make a sorted list of relative-gated short-term loudness measurements,
+    // so that we can compute percentile.
+    std::vector<float> gated_short_term_values;
+    gated_short_term_values.reserve(ungated_short_term_lkfs_.size());
+    for (float short_term_loudness : ungated_short_term_lkfs_) {
+      if (short_term_loudness > kAbsoluteThresholdLKFS &&
+          short_term_loudness > rel_threshold) {
+        gated_short_term_values.push_back(short_term_loudness);
+      }
+    }
+    // Cannot compute any LRA stats if there are no gated short term
+    // measurements.
+    if (gated_short_term_values.empty()) {
+      *is_stable = false;
+      return std::nullopt;
+    }
+    std::sort(gated_short_term_values.begin(), gated_short_term_values.end());
+
+    // Determine the array index for 10th percentile and 95th percentile. The
+    // rounding mechanism for computing the index is taken from the Matlab
+    // implementation described in EBU 3342.
+    const std::vector<float>::size_type length_minus_one = gated_short_term_values.size() - 1;
+    const long index_10th = std::lround(length_minus_one * 0.1f);
+    const long index_95th = std::lround(length_minus_one * 0.95f);
+
+    short_term_10th_percentile_lkfs = gated_short_term_values[index_10th];
+    short_term_95th_percentile_lkfs = gated_short_term_values[index_95th];
+  }
 
   lra_stats.short_term_10th_percentile_lkfs =
-      ClampAndSanitizeDBFS(gated_short_term_values[index_10th]);
+      ClampAndSanitizeDBFS(short_term_10th_percentile_lkfs);
   lra_stats.short_term_95th_percentile_lkfs =
-      ClampAndSanitizeDBFS(gated_short_term_values[index_95th]);
+      ClampAndSanitizeDBFS(short_term_95th_percentile_lkfs);
   lra_stats.loudness_range_lu = lra_stats.short_term_95th_percentile_lkfs -
                                 lra_stats.short_term_10th_percentile_lkfs;
 
@@ -588,33 +878,412 @@ std::optional<EbuR128Analyzer::LRAStats> EbuR128Analyzer::GetLoudnessRangeStats(
 std::optional<EbuR128Analyzer::Rms100msStats>
 EbuR128Analyzer::GetRms100msStats() const {
   // Cannot compute RMS stats if there are no complete steps.
-  if (rms_dbfs_.empty()) {
+  if (num_rms_blocks_ == 0 || gating_mode_ == NONE) {
     return std::nullopt;
   }
   EbuR128Analyzer::Rms100msStats rms_stats;
 
-  // Make a sorted list of rms output so we can compute percentile.
-  std::vector<float> sorted_rms_values;
-  std::copy(rms_dbfs_.begin(), rms_dbfs_.end(),
-            std::back_inserter(sorted_rms_values));
-  std::sort(sorted_rms_values.begin(), sorted_rms_values.end());
-
-  // Determine the array index for 10th percentile and 95th percentile. The
-  // rounding mechanism for computing the index is taken from the Matlab
-  // implementation described in EBU 3342.
-  const std::vector<float>::size_type length_minus_one = sorted_rms_values.size() - 1;
-  const long index_10th = std::lround(length_minus_one * 0.1f);
-  const long index_95th = std::lround(length_minus_one * 0.95f);
+  float rms_10th_percentile_dbfs = kMinDBFS;
+  float rms_95th_percentile_dbfs = kMinDBFS;
+  if (gating_mode_ == HISTOGRAM) {
+    // Rank from the underflow bin so that silence is included.
+    const int64_t length_minus_one = rms_histogram_.count() - 1;
+    rms_10th_percentile_dbfs = rms_histogram_.ValueAtRank(
+        -1, std::lround(length_minus_one * 0.1f));
+    rms_95th_percentile_dbfs = rms_histogram_.ValueAtRank(
+        -1, std::lround(length_minus_one * 0.95f));
+  } else {
+    // Make a sorted list of rms output so we can compute percentile.
+    std::vector<float> sorted_rms_values;
+    std::copy(rms_dbfs_.begin(), rms_dbfs_.end(),
+              std::back_inserter(sorted_rms_values));
+    std::sort(sorted_rms_values.begin(), sorted_rms_values.end());
+
+    // Determine the array index for 10th percentile and 95th percentile. The
+    // rounding mechanism for computing the index is taken from the Matlab
+    // implementation described in EBU 3342.
+    const std::vector<float>::size_type length_minus_one = sorted_rms_values.size() - 1;
+    const long index_10th = std::lround(length_minus_one * 0.1f);
+    const long index_95th = std::lround(length_minus_one * 0.95f);
+
+    rms_10th_percentile_dbfs = sorted_rms_values[index_10th];
+    rms_95th_percentile_dbfs = sorted_rms_values[index_95th];
+  }
 
   rms_stats.rms_10th_percentile_dbfs =
-      ClampAndSanitizeDBFS(sorted_rms_values[index_10th]);
+      ClampAndSanitizeDBFS(rms_10th_percentile_dbfs);
   rms_stats.rms_95th_percentile_dbfs =
-      ClampAndSanitizeDBFS(sorted_rms_values[index_95th]);
-  rms_stats.rms_max_dbfs = ClampAndSanitizeDBFS(sorted_rms_values.back());
+      ClampAndSanitizeDBFS(rms_95th_percentile_dbfs);
+  rms_stats.rms_max_dbfs = ClampAndSanitizeDBFS(rms_max_dbfs_);
 
   return rms_stats;
 }
 
+// Added by sfb 20261015
+bool EbuR128Analyzer::StartSegment(const int64_t segment_start_sample) {
+  if (num_samples_processed_this_step_ != 0 || num_samples_per_step_ <= 0 ||
+      segment_start_sample < 0 ||
+      segment_start_sample % num_samples_per_step_ != 0) {
+    return false;
+  }
+
+  // Filter memory, true peak history, and the circular block buffers are
+  // kept. The accumulators for the current step are already zero because
+  // processing stopped on a step boundary.
+  num_samples_processed_past_steps_ = segment_start_sample;
+  segment_start_sample_ = segment_start_sample;
+
+  // Any complete momentary and short-term blocks now depend only on
+  // pre-roll audio, so their block-level stats can be carried over; they
+  // are recomputed at each step anyway. The measurements are discarded.
+  ClearMeasurements();
+  return true;
+}
+
+// Added by sfb 20261016
+void EbuR128Analyzer::Reset() {
+  for (int i = 0; i < kMaxNumChannelsMeasured; ++i) {
+    filter_memory_all_channels_[i].fill(0.0);
+  }
+  channel_analysis_.fill(ChannelAnalysis());
+  num_samples_processed_past_steps_ = 0;
+  num_samples_processed_this_step_ = 0;
+  segment_start_sample_ = 0;
+  momentary_lkfs_ = kMinLKFS;
+  short_term_lkfs_ = kMinLKFS;
+  ClearMeasurements();
+}
+
+// Added by sfb 20261016
+void EbuR128Analyzer::ClearMeasurements() {
+  sum_of_abs_gated_momentary_powers_ = 0.0f;
+  num_abs_gated_momentary_powers_ = 0;
+  num_momentary_blocks_ = 0;
+  short_term_max_lkfs_ = kMinLKFS;
+  num_rms_blocks_ = 0;
+  rms_max_dbfs_ = kMinDBFS;
+  abs_digital_peak_ = 0.0f;
+  abs_true_peak_ = 0.0f;
+  ungated_momentary_powers_.clear();
+  ungated_momentary_lkfs_.clear();
+  ungated_short_term_lkfs_.clear();
+  short_term_peaks_.clear();
+  short_term_psr_.clear();
+  rms_dbfs_.clear();
+  if (gating_mode_ == HISTOGRAM) {
+    momentary_histogram_ =
+        LoudnessHistogram(kAbsoluteThresholdLKFS, kHistogramMaxLKFS,
+                          kHistogramBinWidthLU, /*track_power_sums=*/true);
+    short_term_histogram_ =
+        LoudnessHistogram(kAbsoluteThresholdLKFS, kHistogramMaxLKFS,
+                          kHistogramBinWidthLU, /*track_power_sums=*/false);
+    rms_histogram_ =
+        LoudnessHistogram(kHistogramMinRmsDBFS, kHistogramMaxRmsDBFS,
+                          kHistogramBinWidthLU, /*track_power_sums=*/false);
+  }
+}
+
+bool EbuR128Analyzer::Merge(const EbuR128Analyzer& next) {
+  if (ConfigurationKey() != next.ConfigurationKey() ||
+      num_samples_processed_this_step_ != 0 ||
+      num_samples_processed_past_steps_ != next.segment_start_sample_) {
+    return false;
+  }
+
+  if (gating_mode_ == HISTOGRAM) {
+    // The binning is identical because the configurations match.
+    momentary_histogram_.Merge(next.momentary_histogram_);
+    short_term_histogram_.Merge(next.short_term_histogram_);
+    rms_histogram_.Merge(next.rms_histogram_);
+  }
+
+  auto append = [](std::vector<float>& to, const std::vector<float>& from) {
+    to.insert(to.end(), from.begin(), from.end());
+  };
+  append(ungated_momentary_powers_, next.ungated_momentary_powers_);
+  append(ungated_momentary_lkfs_, next.ungated_momentary_lkfs_);
+  append(ungated_short_term_lkfs_, next.ungated_short_term_lkfs_);
+  append(short_term_peaks_, next.short_term_peaks_);
+  append(short_term_psr_, next.short_term_psr_);
+  append(rms_dbfs_, next.rms_dbfs_);
+
+  sum_of_abs_gated_momentary_powers_ += next.sum_of_abs_gated_momentary_powers_;
+  num_abs_gated_momentary_powers_ += next.num_abs_gated_momentary_powers_;
+  num_momentary_blocks_ += next.num_momentary_blocks_;
+  short_term_max_lkfs_ =
+      std::fmax(short_term_max_lkfs_, next.short_term_max_lkfs_);
+  num_rms_blocks_ += next.num_rms_blocks_;
+  rms_max_dbfs_ = std::fmax(rms_max_dbfs_, next.rms_max_dbfs_);
+  abs_digital_peak_ = std::fmax(abs_digital_peak_, next.abs_digital_peak_);
+  abs_true_peak_ = std::fmax(abs_true_peak_, next.abs_true_peak_);
+
+  // Continue from the end of next's segment.
+  momentary_lkfs_ = next.momentary_lkfs_;
+  short_term_lkfs_ = next.short_term_lkfs_;
+  filter_memory_all_channels_ = next.filter_memory_all_channels_;
+  channel_analysis_ = next.channel_analysis_;
+  num_samples_processed_past_steps_ = next.num_samples_processed_past_steps_;
+  num_samples_processed_this_step_ = next.num_samples_processed_this_step_;
+  return true;
+}
+
+std::string EbuR128Analyzer::ConfigurationKey() const {
+  StateWriter writer;
+  writer.Write(interleaved_stride_);
+  writer.Write(num_channels_being_measured_);
+  writer.Write(momentary_block_size_samples_);
+  writer.Write(short_term_block_size_samples_);
+  writer.Write(rms_block_size_samples_);
+  writer.Write(num_samples_per_step_);
+  writer.Write(enable_true_peak_measurement_);
+  writer.Write(gating_mode_);
+  writer.Write(enable_block_history_);
+  writer.Write(channel_weights_);
+  writer.Write(stage1_filter_);
+  writer.Write(stage2_filter_);
+  return std::move(writer.bytes());
+}
+
+std::string EbuR128Analyzer::SerializeState() const {
+  static_assert(std::is_trivially_copyable_v<ChannelAnalysis>);
+
+  StateWriter writer;
+  writer.Write(kStateMagic);
+  writer.Write(kStateVersion);
+  const std::string configuration_key = ConfigurationKey();
+  writer.WriteVector(
+      std::vector<char>(configuration_key.begin(), configuration_key.end()));
+
+  writer.Write(filter_memory_all_channels_);
+  writer.Write(channel_analysis_);
+  writer.Write(segment_start_sample_);
+  writer.Write(sum_of_abs_gated_momentary_powers_);
+  writer.Write(num_abs_gated_momentary_powers_);
+  writer.Write(num_momentary_blocks_);
+  writer.Write(short_term_max_lkfs_);
+  writer.Write(num_rms_blocks_);
+  writer.Write(rms_max_dbfs_);
+  writer.Write(num_samples_processed_past_steps_);
+  writer.Write(num_samples_processed_this_step_);
+  writer.Write(abs_digital_peak_);
+  writer.Write(abs_true_peak_);
+  writer.WriteVector(ungated_momentary_powers_);
+  writer.WriteVector(ungated_momentary_lkfs_);
+  writer.WriteVector(ungated_short_term_lkfs_);
+  writer.WriteVector(short_term_peaks_);
+  writer.WriteVector(short_term_psr_);
+  writer.WriteVector(rms_dbfs_);
+  momentary_histogram_.Serialize(writer);
+  short_term_histogram_.Serialize(writer);
+  rms_histogram_.Serialize(writer);
+  return std::move(writer.bytes());
+}
+
+bool EbuR128Analyzer::RestoreState(const std::string& state) {
+  StateReader reader(state.data(), state.size());
+
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  std::vector<char> configuration_key;
+  if (!reader.Read(&magic) || magic != kStateMagic ||
+      !reader.Read(&version) || version != kStateVersion ||
+      !reader.ReadVector(&configuration_key)) {
+    return false;
+  }
+  const std::string expected_configuration_key = ConfigurationKey();
+  if (!std::equal(configuration_key.begin(), configuration_key.end(),
+                  expected_configuration_key.begin(),
+                  expected_configuration_key.end())) {
+    return false;
+  }
+
+  // Everything is read and validated before any of it replaces this
+  // analyzer's state.
+  decltype(filter_memory_all_channels_) filter_memory_all_channels;
+  decltype(channel_analysis_) channel_analysis;
+  int64_t segment_start_sample = 0;
+  float sum_of_abs_gated_momentary_powers = 0.0f;
+  int64_t num_abs_gated_momentary_powers = 0;
+  int64_t num_momentary_blocks = 0;
+  float short_term_max_lkfs = kMinLKFS;
+  int64_t num_rms_blocks = 0;
+  float rms_max_dbfs = kMinDBFS;
+  int64_t num_samples_processed_past_steps = 0;
+  int64_t num_samples_processed_this_step = 0;
+  float abs_digital_peak = 0.0f;
+  float abs_true_peak = 0.0f;
+  std::vector<float> ungated_momentary_powers;
+  std::vector<float> ungated_momentary_lkfs;
+  std::vector<float> ungated_short_term_lkfs;
+  std::vector<float> short_term_peaks;
+  std::vector<float> short_term_psr;
+  std::vector<float> rms_dbfs;
+  LoudnessHistogram momentary_histogram = momentary_histogram_;
+  LoudnessHistogram short_term_histogram = short_term_histogram_;
+  LoudnessHistogram rms_histogram = rms_histogram_;
+  if (!reader.Read(&filter_memory_all_channels) ||
+      !reader.Read(&channel_analysis) ||
+      !reader.Read(&segment_start_sample) ||
+      !reader.Read(&sum_of_abs_gated_momentary_powers) ||
+      !reader.Read(&num_abs_gated_momentary_powers) ||
+      !reader.Read(&num_momentary_blocks) ||
+      !reader.Read(&short_term_max_lkfs) || !reader.Read(&num_rms_blocks) ||
+      !reader.Read(&rms_max_dbfs) ||
+      !reader.Read(&num_samples_processed_past_steps) ||
+      !reader.Read(&num_samples_processed_this_step) ||
+      !reader.Read(&abs_digital_peak) || !reader.Read(&abs_true_peak) ||
+      !reader.ReadVector(&ungated_momentary_powers) ||
+      !reader.ReadVector(&ungated_momentary_lkfs) ||
+      !reader.ReadVector(&ungated_short_term_lkfs) ||
+      !reader.ReadVector(&short_term_peaks) ||
+      !reader.ReadVector(&short_term_psr) || !reader.ReadVector(&rms_dbfs) ||
+      !momentary_histogram.Deserialize(reader) ||
+      !short_term_histogram.Deserialize(reader) ||
+      !rms_histogram.Deserialize(reader) || !reader.AtEnd()) {
+    return false;
+  }
+  if (segment_start_sample < 0 || num_momentary_blocks < 0 ||
+      num_abs_gated_momentary_powers < 0 ||
+      num_abs_gated_momentary_powers > num_momentary_blocks ||
+      num_rms_blocks < 0 || num_samples_processed_past_steps < 0 ||
+      num_samples_processed_this_step < 0 ||
+      num_samples_processed_this_step >= num_samples_per_step_) {
+    return false;
+  }
+  for (const ChannelAnalysis& analysis : channel_analysis) {
+    if (analysis.momentary_index < 0 ||
+        analysis.momentary_index >= kStepsPerMomentaryBlock ||
+        analysis.short_term_index < 0 ||
+        analysis.short_term_index >= kStepsPerShortTermBlock) {
+      return false;
+    }
+  }
+
+  filter_memory_all_channels_ = filter_memory_all_channels;
+  channel_analysis_ = channel_analysis;
+  segment_start_sample_ = segment_start_sample;
+  sum_of_abs_gated_momentary_powers_ = sum_of_abs_gated_momentary_powers;
+  num_abs_gated_momentary_powers_ = num_abs_gated_momentary_powers;
+  num_momentary_blocks_ = num_momentary_blocks;
+  short_term_max_lkfs_ = short_term_max_lkfs;
+  num_rms_blocks_ = num_rms_blocks;
+  rms_max_dbfs_ = rms_max_dbfs;
+  num_samples_processed_past_steps_ = num_samples_processed_past_steps;
+  num_samples_processed_this_step_ = num_samples_processed_this_step;
+  abs_digital_peak_ = abs_digital_peak;
+  abs_true_peak_ = abs_true_peak;
+  ungated_momentary_powers_ = std::move(ungated_momentary_powers);
+  ungated_momentary_lkfs_ = std::move(ungated_momentary_lkfs);
+  ungated_short_term_lkfs_ = std::move(ungated_short_term_lkfs);
+  short_term_peaks_ = std::move(short_term_peaks);
+  short_term_psr_ = std::move(short_term_psr);
+  rms_dbfs_ = std::move(rms_dbfs);
+  momentary_histogram_ = std::move(momentary_histogram);
+  short_term_histogram_ = std::move(short_term_histogram);
+  rms_histogram_ = std::move(rms_histogram);
+  return true;
+}
+
+// Added by sfb 20261016
+std::string EbuR128Analyzer::SerializeResults() const {
+  StateWriter writer;
+  writer.Write(kResultsMagic);
+  writer.Write(kResultsVersion);
+  const std::string configuration_key = ConfigurationKey();
+  writer.WriteVector(
+      std::vector<char>(configuration_key.begin(), configuration_key.end()));
+
+  writer.Write(num_momentary_blocks_);
+  writer.Write(sum_of_abs_gated_momentary_powers_);
+  writer.Write(num_abs_gated_momentary_powers_);
+  writer.Write(NumSamplesProcessed());
+  writer.Write(abs_digital_peak_);
+  writer.Write(abs_true_peak_);
+  if (gating_mode_ == HISTOGRAM) {
+    momentary_histogram_.Serialize(writer);
+  } else if (gating_mode_ == EXACT) {
+    // Blocks at or below the absolute gate never contribute to integrated
+    // loudness, so only the powers above it are kept, in block order.
+    std::vector<float> abs_gated_momentary_powers;
+    abs_gated_momentary_powers.reserve(num_abs_gated_momentary_powers_);
+    for (float power : ungated_momentary_powers_) {
+      if (power > kPowerAbsoluteThreshold) {
+        abs_gated_momentary_powers.push_back(power);
+      }
+    }
+    writer.WriteVector(abs_gated_momentary_powers);
+  }
+  return std::move(writer.bytes());
+}
+
+// Added by sfb 20261016
+bool EbuR128Analyzer::RestoreResults(const std::string& results) {
+  if (NumSamplesProcessed() != 0 || num_momentary_blocks_ != 0) {
+    return false;
+  }
+
+  StateReader reader(results.data(), results.size());
+
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  std::vector<char> configuration_key;
+  if (!reader.Read(&magic) || magic != kResultsMagic ||
+      !reader.Read(&version) || version != kResultsVersion ||
+      !reader.ReadVector(&configuration_key)) {
+    return false;
+  }
+  const std::string expected_configuration_key = ConfigurationKey();
+  if (!std::equal(configuration_key.begin(), configuration_key.end(),
+                  expected_configuration_key.begin(),
+                  expected_configuration_key.end())) {
+    return false;
+  }
+
+  int64_t num_momentary_blocks = 0;
+  float sum_of_abs_gated_momentary_powers = 0.0f;
+  int64_t num_abs_gated_momentary_powers = 0;
+  int64_t num_samples_processed = 0;
+  float abs_digital_peak = 0.0f;
+  float abs_true_peak = 0.0f;
+  if (!reader.Read(&num_momentary_blocks) ||
+      !reader.Read(&sum_of_abs_gated_momentary_powers) ||
+      !reader.Read(&num_abs_gated_momentary_powers) ||
+      !reader.Read(&num_samples_processed) ||
+      !reader.Read(&abs_digital_peak) || !reader.Read(&abs_true_peak) ||
+      num_momentary_blocks < 0 || num_abs_gated_momentary_powers < 0 ||
+      num_abs_gated_momentary_powers > num_momentary_blocks ||
+      num_samples_processed < 0) {
+    return false;
+  }
+
+  LoudnessHistogram momentary_histogram = momentary_histogram_;
+  std::vector<float> abs_gated_momentary_powers;
+  if (gating_mode_ == HISTOGRAM) {
+    if (!momentary_histogram.Deserialize(reader) ||
+        momentary_histogram.count() != num_abs_gated_momentary_powers) {
+      return false;
+    }
+  } else if (gating_mode_ == EXACT &&
+             (!reader.ReadVector(&abs_gated_momentary_powers) ||
+              static_cast<int64_t>(abs_gated_momentary_powers.size()) !=
+                  num_abs_gated_momentary_powers)) {
+    return false;
+  }
+  if (!reader.AtEnd()) {
+    return false;
+  }
+
+  num_momentary_blocks_ = num_momentary_blocks;
+  sum_of_abs_gated_momentary_powers_ = sum_of_abs_gated_momentary_powers;
+  num_abs_gated_momentary_powers_ = num_abs_gated_momentary_powers;
+  num_samples_processed_past_steps_ = num_samples_processed;
+  abs_digital_peak_ = abs_digital_peak;
+  abs_true_peak_ = abs_true_peak;
+  momentary_histogram_ = std::move(momentary_histogram);
+  ungated_momentary_powers_ = std::move(abs_gated_momentary_powers);
+  return true;
+}
+
 float EbuR128Analyzer::digital_peak_dbfs() const {
   return SanitizedConvertToDBFS(abs_digital_peak_);
 }
@@ -22,6 +22,8 @@
 #include <vector>
 
 #include "ebur128_constants.h"
+#include "float_lanes.h"
+#include "loudness_histogram.h"
 
 namespace loudness {
 
@@ -117,9 +119,36 @@ class EbuR128Analyzer {
 
   enum SampleFormat {
     S16 = 0,  // signed 16-bit integer format
-    S32 = 1,  // signed 32-bit integer format
+    S32 = 1,  // signed 32-bit integer format, or fewer bits aligned high
     FLOAT = 2,
     DOUBLE = 3,
+    // Added by sfb 20261015
+    S24 = 4,  // signed 24-bit integer packed in 3 bytes, native byte order
+  };
+
+  // Determines how block-level measurements are kept for gating and
+  // percentile calculations.
+  // Added by sfb 20261015
+  enum GatingMode {
+    // Every momentary, short-term, and rms measurement is stored. Results are
+    // exact, but memory use grows with the duration of the audio and LRA and
+    // rms queries sort all stored measurements.
+    EXACT = 0,
+
+    // Measurements are counted in fixed-width histograms (see
+    // kHistogramBinWidthLU). Memory use is constant and queries take time
+    // proportional to the number of bins. Relative gate thresholds and
+    // percentiles are resolved to the bin width. The per-block history
+    // vectors are only populated if block history is enabled.
+    HISTOGRAM = 1,
+
+    // Added by sfb 20261016
+    // No measurements are kept for gating or percentiles, so integrated
+    // loudness, LRA, and rms stats are unavailable. Intended for live metering
+    // with momentary_lkfs(), short_term_lkfs(), and the peaks, which are
+    // unaffected. The per-block history vectors are only populated if block
+    // history is enabled.
+    NONE = 2,
   };
 
   enum SampleLayout {
@@ -164,9 +193,15 @@ class EbuR128Analyzer {
   // The number of channels that will actually be used for measurement is the
   // minimum of (a) num_input_channels, (b) the length of input_channel_weights
   // array, and (c) the internal max number of supported channels.
+  //
+  // In HISTOGRAM and NONE gating modes, enable_block_history controls whether
+  // the per-block history vectors (ungated_momentary_powers() and friends) are
+  // populated. In EXACT gating mode they are always populated.
   EbuR128Analyzer(int32_t num_input_channels,
                   std::vector<float> input_channel_weights, int32_t sample_rate,
-                  bool enable_true_peak_measurement = false);
+                  bool enable_true_peak_measurement = false,
+                  GatingMode gating_mode = EXACT,
+                  bool enable_block_history = false);
 
   virtual ~EbuR128Analyzer() = default;
 
@@ -196,6 +231,7 @@ class EbuR128Analyzer {
   // been processed so far. Return value will *not* provide a loudness
   // measurement for very short audio clips, because integrated loudness
   // requires at least one momentary block of loudness to have been processed.
+  // Always std::nullopt in NONE gating mode.
   std::optional<float> GetRelativeGatedIntegratedLoudness() const;
 
   // Same as above but concatenates data from multiple analyzers
@@ -207,11 +243,12 @@ class EbuR128Analyzer {
   // short audio clips, because LRA requires at least one short term block of
   // loudness to have been processed. Additionally, EBU TECH 3341 states that
   // the LRA measurement should be annotated as "not stable" for the first 60
-  // seconds of audio.
+  // seconds of audio. Always std::nullopt in NONE gating mode.
   std::optional<LRAStats> GetLoudnessRangeStats(bool* is_stable) const;
 
   // Not a loudness measurement. This is rms evaluated in 100 ms blocks, in
-  // steps of the same length (100 ms).
+  // steps of the same length (100 ms). Always std::nullopt in NONE gating
+  // mode.
   std::optional<Rms100msStats> GetRms100msStats() const;
 
   // Returns the magnitude (absolute value) of the peak amplitude from the audio
@@ -232,6 +269,12 @@ class EbuR128Analyzer {
   // scale.
   float true_peak_dbfs() const;
 
+  // Returns the gating mode used by this analyzer.
+  GatingMode gating_mode() const { return gating_mode_; }
+
+  // The following accessors return the full per-block history. In HISTOGRAM
+  // gating mode the lists are empty unless block history was enabled.
+
   // Returns a reference to the full list of ungated momentary power
   // measurements.
   const std::vector<float>& ungated_momentary_powers() const {
@@ -264,6 +307,93 @@ class EbuR128Analyzer {
     return num_samples_processed_past_steps_ + num_samples_processed_this_step_;
   }
 
+  // Live metering, added by sfb 20261015.
+  //
+  // Returns the loudness of the most recent momentary (400 ms) or short-term
+  // (3 s) block, or kMinLKFS before the first complete block. These update
+  // every step regardless of gating mode or block history, and are not part
+  // of the serialized state.
+  float momentary_lkfs() const { return momentary_lkfs_; }
+  float short_term_lkfs() const { return short_term_lkfs_; }
+
+  // Resets digital_peak() and true_peak() so they cover only the audio
+  // processed afterwards. No other measurement is affected.
+  void ResetPeaks() {
+    abs_digital_peak_ = 0.0f;
+    abs_true_peak_ = 0.0f;
+  }
+
+  // Added by sfb 20261016
+  // Discards all measurements and the filter state, so that unrelated audio
+  // can be measured as if by a newly constructed analyzer.
+  void Reset();
+
+  // Segment-parallel analysis, added by sfb 20261015.
+  //
+  // A long recording can be analyzed in parallel by splitting it into
+  // adjacent segments that begin on 100 ms step boundaries, and analyzing
+  // each segment with its own analyzer. Every analyzer except the first is
+  // first fed the segment_pre_roll_samples() samples that immediately precede
+  // its segment (or all preceding samples, if there are fewer), and then
+  // StartSegment() is called before the segment itself is processed. Merging
+  // the analyzers in order with Merge() gives the same results as a single
+  // pass over the whole recording, up to floating point rounding.
+
+  // Returns the number of samples per channel in one 100 ms step.
+  int64_t num_samples_per_step() const { return num_samples_per_step_; }
+
+  // Returns the recommended pre-roll length in samples per channel: one
+  // short-term block to fill the block buffers, plus one step for the
+  // k-weighting filter state to settle.
+  int64_t segment_pre_roll_samples() const {
+    return (kStepsPerShortTermBlock + 1) * num_samples_per_step_;
+  }
+
+  // Discards all measurements made so far while keeping the filter memory
+  // and block buffers warmed by the pre-roll. The analyzer then behaves as if
+  // it had processed the first segment_start_sample samples of the recording
+  // itself. Returns false, and does nothing, unless the samples processed so
+  // far and segment_start_sample both end on a step boundary.
+  bool StartSegment(int64_t segment_start_sample);
+
+  // Appends the measurements of next, which must have analyzed the segment
+  // that immediately follows the audio processed by this analyzer. Afterwards
+  // this analyzer continues from where next left off. Returns false, leaving
+  // this analyzer unchanged, if the analyzers are configured differently or
+  // the segments are not adjacent.
+  bool Merge(const EbuR128Analyzer& next);
+
+  // Returns the complete analysis state (filter memory, partial-step
+  // accumulators, block buffers, and gating data) as a byte string. The state
+  // is stored in native byte order.
+  std::string SerializeState() const;
+
+  // Restores state returned by SerializeState() from an analyzer with the
+  // same configuration, so that processing can resume where it left off.
+  // Returns false, leaving this analyzer unchanged, if the state is from a
+  // differently configured analyzer or is truncated or corrupt.
+  bool RestoreState(const std::string& state);
+
+  // Added by sfb 20261016
+  // Returns only what integrated loudness and the peaks are computed from: the
+  // number of momentary blocks, the powers of the blocks above the absolute
+  // gate (their histogram in HISTOGRAM gating mode, and none in NONE gating
+  // mode), the sample and true peaks, and the number of samples processed. For
+  // long inputs this is a fraction of SerializeState(), which also holds every
+  // block's loudness, the short-term and RMS measurements, and the filter
+  // state.
+  std::string SerializeResults() const;
+
+  // Restores results returned by SerializeResults() from an analyzer with the
+  // same configuration into this analyzer, which must not have processed any
+  // audio. Afterwards GetRelativeGatedIntegratedLoudness(), digital_peak(),
+  // true_peak() and NumSamplesProcessed() return what they returned for the
+  // original analyzer. Other measurements are not restored, and the analyzer
+  // must not be used to process more audio. Returns false, leaving this
+  // analyzer unchanged, if the results are from a differently configured
+  // analyzer or are truncated or corrupt.
+  bool RestoreResults(const std::string& results);
+
  protected:
   // ChannelAnalysis tracks the state of analysis per channel. In particular,
   // there are three stages of calculation:
@@ -278,7 +408,7 @@ class EbuR128Analyzer {
   // window that updates per-block stats with fully accurate results.
   struct ChannelAnalysis {
     ChannelAnalysis() {
-      true_peak_input_audio.fill(0.0);
+      true_peak_history.fill(0.0);
       momentary_partial_sums.fill(0.0);
       short_term_partial_sums.fill(0.0);
       short_term_partial_peaks.fill(0.0);
@@ -291,11 +421,10 @@ class EbuR128Analyzer {
     float short_term_sst_accumulator = 0.0;
     float partial_peak = 0.0;
 
-    // Circular buffer of input audio for this channel, specifically for true
-    // peak calculation. It requires buffering (a small number of) audio
-    // samples in order to calculate FIR filters.
-    std::array<float, kTruePeakFilterLength> true_peak_input_audio;
-    int32_t true_peak_index = 0;
+    // The most recent input audio for this channel, oldest first,
+    // specifically for true peak calculation. The FIR filters need this much
+    // history to produce an output for the first sample of the next run.
+    std::array<float, kTruePeakFilterLength - 1> true_peak_history;
 
     // Circular buffer for momentary partial sums. Updated per 100 ms step.
     std::array<float, kStepsPerMomentaryBlock> momentary_partial_sums;
@@ -319,30 +448,60 @@ class EbuR128Analyzer {
     float short_term_block_peak = 0.0;
   };
 
-  // Computes the max absolute value of four audio samples computed by
-  // applying the ITU 1770 4X upsampling filters.
-  inline float MaxTruePeakFIR(
-      const std::array<float, kTruePeakFilterLength>& input_audio,
-      int32_t input_audio_circular_index) const;
-
   // Templatized version of Process, allows to avoid unnecessary data type
   // management overhead in the performance-critical per-sample loops.
+  //
+  // Audio is handled in runs of at most kBlockProcessingFrames that never
+  // cross a 100 ms step boundary, so the per-sample loops are free of
+  // step bookkeeping.
   template <typename T, EbuR128Analyzer::SampleLayout LAYOUT>
   void ProcessImpl(const void* audio_data, int64_t num_samples_per_channel);
 
-  // Updates peaks, k-weighting filter, and sum-square accumulators. This is a
-  // critical path for good performance of the code, so it attempts to do
-  // minimal processing per-sample, and leave as much computation as possible to
-  // the per-step update instead.
-  /* __attribute__((always_inline)) */ inline void UpdatePerSample(
-      float unfiltered_sample, int channel_index);
+  // Copies num_frames samples for the channel group starting at
+  // first_channel_index into block_scratch_, converted to float and arranged
+  // one channel per lane. Lanes past the last measured channel are zeroed.
+  template <typename T, EbuR128Analyzer::SampleLayout LAYOUT>
+  inline void LoadChannelGroup(const void* audio_data, int64_t sample_index,
+                               int64_t num_frames, int first_channel_index,
+                               int64_t num_samples_per_channel);
+
+  // Runs the k-weighting filter over the num_frames samples in
+  // block_scratch_ for the channel group starting at first_channel_index, and
+  // updates the group's peaks and sum-square accumulators in the same pass.
+  // This is a critical path for good performance of the code, so it attempts
+  // to do minimal processing per-sample, and leave as much computation as
+  // possible to the per-step update instead.
+  // Added by sfb 20261015
+  inline void FilterChannelGroup(int64_t num_frames, int first_channel_index);
+
+  // Updates the true peak from the num_frames samples in block_scratch_ for
+  // the channel in the given lane of the channel group starting at
+  // first_channel_index. The samples are upsampled 4x by applying the four
+  // ITU 1770 polyphase FIR filters to a linear copy of the channel's audio.
+  // Added by sfb 20261015
+  inline void UpdateTruePeakForChannel(int64_t num_frames,
+                                       int first_channel_index, int lane);
 
   // Updates block-level stats for RMS, momentary, and short-term blocks.
   /* __attribute__((always_inline)) */ inline void UpdatePerStep();
 
-  inline void UpdateAccumulatorsPerSample(float unfiltered_sample,
-                                          float k_weighted_sample,
-                                          ChannelAnalysis& sst);
+  // Discards the measurements made so far, but not the filter state.
+  // Added by sfb 20261016
+  void ClearMeasurements();
+
+  // Returns a byte string that is equal for analyzers with the same
+  // configuration.
+  std::string ConfigurationKey() const;
+
+  // Returns the sum and number of momentary powers above the absolute
+  // threshold.
+  void GetAbsoluteGatedMomentaryPowers(float* sum, int64_t* count) const;
+
+  // Adds the momentary powers above power_threshold (equivalently,
+  // lkfs_threshold) to *sum and increments *count for each of them.
+  void AccumulateGatedMomentaryPowers(float power_threshold,
+                                      float lkfs_threshold, float* sum,
+                                      int64_t* count) const;
 
   // Incrementally updates tracking stats. These update functions are called
   // once for every "step" i.e. a rate of 10 Hz.  The momentary block size is
@@ -389,6 +548,11 @@ class EbuR128Analyzer {
   // upsampling 4x and applying four 12-tap FIR filters.
   const bool enable_true_peak_measurement_;
 
+  // How block-level measurements are kept, and whether the per-block history
+  // vectors are populated.
+  const GatingMode gating_mode_;
+  const bool enable_block_history_;
+
   // Channel weights
   std::array<float, kMaxNumChannelsMeasured> channel_weights_;
 
@@ -423,11 +587,38 @@ class EbuR128Analyzer {
   // Tracks the per-channel intermediate calculations used to compute stats.
   std::array<ChannelAnalysis, kMaxNumChannelsMeasured> channel_analysis_;
 
+  // Staging area for one channel group of input audio, converted to float.
+  // Sample i of the channel in lane l is at index i * kFloatLaneCount + l.
+  std::array<float, kBlockProcessingFrames * kFloatLaneCount> block_scratch_;
+
+  // Linear staging area for true peak calculation: a channel's
+  // true_peak_history followed by the samples of the current run.
+  std::array<float, kTruePeakFilterLength - 1 + kBlockProcessingFrames>
+      true_peak_scratch_;
+
   // Accumulators for momentary powers that were gated by the absolute
   // threshold. Used to compute absolute-gated loudness without an extra loop.
   float sum_of_abs_gated_momentary_powers_ = 0.0f;
   int64_t num_abs_gated_momentary_powers_ = 0;
 
+  // The sample position at which measurement began, set by StartSegment().
+  int64_t segment_start_sample_ = 0;
+
+  // Number of momentary blocks measured so far, whether or not they were
+  // gated.
+  int64_t num_momentary_blocks_ = 0;
+
+  // Largest short-term loudness measured so far.
+  float short_term_max_lkfs_ = kMinLKFS;
+
+  // Loudness of the most recent momentary and short-term blocks.
+  float momentary_lkfs_ = kMinLKFS;
+  float short_term_lkfs_ = kMinLKFS;
+
+  // Number of rms blocks measured so far, and the largest rms level.
+  int64_t num_rms_blocks_ = 0;
+  float rms_max_dbfs_ = kMinDBFS;
+
   // Counters of how many audio ticks (number of audio samples for an individual
   // channel) have been processed so far.
   int64_t num_samples_processed_past_steps_ = 0;
@@ -468,6 +659,13 @@ class EbuR128Analyzer {
   // Rms measurement in dBFS of each rms block (100 ms), in steps of 100 ms
   // (i.e. 10 Hz).
   std::vector<float> rms_dbfs_;
+
+  // In HISTOGRAM gating mode, histograms of momentary loudness (with power
+  // sums) and short-term loudness above the absolute threshold, and of rms
+  // levels. Empty in EXACT and NONE gating modes.
+  LoudnessHistogram momentary_histogram_;
+  LoudnessHistogram short_term_histogram_;
+  LoudnessHistogram rms_histogram_;
 };
 
 }  // namespace loudness
@@ -36,6 +36,10 @@ inline constexpr int kStepsPerMomentaryBlock = 4;
 // Number of 100-millisecond steps in a 3 second "short-term block".
 inline constexpr int kStepsPerShortTermBlock = 30;
 
+// Maximum number of frames filtered per call to the block-processing kernel.
+// Runs of audio are additionally split at every 100 ms step boundary.
+inline constexpr int kBlockProcessingFrames = 256;
+
 // A biquad filter technically has 6 coefficients, but first coefficient is
 // always 1.
 inline constexpr int kNumBiquadCoeffs = 5;
@@ -84,6 +88,17 @@ inline constexpr float kStepLengthSeconds = 0.1f;
 // "not stable" until at least 60 seconds of audio have been processed.
 inline constexpr float k3341StableLRASeconds = 60.0f;
 
+// In histogram gating mode, momentary and short-term loudness are binned from
+// the absolute threshold up to this loudness, in bins of this width. Louder
+// measurements are counted in the top bin.
+inline constexpr float kHistogramBinWidthLU = 0.01f;
+inline constexpr float kHistogramMaxLKFS = 30.0f;
+
+// In histogram gating mode, 100 ms rms levels are binned over this range.
+// Quieter measurements are reported as kMinDBFS.
+inline constexpr float kHistogramMinRmsDBFS = -150.0f;
+inline constexpr float kHistogramMaxRmsDBFS = 20.0f;
+
 // ITU 1770 specifies the following four upsampling FIR filter phases, used
 // for measuring true peaks.
 inline constexpr int kTruePeakFilterLength = 12;
@@ -111,6 +126,8 @@ inline constexpr float kTruePeakFilterPhase3[] = {
 // sample formats into canonical floating point audio format.
 inline constexpr float kNorm16 = 1.0f / std::numeric_limits<int16_t>::max();
 inline constexpr float kNorm32 = 1.0f / std::numeric_limits<int32_t>::max();
+// Added by sfb 20261015
+inline constexpr float kNorm24 = 1.0f / ((1 << 23) - 1);
 
 }  // namespace loudness
 #endif  // LOUDNESS_EBUR128_SRC_EBUR128_CONSTANTS_H_
@@ -0,0 +1,184 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#ifndef LOUDNESS_EBUR128_SRC_FLOAT_LANES_H_
+#define LOUDNESS_EBUR128_SRC_FLOAT_LANES_H_
+
+//
+// FloatLanes is a minimal wrapper around the widest float vector available at
+// compile time. The loudness code uses it to run the same filter on several
+// audio channels at once, one channel per lane.
+//
+// Only the handful of operations needed by the block-processing kernels are
+// provided. Loads and stores are unaligned.
+//
+
+#include "ebur128_constants.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#else
+#include <algorithm>
+#include <cmath>
+#endif
+
+namespace loudness {
+
+#if defined(__AVX2__)
+
+inline constexpr int kFloatLaneCount = 8;
+
+struct FloatLanes {
+  __m256 v;
+
+  static FloatLanes Broadcast(float x) { return {_mm256_set1_ps(x)}; }
+  static FloatLanes Load(const float* p) { return {_mm256_loadu_ps(p)}; }
+  void Store(float* p) const { _mm256_storeu_ps(p, v); }
+
+  friend FloatLanes operator+(FloatLanes a, FloatLanes b) {
+    return {_mm256_add_ps(a.v, b.v)};
+  }
+  friend FloatLanes operator-(FloatLanes a, FloatLanes b) {
+    return {_mm256_sub_ps(a.v, b.v)};
+  }
+  friend FloatLanes operator*(FloatLanes a, FloatLanes b) {
+    return {_mm256_mul_ps(a.v, b.v)};
+  }
+  friend FloatLanes Max(FloatLanes a, FloatLanes b) {
+    return {_mm256_max_ps(a.v, b.v)};
+  }
+  friend FloatLanes Abs(FloatLanes a) {
+    return {_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)};
+  }
+  friend float ReduceMax(FloatLanes a) {
+    __m128 m = _mm_max_ps(_mm256_castps256_ps128(a.v),
+                          _mm256_extractf128_ps(a.v, 1));
+    m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+    m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+    return _mm_cvtss_f32(m);
+  }
+};
+
+#elif defined(__SSE2__)
+
+inline constexpr int kFloatLaneCount = 4;
+
+struct FloatLanes {
+  __m128 v;
+
+  static FloatLanes Broadcast(float x) { return {_mm_set1_ps(x)}; }
+  static FloatLanes Load(const float* p) { return {_mm_loadu_ps(p)}; }
+  void Store(float* p) const { _mm_storeu_ps(p, v); }
+
+  friend FloatLanes operator+(FloatLanes a, FloatLanes b) {
+    return {_mm_add_ps(a.v, b.v)};
+  }
+  friend FloatLanes operator-(FloatLanes a, FloatLanes b) {
+    return {_mm_sub_ps(a.v, b.v)};
+  }
+  friend FloatLanes operator*(FloatLanes a, FloatLanes b) {
+    return {_mm_mul_ps(a.v, b.v)};
+  }
+  friend FloatLanes Max(FloatLanes a, FloatLanes b) {
+    return {_mm_max_ps(a.v, b.v)};
+  }
+  friend FloatLanes Abs(FloatLanes a) {
+    return {_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)};
+  }
+  friend float ReduceMax(FloatLanes a) {
+    __m128 m = _mm_max_ps(a.v, _mm_movehl_ps(a.v, a.v));
+    m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+    return _mm_cvtss_f32(m);
+  }
+};
+
+#elif defined(__ARM_NEON)
+
+inline constexpr int kFloatLaneCount = 4;
+
+struct FloatLanes {
+  float32x4_t v;
+
+  static FloatLanes Broadcast(float x) { return {vdupq_n_f32(x)}; }
+  static FloatLanes Load(const float* p) { return {vld1q_f32(p)}; }
+  void Store(float* p) const { vst1q_f32(p, v); }
+
+  friend FloatLanes operator+(FloatLanes a, FloatLanes b) {
+    return {vaddq_f32(a.v, b.v)};
+  }
+  friend FloatLanes operator-(FloatLanes a, FloatLanes b) {
+    return {vsubq_f32(a.v, b.v)};
+  }
+  friend FloatLanes operator*(FloatLanes a, FloatLanes b) {
+    return {vmulq_f32(a.v, b.v)};
+  }
+  friend FloatLanes Max(FloatLanes a, FloatLanes b) {
+    return {vmaxq_f32(a.v, b.v)};
+  }
+  friend FloatLanes Abs(FloatLanes a) { return {vabsq_f32(a.v)}; }
+  friend float ReduceMax(FloatLanes a) {
+#if defined(__aarch64__)
+    return vmaxvq_f32(a.v);
+#else
+    float32x2_t m = vpmax_f32(vget_low_f32(a.v), vget_high_f32(a.v));
+    return vget_lane_f32(vpmax_f32(m, m), 0);
+#endif
+  }
+};
+
+#else
+
+// Scalar fallback. Four lanes are kept so the compiler has a chance to
+// auto-vectorize, and so that the channel grouping matches SSE and NEON.
+inline constexpr int kFloatLaneCount = 4;
+
+struct FloatLanes {
+  float v[kFloatLaneCount];
+
+  static FloatLanes Broadcast(float x) { return {{x, x, x, x}}; }
+  static FloatLanes Load(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+  void Store(float* p) const { std::copy(v, v + kFloatLaneCount, p); }
+
+  friend FloatLanes operator+(FloatLanes a, FloatLanes b) {
+    for (int i = 0; i < kFloatLaneCount; ++i) a.v[i] += b.v[i];
+    return a;
+  }
+  friend FloatLanes operator-(FloatLanes a, FloatLanes b) {
+    for (int i = 0; i < kFloatLaneCount; ++i) a.v[i] -= b.v[i];
+    return a;
+  }
+  friend FloatLanes operator*(FloatLanes a, FloatLanes b) {
+    for (int i = 0; i < kFloatLaneCount; ++i) a.v[i] *= b.v[i];
+    return a;
+  }
+  friend FloatLanes Max(FloatLanes a, FloatLanes b) {
+    for (int i = 0; i < kFloatLaneCount; ++i) {
+      a.v[i] = std::fmax(a.v[i], b.v[i]);
+    }
+    return a;
+  }
+  friend FloatLanes Abs(FloatLanes a) {
+    for (int i = 0; i < kFloatLaneCount; ++i) a.v[i] = std::fabs(a.v[i]);
+    return a;
+  }
+  friend float ReduceMax(FloatLanes a) {
+    return *std::max_element(a.v, a.v + kFloatLaneCount);
+  }
+};
+
+#endif
+
+static_assert(kMaxNumChannelsMeasured % kFloatLaneCount == 0,
+              "Channel storage must be a whole number of lane groups");
+
+}  // namespace loudness
+
+#endif  // LOUDNESS_EBUR128_SRC_FLOAT_LANES_H_
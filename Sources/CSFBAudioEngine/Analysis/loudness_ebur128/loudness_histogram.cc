@@ -0,0 +1,181 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#include "loudness_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "ebur128_constants.h"
+
+namespace loudness {
+
+LoudnessHistogram::LoudnessHistogram(float min_value, float max_value,
+                                     float bin_width, bool track_power_sums)
+    : min_value_(min_value),
+      bin_width_(bin_width),
+      one_over_bin_width_(1.0f / bin_width) {
+  const int num_bins =
+      static_cast<int>(std::ceil((max_value - min_value) / bin_width));
+  counts_.resize(num_bins, 0);
+  if (track_power_sums) {
+    power_sums_.resize(num_bins, 0.0);
+  }
+}
+
+void LoudnessHistogram::Add(float value, float power) {
+  ++count_;
+  // NaN compares false and is treated as an underflow.
+  if (!(value >= min_value_)) {
+    ++underflow_count_;
+    return;
+  }
+  const int index =
+      std::min(static_cast<int>((value - min_value_) * one_over_bin_width_),
+               num_bins() - 1);
+  ++counts_[index];
+  if (!power_sums_.empty()) {
+    power_sums_[index] += power;
+  }
+}
+
+bool LoudnessHistogram::Merge(const LoudnessHistogram& other) {
+  if (other.min_value_ != min_value_ || other.bin_width_ != bin_width_ ||
+      other.counts_.size() != counts_.size() ||
+      other.power_sums_.size() != power_sums_.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    counts_[i] += other.counts_[i];
+  }
+  for (size_t i = 0; i < power_sums_.size(); ++i) {
+    power_sums_[i] += other.power_sums_[i];
+  }
+  underflow_count_ += other.underflow_count_;
+  count_ += other.count_;
+  return true;
+}
+
+void LoudnessHistogram::Serialize(StateWriter& writer) const {
+  writer.Write(min_value_);
+  writer.Write(bin_width_);
+  writer.Write(static_cast<int32_t>(counts_.size()));
+  writer.Write(static_cast<uint8_t>(!power_sums_.empty()));
+  writer.Write(underflow_count_);
+  writer.Write(count_);
+
+  // Only the occupied bins are written, which keeps serialized state small
+  // since real program material spans a narrow loudness range.
+  int32_t num_occupied_bins = 0;
+  for (int64_t bin_count : counts_) {
+    num_occupied_bins += bin_count != 0;
+  }
+  writer.Write(num_occupied_bins);
+  for (int32_t i = 0; i < num_bins(); ++i) {
+    if (counts_[i] == 0) {
+      continue;
+    }
+    writer.Write(i);
+    writer.Write(counts_[i]);
+    if (!power_sums_.empty()) {
+      writer.Write(power_sums_[i]);
+    }
+  }
+}
+
+bool LoudnessHistogram::Deserialize(StateReader& reader) {
+  float min_value = 0.0f;
+  float bin_width = 0.0f;
+  int32_t num_bins = 0;
+  uint8_t has_power_sums = 0;
+  int64_t underflow_count = 0;
+  int64_t count = 0;
+  int32_t num_occupied_bins = 0;
+  if (!reader.Read(&min_value) || !reader.Read(&bin_width) ||
+      !reader.Read(&num_bins) || !reader.Read(&has_power_sums) ||
+      !reader.Read(&underflow_count) || !reader.Read(&count) ||
+      !reader.Read(&num_occupied_bins)) {
+    return false;
+  }
+  if (min_value != min_value_ || bin_width != bin_width_ ||
+      num_bins != this->num_bins() ||
+      (has_power_sums != 0) != !power_sums_.empty()) {
+    return false;
+  }
+
+  std::vector<int64_t> counts(num_bins, 0);
+  std::vector<double> power_sums(power_sums_.size(), 0.0);
+  for (int32_t j = 0; j < num_occupied_bins; ++j) {
+    int32_t i = 0;
+    if (!reader.Read(&i) || i < 0 || i >= num_bins ||
+        !reader.Read(&counts[i])) {
+      return false;
+    }
+    if (!power_sums.empty() && !reader.Read(&power_sums[i])) {
+      return false;
+    }
+  }
+
+  counts_ = std::move(counts);
+  power_sums_ = std::move(power_sums);
+  underflow_count_ = underflow_count;
+  count_ = count;
+  return true;
+}
+
+int LoudnessHistogram::FirstBinAbove(float threshold) const {
+  // BinCenter(i) > threshold  <=>  i > (threshold - min_value_) / width - 0.5
+  const float position =
+      (threshold - min_value_) * one_over_bin_width_ - 0.5f;
+  if (position < 0.0f) {
+    return 0;
+  }
+  return static_cast<int>(
+      std::min<float>(std::floor(position) + 1.0f, num_bins()));
+}
+
+int64_t LoudnessHistogram::CountFromBin(int first_bin) const {
+  int64_t count = 0;
+  for (int i = std::max(first_bin, 0); i < num_bins(); ++i) {
+    count += counts_[i];
+  }
+  return count;
+}
+
+double LoudnessHistogram::PowerSumFromBin(int first_bin) const {
+  double sum = 0.0;
+  for (int i = std::max(first_bin, 0); i < num_bins(); ++i) {
+    sum += power_sums_[i];
+  }
+  return sum;
+}
+
+float LoudnessHistogram::ValueAtRank(int first_bin, int64_t rank) const {
+  if (first_bin < 0) {
+    if (rank < underflow_count_) {
+      return kMinDBFS;
+    }
+    rank -= underflow_count_;
+    first_bin = 0;
+  }
+  for (int i = first_bin; i < num_bins(); ++i) {
+    if (rank < counts_[i]) {
+      return BinCenter(i);
+    }
+    rank -= counts_[i];
+  }
+  return kMinDBFS;
+}
+
+float LoudnessHistogram::BinCenter(int index) const {
+  return min_value_ + (static_cast<float>(index) + 0.5f) * bin_width_;
+}
+
+}  // namespace loudness
@@ -0,0 +1,89 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#ifndef LOUDNESS_EBUR128_SRC_LOUDNESS_HISTOGRAM_H_
+#define LOUDNESS_EBUR128_SRC_LOUDNESS_HISTOGRAM_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "state_serialization.h"
+
+namespace loudness {
+
+// LoudnessHistogram counts loudness (or level) measurements in fixed-width
+// bins over [min_value, max_value). Values at or above max_value are counted
+// in the last bin. Values below min_value are counted in a separate underflow
+// bin whose representative value is kMinDBFS.
+//
+// Optionally, the linear power of each measurement is summed per bin so that
+// power averages over a range of bins can be computed without quantization
+// error.
+//
+// Memory use is fixed at construction, and queries are O(number of bins).
+class LoudnessHistogram {
+ public:
+  // Creates an empty histogram with no bins. All counts are zero.
+  LoudnessHistogram() = default;
+
+  LoudnessHistogram(float min_value, float max_value, float bin_width,
+                    bool track_power_sums);
+
+  // Adds one measurement. power is ignored unless power sums are tracked.
+  void Add(float value, float power = 0.0f);
+
+  // Adds all the measurements from other. Returns false, leaving this
+  // histogram unchanged, if other does not have the same binning.
+  bool Merge(const LoudnessHistogram& other);
+
+  // Appends the histogram's binning and counts to writer.
+  void Serialize(StateWriter& writer) const;
+
+  // Replaces the histogram's counts with those read from reader. Returns
+  // false if the serialized binning does not match this histogram's.
+  bool Deserialize(StateReader& reader);
+
+  // Returns the number of measurements added, including underflows.
+  int64_t count() const { return count_; }
+
+  // Returns the number of bins, not counting the underflow bin.
+  int num_bins() const { return static_cast<int>(counts_.size()); }
+
+  // Returns the index of the first bin whose center is above threshold.
+  // Returns num_bins() if there is no such bin.
+  int FirstBinAbove(float threshold) const;
+
+  // Returns the number of measurements in bins [first_bin, num_bins()).
+  int64_t CountFromBin(int first_bin) const;
+
+  // Returns the summed power of the measurements in bins
+  // [first_bin, num_bins()). Requires power sums to be tracked.
+  double PowerSumFromBin(int first_bin) const;
+
+  // Returns the value of the measurement at the zero-based rank among the
+  // measurements in bins [first_bin, num_bins()) sorted in ascending order.
+  // If first_bin is negative the underflow bin is included and ranks start
+  // there. The returned value is the center of the bin holding the
+  // measurement.
+  float ValueAtRank(int first_bin, int64_t rank) const;
+
+ private:
+  float BinCenter(int index) const;
+
+  float min_value_ = 0.0f;
+  float bin_width_ = 1.0f;
+  float one_over_bin_width_ = 1.0f;
+
+  std::vector<int64_t> counts_;
+  std::vector<double> power_sums_;
+  int64_t underflow_count_ = 0;
+  int64_t count_ = 0;
+};
+
+}  // namespace loudness
+
+#endif  // LOUDNESS_EBUR128_SRC_LOUDNESS_HISTOGRAM_H_
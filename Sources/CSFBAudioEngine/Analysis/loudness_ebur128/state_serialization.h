@@ -0,0 +1,93 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#ifndef LOUDNESS_EBUR128_SRC_STATE_SERIALIZATION_H_
+#define LOUDNESS_EBUR128_SRC_STATE_SERIALIZATION_H_
+
+//
+// Minimal helpers for writing and reading analyzer state as a flat byte
+// string. Values are stored in native byte order with no padding between
+// them, so serialized state is only meaningful on machines with the same
+// endianness and floating point representation.
+//
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace loudness {
+
+class StateWriter {
+ public:
+  template <typename T>
+  void Write(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    bytes_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  template <typename T>
+  void WriteVector(const std::vector<T>& values) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    Write(static_cast<uint64_t>(values.size()));
+    if (!values.empty()) {
+      bytes_.append(reinterpret_cast<const char*>(values.data()),
+                    values.size() * sizeof(T));
+    }
+  }
+
+  std::string& bytes() { return bytes_; }
+
+ private:
+  std::string bytes_;
+};
+
+class StateReader {
+ public:
+  StateReader(const char* data, size_t length)
+      : position_(data), end_(data + length) {}
+
+  // Reads one value. Returns false, leaving *value unchanged, if too few bytes
+  // remain.
+  template <typename T>
+  bool Read(T* value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (static_cast<size_t>(end_ - position_) < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(value, position_, sizeof(T));
+    position_ += sizeof(T);
+    return true;
+  }
+
+  template <typename T>
+  bool ReadVector(std::vector<T>* values) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    uint64_t size = 0;
+    if (!Read(&size) ||
+        size > static_cast<size_t>(end_ - position_) / sizeof(T)) {
+      return false;
+    }
+    values->resize(size);
+    if (size > 0) {
+      std::memcpy(values->data(), position_, size * sizeof(T));
+    }
+    position_ += size * sizeof(T);
+    return true;
+  }
+
+  bool AtEnd() const { return position_ == end_; }
+
+ private:
+  const char* position_;
+  const char* end_;
+};
+
+}  // namespace loudness
+
+#endif  // LOUDNESS_EBUR128_SRC_STATE_SERIALIZATION_H_
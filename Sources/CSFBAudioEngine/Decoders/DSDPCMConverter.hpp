@@ -0,0 +1,639 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#pragma once
+
+#include "OrderedWorkPipeline.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif /* defined(__AVX2__) */
+
+namespace sfb {
+namespace dsd2pcm {
+
+// MARK: - Tables
+
+// Bit reversal lookup table from http://graphics.stanford.edu/~seander/bithacks.html#BitReverseTable
+constexpr unsigned char bitReverseTable256[256] = {
+#define R2(n) n, n + 2 * 64, n + 1 * 64, n + 3 * 64
+#define R4(n) R2(n), R2(n + 2 * 16), R2(n + 1 * 16), R2(n + 3 * 16)
+#define R6(n) R4(n), R4(n + 2 * 4), R4(n + 1 * 4), R4(n + 3 * 4)
+        R6(0), R6(2), R6(1), R6(3)};
+#undef R6
+#undef R4
+#undef R2
+
+/// The filter's contribution for each value of the channel byte at each lag
+///
+/// `values[lag][byte]` is the sum of the eight taps covering the most-significant-bit-first channel byte `lag` bytes
+/// before the newest one. The second half of the filter is the mirror image of the first, so its tables are the
+/// first half's indexed by the bit-reversed byte, which removes the per-byte bit reversal of the original algorithm.
+template <int Lags>
+struct LagTables {
+    /// The number of channel bytes spanned by the filter
+    static constexpr int lags = Lags;
+
+    float values[Lags][256];
+};
+
+// SPDX-SnippetCopyrightText: 2009,2011 Sebastian Gesemann
+// SPDX-SnippetLicenseIdentifier: BSD-2-Clause-Views
+// SPDX-SnippetComment: Adapted from 'dsd2pcm.c'
+
+/// Returns the lag tables for the symmetric lowpass filter whose second half is `htaps`
+template <std::size_t HalfTaps>
+constexpr auto makeLagTables(const double (&htaps)[HalfTaps]) noexcept {
+    constexpr int ctables = (HalfTaps + 7) / 8;
+    LagTables<2 * ctables> tables{};
+    for (int t = 0; t < ctables; ++t) {
+        const int k = std::min(static_cast<int>(HalfTaps) - (t * 8), 8);
+        for (int e = 0; e < 256; ++e) {
+            double acc = 0.0;
+            for (int m = 0; m < k; ++m) {
+                acc += (((e >> (7 - m)) & 1) * 2 - 1) * htaps[(t * 8) + m];
+            }
+            // These taps cover the byte at lag ctables - 1 - t and, mirrored, the byte at lag ctables + t
+            tables.values[ctables - 1 - t][e] = static_cast<float>(acc);
+            tables.values[ctables + t][bitReverseTable256[e]] = static_cast<float>(acc);
+        }
+    }
+    return tables;
+}
+
+namespace detail {
+
+/// Returns the filter output for the channel byte at `src`, unrolled over the lags
+template <int Lags, std::size_t... Lag>
+inline float sumLags(const LagTables<Lags> &tables, const unsigned char *src,
+                     std::index_sequence<Lag...> /*unused*/) noexcept {
+    return (0.f + ... + tables.values[Lag][*(src - Lag)]);
+}
+
+} /* namespace detail */
+
+/// Filters `count` most-significant-bit-first channel bytes from `src` into `count` samples in `dst`
+///
+/// The `Tables.lags - 1` bytes preceding `src` must be the channel's history. Both paths sum the lags in the same
+/// order so their results are identical.
+template <const auto &Tables>
+void filter(const unsigned char *src, std::size_t count, float *dst) noexcept {
+    constexpr int lags = std::remove_reference_t<decltype(Tables)>::lags;
+    std::size_t n = 0;
+
+#if defined(__AVX2__)
+    // Eight consecutive outputs per iteration using gathers
+    for (; n + 8 <= count; n += 8) {
+        __m256 acc = _mm256_setzero_ps();
+        for (int lag = 0; lag < lags; ++lag) {
+            const __m256i bytes =
+                    _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + n - lag)));
+            acc = _mm256_add_ps(acc, _mm256_i32gather_ps(Tables.values[lag], bytes, sizeof(float)));
+        }
+        _mm256_storeu_ps(dst + n, acc);
+    }
+#endif /* defined(__AVX2__) */
+
+    for (; n < count; ++n) {
+        dst[n] = detail::sumLags(Tables, src + n, std::make_index_sequence<lags>{});
+    }
+}
+
+/// A half-band lowpass filter
+///
+/// Half-band filters are symmetric and every even tap except the center tap, which is 0.5, is zero. Only the odd
+/// taps to one side of the center are stored, ordered outward from the center.
+struct HalfBandFilter {
+    /// The odd taps
+    const float *coefficients;
+    /// The number of odd taps
+    int count;
+
+    /// Returns the length of the filter
+    constexpr int length() const noexcept { return (4 * count) - 1; }
+};
+
+/// A set of filters for DSD to PCM conversion
+///
+/// The first stage decimates DSD by 8 using lag tables generated at compile time. Intermediate half-band stages
+/// only need to protect the final passband so they use a short filter; the final stage uses a steeper one.
+struct FilterProfile {
+    /// The first stage
+    void (*filter)(const unsigned char *src, std::size_t count, float *dst) noexcept;
+    /// The number of channel bytes spanned by the first stage
+    int lags;
+    /// The filter for intermediate half-band stages
+    HalfBandFilter relaxedHalfBand;
+    /// The filter for the final half-band stage
+    HalfBandFilter steepHalfBand;
+};
+
+namespace detail {
+
+// MARK: Short profile
+
+/// The second half of a 48-tap lowpass for DSD64: 0.09 dB down at 20 kHz with about 72 dB rejection above 282.8 kHz
+constexpr double shortHalfTaps[] = {
+        0.085063256997716555,     0.082121916273938008,     0.076482609515994996,     0.068603496103244144,
+        0.059104468059340401,     0.048697207201021055,     0.038108122163291661,     0.028004558597927877,
+        0.018933671127027913,     0.011280947104113801,     0.0052520451372593369,    0.00087795833290224159,
+        -0.0019598429304807533,   -0.0034901610488988845,   -0.0040059396065841321,   -0.0038185431060054148,
+        -0.0032186468306616206,   -0.0024479970546126517,   -0.0016839518927935235,   -0.0010364087827813849,
+        -0.00055485844239013284,  -0.00024213858074163885,  -7.109011139614401e-05,   -6.7822643170820066e-07};
+
+/// 19-tap half-band lowpass: flat to 0.1 fs with about 77 dB rejection above 0.4 fs
+constexpr float shortRelaxedHalfBandTaps[] = {
+        0.30419833905589843,     -0.069805268246755383,   0.018646599544682665,    -0.003134203085523187,
+        9.4532731697475329e-05};
+
+/// 51-tap half-band lowpass: flat to 0.2 fs with about 78 dB rejection above 0.3 fs
+constexpr float shortSteepHalfBandTaps[] = {
+        0.31644951653185112,      -0.10062574808883513,     0.054895861321878875,     -0.033920566146265876,
+        0.021650766641405591,     -0.013730266963023933,    0.0084508016692708437,    -0.0049522868168005683,
+        0.0027067559045214844,    -0.0013417320943155925,   0.0005754378583088225,    -0.00019256907481864325,
+        3.4029256823003676e-05};
+
+inline constexpr auto shortLagTables = makeLagTables(shortHalfTaps);
+
+// MARK: Standard profile
+
+// SPDX-SnippetCopyrightText: 2009,2011 Sebastian Gesemann
+// SPDX-SnippetLicenseIdentifier: BSD-2-Clause-Views
+// SPDX-SnippetComment: Adapted from 'dsd2pcm.c'
+
+/*
+ * Properties of this 96-tap lowpass filter when applied on a signal
+ * with sampling rate of 44100*64 Hz:
+ *
+ * () has a delay of 17 microseconds.
+ *
+ * () flat response up to 48 kHz
+ *
+ * () if you downsample afterwards by a factor of 8, the
+ *    spectrum below 70 kHz is practically alias-free.
+ *
+ * () stopband rejection is about 160 dB
+ */
+
+/*
+ * The 2nd half (48 coeffs) of a 96-tap symmetric lowpass filter
+ */
+constexpr double standardHalfTaps[] = {
+        0.09950731974056658,     0.09562845727714668,     0.08819647126516944,     0.07782552527068175,
+        0.06534876523171299,     0.05172629311427257,     0.0379429484910187,      0.02490921351762261,
+        0.0133774746265897,      0.003883043418804416,    -0.003284703416210726,   -0.008080250212687497,
+        -0.01067241812471033,    -0.01139427235000863,    -0.0106813877974587,     -0.009007905078766049,
+        -0.006828859761015335,   -0.004535184322001496,   -0.002425035959059578,   -0.0006922187080790708,
+        0.0005700762133516592,   0.001353838005269448,    0.001713709169690937,    0.001742046839472948,
+        0.001545601648013235,    0.001226696225277855,    0.0008704322683580222,   0.0005381636200535649,
+        0.000266446345425276,    7.002968738383528e-05,   -5.279407053811266e-05,  -0.0001140625650874684,
+        -0.0001304796361231895,  -0.0001189970287491285,  -9.396247155265073e-05,  -6.577634378272832e-05,
+        -4.07492895872535e-05,   -2.17407957554587e-05,   -9.163058931391722e-06,  -2.017460145032201e-06,
+        1.249721855219005e-06,   2.166655190537392e-06,   1.930520892991082e-06,   1.319400334374195e-06,
+        7.410039764949091e-07,   3.423230509967409e-07,   1.244182214744588e-07,   3.130441005359396e-08};
+
+/// 31-tap half-band lowpass: flat to 0.1 fs with about 120 dB rejection above 0.4 fs
+constexpr float standardRelaxedHalfBandTaps[] = {
+        0.30933480068348977,      -0.081839110241567577,    0.030543894474613631,     -0.01032991031262834,
+        0.0027359748033979041,    -0.0004885434329876931,   4.3195545920566285e-05,   -3.0152023826352866e-07};
+
+/// 87-tap half-band lowpass: flat to 0.2 fs with about 129 dB rejection above 0.3 fs
+constexpr float standardSteepHalfBandTaps[] = {
+        0.31720493083354956,      -0.1028308476199598,      0.058345616297025694,     -0.038307897519039585,
+        0.026606566845168078,     -0.018870844762392584,    0.013423586886973665,     -0.0094726511871741922,
+        0.0065810142064203718,    -0.0044743090432892911,   0.0029612103759098728,    -0.0018978922681913032,
+        0.0011714649375430527,    -0.00069195811370338659,  0.00038809719079792844,   -0.00020460757946655063,
+        9.9994532117618581e-05,   -4.4378634571992547e-05,  1.7300713325053304e-05,   -5.5696063990770461e-06,
+        1.2786967499737577e-06,   -1.051813931090143e-07};
+
+inline constexpr auto standardLagTables = makeLagTables(standardHalfTaps);
+
+// MARK: Long profile
+
+/// The second half of a 192-tap lowpass for DSD64: flat within 0.002 dB to 60 kHz with about 146 dB rejection above
+/// 200 kHz
+constexpr double longHalfTaps[] = {
+        0.083360183497468989,     0.081325750675469746,     0.077353506166152686,     0.071630842333639249,
+        0.064424632617358222,     0.056065288606875756,     0.046927268658494327,     0.037407374187723628,
+        0.027902299657985711,     0.018786921767351225,     0.01039472298933721,      0.0030015538773147065,
+        -0.0031863352930887525,   -0.0080393963238147096,   -0.011506786298380381,    -0.013613407782704221,
+        -0.014452463145472783,    -0.014174290193723361,    -0.012972464778945932,    -0.0110682894018791,
+        -0.0086948291832604165,   -0.0060816096064548835,   -0.0034409630688664132,   -0.00095681843483166399,
+        0.001223511154261051,     0.0029942500481907292,    0.004292764033201538,     0.0050980644036678596,
+        0.005426638061637171,     0.0053261865329141898,    0.0048679545060612065,    0.0041383642278333035,
+        0.00323064849137849,      0.0022370994266935274,    0.0012424339409889958,    0.00031863297799678449,
+        -0.000478544676547978,    -0.0011113282954044112,   -0.0015600759027500345,   -0.0018220013620274278,
+        -0.0019087846455907174,   -0.0018434123736097952,   -0.001656610992365873,    -0.0013832181592024057,
+        -0.0010587944147301498,   -0.00071671416157353864,  -0.00038590031145099859,  -8.9288729794977306e-05,
+        0.00015696587452463656,   0.00034359565425290626,   0.00046774049415846156,   0.00053202150074345364,
+        0.00054332117250325861,   0.00051142468973117781,   0.00044766330910409769,   0.00036367690051735841,
+        0.00027038205004183954,   0.00017719875608048631,   9.1556121033623011e-05,   1.8668519494441144e-05,
+        -3.8449378689689077e-05,  -7.8776420882494629e-05,  -0.00010294401023693207,  -0.00011281853386002878,
+        -0.00011106123886892498,  -0.00010071108465414267,  -8.4824788443497605e-05,  -6.6195823329476554e-05,
+        -4.7161982433154527e-05,  -2.9500452877806934e-05,  -1.4400946258019146e-05,  -2.5017214306557185e-06,
+        6.0296350770185566e-06,   1.1389280894647039e-05,   1.4021093830360268e-05,   1.4505601890447401e-05,
+        1.3464097458945004e-05,   1.1484117001821733e-05,   9.0686817001568734e-06,   6.6085308746240727e-06,
+        4.3742520563990854e-06,   2.5237912865662978e-06,   1.1202668188462565e-06,   1.5517172773641998e-07,
+        -4.272552212360159e-07,   -7.0769649577087339e-07,  -7.7353190239436862e-07,  -7.0570873801950076e-07,
+        -5.7077474805248494e-07,  -4.1746839372677191e-07,  -2.7685172651455467e-07,  -1.6481023753318892e-07,
+        -8.5786238810932762e-08,  -3.679684991496743e-08,   -1.1050024280091148e-08,  -7.537876117125868e-10};
+
+/// 39-tap half-band lowpass: flat to 0.1 fs with about 143 dB rejection above 0.4 fs
+constexpr float longRelaxedHalfBandTaps[] = {
+        0.31173363385415532,      -0.087839170779920286,    0.037449761429468899,     -0.01578309474216955,
+        0.0058870886444362535,    -0.0018114979167925073,   0.00042476494858420242,   -6.6584504029869053e-05,
+        5.1274604533340347e-06,   -2.8394185798935965e-08};
+
+/// 103-tap half-band lowpass: flat to 0.2 fs with about 147 dB rejection above 0.3 fs
+constexpr float longSteepHalfBandTaps[] = {
+        0.3173894466308174,       -0.10337170974644803,     0.059206417018025723,     -0.039432169714446264,
+        0.027923555800255466,     -0.020302455127144337,    0.01489162319347124,      -0.010905469945606855,
+        0.0079188467106054576,    -0.005672755093254133,    0.0039926975396520012,    -0.0027511910662781691,
+        0.0018495996889633094,    -0.0012090210113107508,   0.00076554227427814135,   -0.00046757365222202632,
+        0.00027410036537799717,   -0.0001532797312364762,   8.1128190513184733e-05,   -4.0219201800441284e-05,
+        1.8404009486809258e-05,   -7.6053103463795858e-06,  2.7388310915894014e-06,   -8.0411038875042883e-07,
+        1.6403616950402582e-07,   -1.0578225205546362e-08};
+
+inline constexpr auto longLagTables = makeLagTables(longHalfTaps);
+
+/// Returns a half-band filter using `coefficients`
+template <std::size_t N>
+constexpr HalfBandFilter halfBand(const float (&coefficients)[N]) noexcept {
+    return {coefficients, static_cast<int>(N)};
+}
+
+} /* namespace detail */
+
+/// A short, low CPU profile for previews and on-device transcoding
+constexpr FilterProfile shortProfile{filter<detail::shortLagTables>, detail::shortLagTables.lags,
+                                     detail::halfBand(detail::shortRelaxedHalfBandTaps),
+                                     detail::halfBand(detail::shortSteepHalfBandTaps)};
+
+/// The standard profile using the 96-tap DSD2PCM filter
+constexpr FilterProfile standardProfile{filter<detail::standardLagTables>, detail::standardLagTables.lags,
+                                        detail::halfBand(detail::standardRelaxedHalfBandTaps),
+                                        detail::halfBand(detail::standardSteepHalfBandTaps)};
+
+/// A long, steep profile for archival conversion
+constexpr FilterProfile longProfile{filter<detail::longLagTables>, detail::longLagTables.lags,
+                                    detail::halfBand(detail::longRelaxedHalfBandTaps),
+                                    detail::halfBand(detail::longSteepHalfBandTaps)};
+
+} /* namespace dsd2pcm */
+
+/// The 8:1 first stage for clustered (interleaved) multichannel DSD
+///
+/// Input is processed in chunks of `chunkFrames` frames. For each channel, one strided pass over the chunk copies the
+/// channel's bytes into a small staging area that directly follows the channel's history, so the filter reads them
+/// contiguously and the original per-channel FIFO is unnecessary. A chunk is small enough to stay in cache across the
+/// per-channel passes.
+class DSDPCMFilter final {
+  public:
+    /// The number of frames deinterleaved per chunk
+    static constexpr std::size_t chunkFrames = 1024;
+
+    /// Creates a filter for `channelCount` channels using the first stage of `profile`
+    DSDPCMFilter(int channelCount, const dsd2pcm::FilterProfile &profile)
+      : filter_{profile.filter}, historySize_{static_cast<std::size_t>(profile.lags) - 1},
+        laneSize_{historySize_ + chunkFrames}, channelCount_{channelCount}, staging_(channelCount * laneSize_) {
+        reset();
+    }
+
+    /// Resets the filter history to silence
+    void reset() noexcept {
+        // The original algorithm primes its FIFO with the 0x69 silence pattern, but the oldest bytes are used before
+        // they would have been bit reversed. Store them reversed so the output is identical.
+        const std::size_t reversed = historySize_ / 2;
+        for (int channel = 0; channel < channelCount_; ++channel) {
+            unsigned char *history = lane(channel);
+            std::fill_n(history, reversed, 0x96);
+            std::fill_n(history + reversed, historySize_ - reversed, 0x69);
+        }
+    }
+
+    /// Converts `frames` clustered frames from `src` to PCM in the buffers in `dst`, one per channel
+    /// - parameter lsbitfirst: Whether the least significant bit of each channel byte is the oldest
+    void translate(std::size_t frames, const unsigned char *src, bool lsbitfirst, float *const *dst) noexcept {
+        translate(frames, src, lsbitfirst, dst, 0, channelCount_);
+    }
+
+    /// Converts channels `firstChannel` through `lastChannel - 1` of `frames` clustered frames from `src` to PCM in
+    /// the buffers in `dst`, one per channel
+    ///
+    /// Each channel's history is independent so disjoint channel ranges may be translated concurrently.
+    /// - parameter lsbitfirst: Whether the least significant bit of each channel byte is the oldest
+    void translate(std::size_t frames, const unsigned char *src, bool lsbitfirst, float *const *dst, int firstChannel,
+                   int lastChannel) noexcept {
+        for (std::size_t offset = 0; offset < frames; offset += chunkFrames) {
+            const auto count = std::min(chunkFrames, frames - offset);
+            const auto *chunk = src + (offset * channelCount_);
+            for (int channel = firstChannel; channel < lastChannel; ++channel) {
+                unsigned char *bytes = lane(channel);
+                unsigned char *staged = bytes + historySize_;
+                if (lsbitfirst) {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        staged[i] = dsd2pcm::bitReverseTable256[chunk[(i * channelCount_) + channel]];
+                    }
+                } else {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        staged[i] = chunk[(i * channelCount_) + channel];
+                    }
+                }
+                filter_(staged, count, dst[channel] + offset);
+                // The newest bytes are the history for the next chunk
+                std::copy(staged + count - historySize_, staged + count, bytes);
+            }
+        }
+    }
+
+  private:
+    /// Returns the staging area for `channel`
+    unsigned char *lane(int channel) noexcept { return staging_.data() + (channel * laneSize_); }
+
+    /// The first stage filter
+    void (*filter_)(const unsigned char *src, std::size_t count, float *dst) noexcept;
+    /// The number of history bytes preceding each channel's staged input
+    std::size_t historySize_{0};
+    /// The size of each channel's staging area
+    std::size_t laneSize_{0};
+    /// The number of channels
+    int channelCount_{0};
+    /// The per-channel history and staged input
+    std::vector<unsigned char> staging_;
+};
+
+// MARK: - Half-band decimation
+
+/// A 2:1 decimator using a half-band lowpass filter
+///
+/// The input is split into its even and odd phases. Only the center tap applies to the odd phase, so each output is
+/// half an odd sample plus a short FIR over consecutive even samples, which vectorizes across outputs.
+class HalfBandDecimator final {
+  public:
+    /// Creates a decimator accepting at most `maximumInputLength` samples per call
+    HalfBandDecimator(dsd2pcm::HalfBandFilter filter, std::size_t maximumInputLength)
+      : taps_(2 * filter.count), even_(taps_.size() + (maximumInputLength / 2) + 1),
+        odd_(taps_.size() + (maximumInputLength / 2) + 1) {
+        // The even phase taps in time order, which are the odd taps of the filter
+        for (int i = 0; i < filter.count; ++i) {
+            taps_[filter.count - 1 - i] = filter.coefficients[i];
+            taps_[filter.count + i] = filter.coefficients[i];
+        }
+        reset();
+    }
+
+    /// Clears the filter history
+    void reset() noexcept {
+        std::fill(even_.begin(), even_.end(), 0.f);
+        std::fill(odd_.begin(), odd_.end(), 0.f);
+        evenCount_ = taps_.size() - 1;
+        oddCount_ = taps_.size() - 1;
+    }
+
+    /// Decimates `count` samples from `input` into `output` and returns the number of samples written
+    ///
+    /// An odd sample is retained for the next call. `output` may equal `input`.
+    std::size_t decimate(const float *input, std::size_t count, float *output) noexcept {
+        // Split the input into phases, continuing from a retained even sample
+        std::size_t i = 0;
+        if (evenCount_ > oddCount_ && count > 0) {
+            odd_[oddCount_++] = input[i++];
+        }
+        for (; i + 1 < count; i += 2) {
+            even_[evenCount_++] = input[i];
+            odd_[oddCount_++] = input[i + 1];
+        }
+        if (i < count) {
+            even_[evenCount_++] = input[i];
+        }
+
+#if DEBUG
+        assert(evenCount_ <= even_.size());
+#endif /* DEBUG */
+
+        // Each output needs taps_.size() even samples and the odd sample aligned with the center tap
+        const std::size_t length = taps_.size();
+        const std::size_t produced = evenCount_ - (length - 1);
+        const float *odd = odd_.data() + (length / 2) - 1;
+        std::size_t m = 0;
+        for (; m + block <= produced; m += block) {
+            float acc[block];
+            for (std::size_t j = 0; j < block; ++j) {
+                acc[j] = 0.5f * odd[m + j];
+            }
+            for (std::size_t k = 0; k < length; ++k) {
+                const float tap = taps_[k];
+                const float *even = even_.data() + m + k;
+                for (std::size_t j = 0; j < block; ++j) {
+                    acc[j] += tap * even[j];
+                }
+            }
+            std::copy_n(acc, block, output + m);
+        }
+        for (; m < produced; ++m) {
+            float acc = 0.5f * odd[m];
+            for (std::size_t k = 0; k < length; ++k) {
+                acc += taps_[k] * even_[m + k];
+            }
+            output[m] = acc;
+        }
+
+        // Retain the history for the next call
+        std::copy(even_.data() + produced, even_.data() + evenCount_, even_.data());
+        std::copy(odd_.data() + produced, odd_.data() + oddCount_, odd_.data());
+        evenCount_ -= produced;
+        oddCount_ -= produced;
+
+        return produced;
+    }
+
+  private:
+    /// The number of outputs computed together
+    static constexpr std::size_t block = 8;
+
+    /// The even phase taps
+    std::vector<float> taps_;
+    /// The even phase history followed by pending input
+    std::vector<float> even_;
+    /// The odd phase history followed by pending input
+    std::vector<float> odd_;
+    /// The number of valid samples in `even_`
+    std::size_t evenCount_{0};
+    /// The number of valid samples in `odd_`
+    std::size_t oddCount_{0};
+};
+
+// MARK: - DSD to PCM conversion
+
+/// Converts clustered multichannel DSD to non-interleaved PCM using an 8:1 first stage followed by zero or more 2:1
+/// half-band stages per channel
+///
+/// Since the half-band stages run at successively halved rates the work per DSD byte is nearly constant. All filter
+/// tables are constant, so any number of converters may be created and used concurrently.
+///
+/// Channels are independent, so a converter may divide them into groups converted concurrently. The calling thread
+/// converts the first group and a pipeline of persistent worker threads converts the others; `convert` returns after
+/// every group is finished and does not allocate.
+class DSDPCMConverter final {
+  public:
+    /// Creates a converter for `channelCount` channels with `halfBandStages` half-band stages accepting at most
+    /// `maximumPackets` clustered frames per call
+    /// - parameter channelGroups: The number of channel groups to convert concurrently, at most `channelCount`
+    /// - throws: `std::bad_alloc`, `std::system_error`
+    DSDPCMConverter(int channelCount, int halfBandStages, std::size_t maximumPackets,
+                    const dsd2pcm::FilterProfile &profile = dsd2pcm::standardProfile, int channelGroups = 1)
+      : filter_{channelCount, profile}, scratch_(halfBandStages > 0 ? channelCount * maximumPackets : 0),
+        scratchPlanes_(channelCount) {
+#if DEBUG
+        assert(channelGroups > 0 && channelGroups <= channelCount);
+#endif /* DEBUG */
+
+        stages_.resize(channelCount);
+        for (int channel = 0; channel < channelCount; ++channel) {
+            stages_[channel].reserve(halfBandStages);
+            for (int i = 0; i < halfBandStages; ++i) {
+                stages_[channel].emplace_back(
+                        i + 1 == halfBandStages ? profile.steepHalfBand : profile.relaxedHalfBand,
+                        (maximumPackets >> i) + 1);
+            }
+            scratchPlanes_[channel] = scratch_.data() + (channel * maximumPackets);
+        }
+
+        firstGroupChannels_ = channelCount / channelGroups;
+        groups_.reserve(channelGroups - 1);
+        for (int group = 1; group < channelGroups; ++group) {
+            groups_.push_back({(group * channelCount) / channelGroups, ((group + 1) * channelCount) / channelGroups});
+        }
+        if (!groups_.empty()) {
+            workers_ = std::make_unique<OrderedWorkPipeline<GroupTask>>(
+                    static_cast<int>(groups_.size()), static_cast<int>(groups_.size()), ChannelGroup{}, this);
+        }
+    }
+
+    DSDPCMConverter(const DSDPCMConverter &) = delete;
+    DSDPCMConverter &operator=(const DSDPCMConverter &) = delete;
+
+    /// Returns the number of channel groups converted concurrently
+    int channelGroups() const noexcept { return static_cast<int>(groups_.size()) + 1; }
+
+    /// Resets the converter to silence
+    void reset() noexcept {
+        filter_.reset();
+        for (auto &stages : stages_) {
+            for (auto &stage : stages) {
+                stage.reset();
+            }
+        }
+    }
+
+    /// Converts `packets` clustered frames from `src` to PCM in the buffers in `dst`, one per channel, and returns
+    /// the number of frames written
+    ///
+    /// The half-band stages retain odd samples, so the number of frames written is at most `packets` divided by
+    /// two to the power of the number of half-band stages, rounded up.
+    std::size_t convert(std::size_t packets, const unsigned char *src, bool lsbitfirst, float *const *dst) noexcept {
+        if (!workers_) {
+            return convertChannels({packets, src, lsbitfirst, dst}, 0, static_cast<int>(stages_.size()));
+        }
+
+        // Submitting and retrieving the groups order the job with respect to the workers' accesses
+        job_ = {packets, src, lsbitfirst, dst};
+        for (const auto &group : groups_) {
+            workers_->next() = group;
+            workers_->submit();
+        }
+        const auto frames = convertChannels(job_, 0, firstGroupChannels_);
+        workers_->clear();
+        return frames;
+    }
+
+  private:
+    /// The arguments to `convert`
+    struct Job {
+        std::size_t packets{0};
+        const unsigned char *src{nullptr};
+        bool lsbitfirst{false};
+        float *const *dst{nullptr};
+    };
+
+    /// A group of channels converted concurrently with the others
+    struct ChannelGroup {
+        /// The first channel in the group
+        int firstChannel{0};
+        /// One past the last channel in the group
+        int lastChannel{0};
+    };
+
+    /// Converts channel groups of the current job for an `OrderedWorkPipeline`
+    class GroupTask final {
+      public:
+        using Item = ChannelGroup;
+        static constexpr const char *threadName = "DSDPCMConverter.Worker";
+
+        explicit GroupTask(DSDPCMConverter *converter) noexcept : converter_{converter} {}
+
+        void operator()(ChannelGroup &group) noexcept {
+            converter_->convertChannels(converter_->job_, group.firstChannel, group.lastChannel);
+        }
+
+      private:
+        /// The converter owning the job
+        DSDPCMConverter *converter_{nullptr};
+    };
+
+    /// Converts channels `firstChannel` through `lastChannel - 1` of `job` and returns the number of frames written
+    std::size_t convertChannels(const Job &job, int firstChannel, int lastChannel) noexcept {
+        if (scratch_.empty()) {
+            filter_.translate(job.packets, job.src, job.lsbitfirst, job.dst, firstChannel, lastChannel);
+            return job.packets;
+        }
+
+        filter_.translate(job.packets, job.src, job.lsbitfirst, scratchPlanes_.data(), firstChannel, lastChannel);
+
+        std::size_t frames = 0;
+        for (int channel = firstChannel; channel < lastChannel; ++channel) {
+            auto &stages = stages_[channel];
+            float *scratch = scratchPlanes_[channel];
+            auto count = job.packets;
+            for (auto stage = stages.begin(); stage != stages.end() - 1; ++stage) {
+                count = stage->decimate(scratch, count, scratch);
+            }
+            frames = stages.back().decimate(scratch, count, job.dst[channel]);
+        }
+        return frames;
+    }
+
+    /// The 8:1 first stage
+    DSDPCMFilter filter_;
+    /// The 2:1 half-band stages for each channel
+    std::vector<std::vector<HalfBandDecimator>> stages_;
+    /// Storage for the first stage output
+    std::vector<float> scratch_;
+    /// The first stage output for each channel
+    std::vector<float *> scratchPlanes_;
+
+    /// The current job for the workers
+    Job job_;
+    /// The number of channels converted by the calling thread
+    int firstGroupChannels_{0};
+    /// The channel groups after the first
+    std::vector<ChannelGroup> groups_;
+    /// Workers converting the channel groups after the first, destroyed first
+    std::unique_ptr<OrderedWorkPipeline<GroupTask>> workers_;
+};
+
+} /* namespace sfb */
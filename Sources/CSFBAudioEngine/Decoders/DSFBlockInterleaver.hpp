@@ -0,0 +1,210 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif /* defined(__SSE2__) */
+
+namespace sfb {
+namespace dsf {
+
+// MARK: - DSF Block Interleaving
+
+// A DSF block holds `blockSize` channel bytes for each channel in turn, forming a matrix with one row per channel.
+// Clustered frames hold one channel byte per channel, so interleaving a block is a byte matrix transposition. Columns
+// are interleaved directly from the block into the destination so a partially consumed block never has to be moved.
+
+namespace detail {
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+
+#if defined(__SSE2__)
+using Vector = __m128i;
+
+inline Vector load(const unsigned char *p) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+inline void store(unsigned char *p, Vector v) noexcept { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+inline Vector zero() noexcept { return _mm_setzero_si128(); }
+#else
+using Vector = uint8x16_t;
+
+inline Vector load(const unsigned char *p) noexcept { return vld1q_u8(p); }
+inline void store(unsigned char *p, Vector v) noexcept { vst1q_u8(p, v); }
+inline Vector zero() noexcept { return vdupq_n_u8(0); }
+#endif /* defined(__SSE2__) */
+
+/// The interleaved low and high halves of two vectors
+struct Zipped {
+    Vector low;
+    Vector high;
+};
+
+/// Interleaves the bytes of `a` and `b`
+inline Zipped zip8(Vector a, Vector b) noexcept {
+#if defined(__SSE2__)
+    return {_mm_unpacklo_epi8(a, b), _mm_unpackhi_epi8(a, b)};
+#else
+    const auto z = vzipq_u8(a, b);
+    return {z.val[0], z.val[1]};
+#endif /* defined(__SSE2__) */
+}
+
+/// Interleaves the 16-bit lanes of `a` and `b`
+inline Zipped zip16(Vector a, Vector b) noexcept {
+#if defined(__SSE2__)
+    return {_mm_unpacklo_epi16(a, b), _mm_unpackhi_epi16(a, b)};
+#else
+    const auto z = vzipq_u16(vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b));
+    return {vreinterpretq_u8_u16(z.val[0]), vreinterpretq_u8_u16(z.val[1])};
+#endif /* defined(__SSE2__) */
+}
+
+/// Interleaves the 32-bit lanes of `a` and `b`
+inline Zipped zip32(Vector a, Vector b) noexcept {
+#if defined(__SSE2__)
+    return {_mm_unpacklo_epi32(a, b), _mm_unpackhi_epi32(a, b)};
+#else
+    const auto z = vzipq_u32(vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b));
+    return {vreinterpretq_u8_u32(z.val[0]), vreinterpretq_u8_u32(z.val[1])};
+#endif /* defined(__SSE2__) */
+}
+
+/// Stores the low and high eight bytes of `v` to `low` and `high`
+inline void store64(unsigned char *low, unsigned char *high, Vector v) noexcept {
+#if defined(__SSE2__)
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(low), v);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(high), _mm_unpackhi_epi64(v, v));
+#else
+    vst1_u8(low, vget_low_u8(v));
+    vst1_u8(high, vget_high_u8(v));
+#endif /* defined(__SSE2__) */
+}
+
+/// Interleaves 16 columns of a stereo block
+inline void interleave16(const unsigned char *left, const unsigned char *right, unsigned char *dst) noexcept {
+    const auto z = zip8(load(left), load(right));
+    store(dst, z.low);
+    store(dst + 16, z.high);
+}
+
+/// Interleaves 16 columns of a five or six channel block
+///
+/// Each frame is assembled in an eight byte lane padded with zeros and the lanes are stored in order, each store
+/// overwriting the padding of the previous one. The final store writes `8 - Channels` bytes past the 16 frames.
+template <int Channels>
+void interleave16(const unsigned char *src, std::size_t blockSize, unsigned char *dst) noexcept {
+    static_assert(Channels == 5 || Channels == 6);
+
+    const auto z01 = zip8(load(src), load(src + blockSize));
+    const auto z23 = zip8(load(src + (2 * blockSize)), load(src + (3 * blockSize)));
+    const auto z45 = zip8(load(src + (4 * blockSize)), Channels == 6 ? load(src + (5 * blockSize)) : zero());
+
+    const Vector pairs[3][2] = {{z01.low, z01.high}, {z23.low, z23.high}, {z45.low, z45.high}};
+    for (int half = 0; half < 2; ++half) {
+        const auto quads = zip16(pairs[0][half], pairs[1][half]);
+        const auto tails = zip16(pairs[2][half], zero());
+
+        const auto frames0123 = zip32(quads.low, tails.low);
+        const auto frames4567 = zip32(quads.high, tails.high);
+
+        auto *frame = dst + (half * 8 * Channels);
+        store64(frame, frame + Channels, frames0123.low);
+        store64(frame + (2 * Channels), frame + (3 * Channels), frames0123.high);
+        store64(frame + (4 * Channels), frame + (5 * Channels), frames4567.low);
+        store64(frame + (6 * Channels), frame + (7 * Channels), frames4567.high);
+    }
+}
+
+#endif /* defined(__SSE2__) || defined(__ARM_NEON) */
+
+/// Interleaves `count` columns of a block with `channelCount` rows of `blockSize` bytes starting at `src`
+inline void interleaveScalar(const unsigned char *src, std::size_t blockSize, int channelCount, std::size_t count,
+                             unsigned char *dst) noexcept {
+    for (std::size_t i = 0; i < count; ++i) {
+        for (int channel = 0; channel < channelCount; ++channel) {
+            *dst++ = src[(channel * blockSize) + i];
+        }
+    }
+}
+
+} /* namespace detail */
+
+/// Interleaves `count` columns of a block with `Channels` rows of `blockSize` bytes starting at `src` into `count`
+/// clustered frames at `dst`
+template <int Channels>
+void interleave(const unsigned char *src, std::size_t blockSize, std::size_t count, unsigned char *dst) noexcept {
+    static_assert(Channels > 0);
+
+    if constexpr (Channels == 1) {
+        std::memcpy(dst, src, count);
+        return;
+    }
+
+    std::size_t i = 0;
+#if defined(__SSE2__) || defined(__ARM_NEON)
+    if constexpr (Channels == 2) {
+        for (; i + 16 <= count; i += 16) {
+            detail::interleave16(src + i, src + blockSize + i, dst + (i * 2));
+        }
+    } else if constexpr (Channels == 5 || Channels == 6) {
+        // The stores for 16 frames spill into the following frame, which must exist
+        for (; i + 16 < count; i += 16) {
+            detail::interleave16<Channels>(src + i, blockSize, dst + (i * Channels));
+        }
+    }
+#endif /* defined(__SSE2__) || defined(__ARM_NEON) */
+
+    // The channel count is a constant so the remaining columns are unrolled
+    for (; i < count; ++i) {
+        for (int channel = 0; channel < Channels; ++channel) {
+            dst[(i * Channels) + channel] = src[(channel * blockSize) + i];
+        }
+    }
+}
+
+/// Interleaves `count` columns of a block with `channelCount` rows of `blockSize` bytes starting at `src` into `count`
+/// clustered frames at `dst`
+inline void interleave(const unsigned char *src, std::size_t blockSize, int channelCount, std::size_t count,
+                       unsigned char *dst) noexcept {
+#if DEBUG
+    assert(channelCount > 0);
+#endif /* DEBUG */
+
+    switch (channelCount) {
+    case 1:
+        interleave<1>(src, blockSize, count, dst);
+        break;
+    case 2:
+        interleave<2>(src, blockSize, count, dst);
+        break;
+    case 3:
+        interleave<3>(src, blockSize, count, dst);
+        break;
+    case 4:
+        interleave<4>(src, blockSize, count, dst);
+        break;
+    case 5:
+        interleave<5>(src, blockSize, count, dst);
+        break;
+    case 6:
+        interleave<6>(src, blockSize, count, dst);
+        break;
+    default:
+        detail::interleaveScalar(src, blockSize, channelCount, count, dst);
+        break;
+    }
+}
+
+} /* namespace dsf */
+} /* namespace sfb */
@@ -0,0 +1,523 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#pragma once
+
+#include "OrderedWorkPipeline.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace sfb {
+namespace dst {
+
+// MARK: - Direct Stream Transfer
+
+/// The maximum number of channels in a DST stream
+constexpr int maximumChannels = 6;
+/// The maximum number of filter or probability table elements in a DST frame
+constexpr int maximumElements = 2 * maximumChannels;
+/// The maximum length of a prediction filter
+constexpr int maximumFilterLength = 128;
+/// The maximum length of a probability table
+constexpr int maximumProbabilityLength = 64;
+/// The number of DST frames per second
+constexpr unsigned framesPerSecond = 75;
+
+/// Returns the number of one bit samples per channel in a DST frame of DSD at `sampleRate`
+constexpr std::size_t samplesPerFrame(std::uint32_t sampleRate) noexcept { return sampleRate / framesPerSecond; }
+
+namespace detail {
+
+/// A most-significant-bit-first bit reader returning zeros past the end of its data
+class BitReader final {
+  public:
+    BitReader(const unsigned char *data, std::size_t size) noexcept : data_{data}, size_{size} {}
+
+    /// Returns the number of unread bits
+    std::size_t remaining() const noexcept {
+        return position_ < size_ * 8 ? (size_ * 8) - position_ : 0;
+    }
+
+    /// Reads and returns `count` bits, `count` at most 24
+    std::uint32_t read(int count) noexcept {
+        if (count == 0) {
+            return 0;
+        }
+        const auto byte = position_ >> 3;
+        std::uint32_t window;
+        if (byte + 4 <= size_) {
+            window = (std::uint32_t{data_[byte]} << 24) | (std::uint32_t{data_[byte + 1]} << 16) |
+                     (std::uint32_t{data_[byte + 2]} << 8) | std::uint32_t{data_[byte + 3]};
+        } else {
+            window = 0;
+            for (std::size_t i = 0; i < 4; ++i) {
+                window = (window << 8) | (byte + i < size_ ? data_[byte + i] : 0);
+            }
+        }
+        const auto value = (window << (position_ & 7)) >> (32 - count);
+        position_ += count;
+        return value;
+    }
+
+    /// Reads and returns one bit
+    bool readBit() noexcept { return read(1) != 0; }
+
+    /// Reads and returns `count` bits as a two's complement signed value
+    int readSigned(int count) noexcept {
+        const auto value = read(count);
+        return static_cast<int>(value ^ (1U << (count - 1))) - (1 << (count - 1));
+    }
+
+    /// Reads a Rice code with `k` low bits followed by a sign bit for nonzero values and returns its value
+    /// - returns: The value, or `INT32_MIN` if the data ends before the code
+    int readSignedRice(int k) noexcept {
+        std::uint32_t quotient = 0;
+        while (!readBit()) {
+            if (remaining() == 0) {
+                return INT32_MIN;
+            }
+            ++quotient;
+        }
+        auto value = static_cast<int>((quotient << k) | read(k));
+        if (value != 0 && readBit()) {
+            value = -value;
+        }
+        return value;
+    }
+
+  private:
+    /// The data
+    const unsigned char *data_{nullptr};
+    /// The size of the data in bytes
+    std::size_t size_{0};
+    /// The position of the next bit
+    std::size_t position_{0};
+};
+
+/// The DST arithmetic decoder
+class ArithmeticDecoder final {
+  public:
+    /// Initializes the decoder from the next 12 bits of `reader`
+    explicit ArithmeticDecoder(BitReader &reader) noexcept : reader_{reader}, c_{reader.read(12)} {}
+
+    /// Decodes and returns one bit whose probability of being zero is `p` / 256
+    unsigned decode(unsigned p) noexcept {
+        const unsigned k = (a_ >> 8) | ((a_ >> 7) & 1);
+        const unsigned q = k * p;
+        const unsigned aq = a_ - q;
+
+        unsigned bit;
+        if (c_ < aq) {
+            bit = 1;
+            a_ = aq;
+        } else {
+            bit = 0;
+            a_ = q;
+            c_ -= aq;
+        }
+
+        if (a_ < 2048) {
+            const int n = __builtin_clz(a_) - 20;
+            a_ <<= n;
+            c_ = (c_ << n) | reader_.read(n);
+        }
+
+        return bit;
+    }
+
+  private:
+    /// The source of coded bits
+    BitReader &reader_;
+    /// The interval width
+    unsigned a_{4095};
+    /// The code value relative to the interval
+    unsigned c_{0};
+};
+
+/// Prediction filter coefficient sets or probability tables for a DST frame
+struct Table {
+    /// The number of elements
+    int elements{0};
+    /// The length of each element
+    int length[maximumElements]{};
+    /// The coefficients of each element
+    int coefficients[maximumElements][maximumFilterLength]{};
+};
+
+/// Coefficients for coded prediction filter coefficient sets
+constexpr int filterPredictionCoefficients[3][3] = {{-8, 0, 0}, {-16, 8, 0}, {-9, -5, 6}};
+/// Coefficients for coded probability tables
+constexpr int probabilityPredictionCoefficients[3][3] = {{-8, 0, 0}, {-16, 8, 0}, {-24, 24, -8}};
+
+/// Reads a channel to element mapping into `map` and sets the number of elements in `table`
+inline bool readMap(BitReader &reader, Table &table, int (&map)[maximumChannels], int channelCount) noexcept {
+    table.elements = 1;
+    std::fill(std::begin(map), std::end(map), 0);
+    // All channels use the first element
+    if (reader.readBit()) {
+        return true;
+    }
+
+    for (int channel = 1; channel < channelCount; ++channel) {
+        const int bits = 32 - __builtin_clz(static_cast<unsigned>(table.elements));
+        const auto element = static_cast<int>(reader.read(bits));
+        if (element == table.elements) {
+            if (++table.elements >= maximumElements) {
+                return false;
+            }
+        } else if (element > table.elements) {
+            return false;
+        }
+        map[channel] = element;
+    }
+
+    return true;
+}
+
+/// Reads the elements of `table`, which must already contain the number of elements
+inline bool readTable(BitReader &reader, Table &table, const int (&predictionCoefficients)[3][3], int lengthBits,
+                      int coefficientBits, bool isSigned, int offset) noexcept {
+    const auto readCoefficient = [&]() noexcept {
+        return (isSigned ? reader.readSigned(coefficientBits) : static_cast<int>(reader.read(coefficientBits))) +
+               offset;
+    };
+
+    for (int i = 0; i < table.elements; ++i) {
+        const int length = static_cast<int>(reader.read(lengthBits)) + 1;
+        table.length[i] = length;
+        auto *coefficients = table.coefficients[i];
+
+        if (!reader.readBit()) {
+            for (int j = 0; j < length; ++j) {
+                coefficients[j] = readCoefficient();
+            }
+            continue;
+        }
+
+        // Coefficients after the first `method + 1` are coded as Rice coded residuals from a linear prediction
+        const auto method = static_cast<int>(reader.read(2));
+        if (method == 3) {
+            return false;
+        }
+        for (int j = 0; j <= method && j < length; ++j) {
+            coefficients[j] = readCoefficient();
+        }
+        const auto k = static_cast<int>(reader.read(3));
+        for (int j = method + 1; j < length; ++j) {
+            int x = 0;
+            for (int m = 0; m <= method; ++m) {
+                x += predictionCoefficients[method][m] * coefficients[j - m - 1];
+            }
+            auto c = reader.readSignedRice(k);
+            if (c == INT32_MIN) {
+                return false;
+            }
+            if (x >= 0) {
+                c -= (x + 4) / 8;
+            } else {
+                c += (-x + 3) / 8;
+            }
+            if (!isSigned && (c < offset || c >= offset + (1 << coefficientBits))) {
+                return false;
+            }
+            coefficients[j] = c;
+        }
+    }
+
+    return true;
+}
+
+} /* namespace detail */
+
+} /* namespace dst */
+
+/// A Direct Stream Transfer (ISO/IEC 14496-3 subpart 10) frame decoder
+///
+/// Each frame is independently decodable. Decoded frames are clustered (interleaved) most-significant-bit-first DSD,
+/// the same layout as uncompressed DSDIFF sound data. The decoder retains no state between frames other than
+/// scratch storage, so distinct decoders may decode distinct frames of one stream concurrently.
+class DSTFrameDecoder final {
+  public:
+    /// Frame decoding results
+    enum class Status {
+        /// The frame was decoded
+        success,
+        /// The frame is not valid DST
+        invalid,
+        /// The frame uses segmentation or mapping features that are not supported
+        unsupported,
+    };
+
+    /// Creates a decoder for frames of `channelCount` channels with `samplesPerFrame` one bit samples per channel
+    /// - throws: `std::bad_alloc`
+    DSTFrameDecoder(int channelCount, std::size_t samplesPerFrame)
+      : channelCount_{channelCount}, samplesPerFrame_{samplesPerFrame},
+        filters_{std::make_unique<dst::detail::Table>()}, probabilities_{std::make_unique<dst::detail::Table>()},
+        filterTables_(dst::maximumElements) {
+#if DEBUG
+        assert(channelCount > 0 && channelCount <= dst::maximumChannels);
+        assert(samplesPerFrame % 8 == 0);
+#endif /* DEBUG */
+    }
+
+    /// Returns the size in bytes of a decoded frame
+    std::size_t frameSize() const noexcept { return (samplesPerFrame_ / 8) * channelCount_; }
+
+    /// Decodes the DST frame of `size` bytes at `src` into `frameSize()` bytes at `dst`
+    Status decode(const unsigned char *src, std::size_t size, unsigned char *dst) noexcept {
+        if (size < 1) {
+            return Status::invalid;
+        }
+
+        dst::detail::BitReader reader{src, size};
+
+        // Frames which do not compress are stored as plain DSD following a byte of flags
+        if (!reader.readBit()) {
+            reader.readBit();
+            if (reader.read(6) != 0) {
+                return Status::invalid;
+            }
+            const auto count = std::min(size - 1, frameSize());
+            std::copy_n(src + 1, count, dst);
+            std::fill_n(dst + count, frameSize() - count, 0x69);
+            return Status::success;
+        }
+
+        // Only a single segment per channel with the same segmentation for every channel is supported, which is
+        // the only configuration produced by known encoders
+        if (!reader.readBit() || !reader.readBit() || !reader.readBit()) {
+            return Status::unsupported;
+        }
+
+        // Mapping of channels to filters and probability tables
+        int channelFilters[dst::maximumChannels];
+        int channelProbabilities[dst::maximumChannels];
+        const bool sameMapping = reader.readBit();
+        if (!dst::detail::readMap(reader, *filters_, channelFilters, channelCount_)) {
+            return Status::invalid;
+        }
+        if (sameMapping) {
+            probabilities_->elements = filters_->elements;
+            std::copy(std::begin(channelFilters), std::end(channelFilters), std::begin(channelProbabilities));
+        } else if (!dst::detail::readMap(reader, *probabilities_, channelProbabilities, channelCount_)) {
+            return Status::invalid;
+        }
+
+        bool halfProbability[dst::maximumChannels];
+        for (int channel = 0; channel < channelCount_; ++channel) {
+            halfProbability[channel] = reader.readBit();
+        }
+
+        if (!dst::detail::readTable(reader, *filters_, dst::detail::filterPredictionCoefficients, 7, 9, true, 0) ||
+            !dst::detail::readTable(reader, *probabilities_, dst::detail::probabilityPredictionCoefficients, 6, 7,
+                                    false, 1)) {
+            return Status::invalid;
+        }
+        for (int i = 0; i < probabilities_->elements; ++i) {
+            if (probabilities_->length[i] > dst::maximumProbabilityLength) {
+                return Status::invalid;
+            }
+        }
+
+        if (reader.readBit()) {
+            return Status::invalid;
+        }
+
+        buildFilterTables();
+        decodeSamples(reader, channelFilters, channelProbabilities, halfProbability, dst);
+
+        return Status::success;
+    }
+
+  private:
+    /// Lookup tables for one prediction filter: `values[j][byte]` is the contribution of the eight samples
+    /// `8 * j + 1` through `8 * j + 8` samples in the past, with the most recent in the least significant bit
+    struct FilterTables {
+        std::int16_t values[dst::maximumFilterLength / 8][256];
+        /// The number of tables with nonzero coefficients
+        int count;
+    };
+
+    /// Builds the lookup tables for the prediction filters
+    void buildFilterTables() noexcept {
+        for (int i = 0; i < filters_->elements; ++i) {
+            const int length = filters_->length[i];
+            const auto *coefficients = filters_->coefficients[i];
+            auto &tables = filterTables_[i];
+            tables.count = (length + 7) / 8;
+            for (int j = 0; j < tables.count; ++j) {
+                const int taps = std::min(length - (j * 8), 8);
+                for (int byte = 0; byte < 256; ++byte) {
+                    int value = 0;
+                    for (int bit = 0; bit < taps; ++bit) {
+                        value += (((byte >> bit) & 1) * 2 - 1) * coefficients[(j * 8) + bit];
+                    }
+                    tables.values[j][byte] = static_cast<std::int16_t>(value);
+                }
+            }
+        }
+    }
+
+    /// Decodes the arithmetic coded samples
+    void decodeSamples(dst::detail::BitReader &reader, const int *channelFilters, const int *channelProbabilities,
+                       const bool *halfProbability, unsigned char *dst) noexcept {
+        dst::detail::ArithmeticDecoder decoder{reader};
+
+        // The first bit is reserved and its probability depends on the first filter coefficient
+        decoder.decode(reserveBitProbability(filters_->coefficients[0][0]));
+
+        // Resolve the tables for each channel up front; stores through `dst` may alias any member
+        const FilterTables *tables[dst::maximumChannels];
+        const int *probabilities[dst::maximumChannels];
+        int probabilityLimit[dst::maximumChannels];
+        std::size_t halfProbabilityLength[dst::maximumChannels];
+        for (int channel = 0; channel < channelCount_; ++channel) {
+            tables[channel] = &filterTables_[channelFilters[channel]];
+            probabilities[channel] = probabilities_->coefficients[channelProbabilities[channel]];
+            probabilityLimit[channel] = probabilities_->length[channelProbabilities[channel]] - 1;
+            // Half probability applies until the filter is fully primed with samples from this frame
+            halfProbabilityLength[channel] =
+                    halfProbability[channel] ? static_cast<std::size_t>(filters_->length[channelFilters[channel]]) : 0;
+        }
+
+        // The 128 most recent samples of each channel, most recent in the least significant bit
+        std::uint64_t status[dst::maximumChannels][2];
+        unsigned char bytes[dst::maximumChannels]{};
+        for (int channel = 0; channel < channelCount_; ++channel) {
+            status[channel][0] = status[channel][1] = 0xAAAAAAAAAAAAAAAA;
+        }
+
+        const auto channelCount = channelCount_;
+        for (std::size_t i = 0; i < samplesPerFrame_; ++i) {
+            for (int channel = 0; channel < channelCount; ++channel) {
+                const auto &values = tables[channel]->values;
+                const auto count = tables[channel]->count;
+                const auto *history = status[channel];
+
+                int sum = 0;
+                for (int j = 0; j < count; ++j) {
+                    sum += values[j][(history[j >> 3] >> ((j & 7) * 8)) & 0xFF];
+                }
+                const auto predict = static_cast<std::int16_t>(sum);
+
+                unsigned p = 128;
+                if (i >= halfProbabilityLength[channel]) {
+                    const int index = std::min(std::abs(predict) >> 3, probabilityLimit[channel]);
+                    p = static_cast<unsigned>(probabilities[channel][index]);
+                }
+
+                const auto residual = decoder.decode(p);
+                const unsigned bit = ((predict >> 15) ^ residual) & 1;
+
+                status[channel][1] = (status[channel][1] << 1) | (status[channel][0] >> 63);
+                status[channel][0] = (status[channel][0] << 1) | bit;
+                bytes[channel] = static_cast<unsigned char>((bytes[channel] << 1) | bit);
+            }
+
+            if ((i & 7) == 7) {
+                std::copy_n(bytes, channelCount, dst + ((i >> 3) * channelCount_));
+            }
+        }
+    }
+
+    /// Returns the probability for the reserved first bit
+    static unsigned reserveBitProbability(int coefficient) noexcept {
+        const auto bits = static_cast<unsigned>(coefficient) & 0x7F;
+        unsigned reversed = 0;
+        for (int bit = 0; bit < 8; ++bit) {
+            reversed |= ((bits >> bit) & 1) << (7 - bit);
+        }
+        return (reversed >> 1) + 1;
+    }
+
+    /// The number of channels
+    int channelCount_{0};
+    /// The number of one bit samples per channel in a frame
+    std::size_t samplesPerFrame_{0};
+    /// The prediction filter coefficient sets
+    std::unique_ptr<dst::detail::Table> filters_;
+    /// The probability tables
+    std::unique_ptr<dst::detail::Table> probabilities_;
+    /// Lookup tables for each prediction filter
+    std::vector<FilterTables> filterTables_;
+};
+
+/// A DST frame and the result of decoding it
+struct DSTFrame {
+    /// The DST frame data
+    std::vector<unsigned char> data;
+    /// The decoded frame
+    std::vector<unsigned char> frame;
+    /// The result of decoding
+    DSTFrameDecoder::Status status{DSTFrameDecoder::Status::success};
+};
+
+/// Decodes `DSTFrame` items for an `OrderedWorkPipeline`
+class DSTFrameTask final {
+  public:
+    using Item = DSTFrame;
+    static constexpr const char *threadName = "DSTFramePipeline.Worker";
+
+    /// Creates a task for frames of `channelCount` channels with `samplesPerFrame` one bit samples per channel
+    /// - throws: `std::bad_alloc`
+    DSTFrameTask(int channelCount, std::size_t samplesPerFrame) : decoder_{channelCount, samplesPerFrame} {}
+
+    void operator()(DSTFrame &frame) noexcept {
+        frame.status = decoder_.decode(frame.data.data(), frame.data.size(), frame.frame.data());
+    }
+
+  private:
+    /// The frame decoder
+    DSTFrameDecoder decoder_;
+};
+
+/// Decodes DST frames concurrently on persistent worker threads ahead of the consumer
+///
+/// Frames are submitted in stream order into a fixed number of slots and retrieved in the same order. Each worker
+/// owns a `DSTFrameDecoder`. Once every slot has held a frame of the stream's largest size, operation does not
+/// allocate. With no worker threads frames are decoded synchronously when submitted.
+class DSTFramePipeline final : public OrderedWorkPipeline<DSTFrameTask> {
+  public:
+    /// Creates a pipeline for frames of `channelCount` channels with `samplesPerFrame` one bit samples per channel
+    /// - parameter threadCount: The number of worker threads
+    /// - parameter depth: The maximum number of frames submitted but not yet retrieved
+    /// - throws: `std::bad_alloc`, `std::system_error`
+    DSTFramePipeline(int channelCount, std::size_t samplesPerFrame, int threadCount, int depth)
+      : OrderedWorkPipeline{threadCount, depth, emptyFrame((samplesPerFrame / 8) * channelCount), channelCount,
+                            samplesPerFrame},
+        frameSize_{(samplesPerFrame / 8) * channelCount} {}
+
+    /// Returns the size in bytes of a decoded frame
+    std::size_t frameSize() const noexcept { return frameSize_; }
+
+    /// Returns storage for `size` bytes of DST frame data to be submitted by `submit()`
+    /// - throws: `std::bad_alloc`
+    unsigned char *prepare(std::size_t size) {
+        auto &data = next().data;
+        data.resize(size);
+        return data.data();
+    }
+
+  private:
+    /// Returns a frame with storage for `frameSize` bytes of decoded DSD
+    static DSTFrame emptyFrame(std::size_t frameSize) {
+        DSTFrame frame;
+        frame.frame.resize(frameSize);
+        return frame;
+    }
+
+    /// The size in bytes of a decoded frame
+    std::size_t frameSize_{0};
+};
+
+} /* namespace sfb */
@@ -0,0 +1,368 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif /* defined(__SSSE3__) */
+
+namespace sfb {
+namespace dop {
+
+// MARK: - DSD over PCM
+
+// A DoP frame carries two DSD channel bytes per channel in the low 16 bits of a 24-bit big-endian sample, oldest
+// first, with a marker in the most significant byte alternating between 0x05 and 0xFA on successive frames.
+//
+// Input is clustered DSD: one channel byte per channel for each packet. Output is either one plane of 24-bit samples
+// per channel or packed 24-bit samples interleaved by frame.
+
+/// The marker of the first DoP frame in a stream
+constexpr unsigned char initialMarker = 0x05;
+/// The number of DSD packets in one DoP frame
+constexpr int packetsPerFrame = 2;
+
+/// Returns the marker following `marker`
+constexpr unsigned char nextMarker(unsigned char marker) noexcept { return marker ^ 0xFF; }
+
+namespace detail {
+
+/// Bit reversal lookup table from http://graphics.stanford.edu/~seander/bithacks.html#BitReverseTable
+constexpr unsigned char bitReverseTable256[256] = {
+#define R2(n) n, n + 2 * 64, n + 1 * 64, n + 3 * 64
+#define R4(n) R2(n), R2(n + 2 * 16), R2(n + 1 * 16), R2(n + 3 * 16)
+#define R6(n) R4(n), R4(n + 2 * 4), R4(n + 1 * 4), R4(n + 3 * 4)
+        R6(0), R6(2), R6(1), R6(3)};
+#undef R6
+#undef R4
+#undef R2
+
+/// Returns `byte`, bit reversed if `Reverse` is `true`
+template <bool Reverse>
+constexpr unsigned char dsdByte(unsigned char byte) noexcept {
+    if constexpr (Reverse) {
+        return bitReverseTable256[byte];
+    } else {
+        return byte;
+    }
+}
+
+/// Packs `frames` DoP frames of `channelCount` channels into interleaved packed 24-bit frames at `dst`
+template <bool Reverse>
+unsigned char packInterleaved(const unsigned char *dsd, int channelCount, std::size_t frames, unsigned char marker,
+                              unsigned char *dst) noexcept {
+    for (std::size_t frame = 0; frame < frames; ++frame) {
+        const auto *first = dsd + (frame * 2 * channelCount);
+        for (int channel = 0; channel < channelCount; ++channel) {
+            *dst++ = marker;
+            *dst++ = dsdByte<Reverse>(first[channel]);
+            *dst++ = dsdByte<Reverse>(first[channelCount + channel]);
+        }
+        marker = nextMarker(marker);
+    }
+    return marker;
+}
+
+/// Packs `frames` DoP frames of `channelCount` channels into one plane of 24-bit samples per channel
+template <bool Reverse>
+unsigned char packPlanar(const unsigned char *dsd, int channelCount, std::size_t frames, unsigned char marker,
+                         unsigned char *const *planes) noexcept {
+    // Each plane is written in turn, which is friendlier to the cache than writing every plane for each frame
+    for (int channel = 0; channel < channelCount; ++channel) {
+        const auto *input = dsd + channel;
+        auto *sample = planes[channel];
+        auto channelMarker = marker;
+        for (std::size_t frame = 0; frame < frames; ++frame) {
+            *sample++ = channelMarker;
+            *sample++ = dsdByte<Reverse>(input[0]);
+            *sample++ = dsdByte<Reverse>(input[channelCount]);
+            input += 2 * channelCount;
+            channelMarker = nextMarker(channelMarker);
+        }
+    }
+    return (frames & 1) ? nextMarker(marker) : marker;
+}
+
+#if defined(__SSSE3__) || (defined(__ARM_NEON) && defined(__aarch64__))
+
+#if defined(__SSSE3__)
+using Vector = __m128i;
+
+inline Vector load(const unsigned char *p) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+inline void store(unsigned char *p, Vector v) noexcept { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+inline Vector splat(unsigned char b) noexcept { return _mm_set1_epi8(static_cast<char>(b)); }
+inline Vector bitAnd(Vector a, Vector b) noexcept { return _mm_and_si128(a, b); }
+inline Vector bitOr(Vector a, Vector b) noexcept { return _mm_or_si128(a, b); }
+/// Returns the bytes of `v` selected by `index`, with zero for indexes of 0x80 and above
+inline Vector shuffle(Vector v, Vector index) noexcept { return _mm_shuffle_epi8(v, index); }
+/// Returns bytes 8 through 23 of `low` followed by `high`
+inline Vector middle(Vector low, Vector high) noexcept { return _mm_alignr_epi8(high, low, 8); }
+/// Returns the even and odd bytes of `low` followed by `high`
+inline void unzip(Vector low, Vector high, Vector &even, Vector &odd) noexcept {
+    const auto split = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+    const auto a = _mm_shuffle_epi8(low, split);
+    const auto b = _mm_shuffle_epi8(high, split);
+    even = _mm_unpacklo_epi64(a, b);
+    odd = _mm_unpackhi_epi64(a, b);
+}
+/// Reverses the bits in each byte of `v` by looking up each nibble
+inline Vector reverse(Vector v) noexcept {
+    const auto nibble = _mm_set1_epi8(0x0F);
+    const auto reversedLow = _mm_setr_epi8(0x00, 0x08, 0x04, 0x0C, 0x02, 0x0A, 0x06, 0x0E, 0x01, 0x09, 0x05, 0x0D,
+                                           0x03, 0x0B, 0x07, 0x0F);
+    const auto reversedHigh = _mm_slli_epi16(reversedLow, 4);
+    const auto low = _mm_and_si128(v, nibble);
+    const auto high = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+    return _mm_or_si128(_mm_shuffle_epi8(reversedHigh, low), _mm_shuffle_epi8(reversedLow, high));
+}
+#else
+using Vector = uint8x16_t;
+
+inline Vector load(const unsigned char *p) noexcept { return vld1q_u8(p); }
+inline void store(unsigned char *p, Vector v) noexcept { vst1q_u8(p, v); }
+inline Vector splat(unsigned char b) noexcept { return vdupq_n_u8(b); }
+inline Vector bitAnd(Vector a, Vector b) noexcept { return vandq_u8(a, b); }
+inline Vector bitOr(Vector a, Vector b) noexcept { return vorrq_u8(a, b); }
+/// Returns the bytes of `v` selected by `index`, with zero for indexes of 16 and above
+inline Vector shuffle(Vector v, Vector index) noexcept { return vqtbl1q_u8(v, index); }
+/// Returns bytes 8 through 23 of `low` followed by `high`
+inline Vector middle(Vector low, Vector high) noexcept { return vextq_u8(low, high, 8); }
+/// Returns the even and odd bytes of `low` followed by `high`
+inline void unzip(Vector low, Vector high, Vector &even, Vector &odd) noexcept {
+    const auto z = vuzpq_u8(low, high);
+    even = z.val[0];
+    odd = z.val[1];
+}
+/// Reverses the bits in each byte of `v`
+inline Vector reverse(Vector v) noexcept { return vrbitq_u8(v); }
+#endif /* defined(__SSSE3__) */
+
+/// Byte shuffles producing 16 DoP frames of one channel or eight of two channels from 32 bytes of clustered DSD
+///
+/// The 48 output bytes are produced as three vectors from input bytes 0-15, 8-23, and 16-31. Marker bytes are
+/// selected with index 0xFF, which yields zero, and are filled in using the masks for even and odd frames.
+struct ShuffleTables {
+    unsigned char index[3][16];
+    unsigned char evenMarkers[3][16];
+    unsigned char oddMarkers[3][16];
+};
+
+/// Returns the shuffles for interleaved DoP frames of `channelCount` channels
+consteval ShuffleTables makeShuffleTables(int channelCount) {
+    ShuffleTables tables{};
+    const int frameSize = 3 * channelCount;
+    for (int k = 0; k < 48; ++k) {
+        const int vector = k / 16;
+        const int frame = k / frameSize;
+        const int channel = (k % frameSize) / 3;
+        const int byte = k % 3;
+        auto &index = tables.index[vector][k % 16];
+        if (byte == 0) {
+            index = 0xFF;
+            ((frame & 1) ? tables.oddMarkers : tables.evenMarkers)[vector][k % 16] = 0xFF;
+        } else {
+            const int input = (((2 * frame) + byte - 1) * channelCount) + channel - (vector * 8);
+            if (input < 0 || input > 15) {
+                throw "DoP shuffle input out of range";
+            }
+            index = static_cast<unsigned char>(input);
+        }
+    }
+    return tables;
+}
+
+inline constexpr auto monoShuffleTables = makeShuffleTables(1);
+inline constexpr auto stereoShuffleTables = makeShuffleTables(2);
+
+/// Shuffles and markers for 48 output bytes
+struct Packer {
+    Vector index[3];
+    Vector markers[3];
+
+    Packer(const ShuffleTables &tables, unsigned char marker) noexcept {
+        const auto even = splat(marker);
+        const auto odd = splat(nextMarker(marker));
+        for (int i = 0; i < 3; ++i) {
+            index[i] = load(tables.index[i]);
+            markers[i] = bitOr(bitAnd(load(tables.evenMarkers[i]), even), bitAnd(load(tables.oddMarkers[i]), odd));
+        }
+    }
+
+    /// Packs the 32 input bytes `low` followed by `high` into 48 output bytes at `dst`
+    void pack(Vector low, Vector high, unsigned char *dst) const noexcept {
+        store(dst, bitOr(shuffle(low, index[0]), markers[0]));
+        store(dst + 16, bitOr(shuffle(middle(low, high), index[1]), markers[1]));
+        store(dst + 32, bitOr(shuffle(high, index[2]), markers[2]));
+    }
+};
+
+/// Loads 16 bytes from `p`, bit reversed if `Reverse` is `true`
+template <bool Reverse>
+inline Vector loadDSD(const unsigned char *p) noexcept {
+    if constexpr (Reverse) {
+        return reverse(load(p));
+    } else {
+        return load(p);
+    }
+}
+
+#endif /* defined(__SSSE3__) || (defined(__ARM_NEON) && defined(__aarch64__)) */
+
+} /* namespace detail */
+
+/// Packs `frames` DoP frames from the clustered DSD at `dsd` into interleaved packed 24-bit frames at `dst`
+/// - parameter Channels: The number of channels
+/// - parameter Reverse: Whether the DSD is least significant bit first and must be bit reversed
+/// - returns: The marker for the following frame
+template <int Channels, bool Reverse>
+unsigned char packInterleaved(const unsigned char *dsd, std::size_t frames, unsigned char marker,
+                              unsigned char *dst) noexcept {
+    static_assert(Channels > 0);
+
+    std::size_t frame = 0;
+#if defined(__SSSE3__) || (defined(__ARM_NEON) && defined(__aarch64__))
+    if constexpr (Channels <= 2) {
+        // Each iteration covers an even number of frames so the markers are the same every time
+        constexpr std::size_t framesPerIteration = 16 / Channels;
+        const detail::Packer packer{Channels == 1 ? detail::monoShuffleTables : detail::stereoShuffleTables, marker};
+        for (; frame + framesPerIteration <= frames; frame += framesPerIteration) {
+            const auto *src = dsd + (frame * 2 * Channels);
+            packer.pack(detail::loadDSD<Reverse>(src), detail::loadDSD<Reverse>(src + 16),
+                        dst + (frame * 3 * Channels));
+        }
+    }
+#endif /* defined(__SSSE3__) || (defined(__ARM_NEON) && defined(__aarch64__)) */
+
+    return detail::packInterleaved<Reverse>(dsd + (frame * 2 * Channels), Channels, frames - frame, marker,
+                                            dst + (frame * 3 * Channels));
+}
+
+/// Packs `frames` DoP frames from the clustered DSD at `dsd` into one plane of 24-bit samples per channel
+/// - parameter Channels: The number of channels
+/// - parameter Reverse: Whether the DSD is least significant bit first and must be bit reversed
+/// - returns: The marker for the following frame
+template <int Channels, bool Reverse>
+unsigned char packPlanar(const unsigned char *dsd, std::size_t frames, unsigned char marker,
+                         unsigned char *const *planes) noexcept {
+    static_assert(Channels > 0);
+
+    if constexpr (Channels == 1) {
+        return packInterleaved<1, Reverse>(dsd, frames, marker, planes[0]);
+    }
+
+    std::size_t frame = 0;
+#if defined(__SSSE3__) || (defined(__ARM_NEON) && defined(__aarch64__))
+    if constexpr (Channels == 2) {
+        // Split 16 frames into 32 bytes per channel and pack each as mono
+        const detail::Packer packer{detail::monoShuffleTables, marker};
+        for (; frame + 16 <= frames; frame += 16) {
+            const auto *src = dsd + (frame * 4);
+            detail::Vector left0, right0, left1, right1;
+            detail::unzip(detail::loadDSD<Reverse>(src), detail::loadDSD<Reverse>(src + 16), left0, right0);
+            detail::unzip(detail::loadDSD<Reverse>(src + 32), detail::loadDSD<Reverse>(src + 48), left1, right1);
+            packer.pack(left0, left1, planes[0] + (frame * 3));
+            packer.pack(right0, right1, planes[1] + (frame * 3));
+        }
+    }
+#endif /* defined(__SSSE3__) || (defined(__ARM_NEON) && defined(__aarch64__)) */
+
+    unsigned char *tails[Channels];
+    for (int channel = 0; channel < Channels; ++channel) {
+        tails[channel] = planes[channel] + (frame * 3);
+    }
+    return detail::packPlanar<Reverse>(dsd + (frame * 2 * Channels), Channels, frames - frame, marker, tails);
+}
+
+namespace detail {
+
+/// Calls `pack` with the channel count as a template argument, or returns `false` for unspecialized channel counts
+template <typename Pack>
+bool dispatch(int channelCount, bool reverse, Pack &&pack) noexcept {
+    const auto specialize = [&]<int Channels>() {
+        if (reverse) {
+            pack.template operator()<Channels, true>();
+        } else {
+            pack.template operator()<Channels, false>();
+        }
+    };
+
+    switch (channelCount) {
+    case 1:
+        specialize.template operator()<1>();
+        return true;
+    case 2:
+        specialize.template operator()<2>();
+        return true;
+    case 3:
+        specialize.template operator()<3>();
+        return true;
+    case 4:
+        specialize.template operator()<4>();
+        return true;
+    case 5:
+        specialize.template operator()<5>();
+        return true;
+    case 6:
+        specialize.template operator()<6>();
+        return true;
+    default:
+        return false;
+    }
+}
+
+} /* namespace detail */
+
+/// Packs `frames` DoP frames of `channelCount` channels from the clustered DSD at `dsd` into interleaved packed
+/// 24-bit frames at `dst`
+/// - parameter reverse: Whether the DSD is least significant bit first and must be bit reversed
+/// - returns: The marker for the following frame
+inline unsigned char packInterleaved(const unsigned char *dsd, int channelCount, std::size_t frames, bool reverse,
+                                     unsigned char marker, unsigned char *dst) noexcept {
+#if DEBUG
+    assert(channelCount > 0);
+#endif /* DEBUG */
+
+    unsigned char result = marker;
+    if (detail::dispatch(channelCount, reverse, [&]<int Channels, bool Reverse>() {
+            result = packInterleaved<Channels, Reverse>(dsd, frames, marker, dst);
+        })) {
+        return result;
+    }
+
+    return reverse ? detail::packInterleaved<true>(dsd, channelCount, frames, marker, dst)
+                   : detail::packInterleaved<false>(dsd, channelCount, frames, marker, dst);
+}
+
+/// Packs `frames` DoP frames of `channelCount` channels from the clustered DSD at `dsd` into one plane of 24-bit
+/// samples per channel
+/// - parameter reverse: Whether the DSD is least significant bit first and must be bit reversed
+/// - returns: The marker for the following frame
+inline unsigned char packPlanar(const unsigned char *dsd, int channelCount, std::size_t frames, bool reverse,
+                                unsigned char marker, unsigned char *const *planes) noexcept {
+#if DEBUG
+    assert(channelCount > 0);
+#endif /* DEBUG */
+
+    unsigned char result = marker;
+    if (detail::dispatch(channelCount, reverse, [&]<int Channels, bool Reverse>() {
+            result = packPlanar<Channels, Reverse>(dsd, frames, marker, planes);
+        })) {
+        return result;
+    }
+
+    return reverse ? detail::packPlanar<true>(dsd, channelCount, frames, marker, planes)
+                   : detail::packPlanar<false>(dsd, channelCount, frames, marker, planes);
+}
+
+} /* namespace dop */
+} /* namespace sfb */
@@ -0,0 +1,277 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#pragma once
+
+#include "FLACFrameScanner.hpp"
+#include "OrderedWorkPipeline.hpp"
+
+#include <FLAC/stream_decoder.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+namespace sfb {
+
+// MARK: - FLAC Range Decoding
+
+// FLAC frames are independent, so a range of frames located by `sfb::flac::findRangeEnd()` may be decoded without the
+// frames preceding it. Each range is decoded by a stream decoder of its own reading the range from memory, prefixed
+// with a copy of the stream's STREAMINFO.
+//
+// A range is accepted only if it decodes without error to exactly the samples expected. Anything else, whether a
+// corrupt frame or a range boundary at a false frame sync, is reported so the caller may decode the range with its
+// own stream decoder instead.
+
+/// A decoder of ranges of FLAC frames
+class FLACRangeDecoder final {
+  public:
+    /// Range decoding results
+    enum class Status {
+        /// The range was decoded
+        success,
+        /// The range contains invalid frames or frames not matching STREAMINFO
+        invalid,
+        /// The decoded samples do not match the expected range
+        discontinuity,
+    };
+
+    /// Creates a decoder for ranges of frames of the stream with `stream`
+    /// - throws: `std::bad_alloc`, `std::runtime_error`
+    explicit FLACRangeDecoder(const flac::StreamParameters &stream)
+      : stream_{stream}, header_{flac::makeStreamHeader(stream)}, decoder_{FLAC__stream_decoder_new()} {
+        if (!decoder_) {
+            throw std::bad_alloc();
+        }
+        if (FLAC__stream_decoder_init_stream(decoder_.get(), readCallback, nullptr, nullptr, nullptr, nullptr,
+                                             writeCallback, nullptr, errorCallback,
+                                             this) != FLAC__STREAM_DECODER_INIT_STATUS_OK) {
+            throw std::runtime_error("FLAC__stream_decoder_init_stream failed");
+        }
+    }
+
+    FLACRangeDecoder(const FLACRangeDecoder &) = delete;
+    FLACRangeDecoder &operator=(const FLACRangeDecoder &) = delete;
+
+    /// Decodes the frames in `size` bytes at `src` holding samples [`startSample`, `endSample`)
+    ///
+    /// Samples are stored high-aligned, one channel per vector, and the vectors are grown as needed
+    Status decode(const unsigned char *src, std::size_t size, std::uint64_t startSample, std::uint64_t endSample,
+                  std::vector<std::vector<uint32_t>> &samples) noexcept {
+        if (endSample <= startSample) {
+            return Status::discontinuity;
+        }
+
+        try {
+            samples.resize(stream_.channels);
+            for (auto &channel : samples) {
+                if (channel.size() < endSample - startSample) {
+                    channel.resize(endSample - startSample);
+                }
+            }
+        } catch (const std::bad_alloc &) {
+            return Status::invalid;
+        }
+
+        src_ = src;
+        size_ = size;
+        position_ = 0;
+        startSample_ = startSample;
+        nextSample_ = startSample;
+        endSample_ = endSample;
+        samples_ = &samples;
+        status_ = Status::success;
+
+        if (!FLAC__stream_decoder_reset(decoder_.get()) ||
+            !FLAC__stream_decoder_process_until_end_of_stream(decoder_.get())) {
+            return status_ == Status::success ? Status::invalid : status_;
+        }
+
+        if (status_ == Status::success && nextSample_ != endSample_) {
+            status_ = Status::discontinuity;
+        }
+        return status_;
+    }
+
+  private:
+    /// A `std::unique_ptr` deleter for `FLAC__StreamDecoder` objects
+    struct DecoderDeleter {
+        void operator()(FLAC__StreamDecoder *decoder) noexcept { FLAC__stream_decoder_delete(decoder); }
+    };
+
+    static FLAC__StreamDecoderReadStatus readCallback(const FLAC__StreamDecoder * /*decoder*/, FLAC__byte buffer[],
+                                                      size_t *bytes, void *client_data) noexcept {
+        auto *self = static_cast<FLACRangeDecoder *>(client_data);
+        const auto total = self->header_.size() + self->size_;
+        const auto count = std::min(*bytes, total - self->position_);
+        if (count == 0) {
+            *bytes = 0;
+            return FLAC__STREAM_DECODER_READ_STATUS_END_OF_STREAM;
+        }
+
+        // The STREAMINFO prefix followed by the range
+        std::size_t copied = 0;
+        if (self->position_ < self->header_.size()) {
+            copied = std::min(count, self->header_.size() - self->position_);
+            std::memcpy(buffer, self->header_.data() + self->position_, copied);
+        }
+        if (copied < count) {
+            const auto *src = self->src_ + (self->position_ + copied - self->header_.size());
+            std::memcpy(buffer + copied, src, count - copied);
+        }
+        self->position_ += count;
+        *bytes = count;
+        return FLAC__STREAM_DECODER_READ_STATUS_CONTINUE;
+    }
+
+    static FLAC__StreamDecoderWriteStatus writeCallback(const FLAC__StreamDecoder * /*decoder*/,
+                                                        const FLAC__Frame *frame, const FLAC__int32 *const buffer[],
+                                                        void *client_data) noexcept {
+        auto *self = static_cast<FLACRangeDecoder *>(client_data);
+        const auto &header = frame->header;
+
+        // Changes in channel count or sample rate are left to the caller to report
+        if (header.channels != self->stream_.channels || header.sample_rate != self->stream_.sampleRate) {
+            self->status_ = Status::invalid;
+            return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+        }
+
+        if (header.number.sample_number != self->nextSample_ ||
+            header.blocksize > self->endSample_ - self->nextSample_) {
+            self->status_ = Status::discontinuity;
+            return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+        }
+
+        // FLAC hands us 32-bit signed integers with the samples low-aligned
+        const auto offset = static_cast<std::size_t>(self->nextSample_ - self->startSample_);
+        const auto shift = header.bits_per_sample != 32 ? 32 - header.bits_per_sample : 0;
+        for (uint32_t channel = 0; channel < header.channels; ++channel) {
+            uint32_t *__restrict dst = (*self->samples_)[channel].data() + offset;
+            const FLAC__int32 *__restrict src = buffer[channel];
+            for (uint32_t sample = 0; sample < header.blocksize; ++sample) {
+                dst[sample] = static_cast<uint32_t>(src[sample]) << shift;
+            }
+        }
+
+        self->nextSample_ += header.blocksize;
+        return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
+    }
+
+    static void errorCallback(const FLAC__StreamDecoder * /*decoder*/, FLAC__StreamDecoderErrorStatus /*status*/,
+                              void *client_data) noexcept {
+        // Lost sync and CRC errors are left to the caller's stream decoder to handle and report
+        auto *self = static_cast<FLACRangeDecoder *>(client_data);
+        if (self->status_ == Status::success) {
+            self->status_ = Status::invalid;
+        }
+    }
+
+    /// Stream parameters
+    flac::StreamParameters stream_;
+    /// The stream marker and STREAMINFO preceding each range
+    std::array<unsigned char, flac::streamHeaderSize> header_;
+    /// The stream decoder
+    std::unique_ptr<FLAC__StreamDecoder, DecoderDeleter> decoder_;
+
+    /// The range being decoded
+    const unsigned char *src_{nullptr};
+    /// The size of the range in bytes
+    std::size_t size_{0};
+    /// The number of bytes read including the STREAMINFO prefix
+    std::size_t position_{0};
+    /// The first sample of the range
+    std::uint64_t startSample_{0};
+    /// The next expected sample
+    std::uint64_t nextSample_{0};
+    /// The sample following the range
+    std::uint64_t endSample_{0};
+    /// The decoded samples
+    std::vector<std::vector<uint32_t>> *samples_{nullptr};
+    /// The result of decoding
+    Status status_{Status::success};
+};
+
+/// A range of FLAC frames and the result of decoding it
+struct FLACRange {
+    /// The FLAC frames
+    std::vector<unsigned char> data;
+    /// The number of valid bytes in `data`
+    std::size_t size{0};
+    /// The first sample of the range
+    std::uint64_t startSample{0};
+    /// The sample following the range
+    std::uint64_t endSample{0};
+    /// The decoded samples
+    std::vector<std::vector<uint32_t>> samples;
+    /// The result of decoding
+    FLACRangeDecoder::Status status{FLACRangeDecoder::Status::success};
+
+    /// Returns the number of samples per channel in the range
+    std::size_t frameLength() const noexcept { return static_cast<std::size_t>(endSample - startSample); }
+};
+
+/// Decodes `FLACRange` items for an `OrderedWorkPipeline`
+class FLACRangeTask final {
+  public:
+    using Item = FLACRange;
+    static constexpr const char *threadName = "FLACFramePipeline.Worker";
+
+    /// Creates a task for ranges of frames of the stream with `stream`
+    /// - throws: `std::bad_alloc`, `std::runtime_error`
+    explicit FLACRangeTask(const flac::StreamParameters &stream) : decoder_{stream} {}
+
+    void operator()(FLACRange &range) noexcept {
+        range.status =
+                decoder_.decode(range.data.data(), range.size, range.startSample, range.endSample, range.samples);
+    }
+
+  private:
+    /// The range decoder
+    FLACRangeDecoder decoder_;
+};
+
+/// Decodes ranges of FLAC frames in order, concurrently on persistent worker threads ahead of the consumer
+///
+/// With no worker threads, ranges are decoded synchronously by `submit()`.
+/// - important: All member functions must be called from a single thread
+class FLACFramePipeline final : public OrderedWorkPipeline<FLACRangeTask> {
+  public:
+    /// Creates a pipeline for ranges of frames of the stream with `stream`
+    /// - parameter threadCount: The number of worker threads
+    /// - parameter depth: The maximum number of ranges submitted but not yet retrieved
+    /// - throws: `std::bad_alloc`, `std::runtime_error`, `std::system_error`
+    FLACFramePipeline(const flac::StreamParameters &stream, int threadCount, int depth)
+      : OrderedWorkPipeline{threadCount, depth, FLACRange{}, stream} {}
+
+    /// Returns storage for `size` bytes of FLAC frames to be submitted by `submit()`
+    ///
+    /// The storage may be enlarged by calling again, preserving its contents
+    /// - throws: `std::bad_alloc`
+    unsigned char *prepare(std::size_t size) {
+        auto &data = next().data;
+        data.resize(size);
+        return data.data();
+    }
+
+    /// Submits the first `size` bytes prepared by `prepare()`, holding samples [`startSample`, `endSample`)
+    void submit(std::size_t size, std::uint64_t startSample, std::uint64_t endSample) noexcept {
+        auto &range = next();
+        range.size = std::min(size, range.data.size());
+        range.startSample = startSample;
+        range.endSample = endSample;
+        OrderedWorkPipeline::submit();
+    }
+};
+
+} /* namespace sfb */
@@ -0,0 +1,339 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+namespace sfb {
+namespace flac {
+
+// MARK: - FLAC Frame Scanning
+
+// A FLAC frame begins with a 14-bit sync code, the blocking strategy, the coded block size, sample rate, channel
+// assignment and sample size, the UTF-8 coded frame or sample number, optional block size and sample rate fields and
+// a CRC-8 of the header. See https://www.rfc-editor.org/rfc/rfc9639.html#name-frame-header
+//
+// The sync code may also occur in compressed audio, so a candidate is accepted only if every field is valid, the CRC-8
+// matches and the header agrees with STREAMINFO. A false match remains possible, so ranges of frames located by
+// scanning must be checked for continuity once decoded.
+
+/// Stream parameters from STREAMINFO
+struct StreamParameters {
+    std::uint32_t minBlocksize{0};
+    std::uint32_t maxBlocksize{0};
+    std::uint32_t minFramesize{0};
+    std::uint32_t maxFramesize{0};
+    std::uint32_t sampleRate{0};
+    std::uint32_t channels{0};
+    std::uint32_t bitsPerSample{0};
+    std::uint64_t totalSamples{0};
+};
+
+/// A parsed frame header
+struct FrameHeader {
+    /// Whether the frame is part of a variable block size stream, in which case `number` is a sample number
+    bool variableBlocksize{false};
+    /// The frame number, or the sample number of the first sample for variable block size streams
+    std::uint64_t number{0};
+    /// The number of samples per channel in the frame
+    std::uint32_t blocksize{0};
+    /// The sample rate, or `0` if given by STREAMINFO
+    std::uint32_t sampleRate{0};
+    /// The number of channels
+    std::uint32_t channels{0};
+    /// The number of bits per sample, or `0` if given by STREAMINFO
+    std::uint32_t bitsPerSample{0};
+    /// The size of the header in bytes, including the CRC-8
+    std::size_t size{0};
+};
+
+/// The size of the `fLaC` stream marker followed by a STREAMINFO metadata block
+constexpr std::size_t streamHeaderSize = 4 + 4 + 34;
+/// The maximum size of a frame header
+constexpr std::size_t maximumFrameHeaderSize = 16;
+
+namespace detail {
+
+/// Returns the CRC-8 lookup table for the polynomial x^8 + x^2 + x^1 + x^0
+constexpr std::array<std::uint8_t, 256> makeCRC8Table() noexcept {
+    std::array<std::uint8_t, 256> table{};
+    for (unsigned i = 0; i < 256; ++i) {
+        unsigned crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80) ? ((crc << 1) ^ 0x07) : (crc << 1);
+        }
+        table[i] = static_cast<std::uint8_t>(crc);
+    }
+    return table;
+}
+
+/// CRC-8 lookup table
+inline constexpr auto crc8Table = makeCRC8Table();
+
+} /* namespace detail */
+
+/// Returns the CRC-8 of `size` bytes at `data`
+constexpr std::uint8_t crc8(const unsigned char *data, std::size_t size) noexcept {
+    std::uint8_t crc = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        crc = detail::crc8Table[crc ^ data[i]];
+    }
+    return crc;
+}
+
+/// Parses the frame header at `data`, which has `size` bytes available
+/// - returns: The frame header or `std::nullopt` if `data` does not hold a valid frame header
+inline std::optional<FrameHeader> parseFrameHeader(const unsigned char *data, std::size_t size) noexcept {
+    if (size < 6 || data[0] != 0xFF || (data[1] & 0xFE) != 0xF8) {
+        return std::nullopt;
+    }
+
+    FrameHeader header;
+    header.variableBlocksize = data[1] & 0x01;
+
+    const auto blocksizeCode = data[2] >> 4;
+    const auto sampleRateCode = data[2] & 0x0F;
+    const auto channelAssignment = data[3] >> 4;
+    const auto sampleSizeCode = (data[3] >> 1) & 0x07;
+
+    // Reserved values
+    if (blocksizeCode == 0 || sampleRateCode == 15 || channelAssignment > 10 || sampleSizeCode == 3 ||
+        (data[3] & 0x01)) {
+        return std::nullopt;
+    }
+
+    header.channels = channelAssignment < 8 ? static_cast<std::uint32_t>(channelAssignment) + 1 : 2;
+    constexpr std::uint32_t sampleSizes[] = {0, 8, 12, 0, 16, 20, 24, 32};
+    header.bitsPerSample = sampleSizes[sampleSizeCode];
+
+    // UTF-8 coded frame or sample number
+    std::size_t position = 4;
+    const auto lead = data[position++];
+    int continuationBytes;
+    if (!(lead & 0x80)) {
+        header.number = lead;
+        continuationBytes = 0;
+    } else if ((lead & 0xE0) == 0xC0) {
+        header.number = lead & 0x1F;
+        continuationBytes = 1;
+    } else if ((lead & 0xF0) == 0xE0) {
+        header.number = lead & 0x0F;
+        continuationBytes = 2;
+    } else if ((lead & 0xF8) == 0xF0) {
+        header.number = lead & 0x07;
+        continuationBytes = 3;
+    } else if ((lead & 0xFC) == 0xF8) {
+        header.number = lead & 0x03;
+        continuationBytes = 4;
+    } else if ((lead & 0xFE) == 0xFC) {
+        header.number = lead & 0x01;
+        continuationBytes = 5;
+    } else if (lead == 0xFE && header.variableBlocksize) {
+        header.number = 0;
+        continuationBytes = 6;
+    } else {
+        return std::nullopt;
+    }
+    if (size < position + static_cast<std::size_t>(continuationBytes)) {
+        return std::nullopt;
+    }
+    for (int i = 0; i < continuationBytes; ++i) {
+        const auto byte = data[position++];
+        if ((byte & 0xC0) != 0x80) {
+            return std::nullopt;
+        }
+        header.number = (header.number << 6) | (byte & 0x3F);
+    }
+
+    // Block size
+    if (blocksizeCode == 1) {
+        header.blocksize = 192;
+    } else if (blocksizeCode <= 5) {
+        header.blocksize = 576u << (blocksizeCode - 2);
+    } else if (blocksizeCode == 6) {
+        if (size < position + 1) {
+            return std::nullopt;
+        }
+        header.blocksize = static_cast<std::uint32_t>(data[position]) + 1;
+        position += 1;
+    } else if (blocksizeCode == 7) {
+        if (size < position + 2) {
+            return std::nullopt;
+        }
+        header.blocksize = ((static_cast<std::uint32_t>(data[position]) << 8) | data[position + 1]) + 1;
+        position += 2;
+    } else {
+        header.blocksize = 256u << (blocksizeCode - 8);
+    }
+
+    // Sample rate
+    constexpr std::uint32_t sampleRates[] = {0,     88200, 176400, 192000, 8000, 16000, 22050, 24000,
+                                             32000, 44100, 48000,  96000,  0,    0,     0,     0};
+    if (sampleRateCode == 12) {
+        if (size < position + 1) {
+            return std::nullopt;
+        }
+        header.sampleRate = static_cast<std::uint32_t>(data[position]) * 1000;
+        position += 1;
+    } else if (sampleRateCode == 13 || sampleRateCode == 14) {
+        if (size < position + 2) {
+            return std::nullopt;
+        }
+        header.sampleRate = (static_cast<std::uint32_t>(data[position]) << 8) | data[position + 1];
+        if (sampleRateCode == 14) {
+            header.sampleRate *= 10;
+        }
+        position += 2;
+    } else {
+        header.sampleRate = sampleRates[sampleRateCode];
+    }
+
+    if (size < position + 1 || crc8(data, position) != data[position]) {
+        return std::nullopt;
+    }
+    header.size = position + 1;
+
+    return header;
+}
+
+/// Returns the number of the first sample in the frame with `header`
+///
+/// As in libFLAC, frame numbers in streams with a fixed block size in STREAMINFO count blocks of that size
+constexpr std::uint64_t firstSample(const FrameHeader &header, const StreamParameters &stream) noexcept {
+    if (header.variableBlocksize) {
+        return header.number;
+    }
+    const auto blocksize = stream.minBlocksize == stream.maxBlocksize && stream.maxBlocksize != 0
+                                   ? stream.maxBlocksize
+                                   : header.blocksize;
+    return header.number * blocksize;
+}
+
+/// Returns `true` if `header` agrees with `stream`
+constexpr bool isConsistent(const FrameHeader &header, const StreamParameters &stream) noexcept {
+    if (header.channels != stream.channels) {
+        return false;
+    }
+    if (header.bitsPerSample != 0 && header.bitsPerSample != stream.bitsPerSample) {
+        return false;
+    }
+    if (header.sampleRate != 0 && header.sampleRate != stream.sampleRate) {
+        return false;
+    }
+    if (stream.maxBlocksize != 0 && header.blocksize > stream.maxBlocksize) {
+        return false;
+    }
+    if (stream.totalSamples != 0 && firstSample(header, stream) >= stream.totalSamples) {
+        return false;
+    }
+    return true;
+}
+
+/// Returns the offset of the first frame header in `size` bytes at `data` that agrees with `stream`
+/// - parameter header: Receives the frame header if one is found
+/// - returns: The offset of the frame header or `size` if none was found
+inline std::size_t findFrame(const unsigned char *data, std::size_t size, const StreamParameters &stream,
+                             FrameHeader &header) noexcept {
+    for (std::size_t offset = 0; offset + 1 < size;) {
+        const auto *sync = static_cast<const unsigned char *>(std::memchr(data + offset, 0xFF, size - offset - 1));
+        if (!sync) {
+            break;
+        }
+        offset = static_cast<std::size_t>(sync - data);
+        if (const auto candidate = parseFrameHeader(sync, size - offset);
+            candidate && isConsistent(*candidate, stream)) {
+            header = *candidate;
+            return offset;
+        }
+        ++offset;
+    }
+    return size;
+}
+
+/// Returns the offset of the frame header ending a range of frames at `data` beginning with sample `startSample`
+///
+/// The range ends at the first frame at or after `targetSize` bytes unless that range would hold more than
+/// `maximumSamples` samples per channel, in which case it ends at the last frame within that limit. Frame numbers
+/// increase with offset, so that frame is found by bisection.
+/// - parameter header: Receives the header of the frame ending the range
+/// - returns: The offset of the frame header or `size` if none was found
+inline std::size_t findRangeEnd(const unsigned char *data, std::size_t size, const StreamParameters &stream,
+                                std::uint64_t startSample, std::size_t targetSize, std::uint64_t maximumSamples,
+                                FrameHeader &header) noexcept {
+    // Returns the offset of the first frame following `startSample` in [begin, end)
+    const auto find = [&](std::size_t begin, std::size_t end, FrameHeader &found) -> std::size_t {
+        while (begin < end) {
+            const auto offset = begin + findFrame(data + begin, end - begin, stream, found);
+            if (offset == end || firstSample(found, stream) > startSample) {
+                return offset;
+            }
+            begin = offset + 1;
+        }
+        return end;
+    };
+
+    // The range holds at least one frame
+    const auto target = std::clamp<std::size_t>(targetSize, 1, size);
+    FrameHeader candidate;
+    auto end = find(target, size, candidate);
+    if (end != size && firstSample(candidate, stream) - startSample <= maximumSamples) {
+        header = candidate;
+        return end;
+    }
+
+    // Bisect for the last frame within the limit
+    auto best = size;
+    for (std::size_t low = 1, high = end; low < high;) {
+        const auto middle = low + ((high - low) / 2);
+        const auto offset = find(middle, high, candidate);
+        if (offset == high) {
+            high = middle;
+        } else if (firstSample(candidate, stream) - startSample <= maximumSamples) {
+            header = candidate;
+            best = offset;
+            low = offset + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return best;
+}
+
+/// Returns an `fLaC` stream marker followed by a STREAMINFO metadata block with `stream` and no MD5 signature
+///
+/// A stream decoder reads a range of frames prefixed with this as a stream of its own
+inline std::array<unsigned char, streamHeaderSize> makeStreamHeader(const StreamParameters &stream) noexcept {
+    std::array<unsigned char, streamHeaderSize> header{'f', 'L', 'a', 'C',
+                                                       // Last metadata block, STREAMINFO, 34 bytes
+                                                       0x80, 0, 0, 34};
+    auto *p = header.data() + 8;
+    const auto put = [&p](std::uint64_t value, int bytes) {
+        for (int i = bytes - 1; i >= 0; --i) {
+            *p++ = static_cast<unsigned char>(value >> (8 * i));
+        }
+    };
+    put(stream.minBlocksize, 2);
+    put(stream.maxBlocksize, 2);
+    put(stream.minFramesize, 3);
+    put(stream.maxFramesize, 3);
+    // 20-bit sample rate, 3-bit channels - 1, 5-bit bits per sample - 1 and 36-bit total samples
+    put((static_cast<std::uint64_t>(stream.sampleRate) << 44) |
+                (static_cast<std::uint64_t>(stream.channels - 1) << 41) |
+                (static_cast<std::uint64_t>(stream.bitsPerSample - 1) << 36) | (stream.totalSamples & 0xFFFFFFFFFull),
+        8);
+    // The MD5 signature remains zero, meaning unknown
+    return header;
+}
+
+} /* namespace flac */
+} /* namespace sfb */
@@ -0,0 +1,113 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+
+namespace sfb {
+
+// MARK: - Frame Staging
+
+// Decoders producing audio in fixed blocks decode each block directly into the caller's buffer when it fits in the
+// frames remaining to be read. A block that does not fit is staged where it was decoded, either in storage owned by
+// the decoder or in storage owned by the codec library, and delivered across later reads by advancing a read cursor.
+// Staged frames are never moved, so each frame is copied at most once between the codec library and the caller.
+//
+// A block is described by one pointer per buffer, in the layout of an `AudioBufferList`: one buffer of interleaved
+// frames or one buffer per channel, with the same number of bytes per frame in each.
+
+/// A read cursor over a block of decoded audio frames awaiting delivery
+class FrameStage final {
+  public:
+    /// The maximum number of buffers in a block
+    static constexpr std::size_t maximumBufferCount = 8;
+
+    /// Returns the number of frames remaining to be read
+    [[nodiscard]] std::size_t frameLength() const noexcept { return frameLength_ - position_; }
+
+    /// Returns true if no frames remain to be read
+    [[nodiscard]] bool empty() const noexcept { return position_ == frameLength_; }
+
+    /// Returns true if a block of `blockFrameLength` frames may be decoded directly into a buffer with room for
+    /// `frameLength` more frames
+    ///
+    /// Direct delivery requires that no staged frames remain, since they precede the block.
+    [[nodiscard]] bool canDeliverDirectly(std::size_t blockFrameLength, std::size_t frameLength) const noexcept {
+        return empty() && blockFrameLength <= frameLength;
+    }
+
+    /// Stages a block, discarding any frames remaining from the previous block
+    /// - important: The buffers must remain unchanged until the block is read, skipped, or cleared
+    /// - parameter buffers: Pointers to `bufferCount` buffers each holding `frameLength` frames
+    /// - parameter bufferCount: The number of buffers, at most `maximumBufferCount`
+    /// - parameter bytesPerFrame: The number of bytes per frame in each buffer
+    /// - parameter frameLength: The number of frames in the block
+    void stage(const void *const *buffers, std::size_t bufferCount, std::size_t bytesPerFrame,
+               std::size_t frameLength) noexcept {
+        assert(bufferCount <= maximumBufferCount);
+        bufferCount = std::min(bufferCount, maximumBufferCount);
+        for (std::size_t i = 0; i < bufferCount; ++i) {
+            buffers_[i] = static_cast<const unsigned char *>(buffers[i]);
+        }
+        bufferCount_ = bufferCount;
+        bytesPerFrame_ = bytesPerFrame;
+        frameLength_ = frameLength;
+        position_ = 0;
+    }
+
+    /// Copies staged frames and advances the read cursor past them
+    /// - parameter buffers: Pointers to the same number of buffers as the staged block, with the same bytes per frame
+    /// - parameter offset: The frame in `buffers` at which to write
+    /// - parameter frameLength: The maximum number of frames to copy
+    /// - returns: The number of frames copied
+    std::size_t read(void *const *buffers, std::size_t offset, std::size_t frameLength) noexcept {
+        frameLength = std::min(frameLength, this->frameLength());
+        if (frameLength > 0) {
+            const auto bytes = frameLength * bytesPerFrame_;
+            for (std::size_t i = 0; i < bufferCount_; ++i) {
+                std::memcpy(static_cast<unsigned char *>(buffers[i]) + (offset * bytesPerFrame_),
+                            buffers_[i] + (position_ * bytesPerFrame_), bytes);
+            }
+            position_ += frameLength;
+        }
+        return frameLength;
+    }
+
+    /// Advances the read cursor past staged frames without copying them
+    /// - parameter frameLength: The maximum number of frames to skip
+    /// - returns: The number of frames skipped
+    std::size_t skip(std::size_t frameLength) noexcept {
+        frameLength = std::min(frameLength, this->frameLength());
+        position_ += frameLength;
+        return frameLength;
+    }
+
+    /// Discards any staged frames
+    void clear() noexcept {
+        frameLength_ = 0;
+        position_ = 0;
+    }
+
+  private:
+    /// The staged buffers
+    std::array<const unsigned char *, maximumBufferCount> buffers_{};
+    /// The number of staged buffers
+    std::size_t bufferCount_{0};
+    /// The number of bytes per frame in each staged buffer
+    std::size_t bytesPerFrame_{0};
+    /// The number of frames in the staged block
+    std::size_t frameLength_{0};
+    /// The read cursor
+    std::size_t position_{0};
+};
+
+} /* namespace sfb */
@@ -0,0 +1,274 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+namespace sfb {
+namespace mpeg {
+
+// MARK: - MPEG Audio Frame Headers
+
+// An MPEG audio frame begins with an 11-bit sync word followed by the version, layer, protection bit, bitrate index,
+// sample rate index, padding bit and channel mode. The frame size follows from the bitrate, sample rate and padding,
+// except for free format streams which are not handled here.
+//
+// The sync word may also occur in audio data or tags, so a candidate is accepted only if every field is valid and, when
+// it fits in the data, the header following the frame agrees with it.
+
+/// An MPEG audio version
+enum class Version { mpeg1, mpeg2, mpeg25 };
+
+/// A parsed frame header
+struct FrameHeader {
+    Version version{Version::mpeg1};
+    /// The layer, `1`, `2` or `3`
+    unsigned layer{0};
+    /// Whether a CRC-16 follows the header
+    bool protection{false};
+    /// The bitrate in bits per second
+    std::uint32_t bitrate{0};
+    std::uint32_t sampleRate{0};
+    bool padding{false};
+    std::uint32_t channels{0};
+    /// The number of audio frames decoded from the MPEG frame
+    std::uint32_t samplesPerFrame{0};
+    /// The size of the frame in bytes, including the header
+    std::uint32_t size{0};
+};
+
+/// The size of a frame header
+constexpr std::size_t frameHeaderSize = 4;
+
+namespace detail {
+
+/// Bitrates in kbps indexed by version and layer, then by bitrate index
+constexpr std::uint16_t bitrates[5][15] = {
+        {0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448}, // MPEG-1 layer I
+        {0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384},    // MPEG-1 layer II
+        {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320},     // MPEG-1 layer III
+        {0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256},    // MPEG-2 and 2.5 layer I
+        {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160},         // MPEG-2 and 2.5 layers II and III
+};
+
+/// MPEG-1 sample rates indexed by sample rate index
+constexpr std::uint32_t sampleRates[3] = {44100, 48000, 32000};
+
+/// Returns the big-endian 32-bit value at `p`
+inline std::uint32_t readUInt32(const unsigned char *p) noexcept {
+    return (std::uint32_t{p[0]} << 24) | (std::uint32_t{p[1]} << 16) | (std::uint32_t{p[2]} << 8) | p[3];
+}
+
+} /* namespace detail */
+
+/// Parses the frame header at `data`
+/// - returns: The frame header or `std::nullopt` if `data` does not hold a valid, non-free format frame header
+inline std::optional<FrameHeader> parseFrameHeader(const unsigned char *data, std::size_t size) noexcept {
+    if (size < frameHeaderSize || data[0] != 0xFF || (data[1] & 0xE0) != 0xE0) {
+        return std::nullopt;
+    }
+
+    const unsigned versionBits = (data[1] >> 3) & 0x3;
+    const unsigned layerBits = (data[1] >> 1) & 0x3;
+    const unsigned bitrateIndex = data[2] >> 4;
+    const unsigned sampleRateIndex = (data[2] >> 2) & 0x3;
+    // Version 1 is reserved, as are layer 0, bitrate index 15, sample rate index 3 and emphasis 2
+    if (versionBits == 1 || layerBits == 0 || bitrateIndex == 0 || bitrateIndex == 15 || sampleRateIndex == 3 ||
+        (data[3] & 0x3) == 2) {
+        return std::nullopt;
+    }
+
+    FrameHeader header;
+    header.version = versionBits == 3 ? Version::mpeg1 : versionBits == 2 ? Version::mpeg2 : Version::mpeg25;
+    header.layer = 4 - layerBits;
+    header.protection = (data[1] & 0x1) == 0;
+    header.padding = (data[2] & 0x2) != 0;
+    header.channels = (data[3] >> 6) == 3 ? 1 : 2;
+
+    const bool mpeg1 = header.version == Version::mpeg1;
+    const auto table = mpeg1 ? header.layer - 1 : header.layer == 1 ? 3 : 4;
+    header.bitrate = std::uint32_t{detail::bitrates[table][bitrateIndex]} * 1000;
+    header.sampleRate = detail::sampleRates[sampleRateIndex] >> (mpeg1 ? 0 : header.version == Version::mpeg2 ? 1 : 2);
+
+    if (header.layer == 1) {
+        header.samplesPerFrame = 384;
+        header.size = ((12 * header.bitrate / header.sampleRate) + (header.padding ? 1 : 0)) * 4;
+    } else {
+        header.samplesPerFrame = header.layer == 3 && !mpeg1 ? 576 : 1152;
+        header.size = (header.samplesPerFrame / 8 * header.bitrate / header.sampleRate) + (header.padding ? 1 : 0);
+    }
+
+    return header;
+}
+
+/// Returns true if frames with headers `a` and `b` may belong to the same stream
+inline bool isCompatible(const FrameHeader &a, const FrameHeader &b) noexcept {
+    return a.version == b.version && a.layer == b.layer && a.sampleRate == b.sampleRate && a.channels == b.channels;
+}
+
+/// Finds the first frame in `data` whose header is valid and, if it fits, is followed by a compatible header
+/// - parameter header: Receives the frame header
+/// - returns: The offset of the frame or `size` if no frame was found
+inline std::size_t findFrame(const unsigned char *data, std::size_t size, FrameHeader &header) noexcept {
+    for (std::size_t offset = 0; offset + frameHeaderSize <= size; ++offset) {
+        const auto *sync = static_cast<const unsigned char *>(std::memchr(data + offset, 0xFF, size - offset));
+        if (!sync) {
+            break;
+        }
+        offset = static_cast<std::size_t>(sync - data);
+
+        const auto candidate = parseFrameHeader(data + offset, size - offset);
+        if (!candidate) {
+            continue;
+        }
+
+        const auto next = offset + candidate->size;
+        if (next + frameHeaderSize <= size) {
+            const auto following = parseFrameHeader(data + next, size - next);
+            if (!following || !isCompatible(*candidate, *following)) {
+                continue;
+            }
+        }
+
+        header = *candidate;
+        return offset;
+    }
+
+    return size;
+}
+
+// MARK: - Xing, Info and VBRI Frames
+
+// Encoders commonly write a layer III frame holding no audio at the start of a stream to describe it. LAME and others
+// write a Xing frame, or an Info frame for constant bitrate streams, after the side information. It may hold the number
+// of frames and bytes in the stream, a seek table and a quality indicator, optionally followed by a LAME extension
+// giving the encoder delay and padding for gapless playback. The Fraunhofer encoder writes a VBRI frame at a fixed
+// offset holding the number of frames and bytes and its own seek table.
+//
+// Both seek tables map fractions of the stream duration to approximate byte offsets, so they are not parsed: sample
+// accurate seeking needs the offset of the frame holding the target sample.
+
+/// A parsed Xing, Info or VBRI frame
+struct InfoFrame {
+    /// The kind of an info frame
+    enum class Kind { xing, vbri };
+
+    Kind kind{Kind::xing};
+    /// The number of MPEG frames in the stream, or `0` if not present
+    std::uint32_t frames{0};
+    /// The number of bytes in the stream, or `0` if not present
+    std::uint32_t bytes{0};
+    /// Whether the frame holds a LAME extension with gapless information
+    bool hasGaplessInfo{false};
+    /// The number of audio frames of encoder delay at the start of the stream
+    std::uint32_t encoderDelay{0};
+    /// The number of audio frames of padding at the end of the stream
+    std::uint32_t encoderPadding{0};
+};
+
+/// Returns the offset of a Xing or Info tag in a frame with `header`
+inline std::size_t xingOffset(const FrameHeader &header) noexcept {
+    // The tag follows the side information
+    std::size_t sideInfoSize;
+    if (header.version == Version::mpeg1) {
+        sideInfoSize = header.channels == 1 ? 17 : 32;
+    } else {
+        sideInfoSize = header.channels == 1 ? 9 : 17;
+    }
+    return frameHeaderSize + (header.protection ? 2 : 0) + sideInfoSize;
+}
+
+/// The offset of a VBRI tag in a frame
+constexpr std::size_t vbriOffset = frameHeaderSize + 32;
+
+/// Parses a Xing, Info or VBRI frame
+/// - parameter data: The frame, which must begin with `header`
+/// - parameter size: The number of bytes available at `data`
+/// - returns: The info frame or `std::nullopt` if the frame is not an info frame
+inline std::optional<InfoFrame> parseInfoFrame(const unsigned char *data, std::size_t size,
+                                               const FrameHeader &header) noexcept {
+    if (header.layer != 3) {
+        return std::nullopt;
+    }
+    size = std::min<std::size_t>(size, header.size);
+
+    InfoFrame info;
+
+    if (auto offset = xingOffset(header);
+        offset + 8 <= size &&
+        (std::memcmp(data + offset, "Xing", 4) == 0 || std::memcmp(data + offset, "Info", 4) == 0)) {
+        const auto flags = detail::readUInt32(data + offset + 4);
+        offset += 8;
+
+        // Frames, bytes, seek table and quality
+        if (flags & 0x1) {
+            if (offset + 4 > size) {
+                return std::nullopt;
+            }
+            info.frames = detail::readUInt32(data + offset);
+            offset += 4;
+        }
+        if (flags & 0x2) {
+            if (offset + 4 > size) {
+                return std::nullopt;
+            }
+            info.bytes = detail::readUInt32(data + offset);
+            offset += 4;
+        }
+        if (flags & 0x4) {
+            offset += 100;
+        }
+        if (flags & 0x8) {
+            offset += 4;
+        }
+
+        // The LAME extension begins with a nine byte encoder version followed by twelve bytes of encoder settings
+        if (offset + 24 <= size &&
+            (std::memcmp(data + offset, "LAME", 4) == 0 || std::memcmp(data + offset, "Lavf", 4) == 0 ||
+             std::memcmp(data + offset, "Lavc", 4) == 0)) {
+            const auto *gapless = data + offset + 21;
+            info.hasGaplessInfo = true;
+            info.encoderDelay = (std::uint32_t{gapless[0]} << 4) | (gapless[1] >> 4);
+            info.encoderPadding = ((std::uint32_t{gapless[1]} & 0xF) << 8) | gapless[2];
+        }
+
+        return info;
+    }
+
+    if (vbriOffset + 18 <= size && std::memcmp(data + vbriOffset, "VBRI", 4) == 0) {
+        info.kind = InfoFrame::Kind::vbri;
+        info.bytes = detail::readUInt32(data + vbriOffset + 10);
+        info.frames = detail::readUInt32(data + vbriOffset + 14);
+        return info;
+    }
+
+    return std::nullopt;
+}
+
+/// Returns the number of audio frames in a stream described by `info` once encoder delay and padding are removed
+/// - parameter header: The header of the info frame
+/// - returns: The number of audio frames or `std::nullopt` if `info` does not give the number of frames
+inline std::optional<std::uint64_t> audioFrameCount(const InfoFrame &info, const FrameHeader &header) noexcept {
+    if (info.frames == 0) {
+        return std::nullopt;
+    }
+
+    const auto total = std::uint64_t{info.frames} * header.samplesPerFrame;
+    const std::uint64_t trimmed = info.hasGaplessInfo ? info.encoderDelay + info.encoderPadding : 0;
+    if (trimmed >= total) {
+        return std::nullopt;
+    }
+    return total - trimmed;
+}
+
+} /* namespace mpeg */
+} /* namespace sfb */
@@ -0,0 +1,60 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#import <AVFAudio/AVFAudio.h>
+
+#import "FrameStage.hpp"
+
+#import <algorithm>
+#import <cassert>
+
+NS_ASSUME_NONNULL_BEGIN
+
+namespace sfb {
+
+/// Returns the address of `frame` in buffer `index` of `buffer`
+inline void *frameAddress(AVAudioPCMBuffer *buffer, UInt32 index, AVAudioFrameCount frame) noexcept {
+    return static_cast<unsigned char *>(buffer.audioBufferList->mBuffers[index].mData) +
+           (static_cast<size_t>(frame) * buffer.format.streamDescription->mBytesPerFrame);
+}
+
+/// Stages the first `frameLength` frames of `buffer` in `stage`
+/// - important: The frames must remain unchanged until they are read, skipped, or cleared
+inline void stageFrames(FrameStage &stage, AVAudioPCMBuffer *buffer, AVAudioFrameCount frameLength) noexcept {
+    assert(frameLength <= buffer.frameCapacity);
+    const auto *abl = buffer.audioBufferList;
+    const void *buffers[FrameStage::maximumBufferCount];
+    const auto bufferCount = std::min(static_cast<size_t>(abl->mNumberBuffers), FrameStage::maximumBufferCount);
+    for (size_t i = 0; i < bufferCount; ++i) {
+        buffers[i] = abl->mBuffers[i].mData;
+    }
+    stage.stage(buffers, bufferCount, buffer.format.streamDescription->mBytesPerFrame, frameLength);
+}
+
+/// Appends up to `frameLength` frames from `stage` to `buffer` and returns the number of frames appended
+inline AVAudioFrameCount appendStagedFrames(FrameStage &stage, AVAudioPCMBuffer *buffer,
+                                            AVAudioFrameCount frameLength) noexcept {
+    frameLength = std::min(frameLength, buffer.frameCapacity - buffer.frameLength);
+    if (frameLength == 0 || stage.empty()) {
+        return 0;
+    }
+
+    const auto *abl = buffer.audioBufferList;
+    void *buffers[FrameStage::maximumBufferCount];
+    const auto bufferCount = std::min(static_cast<size_t>(abl->mNumberBuffers), FrameStage::maximumBufferCount);
+    for (size_t i = 0; i < bufferCount; ++i) {
+        buffers[i] = abl->mBuffers[i].mData;
+    }
+
+    const auto framesRead = static_cast<AVAudioFrameCount>(stage.read(buffers, buffer.frameLength, frameLength));
+    buffer.frameLength += framesRead;
+    return framesRead;
+}
+
+} /* namespace sfb */
+
+NS_ASSUME_NONNULL_END
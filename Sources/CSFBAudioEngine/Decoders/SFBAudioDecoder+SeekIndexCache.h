@@ -0,0 +1,47 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#import "SFBAudioDecoder.h"
+
+#import "SeekIndexCache.hpp"
+
+#import <exception>
+#import <optional>
+
+NS_ASSUME_NONNULL_BEGIN
+
+namespace sfb {
+
+/// The seek index cache and identity of a file
+struct SeekIndexCacheKey final {
+    SeekIndexCache cache_;
+    FileIdentity identity_;
+};
+
+/// Returns the seek index cache key for the file at `url`, or `std::nullopt` if seek indexes are not cached or `url` is
+/// not a file URL
+inline std::optional<SeekIndexCacheKey> seekIndexCacheKey(NSURL *_Nullable url) noexcept {
+    NSURL *directoryURL = SFBAudioDecoder.seekIndexCacheDirectoryURL;
+    if (directoryURL == nil || !url.isFileURL) {
+        return std::nullopt;
+    }
+
+    const auto identity = FileIdentity::forPath(url.fileSystemRepresentation, false);
+    if (!identity.has_value()) {
+        return std::nullopt;
+    }
+
+    try {
+        return SeekIndexCacheKey{SeekIndexCache{directoryURL.fileSystemRepresentation}, *identity};
+    } catch (const std::exception &e) {
+        return std::nullopt;
+    }
+}
+
+} /* namespace sfb */
+
+NS_ASSUME_NONNULL_END
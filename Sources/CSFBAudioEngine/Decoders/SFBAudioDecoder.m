@@ -39,6 +39,7 @@ static void SFBCreateAudioDecoderLog(void) {
 @dynamic frameLength;
 
 static NSMutableArray *_registeredSubclasses = nil;
+static NSURL *_seekIndexCacheDirectoryURL = nil;
 
 + (void)load {
     [NSError
@@ -142,6 +143,19 @@ static NSMutableArray *_registeredSubclasses = nil;
     return NO;
 }
 
++ (NSURL *)seekIndexCacheDirectoryURL {
+    @synchronized([SFBAudioDecoder class]) {
+        return _seekIndexCacheDirectoryURL;
+    }
+}
+
++ (void)setSeekIndexCacheDirectoryURL:(NSURL *)seekIndexCacheDirectoryURL {
+    NSURL *url = [seekIndexCacheDirectoryURL copy];
+    @synchronized([SFBAudioDecoder class]) {
+        _seekIndexCacheDirectoryURL = url;
+    }
+}
+
 - (instancetype)initWithURL:(NSURL *)url {
     return [self initWithURL:url detectContentType:YES mimeTypeHint:nil error:nil];
 }
@@ -1,17 +0,0 @@
-//
-// SPDX-FileCopyrightText: 2014 Stephen F. Booth <contact@sbooth.dev>
-// SPDX-License-Identifier: MIT
-//
-// Part of https://github.com/sbooth/SFBAudioEngine
-//
-
-#import "SFBDSDDecoder+Internal.h"
-
-NS_ASSUME_NONNULL_BEGIN
-
-// An SFBDSDDecoder subclass supporting DSDIFF (DSD Interchange File Format)
-// See http://www.sonicstudio.com/pdf/dsd/DSDIFF_1.5_Spec.pdf
-@interface SFBDSDIFFDecoder : SFBDSDDecoder
-@end
-
-NS_ASSUME_NONNULL_END
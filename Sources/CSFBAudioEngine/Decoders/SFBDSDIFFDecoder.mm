@@ -6,7 +6,9 @@
 //
 
 #import "SFBDSDIFFDecoder.h"
+#import "SFBDSDDecoder+Internal.h"
 
+#import "DSTDecoder.hpp"
 #import "NSData+SFBExtensions.h"
 #import "SFBCStringForOSType.h"
 #import "SFBLocalizedNameForURL.h"
@@ -16,9 +18,12 @@
 #import <os/log.h>
 
 #import <algorithm>
+#import <atomic>
 #import <cstdint>
+#import <cstring>
 #import <map>
 #import <memory>
+#import <new>
 #import <string>
 #import <vector>
 
@@ -167,28 +172,27 @@ struct LoudspeakerConfigurationChunk : public DSDIFFChunk {
 // 'DSD ' in 'FRM8'
 struct DSDSoundDataChunk : public DSDIFFChunk {};
 
-// 'DST ', 'DSTI', 'COMT', 'DIIN', 'MANF' are not handled
+// 'DST ' in 'FRM8'
+struct DSTSoundDataChunk : public DSDIFFChunk {
+    // From the 'FRTE' chunk
+    uint32_t numberFrames_;
+    uint16_t frameRate_;
+    // The offset of the first chunk following 'FRTE'
+    int64_t firstFrameOffset_;
+};
+
+// 'DSTI' in 'FRM8'
+struct DSTSoundIndexChunk : public DSDIFFChunk {
+    struct Entry {
+        uint64_t offset_;
+        uint32_t length_;
+    };
+    std::vector<Entry> entries_;
+};
+
+// 'DSTF' and 'DSTC' in 'DST ' are read while decoding
+// 'COMT', 'DIIN', 'MANF' are not handled
 
-//// 'DST ' in 'FRM8'
-// class DSTSoundDataChunk : public DSDIFFChunk
-//{};
-//
-//// 'FRTE' in 'DST '
-// class DSTFrameInformationChunk : public DSDIFFChunk
-//{};
-//
-//// 'FRTE' in 'DST '
-// class DSTFrameDataChunk : public DSDIFFChunk
-//{};
-//
-//// 'FRTE' in 'DST '
-// class DSTFrameCRCChunk : public DSDIFFChunk
-//{};
-//
-//// 'DSTI' in 'FRM8'
-// class DSTSoundIndexChunk : public DSDIFFChunk
-//{};
-//
 //// 'COMT' in 'FRM8'
 // class CommentsChunk : public DSDIFFChunk
 //{};
@@ -574,6 +578,117 @@ std::shared_ptr<DSDSoundDataChunk> parseDSDSoundDataChunk(SFBInputSource *inputS
     return result;
 }
 
+std::shared_ptr<DSTSoundDataChunk> parseDSTSoundDataChunk(SFBInputSource *inputSource, const uint32_t chunkID,
+                                                          const uint64_t chunkDataSize) {
+    if (chunkID != 'DST ') {
+        os_log_error(gSFBDSDDecoderLog, "Invalid chunk ID for 'DST ' chunk");
+        return nullptr;
+    }
+
+    auto result = std::make_shared<DSTSoundDataChunk>();
+
+    result->chunkID_ = chunkID;
+    result->dataSize_ = chunkDataSize;
+    NSInteger offset;
+    if (![inputSource getOffset:&offset error:nil]) {
+        os_log_error(gSFBDSDDecoderLog, "Error getting chunk data offset");
+        return nullptr;
+    }
+    result->dataOffset_ = offset;
+
+    // 'FRTE' is required to be the first local chunk
+    uint32_t localChunkID;
+    uint64_t localChunkDataSize;
+    if (chunkDataSize < 18 || !readChunkIDAndDataSize(inputSource, localChunkID, localChunkDataSize) ||
+        localChunkID != 'FRTE' || localChunkDataSize != 6) {
+        os_log_error(gSFBDSDDecoderLog, "Missing 'FRTE' chunk in 'DST ' chunk");
+        return nullptr;
+    }
+
+    if (![inputSource readUInt32BigEndian:&result->numberFrames_ error:nil]) {
+        os_log_error(gSFBDSDDecoderLog, "Unable to read numFrames in 'FRTE' chunk");
+        return nullptr;
+    }
+
+    if (![inputSource readUInt16BigEndian:&result->frameRate_ error:nil]) {
+        os_log_error(gSFBDSDDecoderLog, "Unable to read frameRate in 'FRTE' chunk");
+        return nullptr;
+    }
+
+    result->firstFrameOffset_ = offset + 18;
+
+    // Skip the frames, which are read while decoding
+    if (![inputSource seekToOffset:(offset + static_cast<NSInteger>(chunkDataSize)) error:nil]) {
+        os_log_error(gSFBDSDDecoderLog, "Error skipping chunk data");
+        return nullptr;
+    }
+
+    return result;
+}
+
+std::shared_ptr<DSTSoundIndexChunk> parseDSTSoundIndexChunk(SFBInputSource *inputSource, const uint32_t chunkID,
+                                                            const uint64_t chunkDataSize, const uint32_t numberFrames) {
+    if (chunkID != 'DSTI') {
+        os_log_error(gSFBDSDDecoderLog, "Invalid chunk ID for 'DSTI' chunk");
+        return nullptr;
+    }
+
+    auto result = std::make_shared<DSTSoundIndexChunk>();
+
+    result->chunkID_ = chunkID;
+    result->dataSize_ = chunkDataSize;
+    NSInteger offset;
+    if (![inputSource getOffset:&offset error:nil]) {
+        os_log_error(gSFBDSDDecoderLog, "Error getting chunk data offset");
+        return nullptr;
+    }
+    result->dataOffset_ = offset;
+
+    // Only entries for frames in the 'DST ' chunk that lie within the input are read
+    auto entryCount = std::min(chunkDataSize / 12, static_cast<uint64_t>(numberFrames));
+    if (NSInteger length; [inputSource getLength:&length error:nil]) {
+        entryCount = std::min(entryCount, static_cast<uint64_t>(std::max(length - offset, NSInteger{0})) / 12);
+    }
+
+    // Read the entire index at once; an hour of audio has 270,000 entries
+    try {
+        std::vector<unsigned char> data(entryCount * 12);
+        NSInteger bytesRead;
+        if (![inputSource readBytes:data.data()
+                              length:static_cast<NSInteger>(data.size())
+                           bytesRead:&bytesRead
+                               error:nil] ||
+            bytesRead != static_cast<NSInteger>(data.size())) {
+            os_log_error(gSFBDSDDecoderLog, "Unable to read 'DSTI' chunk");
+            return nullptr;
+        }
+
+        std::vector<DSTSoundIndexChunk::Entry> entries;
+        entries.reserve(entryCount);
+        for (size_t i = 0; i < data.size(); i += 12) {
+            uint64_t entryOffset = 0;
+            for (size_t j = 0; j < 8; ++j) {
+                entryOffset = (entryOffset << 8) | data[i + j];
+            }
+            uint32_t length = 0;
+            for (size_t j = 8; j < 12; ++j) {
+                length = (length << 8) | data[i + j];
+            }
+            entries.push_back({entryOffset, length});
+        }
+        result->entries_ = std::move(entries);
+    } catch (const std::bad_alloc &e) {
+        os_log_info(gSFBDSDDecoderLog, "Ignoring 'DSTI' chunk: %{public}s", e.what());
+    }
+
+    if (![inputSource seekToOffset:(offset + static_cast<NSInteger>(chunkDataSize)) error:nil]) {
+        os_log_error(gSFBDSDDecoderLog, "Error skipping chunk data");
+        return nullptr;
+    }
+
+    return result;
+}
+
 std::unique_ptr<FormDSDChunk> parseFormDSDChunk(SFBInputSource *inputSource, const uint32_t chunkID,
                                                 const uint64_t chunkDataSize) {
     if (chunkID != 'FRM8') {
@@ -636,6 +751,25 @@ std::unique_ptr<FormDSDChunk> parseFormDSDChunk(SFBInputSource *inputSource, con
                 }
                 break;
 
+            case 'DST ':
+                if (auto chunk = parseDSTSoundDataChunk(inputSource, localChunkID, localChunkDataSize); chunk) {
+                    result->localChunks_[chunk->chunkID_] = chunk;
+                }
+                break;
+
+            case 'DSTI': {
+                // The index follows the 'DST ' chunk, whose frame count bounds the number of entries
+                uint32_t numberFrames = 0;
+                if (const auto it = result->localChunks_.find('DST '); it != result->localChunks_.end()) {
+                    numberFrames = std::static_pointer_cast<DSTSoundDataChunk>(it->second)->numberFrames_;
+                }
+                if (auto chunk = parseDSTSoundIndexChunk(inputSource, localChunkID, localChunkDataSize, numberFrames);
+                    chunk) {
+                    result->localChunks_[chunk->chunkID_] = chunk;
+                }
+                break;
+            }
+
                 // Skip unrecognized or ignored chunks
             default:
                 if (![inputSource getOffset:&offset error:nil]) {
@@ -672,6 +806,12 @@ std::unique_ptr<FormDSDChunk> parseDSDIFF(SFBInputSource *inputSource) {
     return parseFormDSDChunk(inputSource, chunkID, chunkDataSize);
 }
 
+/// The maximum number of threads used by `SFBDSDIFFDecoder` for DST decoding, or `0` for the default
+std::atomic<NSUInteger> maximumDSTDecodingThreads_ = 0;
+
+/// The default maximum number of threads decoding DST frames ahead of the consumer
+constexpr NSUInteger kDefaultMaximumDSTDecodingThreads = 4;
+
 } /* namespace */
 
 @interface SFBDSDIFFDecoder () {
@@ -680,7 +820,29 @@ std::unique_ptr<FormDSDChunk> parseDSDIFF(SFBInputSource *inputSource) {
     AVAudioFramePosition _packetPosition;
     AVAudioFramePosition _packetCount;
     int64_t _audioOffset;
+    // DST decoding state
+    std::unique_ptr<sfb::DSTFramePipeline> _dstPipeline;
+    std::vector<DSTSoundIndexChunk::Entry> _dstIndex;
+    /// Offsets of the 'DSTF' chunks read so far, in frame order
+    std::vector<int64_t> _dstFrameOffsets;
+    int64_t _dstFirstFrameOffset;
+    int64_t _dstEndOffset;
+    /// The offset of the next chunk to read in the 'DST ' chunk
+    int64_t _dstNextChunkOffset;
+    uint32_t _dstFrameCount;
+    /// The number of the next frame to submit for decoding
+    uint32_t _dstNextFrame;
+    /// The number of bytes already consumed from the oldest decoded frame
+    size_t _dstFrameByteOffset;
 }
+- (BOOL)openDSTSoundDataChunk:(const DSTSoundDataChunk &)soundDataChunk
+                   soundIndex:(DSTSoundIndexChunk *)soundIndexChunk
+                        error:(NSError **)error;
+- (BOOL)submitDSTFramesReturningError:(NSError **)error;
+- (BOOL)decodeDSTIntoBuffer:(AVAudioCompressedBuffer *)buffer
+                packetCount:(AVAudioPacketCount)packetCount
+                      error:(NSError **)error;
+- (BOOL)locateDSTFrame:(uint32_t)frame offset:(int64_t *)offset error:(NSError **)error;
 @end
 
 @implementation SFBDSDIFFDecoder
@@ -701,6 +863,14 @@ std::unique_ptr<FormDSDChunk> parseDSDIFF(SFBInputSource *inputSource) {
     return SFBDSDDecoderNameDSDIFF;
 }
 
++ (NSUInteger)maximumDSTDecodingThreads {
+    return maximumDSTDecodingThreads_;
+}
+
++ (void)setMaximumDSTDecodingThreads:(NSUInteger)maximumDSTDecodingThreads {
+    maximumDSTDecodingThreads_ = maximumDSTDecodingThreads;
+}
+
 + (BOOL)testInputSource:(SFBInputSource *)inputSource
         formatIsSupported:(SFBTernaryTruthValue *)formatIsSupported
                     error:(NSError **)error {
@@ -802,6 +972,34 @@ std::unique_ptr<FormDSDChunk> parseDSDIFF(SFBInputSource *inputSource) {
     _sourceFormat = [[AVAudioFormat alloc] initWithStreamDescription:&sourceStreamDescription
                                                        channelLayout:channelLayout];
 
+    auto compressionTypeChunk = std::static_pointer_cast<CompressionTypeChunk>(propertyChunk->localChunks_['CMPR']);
+    if (compressionTypeChunk && compressionTypeChunk->compressionType_ == 'DST ') {
+        auto soundDataChunk = std::static_pointer_cast<DSTSoundDataChunk>(chunks->localChunks_['DST ']);
+        if (!soundDataChunk) {
+            os_log_error(gSFBDSDDecoderLog, "Missing chunk in file");
+            if (error != nullptr) {
+                *error = [self invalidFormatError:NSLocalizedString(@"DSD Interchange", @"")];
+            }
+            return NO;
+        }
+
+        auto soundIndexChunk = std::static_pointer_cast<DSTSoundIndexChunk>(chunks->localChunks_['DSTI']);
+        if (![self openDSTSoundDataChunk:*soundDataChunk soundIndex:soundIndexChunk.get() error:error]) {
+            return NO;
+        }
+
+        _isOpen = YES;
+
+        return YES;
+    } else if (compressionTypeChunk && compressionTypeChunk->compressionType_ != 'DSD ') {
+        os_log_error(gSFBDSDDecoderLog, "Unsupported compression type '%{public}.4s'",
+                     SFBCStringForOSType(compressionTypeChunk->compressionType_));
+        if (error != nullptr) {
+            *error = [self invalidFormatError:NSLocalizedString(@"DSD Interchange", @"")];
+        }
+        return NO;
+    }
+
     auto soundDataChunk = std::static_pointer_cast<DSDSoundDataChunk>(chunks->localChunks_['DSD ']);
     if (!soundDataChunk) {
         os_log_error(gSFBDSDDecoderLog, "Missing chunk in file");
@@ -827,6 +1025,9 @@ std::unique_ptr<FormDSDChunk> parseDSDIFF(SFBInputSource *inputSource) {
 
 - (BOOL)closeReturningError:(NSError **)error {
     _isOpen = NO;
+    _dstPipeline.reset();
+    _dstIndex.clear();
+    _dstFrameOffsets.clear();
     return [super closeReturningError:error];
 }
 
@@ -857,6 +1058,10 @@ std::unique_ptr<FormDSDChunk> parseDSDIFF(SFBInputSource *inputSource) {
         return YES;
     }
 
+    if (_dstPipeline) {
+        return [self decodeDSTIntoBuffer:buffer packetCount:packetCount error:error];
+    }
+
     AVAudioPacketCount packetsRemaining = static_cast<AVAudioPacketCount>(_packetCount - _packetPosition);
     AVAudioPacketCount packetsToRead = std::min(packetCount, packetsRemaining);
     AVAudioPacketCount packetsRead = 0;
@@ -911,6 +1116,29 @@ std::unique_ptr<FormDSDChunk> parseDSDIFF(SFBInputSource *inputSource) {
 - (BOOL)seekToPacket:(AVAudioFramePosition)packet error:(NSError **)error {
     NSParameterAssert(packet >= 0);
 
+    if (_dstPipeline) {
+        const auto packetSize = kSFBBytesPerDSDPacketPerChannel * _processingFormat.channelCount;
+        const auto packetsPerFrame = static_cast<AVAudioFramePosition>(_dstPipeline->frameSize() / packetSize);
+        const auto frame = static_cast<uint32_t>(std::min<AVAudioFramePosition>(packet / packetsPerFrame,
+                                                                                _dstFrameCount));
+
+        // Seeking to the end requires no frame data
+        int64_t offset = _dstEndOffset;
+        if (frame < _dstFrameCount && ![self locateDSTFrame:frame offset:&offset error:error]) {
+            os_log_debug(gSFBDSDDecoderLog, "-seekToPacket:error: unable to locate DST frame %u", frame);
+            return NO;
+        }
+
+        // Frames decoded ahead of the previous position are discarded
+        _dstPipeline->clear();
+        _dstNextChunkOffset = offset;
+        _dstNextFrame = frame;
+        _dstFrameByteOffset =
+                frame < _dstFrameCount ? static_cast<size_t>(packet - (frame * packetsPerFrame)) * packetSize : 0;
+        _packetPosition = packet;
+        return YES;
+    }
+
     NSInteger packetOffset = packet * kSFBBytesPerDSDPacketPerChannel * _processingFormat.channelCount;
     if (![_inputSource seekToOffset:(_audioOffset + packetOffset) error:error]) {
         os_log_debug(gSFBDSDDecoderLog, "-seekToPacket:error: failed seeking to input offset: %lld",
@@ -922,4 +1150,254 @@ std::unique_ptr<FormDSDChunk> parseDSDIFF(SFBInputSource *inputSource) {
     return YES;
 }
 
+// MARK: - DST
+
+- (BOOL)openDSTSoundDataChunk:(const DSTSoundDataChunk &)soundDataChunk
+                   soundIndex:(DSTSoundIndexChunk *)soundIndexChunk
+                        error:(NSError **)error {
+    const auto sampleRate = static_cast<uint32_t>(_processingFormat.sampleRate);
+    const auto channelCount = static_cast<int>(_processingFormat.channelCount);
+    if (soundDataChunk.frameRate_ != sfb::dst::framesPerSecond || channelCount > sfb::dst::maximumChannels ||
+        sampleRate % (sfb::dst::framesPerSecond * 8) != 0) {
+        os_log_error(gSFBDSDDecoderLog, "Unsupported DST stream: %d channels at %u Hz, %u frames per second",
+                     channelCount, sampleRate, soundDataChunk.frameRate_);
+        if (error != nullptr) {
+            *error = [self invalidFormatError:NSLocalizedString(@"DSD Interchange", @"")
+                           recoverySuggestion:NSLocalizedString(@"The file's DST compression parameters are not "
+                                                                @"supported.",
+                                                                @"")];
+        }
+        return NO;
+    }
+
+    // Frames are decoded in order ahead of the consumer by a pool of threads, or on demand with a single thread
+    const NSUInteger maximumThreads = maximumDSTDecodingThreads_;
+    const auto usableThreads = std::min(maximumThreads != 0 ? maximumThreads : kDefaultMaximumDSTDecodingThreads,
+                                        NSProcessInfo.processInfo.activeProcessorCount);
+    const int threads = usableThreads > 1 ? static_cast<int>(usableThreads) : 0;
+    try {
+        _dstPipeline = std::make_unique<sfb::DSTFramePipeline>(channelCount, sfb::dst::samplesPerFrame(sampleRate),
+                                                               threads, (2 * threads) + 1);
+        if (soundIndexChunk) {
+            _dstIndex = std::move(soundIndexChunk->entries_);
+        }
+        _dstFrameOffsets.reserve(soundDataChunk.numberFrames_);
+    } catch (const std::exception &e) {
+        os_log_error(gSFBDSDDecoderLog, "Error creating DST decoder: %{public}s", e.what());
+        _dstPipeline.reset();
+        if (error != nullptr) {
+            *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:ENOMEM userInfo:nil];
+        }
+        return NO;
+    }
+
+    _dstFirstFrameOffset = soundDataChunk.firstFrameOffset_;
+    _dstEndOffset = soundDataChunk.dataOffset_ + static_cast<int64_t>(soundDataChunk.dataSize_);
+    _dstNextChunkOffset = _dstFirstFrameOffset;
+    _dstFrameCount = soundDataChunk.numberFrames_;
+    _dstNextFrame = 0;
+    _dstFrameByteOffset = 0;
+
+    _packetPosition = 0;
+    _packetCount = static_cast<AVAudioFramePosition>(_dstFrameCount) *
+                   static_cast<AVAudioFramePosition>(sfb::dst::samplesPerFrame(sampleRate) / kSFBPCMFramesPerDSDPacket);
+
+    return YES;
+}
+
+- (BOOL)submitDSTFramesReturningError:(NSError **)error {
+    if (_dstNextFrame == _dstFrameCount || !_dstPipeline->canSubmit()) {
+        return YES;
+    }
+
+    if (![_inputSource seekToOffset:_dstNextChunkOffset error:error]) {
+        return NO;
+    }
+
+    // An uncompressed frame is one byte larger than its decoded size
+    const auto maximumFrameDataSize = _dstPipeline->frameSize() + 1;
+
+    while (_dstNextFrame < _dstFrameCount && _dstPipeline->canSubmit()) {
+        uint32_t chunkID;
+        uint64_t chunkDataSize;
+        if (_dstNextChunkOffset + 12 > _dstEndOffset ||
+            !readChunkIDAndDataSize(_inputSource, chunkID, chunkDataSize) ||
+            chunkDataSize > static_cast<uint64_t>(_dstEndOffset - _dstNextChunkOffset - 12)) {
+            os_log_error(gSFBDSDDecoderLog, "Missing DST frame %u of %u", _dstNextFrame, _dstFrameCount);
+            if (error != nullptr) {
+                *error = [self invalidFormatError:NSLocalizedString(@"DSD Interchange", @"")];
+            }
+            return NO;
+        }
+
+        const auto chunkOffset = _dstNextChunkOffset;
+        _dstNextChunkOffset += 12 + static_cast<int64_t>(chunkDataSize + (chunkDataSize & 1));
+
+        // 'DSTC' and unknown chunks are skipped
+        if (chunkID != 'DSTF') {
+            if (![_inputSource seekToOffset:_dstNextChunkOffset error:error]) {
+                return NO;
+            }
+            continue;
+        }
+
+        if (chunkDataSize > maximumFrameDataSize) {
+            os_log_error(gSFBDSDDecoderLog, "Invalid size %llu for DST frame %u", chunkDataSize, _dstNextFrame);
+            if (error != nullptr) {
+                *error = [self invalidFormatError:NSLocalizedString(@"DSD Interchange", @"")];
+            }
+            return NO;
+        }
+
+        if (_dstNextFrame == _dstFrameOffsets.size()) {
+            _dstFrameOffsets.push_back(chunkOffset);
+        }
+
+        auto *data = _dstPipeline->prepare(static_cast<size_t>(chunkDataSize));
+        NSInteger bytesRead;
+        if (![_inputSource readBytes:data
+                              length:static_cast<NSInteger>(chunkDataSize)
+                           bytesRead:&bytesRead
+                               error:error]) {
+            os_log_error(gSFBDSDDecoderLog, "Error reading DST frame %u", _dstNextFrame);
+            return NO;
+        }
+
+        if (bytesRead != static_cast<NSInteger>(chunkDataSize)) {
+            os_log_error(gSFBDSDDecoderLog, "Missing DST frame data: requested %llu bytes, got %ld", chunkDataSize,
+                         static_cast<long>(bytesRead));
+            if (error != nullptr) {
+                *error = [self invalidFormatError:NSLocalizedString(@"DSD Interchange", @"")];
+            }
+            return NO;
+        }
+
+        _dstPipeline->submit();
+        ++_dstNextFrame;
+
+        if ((chunkDataSize & 1) && ![_inputSource seekToOffset:_dstNextChunkOffset error:error]) {
+            return NO;
+        }
+    }
+
+    return YES;
+}
+
+- (BOOL)decodeDSTIntoBuffer:(AVAudioCompressedBuffer *)buffer
+                packetCount:(AVAudioPacketCount)packetCount
+                      error:(NSError **)error {
+    const auto packetSize = kSFBBytesPerDSDPacketPerChannel * _processingFormat.channelCount;
+    const auto frameSize = _dstPipeline->frameSize();
+
+    packetCount = static_cast<AVAudioPacketCount>(std::min<AVAudioFramePosition>(packetCount,
+                                                                                 _packetCount - _packetPosition));
+
+    while (buffer.packetCount < packetCount) {
+        // Keep the pipeline full so frames are decoded while earlier frames are consumed
+        if (![self submitDSTFramesReturningError:error]) {
+            return NO;
+        }
+
+        if (_dstPipeline->empty()) {
+            break;
+        }
+
+        if (const auto status = _dstPipeline->wait().status; status != sfb::DSTFrameDecoder::Status::success) {
+            os_log_error(gSFBDSDDecoderLog, "%{public}s DST frame at packet %lld",
+                         status == sfb::DSTFrameDecoder::Status::unsupported ? "Unsupported" : "Invalid",
+                         _packetPosition);
+            if (error != nullptr) {
+                *error = [self invalidFormatError:NSLocalizedString(@"DSD Interchange", @"")];
+            }
+            return NO;
+        }
+
+        const auto packetsAvailable = static_cast<AVAudioPacketCount>((frameSize - _dstFrameByteOffset) / packetSize);
+        const auto packets = std::min(packetsAvailable, packetCount - buffer.packetCount);
+        const auto bytes = packets * packetSize;
+
+        std::memcpy(static_cast<unsigned char *>(buffer.data) + buffer.byteLength,
+                    _dstPipeline->front().frame.data() + _dstFrameByteOffset, bytes);
+        buffer.packetCount += packets;
+        buffer.byteLength += bytes;
+
+        _dstFrameByteOffset += bytes;
+        _packetPosition += packets;
+
+        if (_dstFrameByteOffset == frameSize) {
+            _dstPipeline->pop();
+            _dstFrameByteOffset = 0;
+        }
+    }
+
+    return YES;
+}
+
+- (BOOL)locateDSTFrame:(uint32_t)frame offset:(int64_t *)offset error:(NSError **)error {
+    NSParameterAssert(frame < _dstFrameCount);
+    NSParameterAssert(offset != nullptr);
+
+    if (frame < _dstFrameOffsets.size()) {
+        *offset = _dstFrameOffsets[frame];
+        return YES;
+    }
+
+    // The index may record the offset of either the 'DSTF' chunk or its data, so check for the chunk header at both
+    if (frame < _dstIndex.size() && _dstIndex[frame].offset_ <= static_cast<uint64_t>(_dstEndOffset)) {
+        for (const auto candidate : {static_cast<int64_t>(_dstIndex[frame].offset_) - 12,
+                                     static_cast<int64_t>(_dstIndex[frame].offset_)}) {
+            uint32_t chunkID;
+            uint64_t chunkDataSize;
+            if (candidate >= _dstFirstFrameOffset && candidate + 12 <= _dstEndOffset &&
+                [_inputSource seekToOffset:candidate error:nil] &&
+                readChunkIDAndDataSize(_inputSource, chunkID, chunkDataSize) && chunkID == 'DSTF' &&
+                chunkDataSize == _dstIndex[frame].length_) {
+                *offset = candidate;
+                return YES;
+            }
+        }
+        os_log_info(gSFBDSDDecoderLog, "Ignoring invalid 'DSTI' entry for frame %u", frame);
+    }
+
+    // Without a usable index walk the chunk headers from the last known frame, recording offsets along the way
+    uint32_t chunkFrame = _dstFrameOffsets.empty() ? 0 : static_cast<uint32_t>(_dstFrameOffsets.size() - 1);
+    int64_t chunkOffset = _dstFrameOffsets.empty() ? _dstFirstFrameOffset : _dstFrameOffsets.back();
+    while (chunkOffset + 12 <= _dstEndOffset) {
+        uint32_t chunkID;
+        uint64_t chunkDataSize;
+        if (![_inputSource seekToOffset:chunkOffset error:error]) {
+            return NO;
+        }
+        if (!readChunkIDAndDataSize(_inputSource, chunkID, chunkDataSize)) {
+            os_log_error(gSFBDSDDecoderLog, "Missing DST frame %u of %u", frame, _dstFrameCount);
+            if (error != nullptr) {
+                *error = [self invalidFormatError:NSLocalizedString(@"DSD Interchange", @"")];
+            }
+            return NO;
+        }
+
+        if (chunkDataSize > static_cast<uint64_t>(_dstEndOffset - chunkOffset - 12)) {
+            break;
+        }
+
+        if (chunkID == 'DSTF') {
+            if (chunkFrame == _dstFrameOffsets.size()) {
+                _dstFrameOffsets.push_back(chunkOffset);
+            }
+            if (chunkFrame == frame) {
+                *offset = chunkOffset;
+                return YES;
+            }
+            ++chunkFrame;
+        }
+
+        chunkOffset += 12 + static_cast<int64_t>(chunkDataSize + (chunkDataSize & 1));
+    }
+
+    if (error != nullptr) {
+        *error = [self invalidFormatError:NSLocalizedString(@"DSD Interchange", @"")];
+    }
+    return NO;
+}
+
 @end
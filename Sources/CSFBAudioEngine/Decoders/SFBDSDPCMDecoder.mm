@@ -7,6 +7,7 @@
 
 #import "SFBDSDPCMDecoder.h"
 
+#import "DSDPCMConverter.hpp"
 #import "SFBAudioDecoder+Internal.h"
 #import "SFBDSDDecoder.h"
 #import "SFBLocalizedNameForURL.h"
@@ -17,228 +18,74 @@
 
 #import <algorithm>
 #import <cstdint>
+#import <iterator>
+#import <memory>
 #import <vector>
 
 namespace {
 
-constexpr int kDSDPacketsPerPCMFrame = 8 / kSFBPCMFramesPerDSDPacket;
 constexpr int kBufferSizePackets = 16384;
 
-// Bit reversal lookup table from http://graphics.stanford.edu/~seander/bithacks.html#BitReverseTable
-constexpr unsigned char sBitReverseTable256[256] = {
-#define R2(n) n, n + 2 * 64, n + 1 * 64, n + 3 * 64
-#define R4(n) R2(n), R2(n + 2 * 16), R2(n + 1 * 16), R2(n + 3 * 16)
-#define R6(n) R4(n), R4(n + 2 * 4), R4(n + 1 * 4), R4(n + 3 * 4)
-        R6(0), R6(2), R6(1), R6(3)};
-
-// MARK: - Begin DSD2PCM
-
-// SPDX-SnippetCopyrightText: 2009,2011 Sebastian Gesemann
-// SPDX-SnippetLicenseIdentifier: BSD-2-Clause-Views
-// SPDX-SnippetComment: Adapted from 'dsd2pcm.c'
-
-#define HTAPS 48                  /* number of FIR constants */
-#define FIFOSIZE 16               /* must be a power of two */
-#define FIFOMASK (FIFOSIZE - 1)   /* bit mask for FIFO offsets */
-#define CTABLES ((HTAPS + 7) / 8) /* number of "8 MACs" lookup tables */
-
-#if FIFOSIZE * 8 < HTAPS * 2
-#error "FIFOSIZE too small"
-#endif
-
-/*
- * Properties of this 96-tap lowpass filter when applied on a signal
- * with sampling rate of 44100*64 Hz:
- *
- * () has a delay of 17 microseconds.
- *
- * () flat response up to 48 kHz
- *
- * () if you downsample afterwards by a factor of 8, the
- *    spectrum below 70 kHz is practically alias-free.
- *
- * () stopband rejection is about 160 dB
- *
- * The coefficient tables ("ctables") take only 6 Kibi Bytes and
- * should fit into a modern processor's fast cache.
- */
-
-/*
- * The 2nd half (48 coeffs) of a 96-tap symmetric lowpass filter
- */
-constexpr double htaps[HTAPS] = {
-        0.09950731974056658,    0.09562845727714668,    0.08819647126516944,    0.07782552527068175,
-        0.06534876523171299,    0.05172629311427257,    0.0379429484910187,     0.02490921351762261,
-        0.0133774746265897,     0.003883043418804416,   -0.003284703416210726,  -0.008080250212687497,
-        -0.01067241812471033,   -0.01139427235000863,   -0.0106813877974587,    -0.009007905078766049,
-        -0.006828859761015335,  -0.004535184322001496,  -0.002425035959059578,  -0.0006922187080790708,
-        0.0005700762133516592,  0.001353838005269448,   0.001713709169690937,   0.001742046839472948,
-        0.001545601648013235,   0.001226696225277855,   0.0008704322683580222,  0.0005381636200535649,
-        0.000266446345425276,   7.002968738383528e-05,  -5.279407053811266e-05, -0.0001140625650874684,
-        -0.0001304796361231895, -0.0001189970287491285, -9.396247155265073e-05, -6.577634378272832e-05,
-        -4.07492895872535e-05,  -2.17407957554587e-05,  -9.163058931391722e-06, -2.017460145032201e-06,
-        1.249721855219005e-06,  2.166655190537392e-06,  1.930520892991082e-06,  1.319400334374195e-06,
-        7.410039764949091e-07,  3.423230509967409e-07,  1.244182214744588e-07,  3.130441005359396e-08};
-
-float ctables[CTABLES][256];
-
-void dsd2pcm_precalc() noexcept {
-    int t;
-    int e;
-    int m;
-    int k;
-    double acc;
-    for (t = 0; t < CTABLES; ++t) {
-        k = HTAPS - (t * 8);
-        k = std::min(k, 8);
-        for (e = 0; e < 256; ++e) {
-            acc = 0.0;
-            for (m = 0; m < k; ++m) {
-                acc += (((e >> (7 - m)) & 1) * 2 - 1) * htaps[(t * 8) + m];
-            }
-            ctables[CTABLES - 1 - t][e] = static_cast<float>(acc);
-        }
+/// The lowest supported PCM output sample rate
+constexpr double kMinimumPCMSampleRate = 88200;
+/// The highest supported PCM output sample rate
+constexpr double kMaximumPCMSampleRate = 384000;
+
+/// DSD sample rates supported for PCM conversion
+constexpr double kSupportedDSDSampleRates[] = {
+        kSFBSampleRateDSD64,         kSFBSampleRateDSD128,        kSFBSampleRateDSD256,
+        kSFBSampleRateDSD512,        kSFBSampleRateDSD64Variant,  kSFBSampleRateDSD128Variant,
+        kSFBSampleRateDSD256Variant, kSFBSampleRateDSD512Variant};
+
+/// Returns the number of DSD packets per PCM frame for conversion from `dsdSampleRate` to `pcmSampleRate`, or `0` if
+/// the conversion is not supported
+///
+/// A `pcmSampleRate` of `0` selects the highest supported PCM sample rate.
+int packetsPerPCMFrame(double dsdSampleRate, double pcmSampleRate) noexcept {
+    if (std::find(std::begin(kSupportedDSDSampleRates), std::end(kSupportedDSDSampleRates), dsdSampleRate) ==
+        std::end(kSupportedDSDSampleRates)) {
+        return 0;
     }
-}
 
-struct dsd2pcm_ctx {
-    unsigned char fifo[FIFOSIZE];
-    unsigned fifopos;
-};
-
-/**
- * resets the internal state for a fresh new stream
- */
-void dsd2pcm_reset(dsd2pcm_ctx *ptr) noexcept {
-    int i;
-    for (i = 0; i < FIFOSIZE; ++i) {
-        ptr->fifo[i] = 0x69; /* my favorite silence pattern */
+    // The first stage always decimates by 8 and each subsequent stage by 2
+    int packets = 1;
+    if (pcmSampleRate == 0) {
+        while (dsdSampleRate / (kSFBPCMFramesPerDSDPacket * packets) > kMaximumPCMSampleRate) {
+            packets *= 2;
+        }
+        return packets;
     }
-    ptr->fifopos = 0;
-    /* 0x69 = 01101001
-     * This pattern "on repeat" makes a low energy 352.8 kHz tone
-     * and a high energy 1.0584 MHz tone which should be filtered
-     * out completely by any playback system --> silence
-     */
-}
 
-/**
- * initializes a "dsd2pcm engine" for one channel
- * (allocates memory)
- */
-dsd2pcm_ctx *dsd2pcm_init() noexcept {
-    dsd2pcm_ctx *ptr = static_cast<dsd2pcm_ctx *>(std::malloc(sizeof(dsd2pcm_ctx)));
-    if (ptr != nullptr) {
-        dsd2pcm_reset(ptr);
+    if (pcmSampleRate < kMinimumPCMSampleRate || pcmSampleRate > kMaximumPCMSampleRate) {
+        return 0;
     }
-    return ptr;
-}
-
-/**
- * deinitializes a "dsd2pcm engine"
- * (releases memory, don't forget!)
- */
-void dsd2pcm_destroy(dsd2pcm_ctx *ptr) noexcept { std::free(ptr); }
-
-/**
- * clones the context and returns a pointer to the
- * newly allocated copy
- */
-dsd2pcm_ctx *dsd2pcm_clone(dsd2pcm_ctx *ptr) noexcept {
-    dsd2pcm_ctx *p2 = static_cast<dsd2pcm_ctx *>(std::malloc(sizeof(dsd2pcm_ctx)));
-    if (p2 != nullptr) {
-        std::memcpy(p2, ptr, sizeof(dsd2pcm_ctx));
+    while (dsdSampleRate / (kSFBPCMFramesPerDSDPacket * packets) > pcmSampleRate) {
+        packets *= 2;
     }
-    return p2;
+    return dsdSampleRate / (kSFBPCMFramesPerDSDPacket * packets) == pcmSampleRate ? packets : 0;
 }
 
-/**
- * "translates" a stream of octets to a stream of floats
- * (8:1 decimation)
- * @param ptr -- pointer to abstract context (buffers)
- * @param samples -- number of octets/samples to "translate"
- * @param src -- pointer to first octet (input)
- * @param src_stride -- src pointer increment
- * @param lsbf -- bitorder, 0=msb first, 1=lsbfirst
- * @param dst -- pointer to first float (output)
- * @param dst_stride -- dst pointer increment
- */
-void dsd2pcm_translate(dsd2pcm_ctx *ptr, size_t samples, const unsigned char *src, ptrdiff_t src_stride, bool lsbf,
-                       float *dst, ptrdiff_t dst_stride) noexcept {
-    unsigned ffp;
-    unsigned i;
-    unsigned bite1;
-    unsigned bite2;
-    unsigned char *p;
-    double acc;
-    ffp = ptr->fifopos;
-    while (samples-- > 0) {
-        bite1 = *src & 0xFFU;
-        if (lsbf) {
-            bite1 = sBitReverseTable256[bite1];
-        }
-        ptr->fifo[ffp] = static_cast<unsigned char>(bite1);
-        src += src_stride;
-        p = ptr->fifo + ((ffp - CTABLES) & FIFOMASK);
-        *p = sBitReverseTable256[*p & 0xFF];
-        acc = 0;
-        for (i = 0; i < CTABLES; ++i) {
-            bite1 = ptr->fifo[(ffp - i) & FIFOMASK] & 0xFF;
-            bite2 = ptr->fifo[(ffp - (CTABLES * 2 - 1) + i) & FIFOMASK] & 0xFF;
-            acc += ctables[i][bite1] + ctables[i][bite2];
-        }
-        *dst = static_cast<float>(acc);
-        dst += dst_stride;
-        ffp = (ffp + 1) & FIFOMASK;
+/// Returns the converter filters for `filterProfile`
+const sfb::dsd2pcm::FilterProfile &converterProfile(SFBDSDPCMFilterProfile filterProfile) noexcept {
+    switch (filterProfile) {
+    case SFBDSDPCMFilterProfileShort:
+        return sfb::dsd2pcm::shortProfile;
+    case SFBDSDPCMFilterProfileLong:
+        return sfb::dsd2pcm::longProfile;
+    case SFBDSDPCMFilterProfileStandard:
+    default:
+        return sfb::dsd2pcm::standardProfile;
     }
-    ptr->fifopos = ffp;
 }
 
-// MARK: End DSD2PCM -
-
-// MARK: Initialization
-
-void setupDSD2PCM() noexcept __attribute__((constructor));
-void setupDSD2PCM() noexcept { dsd2pcm_precalc(); }
-
-// MARK: DXD
-
-class DXD {
-  public:
-    DXD() : handle_(dsd2pcm_init()) {
-        if (handle_ == nullptr) {
-            throw std::bad_alloc();
-        }
-    }
-
-    DXD(DXD const &x) : handle_(dsd2pcm_clone(x.handle_)) {
-        if (handle_ == nullptr) {
-            throw std::bad_alloc();
-        }
-    }
-
-    ~DXD() noexcept { dsd2pcm_destroy(handle_); }
-
-    DXD &operator=(DXD x) {
-        std::swap(handle_, x.handle_);
-        return *this;
-    }
-
-    void translate(size_t samples, const unsigned char *src, ptrdiff_t src_stride, bool lsbitfirst, float *dst,
-                   ptrdiff_t dst_stride) noexcept {
-        dsd2pcm_translate(handle_, samples, src, src_stride, lsbitfirst, dst, dst_stride);
-    }
-
-  private:
-    dsd2pcm_ctx *handle_;
-};
-
 } /* namespace */
 
 @interface SFBDSDPCMDecoder () {
   @private
     AVAudioCompressedBuffer *_buffer;
-    std::vector<DXD> _context;
+    std::unique_ptr<sfb::DSDPCMConverter> _converter;
+    std::vector<float *> _output;
+    int _packetsPerFrame;
 }
 @end
 
@@ -275,6 +122,8 @@ class DXD {
         _decoder = decoder;
         // 6 dBFS gain -> powf(10.f, 6.f / 20.f) -> 0x1.fec984p+0 (approximately 1.99526231496888)
         _linearGain = 0x1.fec984p+0;
+        _filterProfile = SFBDSDPCMFilterProfileStandard;
+        _maximumConversionThreads = 1;
     }
     return self;
 }
@@ -324,8 +173,10 @@ class DXD {
         return NO;
     }
 
-    if (asbd->mSampleRate != static_cast<Float64>(kSFBSampleRateDSD64)) {
-        os_log_error(gSFBAudioDecoderLog, "Unsupported DSD sample rate for PCM conversion: %g", asbd->mSampleRate);
+    _packetsPerFrame = packetsPerPCMFrame(asbd->mSampleRate, _pcmSampleRate);
+    if (_packetsPerFrame == 0) {
+        os_log_error(gSFBAudioDecoderLog, "Unsupported sample rates for DSD to PCM conversion: %g Hz to %g Hz",
+                     asbd->mSampleRate, _pcmSampleRate);
         if (error != nullptr) {
             NSMutableDictionary *userInfo = [NSMutableDictionary
                     dictionaryWithObject:NSLocalizedString(
@@ -353,7 +204,7 @@ class DXD {
     // Generate non-interleaved 32-bit float output
     _processingFormat = [[AVAudioFormat alloc]
             initWithCommonFormat:AVAudioPCMFormatFloat32
-                      sampleRate:(asbd->mSampleRate / (kSFBPCMFramesPerDSDPacket * kDSDPacketsPerPCMFrame))
+                      sampleRate:(asbd->mSampleRate / (kSFBPCMFramesPerDSDPacket * _packetsPerFrame))
                      interleaved:NO
                    channelLayout:_decoder.processingFormat.channelLayout];
 
@@ -364,9 +215,16 @@ class DXD {
     _buffer.packetCount = 0;
 
     try {
-        _context.resize(asbd->mChannelsPerFrame);
+        const int halfBandStages = __builtin_ctz(_packetsPerFrame);
+        const auto threads = _maximumConversionThreads != 0 ? _maximumConversionThreads
+                                                             : NSProcessInfo.processInfo.activeProcessorCount;
+        const auto channelGroups = static_cast<int>(std::clamp<NSUInteger>(threads, 1, asbd->mChannelsPerFrame));
+        _converter = std::make_unique<sfb::DSDPCMConverter>(asbd->mChannelsPerFrame, halfBandStages,
+                                                            kBufferSizePackets, converterProfile(_filterProfile),
+                                                            channelGroups);
+        _output.resize(asbd->mChannelsPerFrame);
     } catch (const std::exception &e) {
-        os_log_error(gSFBAudioDecoderLog, "Error resizing _context: %{public}s", e.what());
+        os_log_error(gSFBAudioDecoderLog, "Error creating DSD to PCM converters: %{public}s", e.what());
         _buffer = nil;
         if (error != nullptr) {
             *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:ENOMEM userInfo:nil];
@@ -379,7 +237,8 @@ class DXD {
 
 - (BOOL)closeReturningError:(NSError **)error {
     _buffer = nil;
-    _context.clear();
+    _converter.reset();
+    _output.clear();
     return [_decoder closeReturningError:error];
 }
 
@@ -388,11 +247,11 @@ class DXD {
 }
 
 - (AVAudioFramePosition)framePosition {
-    return _decoder.packetPosition / kDSDPacketsPerPCMFrame;
+    return _decoder.packetPosition / _packetsPerFrame;
 }
 
 - (AVAudioFramePosition)frameLength {
-    return _decoder.packetCount / kDSDPacketsPerPCMFrame;
+    return _decoder.packetCount / _packetsPerFrame;
 }
 
 - (BOOL)decodeIntoBuffer:(AVAudioBuffer *)buffer error:(NSError **)error {
@@ -422,7 +281,7 @@ class DXD {
         AVAudioFrameCount framesRemaining = frameLength - framesRead;
 
         // Grab the DSD audio
-        AVAudioPacketCount dsdPacketsRemaining = framesRemaining * kDSDPacketsPerPCMFrame;
+        AVAudioPacketCount dsdPacketsRemaining = framesRemaining * _packetsPerFrame;
         if (![_decoder decodeIntoBuffer:_buffer
                             packetCount:std::min(_buffer.packetCapacity, dsdPacketsRemaining)
                                   error:error]) {
@@ -434,21 +293,22 @@ class DXD {
             break;
         }
 
-        AVAudioFrameCount framesDecoded = dsdPacketsDecoded / kDSDPacketsPerPCMFrame;
-
         // Convert to PCM
         // NB: Currently DSDIFFDecoder and DSFDecoder only produce interleaved output
 
+        // The half-band stages retain odd samples so the frame count never exceeds framesRemaining
         float *const *floatChannelData = buffer.floatChannelData;
         AVAudioChannelCount channelCount = buffer.format.channelCount;
+        for (AVAudioChannelCount channel = 0; channel < channelCount; ++channel) {
+            _output[channel] = floatChannelData[channel] + framesRead;
+        }
         const bool isBigEndian = (_buffer.format.streamDescription->mFormatFlags & kAudioFormatFlagIsBigEndian) ==
                                  kAudioFormatFlagIsBigEndian;
+        const auto framesDecoded = static_cast<AVAudioFrameCount>(_converter->convert(
+                dsdPacketsDecoded, static_cast<const unsigned char *>(_buffer.data), !isBigEndian, _output.data()));
+        // Boost signal by 6 dBFS
         for (AVAudioChannelCount channel = 0; channel < channelCount; ++channel) {
-            const auto *const input = static_cast<const unsigned char *>(_buffer.data) + channel;
-            float *output = floatChannelData[channel];
-            _context[channel].translate(framesDecoded, input, channelCount, !isBigEndian, output, 1);
-            // Boost signal by 6 dBFS
-            vDSP_vsmul(output, 1, &linearGain, output, 1, framesDecoded);
+            vDSP_vsmul(_output[channel], 1, &linearGain, _output[channel], 1, framesDecoded);
         }
 
         buffer.frameLength += framesDecoded;
@@ -471,13 +331,15 @@ class DXD {
 - (BOOL)seekToFrame:(AVAudioFramePosition)frame error:(NSError **)error {
     NSParameterAssert(frame >= 0);
 
-    if (![_decoder seekToPacket:(frame * kDSDPacketsPerPCMFrame) error:error]) {
+    if (![_decoder seekToPacket:(frame * _packetsPerFrame) error:error]) {
         return NO;
     }
 
     _buffer.packetCount = 0;
     _buffer.byteLength = 0;
 
+    _converter->reset();
+
     return YES;
 }
 
@@ -7,18 +7,20 @@
 
 #import "SFBDSFDecoder.h"
 
+#import "DSFBlockInterleaver.hpp"
 #import "NSData+SFBExtensions.h"
 #import "SFBCStringForOSType.h"
 #import "SFBLocalizedNameForURL.h"
 
 #import <os/log.h>
 
-#import <stdint.h>
+#import <cstdint>
+#import <memory>
+#import <new>
 
 SFBDSDDecoderName const SFBDSDDecoderNameDSF = @"org.sbooth.AudioEngine.DSDDecoder.DSF";
 
 #define DSF_BLOCK_SIZE_BYTES_PER_CHANNEL 4096
-#define MATRIX_TRANPOSE_BLOCK_SIZE 64
 
 // Read a four byte chunk ID as a uint32_t
 static BOOL readChunkID(SFBInputSource *inputSource, uint32_t *chunkID) {
@@ -36,28 +38,17 @@ static BOOL readChunkID(SFBInputSource *inputSource, uint32_t *chunkID) {
     return YES;
 }
 
-static void matrixTranspose(const unsigned char *restrict A, unsigned char *restrict B, size_t rows, size_t columns) {
-    for (size_t r = 0; r < rows; r += MATRIX_TRANPOSE_BLOCK_SIZE) {
-        for (size_t c = 0; c < columns; c += MATRIX_TRANPOSE_BLOCK_SIZE) {
-            size_t r_end = MIN(r + MATRIX_TRANPOSE_BLOCK_SIZE, rows);
-            size_t c_end = MIN(c + MATRIX_TRANPOSE_BLOCK_SIZE, columns);
-            for (size_t i = r; i < r_end; ++i) {
-                for (size_t j = c; j < c_end; ++j) {
-                    B[(j * rows) + i] = A[(i * columns) + j];
-                }
-            }
-        }
-    }
-}
-
 @interface SFBDSFDecoder () {
   @private
     AVAudioFramePosition _packetPosition;
     AVAudioFramePosition _packetCount;
     int64_t _audioOffset;
-    AVAudioCompressedBuffer *_buffer;
+    // The most recently read block, in file order
+    std::unique_ptr<unsigned char[]> _block;
+    // The number of packets in _block already consumed
+    AVAudioPacketCount _blockCursor;
 }
-- (BOOL)readAndInterleaveDSFBlockReturningError:(NSError **)error;
+- (BOOL)readDSFBlockReturningError:(NSError **)error;
 @end
 
 @implementation SFBDSFDecoder
@@ -328,22 +319,26 @@ static void matrixTranspose(const unsigned char *restrict A, unsigned char *rest
 
     // Metadata chunk is ignored
 
-    _buffer = [[AVAudioCompressedBuffer alloc]
-               initWithFormat:_processingFormat
-               packetCapacity:(DSF_BLOCK_SIZE_BYTES_PER_CHANNEL / kSFBBytesPerDSDPacketPerChannel)
-            maximumPacketSize:(kSFBBytesPerDSDPacketPerChannel * channelNum)];
-    _buffer.packetCount = 0;
+    _block.reset(new (std::nothrow) unsigned char[DSF_BLOCK_SIZE_BYTES_PER_CHANNEL * channelNum]);
+    if (!_block) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:ENOMEM userInfo:nil];
+        }
+        return NO;
+    }
+    // No block has been read
+    _blockCursor = DSF_BLOCK_SIZE_BYTES_PER_CHANNEL / kSFBBytesPerDSDPacketPerChannel;
 
     return YES;
 }
 
 - (BOOL)closeReturningError:(NSError **)error {
-    _buffer = nil;
+    _block.reset();
     return [super closeReturningError:error];
 }
 
 - (BOOL)isOpen {
-    return _buffer != nil;
+    return _block != nullptr;
 }
 
 - (AVAudioFramePosition)packetPosition {
@@ -371,45 +366,31 @@ static void matrixTranspose(const unsigned char *restrict A, unsigned char *rest
 
     AVAudioPacketCount packetsRemaining = (AVAudioPacketCount)(_packetCount - _packetPosition);
     AVAudioPacketCount packetsToRead = MIN(packetCount, packetsRemaining);
-    AVAudioPacketCount packetsProcessed = 0;
-
-    uint32_t packetSize = kSFBBytesPerDSDPacketPerChannel * _processingFormat.channelCount;
 
-    for (;;) {
-        AVAudioPacketCount packetsInBuffer = _buffer.packetCount;
-        AVAudioPacketCount packetsToCopy = MIN(packetsInBuffer, packetsToRead - packetsProcessed);
+    const AVAudioPacketCount packetsPerBlock = DSF_BLOCK_SIZE_BYTES_PER_CHANNEL / kSFBBytesPerDSDPacketPerChannel;
+    const AVAudioChannelCount channelCount = _processingFormat.channelCount;
+    const uint32_t packetSize = kSFBBytesPerDSDPacketPerChannel * channelCount;
 
-        // Copy data from the internal buffer to output
-        if (packetsToCopy) {
-            uint32_t copySize = packetsToCopy * packetSize;
-            memcpy((unsigned char *)buffer.data + (buffer.packetCount * packetSize), _buffer.data, copySize);
-            buffer.packetCount += packetsToCopy;
-            buffer.byteLength += copySize;
-
-            // Move remaining data in buffer to beginning
-            if (packetsToCopy != packetsInBuffer) {
-                unsigned char *dst = (unsigned char *)_buffer.data;
-                memmove(dst, dst + copySize, (packetsInBuffer - packetsToCopy) * packetSize);
+    while (buffer.packetCount < packetsToRead) {
+        // Read the next block once the current one is consumed
+        if (_blockCursor == packetsPerBlock) {
+            if (![self readDSFBlockReturningError:error]) {
+                return NO;
             }
-
-            _buffer.packetCount -= packetsToCopy;
-            _buffer.byteLength -= copySize;
-
-            packetsProcessed += packetsToCopy;
         }
 
-        // All requested packets were read
-        if (packetsProcessed == packetsToRead) {
-            break;
-        }
+        // Interleave directly from the block into the output
+        AVAudioPacketCount packetsToCopy = MIN(packetsPerBlock - _blockCursor, packetsToRead - buffer.packetCount);
+        sfb::dsf::interleave(_block.get() + _blockCursor, DSF_BLOCK_SIZE_BYTES_PER_CHANNEL,
+                             static_cast<int>(channelCount), packetsToCopy,
+                             static_cast<unsigned char *>(buffer.data) + buffer.byteLength);
 
-        // Read  the next block
-        if (![self readAndInterleaveDSFBlockReturningError:error]) {
-            return NO;
-        }
+        _blockCursor += packetsToCopy;
+        buffer.packetCount += packetsToCopy;
+        buffer.byteLength += packetsToCopy * packetSize;
     }
 
-    _packetPosition += packetsProcessed;
+    _packetPosition += buffer.packetCount;
 
     return YES;
 }
@@ -443,22 +424,12 @@ static void matrixTranspose(const unsigned char *restrict A, unsigned char *rest
         return NO;
     }
 
-    if (![self readAndInterleaveDSFBlockReturningError:error]) {
+    if (![self readDSFBlockReturningError:error]) {
         return NO;
     }
 
-    // Skip ahead in the interleaved audio to the specified packet
-    AVAudioPacketCount packetsInBuffer = _buffer.packetCount;
-    AVAudioPacketCount packetsToSkip = (AVAudioPacketCount)(packet % packetsInBuffer);
-    AVAudioPacketCount packetsToMove = packetsInBuffer - packetsToSkip;
-
-    // Move data
-    uint32_t packetSize = kSFBBytesPerDSDPacketPerChannel * _processingFormat.channelCount;
-    const unsigned char *src = (unsigned char *)_buffer.data + (packetsToSkip * packetSize);
-    memmove(_buffer.data, src, packetsToMove * packetSize);
-
-    _buffer.packetCount = packetsToMove;
-    _buffer.byteLength = packetsToMove * packetSize;
+    // Skip ahead in the block to the specified packet
+    _blockCursor = (AVAudioPacketCount)(packet % DSF_BLOCK_SIZE_BYTES_PER_CHANNEL);
 
     _packetPosition = packet;
 
@@ -466,15 +437,14 @@ static void matrixTranspose(const unsigned char *restrict A, unsigned char *rest
 }
 
 // Read input, grouped in DSF as 8 one-bit samples per frame (a single channel byte) in a block
-// of the specified block size (4096 bytes per channel for DSF version 1) for each channel,
-// then interleave the channel bytes into clustered frames.
+// of the specified block size (4096 bytes per channel for DSF version 1) for each channel.
 // The DSF blocks form a matrix with one row per channel and one column per channel byte.
 // For stereo, the data is arranged as 4096 L channel bytes followed by 4096 R channel bytes,
 // a 2 x 4096 matrix.
-// Interleaving is accomplished by matrix transposition.
-- (BOOL)readAndInterleaveDSFBlockReturningError:(NSError **)error {
-    unsigned char *buf = (unsigned char *)_buffer.data;
-    uint32_t bufsize = _buffer.byteCapacity;
+// The block is kept as read and columns are interleaved into clustered frames as they are consumed.
+- (BOOL)readDSFBlockReturningError:(NSError **)error {
+    unsigned char *buf = _block.get();
+    uint32_t bufsize = DSF_BLOCK_SIZE_BYTES_PER_CHANNEL * _processingFormat.channelCount;
 
     NSInteger bytesRead;
     if (![_inputSource readBytes:buf length:bufsize bytesRead:&bytesRead error:error]) {
@@ -497,15 +467,7 @@ static void matrixTranspose(const unsigned char *restrict A, unsigned char *rest
         return NO;
     }
 
-    // Deinterleave the blocks and interleave the samples into clustered frames
-    AVAudioChannelCount channelCount = _processingFormat.channelCount;
-    assert(channelCount != 0);
-    unsigned char tmp[bufsize];
-    matrixTranspose(buf, tmp, channelCount, DSF_BLOCK_SIZE_BYTES_PER_CHANNEL);
-    memcpy(buf, tmp, bufsize);
-
-    _buffer.packetCount = (AVAudioPacketCount)(bytesRead / (kSFBBytesPerDSDPacketPerChannel * channelCount));
-    _buffer.byteLength = (uint32_t)bytesRead;
+    _blockCursor = 0;
 
     return YES;
 }
@@ -11,20 +11,16 @@
 #import "SFBDSDDecoder.h"
 #import "SFBLocalizedNameForURL.h"
 
+#import "DoPPacker.hpp"
+
 #import <os/log.h>
 
-#import <stdint.h>
+#import <cstdint>
+#import <vector>
 
 #define DSD_PACKETS_PER_DOP_FRAME (16 / kSFBPCMFramesPerDSDPacket)
 #define BUFFER_SIZE_PACKETS 4096
 
-// Bit reversal lookup table from http://graphics.stanford.edu/~seander/bithacks.html#BitReverseTable
-static const unsigned char sBitReverseTable256[256] = {
-#define R2(n) n, n + 2 * 64, n + 1 * 64, n + 3 * 64
-#define R4(n) R2(n), R2(n + 2 * 16), R2(n + 1 * 16), R2(n + 3 * 16)
-#define R6(n) R4(n), R4(n + 2 * 4), R4(n + 1 * 4), R4(n + 3 * 4)
-        R6(0), R6(2), R6(1), R6(3)};
-
 // Support DSD64, DSD128, and DSD256 (64x, 128x, and 256x the CD sample rate of 44.1 kHz)
 // as well as the 48.0 kHz variants 6.144 MHz and 12.288 MHz
 static BOOL IsSupportedDoPSampleRate(Float64 sampleRate) {
@@ -45,6 +41,8 @@ static BOOL IsSupportedDoPSampleRate(Float64 sampleRate) {
     AVAudioCompressedBuffer *_buffer;
     unsigned char _marker;
     BOOL _reverseBits;
+    /// The destination of each channel for non-interleaved output
+    std::vector<unsigned char *> _planes;
 }
 @end
 
@@ -78,7 +76,7 @@ static BOOL IsSupportedDoPSampleRate(Float64 sampleRate) {
 
     if ((self = [super init])) {
         _decoder = decoder;
-        _marker = 0x05;
+        _marker = sfb::dop::initialMarker;
     }
     return self;
 }
@@ -155,19 +153,22 @@ static BOOL IsSupportedDoPSampleRate(Float64 sampleRate) {
 
     _reverseBits = (asbd->mFormatFlags & kAudioFormatFlagIsBigEndian) == 0;
 
-    // Generate non-interleaved 24-bit big endian output
+    // Generate 24-bit big endian output, non-interleaved unless packed frames were requested
     AudioStreamBasicDescription processingStreamDescription = {0};
 
     processingStreamDescription.mFormatID = kAudioFormatLinearPCM /*kSFBAudioFormatDoP*/;
-    processingStreamDescription.mFormatFlags = kAudioFormatFlagIsSignedInteger | kAudioFormatFlagIsPacked |
-                                               kAudioFormatFlagIsNonInterleaved | kAudioFormatFlagIsBigEndian;
+    processingStreamDescription.mFormatFlags =
+            kAudioFormatFlagIsSignedInteger | kAudioFormatFlagIsPacked | kAudioFormatFlagIsBigEndian;
+    if (!_interleavesOutput) {
+        processingStreamDescription.mFormatFlags |= kAudioFormatFlagIsNonInterleaved;
+    }
 
     processingStreamDescription.mSampleRate =
             asbd->mSampleRate / (kSFBPCMFramesPerDSDPacket * DSD_PACKETS_PER_DOP_FRAME);
     processingStreamDescription.mChannelsPerFrame = asbd->mChannelsPerFrame;
     processingStreamDescription.mBitsPerChannel = 24;
 
-    processingStreamDescription.mBytesPerPacket = 3;
+    processingStreamDescription.mBytesPerPacket = _interleavesOutput ? 3 * asbd->mChannelsPerFrame : 3;
     processingStreamDescription.mFramesPerPacket = 1;
     processingStreamDescription.mBytesPerFrame =
             processingStreamDescription.mBytesPerPacket / processingStreamDescription.mFramesPerPacket;
@@ -181,6 +182,8 @@ static BOOL IsSupportedDoPSampleRate(Float64 sampleRate) {
             maximumPacketSize:(kSFBBytesPerDSDPacketPerChannel * _decoder.processingFormat.channelCount)];
     _buffer.packetCount = 0;
 
+    _planes.resize(asbd->mChannelsPerFrame);
+
     return YES;
 }
 
@@ -244,31 +247,22 @@ static BOOL IsSupportedDoPSampleRate(Float64 sampleRate) {
 
         AVAudioFrameCount framesDecoded = dsdPacketsDecoded / DSD_PACKETS_PER_DOP_FRAME;
 
-        unsigned char marker = _marker;
-        AVAudioChannelCount channelCount = _processingFormat.channelCount;
-        for (AVAudioChannelCount channel = 0; channel < channelCount; ++channel) {
-            const unsigned char *input = (const unsigned char *)_buffer.data + channel;
-            unsigned char *output = (unsigned char *)buffer.audioBufferList->mBuffers[channel].mData +
-                                    buffer.audioBufferList->mBuffers[channel].mDataByteSize;
-
-            // The DoP marker should match across channels
-            marker = _marker;
-            for (AVAudioFrameCount i = 0; i < framesDecoded; ++i) {
-                // Insert the DoP marker
-                *output++ = marker;
-
-                // Copy the DSD bits
-                *output++ = _reverseBits ? sBitReverseTable256[*input] : *input;
-                input += channelCount;
-                *output++ = _reverseBits ? sBitReverseTable256[*input] : *input;
-                input += channelCount;
-
-                marker = marker == 0x05 ? 0xfa : 0x05;
+        const auto *dsd = static_cast<const unsigned char *>(_buffer.data);
+        const auto channelCount = static_cast<int>(_processingFormat.channelCount);
+        AudioBufferList *bufferList = buffer.audioBufferList;
+
+        if (_processingFormat.isInterleaved) {
+            auto *output = static_cast<unsigned char *>(bufferList->mBuffers[0].mData) +
+                           bufferList->mBuffers[0].mDataByteSize;
+            _marker = sfb::dop::packInterleaved(dsd, channelCount, framesDecoded, _reverseBits, _marker, output);
+        } else {
+            for (int channel = 0; channel < channelCount; ++channel) {
+                _planes[channel] = static_cast<unsigned char *>(bufferList->mBuffers[channel].mData) +
+                                   bufferList->mBuffers[channel].mDataByteSize;
             }
+            _marker = sfb::dop::packPlanar(dsd, channelCount, framesDecoded, _reverseBits, _marker, _planes.data());
         }
 
-        _marker = marker;
-
         buffer.frameLength += framesDecoded;
         framesRead += framesDecoded;
 
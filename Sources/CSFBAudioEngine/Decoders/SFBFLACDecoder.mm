@@ -6,8 +6,12 @@
 //
 
 #import "SFBFLACDecoder.h"
+#import "SFBAudioDecoder+Internal.h"
 
+#import "FLACFramePipeline.hpp"
 #import "NSData+SFBExtensions.h"
+#import "SFBAudioDecoder+FrameStage.h"
+#import "SFBAudioDecoder+SeekIndexCache.h"
 #import "SFBLocalizedNameForURL.h"
 
 #import <AVFAudioExtensions/AVFAudioExtensions.h>
@@ -19,10 +23,15 @@
 #import <os/log.h>
 
 #import <algorithm>
+#import <atomic>
 #import <cstdlib>
 #import <cstring>
+#import <deque>
+#import <exception>
 #import <memory>
+#import <new>
 #import <optional>
+#import <vector>
 
 #import <simd/simd.h>
 
@@ -48,6 +57,49 @@ struct flac__stream_decoder_deleter {
 
 using flac__stream_decoder_unique_ptr = std::unique_ptr<FLAC__StreamDecoder, flac__stream_decoder_deleter>;
 
+/// Whether `SFBFLACDecoder` decodes ranges of frames in parallel
+std::atomic_bool decodesFramesInParallel_ = false;
+
+/// The maximum number of threads decoding ranges of frames ahead of the consumer
+constexpr int kMaximumFLACDecodingThreads = 4;
+/// The target size in bytes of a range of frames decoded in parallel
+constexpr std::size_t kFLACRangeSize = 256 * 1024;
+/// The number of bytes read past the target size of a range to find the frame ending it
+constexpr std::size_t kFLACRangeLookahead = 64 * 1024;
+/// The size in bytes of the largest range of frames decoded in parallel
+constexpr std::size_t kMaximumFLACRangeSize = 16 * 1024 * 1024;
+/// The maximum number of frames in a range of frames decoded in parallel
+constexpr uint64_t kMaximumFLACRangeFrames = 128 * 1024;
+
+/// Seek points recorded while decoding are at least this many frames apart
+constexpr uint64_t kSeekIndexResolution = 16384;
+/// The format of cached seek indexes, whose points hold the offsets of FLAC frames
+constexpr uint32_t kSeekIndexCacheFormat = 0x464c4331; // 'FLC1'
+
+/// Returns the point ending a range of frames beginning at `frame` and `offset` using the seek points in
+/// `seekTable`, or `std::nullopt` if the next seek point is farther than a range may extend
+///
+/// The range ends at the first seek point at or after `kFLACRangeSize` bytes or at the last seek point within the
+/// limits on the size of a range.
+std::optional<sfb::SeekIndexPoint> seekTableRangeEnd(const std::vector<sfb::SeekIndexPoint> &seekTable,
+                                                     uint64_t frame, uint64_t offset) noexcept {
+    auto point = std::ranges::upper_bound(seekTable, frame, {}, &sfb::SeekIndexPoint::frame_);
+    if (point == seekTable.end() || point->offset_ <= offset) {
+        return std::nullopt;
+    }
+
+    std::optional<sfb::SeekIndexPoint> end;
+    for (; point != seekTable.end() && point->frame_ - frame <= kMaximumFLACRangeFrames &&
+           point->offset_ - offset <= kMaximumFLACRangeSize;
+         ++point) {
+        end = *point;
+        if (point->offset_ - offset >= kFLACRangeSize) {
+            break;
+        }
+    }
+    return end;
+}
+
 /// Returns an AVAudioChannelLayout for the given WAVE channel mask
 AVAudioChannelLayout *_Nullable channelLayoutFromWAVEMask(UInt32 dwChannelMask) noexcept {
     NSCParameterAssert(dwChannelMask != 0);
@@ -78,6 +130,13 @@ AVAudioChannelLayout *_Nullable channelLayoutFromWAVEMask(UInt32 dwChannelMask)
 
 } /* namespace */
 
+// When `decodesFramesInParallel` is set, the stream is split into ranges of frames, and ranges are decoded ahead of
+// the consumer by a pool of threads each with its own stream decoder. A range that does not decode cleanly to the
+// expected frames reverts decoding to a single stream decoder until the next seek.
+//
+// When `SFBAudioDecoder.seekIndexCacheDirectoryURL` is set, the offsets of frames in streams without a seek table are
+// recorded while decoding and cached once every frame has been decoded, so later seeks read from the nearest indexed
+// frame instead of searching the stream.
 @interface SFBFLACDecoder () {
   @private
     flac__stream_decoder_unique_ptr _flac;
@@ -85,10 +144,52 @@ AVAudioChannelLayout *_Nullable channelLayoutFromWAVEMask(UInt32 dwChannelMask)
     uint32_t _channelMask; /* from WAVEFORMATEXTENSIBLE_CHANNEL_MASK */
     AVAudioFramePosition _framePosition;
     std::optional<FLAC__FrameHeader> _previousFrameHeader;
-    AVAudioPCMBuffer *_frameBuffer; // For converting push to pull
+    /// Storage for frames not written directly to the caller's buffer, for converting push to pull
+    AVAudioPCMBuffer *_frameBuffer;
+    /// Decoded frames awaiting delivery
+    sfb::FrameStage _stagedFrames;
+    /// The caller's buffer while decoding sequentially, to which frames fitting in `_outputFrameLength` are written
+    AVAudioPCMBuffer *_outputBuffer;
+    /// The number of frames that may be written to `_outputBuffer`
+    AVAudioFrameCount _outputFrameLength;
     NSError *_writeError;
+    // Parallel decoding state
+    std::unique_ptr<sfb::FLACFramePipeline> _pipeline;
+    sfb::flac::StreamParameters _streamParameters;
+    /// Whether audio is delivered from `_pipeline` rather than `_flac`
+    BOOL _decodesInParallel;
+    /// The offset of the next range of frames to submit for decoding
+    int64_t _nextRangeOffset;
+    /// The first frame of the next range of frames to submit for decoding
+    uint64_t _nextRangeFrame;
+    /// The number of frames already consumed from the oldest decoded range
+    size_t _rangeFrameOffset;
+    /// The first frame and offset of each range in `_pipeline`, oldest first
+    std::deque<sfb::SeekIndexPoint> _submittedRanges;
+    // Seek index state
+    /// Whether the stream contains a SEEKTABLE metadata block
+    BOOL _hasSeekTable;
+    /// The valid points in the SEEKTABLE followed by the end of the stream, which end ranges decoded in parallel
+    std::vector<sfb::SeekIndexPoint> _seekTable;
+    /// Seek points read from the seek index cache or recorded while decoding
+    std::vector<sfb::SeekIndexPoint> _seekPoints;
+    /// Whether seek points are recorded while decoding
+    BOOL _buildsSeekIndex;
+    /// The first frame not indexed by `_seekPoints`, which index every earlier frame
+    uint64_t _seekIndexEnd;
 }
+/// Returns `YES` if FLAC frames may be read from the input at byte offsets
+@property(nonatomic, readonly) BOOL framesAreAddressable;
 - (BOOL)initializeFLACStreamDecoder:(FLAC__StreamDecoder *)decoder error:(NSError **)error;
+- (void)setUpParallelDecoding;
+- (void)resumeParallelDecoding;
+- (BOOL)decodeSequentiallyReturningError:(NSError **)error;
+- (BOOL)submitFLACRangesReturningError:(NSError **)error;
+- (void)popFLACRange;
+- (BOOL)seekUsingSeekIndexToFrame:(AVAudioFramePosition)frame;
+- (void)recordSeekPoint:(sfb::SeekIndexPoint)point frameLength:(uint64_t)frameLength;
+- (BOOL)loadCachedSeekIndex;
+- (void)cacheSeekIndex;
 - (FLAC__StreamDecoderWriteStatus)handleFLACWrite:(const FLAC__StreamDecoder *)decoder
                                             frame:(const FLAC__Frame *)frame
                                            buffer:(const FLAC__int32 *const[])buffer;
@@ -221,6 +322,14 @@ void errorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
     return SFBAudioDecoderNameFLAC;
 }
 
++ (BOOL)decodesFramesInParallel {
+    return decodesFramesInParallel_;
+}
+
++ (void)setDecodesFramesInParallel:(BOOL)decodesFramesInParallel {
+    decodesFramesInParallel_ = decodesFramesInParallel;
+}
+
 + (BOOL)testInputSource:(SFBInputSource *)inputSource
         formatIsSupported:(SFBTernaryTruthValue *)formatIsSupported
                     error:(NSError **)error {
@@ -407,10 +516,25 @@ void errorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
     _frameBuffer = [[AVAudioPCMBuffer alloc] initWithPCMFormat:_processingFormat
                                                  frameCapacity:_streamInfo->max_blocksize];
 
+    // Without a seek table a seek index is read from the cache or recorded while decoding for the cache
+    _seekIndexEnd = 0;
+    if (!_hasSeekTable && self.framesAreAddressable && _inputSource.supportsSeeking &&
+        _streamInfo->total_samples > 0 && SFBAudioDecoder.seekIndexCacheDirectoryURL != nil) {
+        _buildsSeekIndex = ![self loadCachedSeekIndex];
+    }
+
+    if (decodesFramesInParallel_) {
+        [self setUpParallelDecoding];
+    }
+
     return YES;
 }
 
 - (BOOL)closeReturningError:(NSError **)error {
+    _pipeline.reset();
+    _submittedRanges.clear();
+    _decodesInParallel = NO;
+
     if (_flac && !FLAC__stream_decoder_finish(_flac.get())) {
         os_log_info(gSFBAudioDecoderLog, "FLAC__stream_decoder_finish failed: %{public}s",
                     FLAC__stream_decoder_get_resolved_state_string(_flac.get()));
@@ -419,10 +543,16 @@ void errorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
     _flac.reset();
 
     _frameBuffer = nil;
+    _stagedFrames.clear();
     _streamInfo.reset();
     _channelMask = 0;
     _previousFrameHeader.reset();
 
+    _hasSeekTable = NO;
+    _seekTable.clear();
+    _seekPoints.clear();
+    _buildsSeekIndex = NO;
+
     return [super closeReturningError:error];
 }
 
@@ -450,12 +580,9 @@ void errorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
 
     auto framesRemaining = std::min(frameLength, buffer.frameCapacity);
     while (framesRemaining > 0) {
-        // Copy as much as possible from the internal frame buffer
-        if (_frameBuffer.frameLength > 0) {
-            const auto framesCopied = [buffer appendFromBuffer:_frameBuffer
-                                             readingFromOffset:0
-                                                   frameLength:framesRemaining];
-            [_frameBuffer trimAtOffset:0 frameLength:framesCopied];
+        // Copy as much as possible from the staged frames
+        if (!_stagedFrames.empty()) {
+            const auto framesCopied = sfb::appendStagedFrames(_stagedFrames, buffer, framesRemaining);
 
             framesRemaining -= framesCopied;
             _framePosition += framesCopied;
@@ -466,13 +593,81 @@ void errorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
             }
         }
 
+        if (_decodesInParallel) {
+            // Keep the pipeline full so ranges are decoded while earlier ranges are consumed
+            if (![self submitFLACRangesReturningError:error]) {
+                return NO;
+            }
+
+            // Decoding reverted to sequential while submitting ranges
+            if (!_decodesInParallel) {
+                continue;
+            }
+
+            // EOS reached
+            if (_pipeline->empty()) {
+                break;
+            }
+
+            if (const auto status = _pipeline->wait().status; status != sfb::FLACRangeDecoder::Status::success) {
+                os_log_info(gSFBAudioDecoderLog, "%{public}s FLAC frames at frame %lld, decoding sequentially",
+                            status == sfb::FLACRangeDecoder::Status::invalid ? "Invalid" : "Discontinuous",
+                            _framePosition);
+                if (![self decodeSequentiallyReturningError:error]) {
+                    return NO;
+                }
+                continue;
+            }
+
+            const auto &range = _pipeline->front();
+
+            // A seek using the seek index may begin past the end of the range at the seek point
+            if (_rangeFrameOffset >= range.frameLength()) {
+                _rangeFrameOffset -= range.frameLength();
+                [self popFLACRange];
+                continue;
+            }
+
+            const auto framesAvailable = range.frameLength() - _rangeFrameOffset;
+            const auto framesCopied =
+                    static_cast<AVAudioFrameCount>(std::min<size_t>(framesRemaining, framesAvailable));
+            // Decoded ranges hold high-aligned samples, as does the frame buffer
+            for (UInt32 channel = 0; channel < buffer.audioBufferList->mNumberBuffers; ++channel) {
+                std::memcpy(sfb::frameAddress(buffer, channel, buffer.frameLength),
+                            range.samples[channel].data() + _rangeFrameOffset, framesCopied * sizeof(uint32_t));
+            }
+            buffer.frameLength += framesCopied;
+
+            framesRemaining -= framesCopied;
+            _framePosition += framesCopied;
+            _rangeFrameOffset += framesCopied;
+
+            if (_rangeFrameOffset == range.frameLength()) {
+                [self popFLACRange];
+                _rangeFrameOffset = 0;
+            }
+
+            continue;
+        }
+
         // EOS reached
         if (FLAC__stream_decoder_get_state(_flac.get()) == FLAC__STREAM_DECODER_END_OF_STREAM) {
             break;
         }
 
-        // Decode the next FLAC frame
-        if (!FLAC__stream_decoder_process_single(_flac.get())) {
+        // The stream decoder is positioned at the start of the next frame
+        FLAC__uint64 offset = 0;
+        const bool recordsSeekPoint =
+                _buildsSeekIndex && FLAC__stream_decoder_get_decode_position(_flac.get(), &offset);
+
+        // Decode the next FLAC frame, directly into buffer if it fits
+        const auto bufferFrameLength = buffer.frameLength;
+        _outputBuffer = buffer;
+        _outputFrameLength = framesRemaining;
+        const auto result = FLAC__stream_decoder_process_single(_flac.get());
+        _outputBuffer = nil;
+
+        if (!result) {
             os_log_error(gSFBAudioDecoderLog, "FLAC__stream_decoder_process_single failed: %{public}s",
                          FLAC__stream_decoder_get_resolved_state_string(_flac.get()));
             if (error != nullptr) {
@@ -480,6 +675,17 @@ void errorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
             }
             return NO;
         }
+
+        // The frame position is the first frame decoded and the frames written to buffer are delivered
+        const auto framesDelivered = buffer.frameLength - bufferFrameLength;
+        if (const auto framesDecoded = framesDelivered + _stagedFrames.frameLength();
+            recordsSeekPoint && framesDecoded > 0) {
+            [self recordSeekPoint:sfb::SeekIndexPoint{static_cast<uint64_t>(_framePosition), offset}
+                      frameLength:framesDecoded];
+        }
+
+        framesRemaining -= framesDelivered;
+        _framePosition += framesDelivered;
     }
 
     return YES;
@@ -489,11 +695,23 @@ void errorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
     NSParameterAssert(frame >= 0);
     //    NSParameterAssert(frame <= _totalFrames);
 
+    if (static_cast<uint64_t>(frame) < _seekIndexEnd && [self seekUsingSeekIndexToFrame:frame]) {
+        return YES;
+    }
+
     // FLAC__stream_decoder_seek_absolute() may call the write callback with a partial frame.
     // To prevent losing audio clear the buffers before the seek request, not after.
-    _frameBuffer.frameLength = 0;
+    _stagedFrames.clear();
     _previousFrameHeader.reset();
 
+    // Ranges read ahead of the consumer moved the input, so any input buffered by the stream decoder is stale
+    if (_decodesInParallel) {
+        _pipeline->clear();
+        _submittedRanges.clear();
+        _rangeFrameOffset = 0;
+        FLAC__stream_decoder_flush(_flac.get());
+    }
+
     auto result = FLAC__stream_decoder_seek_absolute(_flac.get(), static_cast<FLAC__uint64>(frame));
 
     // Attempt to re-sync the stream if necessary
@@ -512,10 +730,18 @@ void errorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
     }
 
     // Manually set frame position if no audio was produced during the seek
-    if (_frameBuffer.frameLength == 0) {
+    if (_stagedFrames.empty()) {
         _framePosition = frame;
     }
 
+    if (_pipeline) {
+        [self resumeParallelDecoding];
+    }
+
+    return YES;
+}
+
+- (BOOL)framesAreAddressable {
     return YES;
 }
 
@@ -524,6 +750,10 @@ void errorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
         os_log_error(gSFBAudioDecoderLog,
                      "FLAC__stream_decoder_set_metadata_respond(FLAC__METADATA_TYPE_VORBIS_COMMENT) failed");
     }
+    if (!FLAC__stream_decoder_set_metadata_respond(decoder, FLAC__METADATA_TYPE_SEEKTABLE)) {
+        os_log_error(gSFBAudioDecoderLog,
+                     "FLAC__stream_decoder_set_metadata_respond(FLAC__METADATA_TYPE_SEEKTABLE) failed");
+    }
 
     auto status = FLAC__stream_decoder_init_stream(decoder, readCallback, seekCallback, tellCallback, lengthCallback,
                                                    eofCallback, writeCallback, metadataCallback, errorCallback,
@@ -540,6 +770,333 @@ void errorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
     return YES;
 }
 
+- (void)setUpParallelDecoding {
+    // Ranges of frames are read by offset, and a known length is needed to end the last range
+    if (!self.framesAreAddressable || !_inputSource.supportsSeeking || _streamInfo->total_samples == 0) {
+        return;
+    }
+
+    const auto processors = static_cast<int>(NSProcessInfo.processInfo.activeProcessorCount);
+    if (processors < 2) {
+        return;
+    }
+    const int threads = std::min(processors, kMaximumFLACDecodingThreads);
+
+    _streamParameters.minBlocksize = _streamInfo->min_blocksize;
+    _streamParameters.maxBlocksize = _streamInfo->max_blocksize;
+    _streamParameters.minFramesize = _streamInfo->min_framesize;
+    _streamParameters.maxFramesize = _streamInfo->max_framesize;
+    _streamParameters.sampleRate = _streamInfo->sample_rate;
+    _streamParameters.channels = _streamInfo->channels;
+    _streamParameters.bitsPerSample = _streamInfo->bits_per_sample;
+    _streamParameters.totalSamples = _streamInfo->total_samples;
+
+    try {
+        _pipeline = std::make_unique<sfb::FLACFramePipeline>(_streamParameters, threads, (2 * threads) + 1);
+    } catch (const std::exception &e) {
+        os_log_info(gSFBAudioDecoderLog, "Error creating FLAC frame pipeline, decoding sequentially: %{public}s",
+                    e.what());
+        return;
+    }
+
+    // Seek point offsets are relative to the first frame, at which the stream decoder is positioned. The last range
+    // ends at the end of the input.
+    FLAC__uint64 firstFrameOffset;
+    NSInteger length;
+    if (!_seekTable.empty() && FLAC__stream_decoder_get_decode_position(_flac.get(), &firstFrameOffset) &&
+        [_inputSource getLength:&length error:nil] &&
+        static_cast<uint64_t>(length) > firstFrameOffset + _seekTable.back().offset_) {
+        for (auto &point : _seekTable) {
+            point.offset_ += firstFrameOffset;
+        }
+        try {
+            _seekTable.push_back({_streamParameters.totalSamples, static_cast<uint64_t>(length)});
+        } catch (const std::bad_alloc &) {
+            _seekTable.clear();
+        }
+    } else {
+        _seekTable.clear();
+    }
+
+    [self resumeParallelDecoding];
+}
+
+- (void)resumeParallelDecoding {
+    // The stream decoder is positioned at the start of a frame following any staged audio
+    FLAC__uint64 offset;
+    if (!FLAC__stream_decoder_get_decode_position(_flac.get(), &offset)) {
+        os_log_info(gSFBAudioDecoderLog, "FLAC__stream_decoder_get_decode_position failed, decoding sequentially");
+        _decodesInParallel = NO;
+        return;
+    }
+
+    _nextRangeOffset = static_cast<int64_t>(offset);
+    _nextRangeFrame = static_cast<uint64_t>(_framePosition) + _stagedFrames.frameLength();
+    _rangeFrameOffset = 0;
+    _decodesInParallel = YES;
+}
+
+- (BOOL)decodeSequentiallyReturningError:(NSError **)error {
+    _pipeline->clear();
+    _submittedRanges.clear();
+    _rangeFrameOffset = 0;
+    _decodesInParallel = NO;
+
+    // Resume the stream decoder at the first frame not yet delivered; ranges read ahead moved the input
+    _stagedFrames.clear();
+    _previousFrameHeader.reset();
+    if (!FLAC__stream_decoder_flush(_flac.get()) ||
+        !FLAC__stream_decoder_seek_absolute(_flac.get(), static_cast<FLAC__uint64>(_framePosition))) {
+        os_log_error(gSFBAudioDecoderLog, "Error resuming sequential FLAC decoding: %{public}s",
+                     FLAC__stream_decoder_get_resolved_state_string(_flac.get()));
+        if (error != nullptr) {
+            *error = [self genericDecodingError];
+        }
+        return NO;
+    }
+
+    return YES;
+}
+
+- (BOOL)submitFLACRangesReturningError:(NSError **)error {
+    const auto totalFrames = _streamParameters.totalSamples;
+    if (_nextRangeFrame >= totalFrames || !_pipeline->canSubmit()) {
+        return YES;
+    }
+
+    if (![_inputSource seekToOffset:_nextRangeOffset error:error]) {
+        return NO;
+    }
+
+    while (_nextRangeFrame < totalFrames && _pipeline->canSubmit()) {
+        std::size_t size = 0;
+        std::size_t rangeSize = 0;
+        uint64_t endFrame = 0;
+
+        // Seek points locate frames without scanning, so ranges end at seek points when they are close enough
+        if (const auto end = seekTableRangeEnd(_seekTable, _nextRangeFrame, static_cast<uint64_t>(_nextRangeOffset));
+            end) {
+            rangeSize = static_cast<std::size_t>(end->offset_ - static_cast<uint64_t>(_nextRangeOffset));
+            endFrame = end->frame_;
+
+            unsigned char *data;
+            try {
+                data = _pipeline->prepare(rangeSize);
+            } catch (const std::bad_alloc &) {
+                if (error != nullptr) {
+                    *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:ENOMEM userInfo:nil];
+                }
+                return NO;
+            }
+
+            NSInteger bytesRead;
+            if (![_inputSource readBytes:data
+                                  length:static_cast<NSInteger>(rangeSize)
+                               bytesRead:&bytesRead
+                                   error:error]) {
+                os_log_error(gSFBAudioDecoderLog, "Error reading FLAC frames at offset %lld", _nextRangeOffset);
+                return NO;
+            }
+            if (static_cast<std::size_t>(bytesRead) != rangeSize) {
+                os_log_info(gSFBAudioDecoderLog, "Missing FLAC frames after offset %lld, decoding sequentially",
+                            _nextRangeOffset);
+                return [self decodeSequentiallyReturningError:error];
+            }
+            size = rangeSize;
+        } else {
+            // Otherwise read past the target size until a frame ending the range is found
+            for (auto capacity = kFLACRangeSize + kFLACRangeLookahead;; capacity *= 2) {
+                if (capacity > kMaximumFLACRangeSize) {
+                    os_log_info(gSFBAudioDecoderLog,
+                                "No FLAC frame found in %zu bytes at offset %lld, decoding sequentially", size,
+                                _nextRangeOffset);
+                    return [self decodeSequentiallyReturningError:error];
+                }
+
+                unsigned char *data;
+                try {
+                    data = _pipeline->prepare(capacity);
+                } catch (const std::bad_alloc &) {
+                    if (error != nullptr) {
+                        *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:ENOMEM userInfo:nil];
+                    }
+                    return NO;
+                }
+
+                NSInteger bytesRead;
+                if (![_inputSource readBytes:data + size
+                                      length:static_cast<NSInteger>(capacity - size)
+                                   bytesRead:&bytesRead
+                                       error:error]) {
+                    os_log_error(gSFBAudioDecoderLog, "Error reading FLAC frames at offset %lld", _nextRangeOffset);
+                    return NO;
+                }
+                size += static_cast<std::size_t>(bytesRead);
+                const bool atEOF = size < capacity && _inputSource.atEOF;
+
+                // The last range runs to the end of the input
+                if (atEOF && totalFrames - _nextRangeFrame <= kMaximumFLACRangeFrames) {
+                    rangeSize = size;
+                    endFrame = totalFrames;
+                    break;
+                }
+
+                sfb::flac::FrameHeader header;
+                rangeSize = sfb::flac::findRangeEnd(data, size, _streamParameters, _nextRangeFrame, kFLACRangeSize,
+                                                    kMaximumFLACRangeFrames, header);
+                if (rangeSize != size) {
+                    endFrame = sfb::flac::firstSample(header, _streamParameters);
+                    break;
+                }
+
+                if (atEOF) {
+                    os_log_info(gSFBAudioDecoderLog, "Missing FLAC frames after offset %lld, decoding sequentially",
+                                _nextRangeOffset);
+                    return [self decodeSequentiallyReturningError:error];
+                }
+            }
+        }
+
+        try {
+            _submittedRanges.push_back({_nextRangeFrame, static_cast<uint64_t>(_nextRangeOffset)});
+        } catch (const std::bad_alloc &) {
+            if (error != nullptr) {
+                *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:ENOMEM userInfo:nil];
+            }
+            return NO;
+        }
+
+        _pipeline->submit(rangeSize, _nextRangeFrame, endFrame);
+        _nextRangeOffset += static_cast<int64_t>(rangeSize);
+        _nextRangeFrame = endFrame;
+
+        if (rangeSize != size && ![_inputSource seekToOffset:_nextRangeOffset error:error]) {
+            return NO;
+        }
+    }
+
+    return YES;
+}
+
+- (void)popFLACRange {
+    [self recordSeekPoint:_submittedRanges.front() frameLength:_pipeline->front().frameLength()];
+    _submittedRanges.pop_front();
+    _pipeline->pop();
+}
+
+- (BOOL)seekUsingSeekIndexToFrame:(AVAudioFramePosition)frame {
+    const auto target = static_cast<uint64_t>(frame);
+    const auto entry = std::ranges::upper_bound(_seekPoints, target, {}, &sfb::SeekIndexPoint::frame_);
+    if (entry == std::begin(_seekPoints)) {
+        return NO;
+    }
+    const auto point = *std::prev(entry);
+
+    _stagedFrames.clear();
+    _previousFrameHeader.reset();
+
+    // Ranges are read by offset so decoding in parallel resumes at the seek point with no input read
+    if (_pipeline) {
+        _pipeline->clear();
+        _submittedRanges.clear();
+        FLAC__stream_decoder_flush(_flac.get());
+        _nextRangeOffset = static_cast<int64_t>(point.offset_);
+        _nextRangeFrame = point.frame_;
+        _rangeFrameOffset = static_cast<size_t>(target - point.frame_);
+        _framePosition = frame;
+        _decodesInParallel = YES;
+        return YES;
+    }
+
+    // Otherwise the stream decoder resumes at the seek point and decodes forward to the frame containing the target
+    if (!FLAC__stream_decoder_flush(_flac.get()) ||
+        ![_inputSource seekToOffset:static_cast<NSInteger>(point.offset_) error:nil]) {
+        return NO;
+    }
+
+    for (bool atSeekPoint = true;; atSeekPoint = false) {
+        _stagedFrames.clear();
+        if (!FLAC__stream_decoder_process_single(_flac.get()) || _stagedFrames.empty()) {
+            os_log_info(gSFBAudioDecoderLog, "Error decoding FLAC frames from seek point for frame %llu",
+                        point.frame_);
+            return NO;
+        }
+        if (atSeekPoint && static_cast<uint64_t>(_framePosition) != point.frame_) {
+            os_log_info(gSFBAudioDecoderLog, "FLAC seek point for frame %llu is incorrect", point.frame_);
+            return NO;
+        }
+        if (static_cast<uint64_t>(_framePosition) + _stagedFrames.frameLength() > target) {
+            break;
+        }
+    }
+
+    _stagedFrames.skip(static_cast<size_t>(frame - _framePosition));
+    _framePosition = frame;
+
+    return YES;
+}
+
+- (void)recordSeekPoint:(sfb::SeekIndexPoint)point frameLength:(uint64_t)frameLength {
+    if (!_buildsSeekIndex || point.frame_ != _seekIndexEnd) {
+        return;
+    }
+
+    if (_seekPoints.empty() || point.frame_ - _seekPoints.back().frame_ >= kSeekIndexResolution) {
+        _seekPoints.push_back(point);
+    }
+    _seekIndexEnd += frameLength;
+
+    if (_seekIndexEnd >= _streamInfo->total_samples) {
+        _buildsSeekIndex = NO;
+        [self cacheSeekIndex];
+    }
+}
+
+- (BOOL)loadCachedSeekIndex {
+    const auto key = sfb::seekIndexCacheKey(_inputSource.url);
+    if (!key) {
+        return NO;
+    }
+
+    try {
+        const auto entry = key->cache_.find(key->identity_, kSeekIndexCacheFormat, 0);
+        if (!entry || entry->index().frameLength() != _streamInfo->total_samples) {
+            return NO;
+        }
+
+        const auto &index = entry->index();
+        std::vector<sfb::SeekIndexPoint> points(index.count());
+        for (size_t i = 0; i < points.size(); ++i) {
+            points[i] = index.point(i);
+        }
+        _seekPoints = std::move(points);
+        _seekIndexEnd = _streamInfo->total_samples;
+        return YES;
+    } catch (const std::exception &e) {
+        os_log_error(gSFBAudioDecoderLog, "Error reading cached FLAC seek index: %{public}s", e.what());
+        return NO;
+    }
+}
+
+- (void)cacheSeekIndex {
+    const auto key = sfb::seekIndexCacheKey(_inputSource.url);
+    if (!key) {
+        return;
+    }
+
+    try {
+        sfb::SeekIndexBuilder index{kSeekIndexCacheFormat, 0};
+        for (const auto &point : _seekPoints) {
+            index.append(point, nullptr);
+        }
+        if (!key->cache_.store(key->identity_, index, _streamInfo->total_samples)) {
+            os_log_error(gSFBAudioDecoderLog, "Error caching FLAC seek index");
+        }
+    } catch (const std::exception &e) {
+        os_log_error(gSFBAudioDecoderLog, "Error caching FLAC seek index: %{public}s", e.what());
+    }
+}
+
 - (FLAC__StreamDecoderWriteStatus)handleFLACWrite:(const FLAC__StreamDecoder *)decoder
                                             frame:(const FLAC__Frame *)frame
                                            buffer:(const FLAC__int32 *const[])buffer {
@@ -569,7 +1126,7 @@ void errorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
                     unsupportedFormatError:NSLocalizedString(@"FLAC", @"")
                         recoverySuggestion:NSLocalizedString(@"Changes in channel count are not supported.", @"")];
 
-            _frameBuffer.frameLength = 0;
+            _stagedFrames.clear();
             return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
         }
 
@@ -582,7 +1139,7 @@ void errorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
                     [self unsupportedFormatError:NSLocalizedString(@"FLAC", @"")
                               recoverySuggestion:NSLocalizedString(@"Changes in sample rate are not supported.", @"")];
 
-            _frameBuffer.frameLength = 0;
+            _stagedFrames.clear();
             return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
         }
 
@@ -599,7 +1156,7 @@ void errorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
                     recoverySuggestion:NSLocalizedString(@"Channel count mismatch between STREAMINFO and frame header.",
                                                          @"")];
 
-        _frameBuffer.frameLength = 0;
+        _stagedFrames.clear();
         return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
     }
 
@@ -609,8 +1166,14 @@ void errorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
 #endif /* DEBUG */
     _framePosition = frame->header.number.sample_number;
 
+    // Frames fitting in the caller's buffer are written there, and otherwise staged
+    const bool direct =
+            _outputBuffer != nil && _stagedFrames.canDeliverDirectly(frame->header.blocksize, _outputFrameLength);
+    AVAudioPCMBuffer *output = direct ? _outputBuffer : _frameBuffer;
+    const auto outputOffset = direct ? _outputBuffer.frameLength : 0;
+
     // FLAC hands us 32-bit signed integers with the samples low-aligned
-    if (const auto *abl = _frameBuffer.audioBufferList; frame->header.bits_per_sample != 32) [[likely]] {
+    if (frame->header.bits_per_sample != 32) [[likely]] {
         // Shift the samples to high alignment
         const auto shift = 32 - frame->header.bits_per_sample;
         const auto channels = frame->header.channels;
@@ -622,7 +1185,7 @@ void errorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
             using simd_packed_vector = simd_packed_uint16;
             constexpr uint32_t simd_vector_size = 16;
 
-            uint32_t *__restrict dst = static_cast<uint32_t *>(abl->mBuffers[channel].mData);
+            uint32_t *__restrict dst = static_cast<uint32_t *>(sfb::frameAddress(output, channel, outputOffset));
             const FLAC__int32 *__restrict src = buffer[channel];
 
             uint32_t sample = 0;
@@ -640,11 +1203,16 @@ void errorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
         }
     } else {
         for (uint32_t channel = 0; channel < frame->header.channels; ++channel) {
-            memcpy(abl->mBuffers[channel].mData, buffer[channel], frame->header.blocksize * sizeof(FLAC__int32));
+            memcpy(sfb::frameAddress(output, channel, outputOffset), buffer[channel],
+                   frame->header.blocksize * sizeof(FLAC__int32));
         }
     }
 
-    _frameBuffer.frameLength = frame->header.blocksize;
+    if (direct) {
+        _outputBuffer.frameLength += frame->header.blocksize;
+    } else {
+        sfb::stageFrames(_stagedFrames, _frameBuffer, frame->header.blocksize);
+    }
     _previousFrameHeader = frame->header;
 
     return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
@@ -655,6 +1223,27 @@ void errorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
 
     if (metadata->type == FLAC__METADATA_TYPE_STREAMINFO) {
         _streamInfo = metadata->data.stream_info;
+    } else if (metadata->type == FLAC__METADATA_TYPE_SEEKTABLE) {
+        _hasSeekTable = metadata->data.seek_table.num_points > 0;
+        // Keep the points that are usable as range boundaries: placeholders are skipped and frames and offsets must
+        // increase. Offsets are relative to the first frame until parallel decoding is set up.
+        _seekTable.clear();
+        try {
+            for (FLAC__uint32 i = 0; i < metadata->data.seek_table.num_points; ++i) {
+                const auto &point = metadata->data.seek_table.points[i];
+                if (point.sample_number == FLAC__STREAM_METADATA_SEEKPOINT_PLACEHOLDER || point.frame_samples == 0 ||
+                    (_streamInfo && point.sample_number >= _streamInfo->total_samples)) {
+                    continue;
+                }
+                if (!_seekTable.empty() && (point.sample_number <= _seekTable.back().frame_ ||
+                                            point.stream_offset <= _seekTable.back().offset_)) {
+                    continue;
+                }
+                _seekTable.push_back({point.sample_number, point.stream_offset});
+            }
+        } catch (const std::bad_alloc &) {
+            _seekTable.clear();
+        }
     } else if (metadata->type == FLAC__METADATA_TYPE_VORBIS_COMMENT) {
         for (FLAC__uint32 i = 0; i < metadata->data.vorbis_comment.num_comments; ++i) {
             // Look for a channel mask; see https://www.ietf.org/rfc/rfc9639.html#channel-mask
@@ -685,6 +1274,10 @@ void errorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
 
 @end
 
+// An SFBAudioDecoder subclass supporting Ogg FLAC
+@interface SFBOggFLACDecoder : SFBFLACDecoder
+@end
+
 @implementation SFBOggFLACDecoder
 
 + (void)load {
@@ -745,4 +1338,9 @@ void errorCallback(const FLAC__StreamDecoder *decoder, FLAC__StreamDecoderErrorS
     return YES;
 }
 
+- (BOOL)framesAreAddressable {
+    // Ogg pages interleave framing with the FLAC frames
+    return NO;
+}
+
 @end
@@ -1,16 +0,0 @@
-//
-// SPDX-FileCopyrightText: 2006 Stephen F. Booth <contact@sbooth.dev>
-// SPDX-License-Identifier: MIT
-//
-// Part of https://github.com/sbooth/SFBAudioEngine
-//
-
-#import "SFBAudioDecoder+Internal.h"
-
-NS_ASSUME_NONNULL_BEGIN
-
-// An SFBAudioDecoder subclass supporting MPEG1
-@interface SFBMPEGDecoder : SFBAudioDecoder
-@end
-
-NS_ASSUME_NONNULL_END
@@ -6,7 +6,11 @@
 //
 
 #import "SFBMPEGDecoder.h"
+#import "SFBAudioDecoder+Internal.h"
 
+#import "MPEGInfoFrame.hpp"
+#import "SFBAudioDecoder+FrameStage.h"
+#import "SFBAudioDecoder+SeekIndexCache.h"
 #import "SFBLocalizedNameForURL.h"
 
 #import <AVFAudioExtensions/AVFAudioExtensions.h>
@@ -14,8 +18,67 @@
 
 #import <os/log.h>
 
+#import <atomic>
+#import <exception>
+#import <memory>
+#import <vector>
+
 SFBAudioDecoderName const SFBAudioDecoderNameMPEG = @"org.sbooth.AudioEngine.Decoder.MPEG";
 
+namespace {
+
+/// Whether `SFBMPEGDecoder` builds frame indexes in the background
+std::atomic_bool buildsFrameIndexInBackground_ = false;
+
+/// The number of bytes following any ID3v2 tag searched for the first frame
+constexpr NSInteger kFirstFrameSearchSize = 8192;
+/// The number of entries in a frame index built in the background
+constexpr long kFrameIndexSize = 8192;
+/// The format of cached frame indexes, whose points are the evenly spaced entries of an mpg123 frame index
+constexpr uint32_t kFrameIndexCacheFormat = 0x4d504731; // 'MPG1'
+
+/// A frame index built by a separate decoder
+struct BackgroundFrameIndex {
+    /// The offsets of every `step_` frames, which may only be accessed by the building decoder until `complete_` is set
+    std::vector<int64_t> offsets_;
+    /// The number of frames between offsets
+    int64_t step_{0};
+    /// The exact length of the stream in frames
+    AVAudioFramePosition frameLength_{SFBUnknownFrameLength};
+    /// Whether the index is complete
+    std::atomic_bool complete_ = false;
+    /// Whether building the index should stop
+    std::atomic_bool cancelled_ = false;
+};
+
+} /* namespace */
+
+// Opening does not scan the stream. The length is read from a Xing, Info or VBRI frame, less any encoder delay and
+// padding given by a LAME extension, or otherwise estimated from the bitrate; it becomes exact once decoding reaches
+// the end of the stream. Seeking reads frame headers forward from the nearest known frame, extending the frame index.
+// Complete frame indexes and exact lengths are cached when `SFBAudioDecoder.seekIndexCacheDirectoryURL` is set.
+// When `buildsFrameIndexInBackground` is set, seekable files are also scanned on a background queue.
+@interface SFBMPEGDecoder () {
+  @private
+    mpg123_handle *_mpg123;
+    AVAudioFramePosition _framePosition;
+    /// The length given by an info frame or found by decoding to the end, or `SFBUnknownFrameLength`
+    AVAudioFramePosition _frameLength;
+    /// Decoded frames awaiting delivery, staged in mpg123's output buffer
+    sfb::FrameStage _stagedFrames;
+    /// Whether this decoder only builds a frame index and produces no audio
+    bool _isFrameIndexer;
+    std::shared_ptr<BackgroundFrameIndex> _backgroundFrameIndex;
+    /// Whether the frame index was read from or written to the seek index cache
+    bool _frameIndexIsCached;
+}
+- (BOOL)readInfoFrameLength:(AVAudioFramePosition *)frameLength error:(NSError **)error;
+- (void)buildFrameIndexInBackground;
+- (void)adoptBackgroundFrameIndex;
+- (BOOL)loadCachedFrameIndex;
+- (void)cacheFrameIndex;
+@end
+
 // ========================================
 // Callbacks
 static int read_callback(void *iohandle, void *ptr, size_t size, size_t *read) {
@@ -23,6 +86,11 @@ static int read_callback(void *iohandle, void *ptr, size_t size, size_t *read) {
 
     SFBMPEGDecoder *decoder = (__bridge SFBMPEGDecoder *)iohandle;
 
+    // Fail reads to stop a cancelled scan
+    if (decoder->_isFrameIndexer && decoder->_backgroundFrameIndex->cancelled_) {
+        return -1;
+    }
+
     NSInteger bytesRead;
     if (![decoder->_inputSource readBytes:ptr length:(NSInteger)size bytesRead:&bytesRead error:nil]) {
         return -1;
@@ -128,14 +196,6 @@ static BOOL contains_mp3_sync_word_and_minimal_valid_frame_header(const unsigned
     return NO;
 }
 
-@interface SFBMPEGDecoder () {
-  @private
-    mpg123_handle *_mpg123;
-    AVAudioFramePosition _framePosition;
-    AVAudioPCMBuffer *_buffer;
-}
-@end
-
 @implementation SFBMPEGDecoder
 
 + (void)load {
@@ -154,6 +214,14 @@ static BOOL contains_mp3_sync_word_and_minimal_valid_frame_header(const unsigned
     return SFBAudioDecoderNameMPEG;
 }
 
++ (BOOL)buildsFrameIndexInBackground {
+    return buildsFrameIndexInBackground_;
+}
+
++ (void)setBuildsFrameIndexInBackground:(BOOL)buildsFrameIndexInBackground {
+    buildsFrameIndexInBackground_ = buildsFrameIndexInBackground;
+}
+
 + (BOOL)testInputSource:(SFBInputSource *)inputSource
         formatIsSupported:(SFBTernaryTruthValue *)formatIsSupported
                     error:(NSError **)error {
@@ -247,6 +315,12 @@ static BOOL contains_mp3_sync_word_and_minimal_valid_frame_header(const unsigned
         return NO;
     }
 
+    // The length is read from an info frame if present, avoiding a scan of the entire stream
+    _frameLength = SFBUnknownFrameLength;
+    if (_inputSource.supportsSeeking && ![self readInfoFrameLength:&_frameLength error:error]) {
+        return NO;
+    }
+
     _mpg123 = mpg123_new(NULL, NULL);
 
     if (!_mpg123) {
@@ -259,6 +333,9 @@ static BOOL contains_mp3_sync_word_and_minimal_valid_frame_header(const unsigned
     // Force decode to floating point instead of 16-bit signed integer
     mpg123_param2(_mpg123, MPG123_FLAGS, MPG123_FORCE_FLOAT | MPG123_SKIP_ID3V2 | MPG123_GAPLESS | MPG123_QUIET, 0);
     mpg123_param2(_mpg123, MPG123_RESYNC_LIMIT, 2048, 0);
+    if (_isFrameIndexer) {
+        mpg123_param2(_mpg123, MPG123_INDEX_SIZE, kFrameIndexSize, 0);
+    }
 
     if (mpg123_reader64(_mpg123, read_callback, _inputSource.supportsSeeking ? lseek_callback : NULL, NULL) !=
         MPG123_OK) {
@@ -347,19 +424,15 @@ static BOOL contains_mp3_sync_word_and_minimal_valid_frame_header(const unsigned
     _sourceFormat = [[AVAudioFormat alloc] initWithStreamDescription:&sourceStreamDescription
                                                        channelLayout:channelLayout];
 
-    if (_inputSource.supportsSeeking && mpg123_scan(_mpg123) != MPG123_OK) {
-        mpg123_close(_mpg123);
-        mpg123_delete(_mpg123);
-        _mpg123 = NULL;
+    _stagedFrames.clear();
 
-        if (error) {
-            *error = [self invalidFormatError:NSLocalizedString(@"MP3", @"")];
-        }
-        return NO;
+    // A cached frame index gives the exact length and makes scanning unnecessary
+    _frameIndexIsCached = false;
+    if (!_isFrameIndexer && _inputSource.supportsSeeking && ![self loadCachedFrameIndex] &&
+        buildsFrameIndexInBackground_ && _inputSource.url.isFileURL) {
+        [self buildFrameIndexInBackground];
     }
 
-    _buffer = [[AVAudioPCMBuffer alloc] initWithPCMFormat:_processingFormat frameCapacity:framesPerMPEGFrame];
-
     return YES;
 }
 
@@ -369,7 +442,12 @@ static BOOL contains_mp3_sync_word_and_minimal_valid_frame_header(const unsigned
         mpg123_delete(_mpg123);
         _mpg123 = NULL;
     }
-    _buffer = nil;
+    _stagedFrames.clear();
+
+    if (_backgroundFrameIndex && !_isFrameIndexer) {
+        _backgroundFrameIndex->cancelled_ = true;
+        _backgroundFrameIndex.reset();
+    }
 
     return [super closeReturningError:error];
 }
@@ -383,6 +461,11 @@ static BOOL contains_mp3_sync_word_and_minimal_valid_frame_header(const unsigned
 }
 
 - (AVAudioFramePosition)frameLength {
+    if (_frameLength != SFBUnknownFrameLength) {
+        return _frameLength;
+    }
+
+    // Otherwise mpg123 estimates the length from the input length and bitrate
     int64_t length = mpg123_length64(_mpg123);
     if (length == MPG123_ERR) {
         return SFBUnknownFrameLength;
@@ -402,19 +485,13 @@ static BOOL contains_mp3_sync_word_and_minimal_valid_frame_header(const unsigned
         return YES;
     }
 
-    AVAudioFrameCount framesProcessed = 0;
+    [self adoptBackgroundFrameIndex];
 
     for (;;) {
-        AVAudioFrameCount framesRemaining = frameLength - framesProcessed;
-        AVAudioFrameCount framesCopied = [buffer appendFromBuffer:_buffer
-                                                readingFromOffset:0
-                                                      frameLength:framesRemaining];
-        [_buffer trimAtOffset:0 frameLength:framesCopied];
-
-        framesProcessed += framesCopied;
+        sfb::appendStagedFrames(_stagedFrames, buffer, frameLength - buffer.frameLength);
 
         // All requested frames were read
-        if (framesProcessed == frameLength) {
+        if (buffer.frameLength == frameLength) {
             break;
         }
 
@@ -425,6 +502,13 @@ static BOOL contains_mp3_sync_word_and_minimal_valid_frame_header(const unsigned
         int result = mpg123_decode_frame(_mpg123, &frameNumber, &audioData, &bytesDecoded);
         // EOS
         if (result == MPG123_DONE) {
+            // The length in an info frame may be wrong and an estimated length usually is
+            _frameLength = _framePosition + buffer.frameLength;
+            // mpg123 indexes frames as they are read so the index now covers the stream; a background index caches
+            // itself
+            if (!_frameIndexIsCached && !_backgroundFrameIndex) {
+                [self cacheFrameIndex];
+            }
             break;
         }
         if (result != MPG123_OK) {
@@ -435,11 +519,14 @@ static BOOL contains_mp3_sync_word_and_minimal_valid_frame_header(const unsigned
             return NO;
         }
 
-        memcpy(_buffer.audioBufferList->mBuffers[0].mData, audioData, bytesDecoded);
-        _buffer.frameLength = (AVAudioFrameCount)(bytesDecoded / (_buffer.stride * sizeof(float)));
+        // The decoded frame remains in mpg123's output buffer until the next is decoded, so it is staged in place and
+        // copied once, to buffer
+        const void *buffers[] = {audioData};
+        const size_t bytesPerFrame = _processingFormat.streamDescription->mBytesPerFrame;
+        _stagedFrames.stage(buffers, 1, bytesPerFrame, bytesDecoded / bytesPerFrame);
     }
 
-    _framePosition += framesProcessed;
+    _framePosition += buffer.frameLength;
 
     return YES;
 }
@@ -447,6 +534,10 @@ static BOOL contains_mp3_sync_word_and_minimal_valid_frame_header(const unsigned
 - (BOOL)seekToFrame:(AVAudioFramePosition)frame error:(NSError **)error {
     NSParameterAssert(frame >= 0);
 
+    [self adoptBackgroundFrameIndex];
+
+    // Frames past the end of mpg123's frame index are reached by reading frame headers from its last entry, which
+    // extends the index
     off_t offset = mpg123_seek(_mpg123, frame, SEEK_SET);
     if (offset < 0) {
         os_log_error(gSFBAudioDecoderLog, "mpg123 seek error");
@@ -457,9 +548,181 @@ static BOOL contains_mp3_sync_word_and_minimal_valid_frame_header(const unsigned
     }
 
     _framePosition = offset;
-    _buffer.frameLength = 0;
+    _stagedFrames.clear();
 
     return offset >= 0;
 }
 
+- (BOOL)readInfoFrameLength:(AVAudioFramePosition *)frameLength error:(NSError **)error {
+    NSParameterAssert(frameLength != NULL);
+
+    NSInteger originalOffset;
+    if (![_inputSource getOffset:&originalOffset error:error] || ![_inputSource seekToOffset:0 error:error]) {
+        return NO;
+    }
+
+    unsigned char buf[kFirstFrameSearchSize];
+    NSInteger len;
+    if (![_inputSource readBytes:buf length:sizeof buf bytesRead:&len error:error]) {
+        return NO;
+    }
+
+    // Skip an ID3v2 tag
+    if (len >= 10 && is_id3v2_tag_header(buf)) {
+        if (![_inputSource seekToOffset:id3v2_tag_total_size(buf) error:error] ||
+            ![_inputSource readBytes:buf length:sizeof buf bytesRead:&len error:error]) {
+            return NO;
+        }
+    }
+
+    sfb::mpeg::FrameHeader header;
+    const auto size = static_cast<std::size_t>(len);
+    if (const auto offset = sfb::mpeg::findFrame(buf, size, header); offset < size) {
+        if (const auto info = sfb::mpeg::parseInfoFrame(buf + offset, size - offset, header); info) {
+            if (const auto length = sfb::mpeg::audioFrameCount(*info, header); length) {
+                *frameLength = static_cast<AVAudioFramePosition>(*length);
+            }
+        }
+    }
+
+    return [_inputSource seekToOffset:originalOffset error:error];
+}
+
+- (void)buildFrameIndexInBackground {
+    NSURL *url = _inputSource.url;
+    auto frameIndex = std::make_shared<BackgroundFrameIndex>();
+    _backgroundFrameIndex = frameIndex;
+
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        NSError *error = nil;
+        SFBMPEGDecoder *indexer = [[SFBMPEGDecoder alloc] initWithURL:url
+                                                          decoderName:SFBAudioDecoderNameMPEG
+                                                                error:&error];
+        if (!indexer) {
+            os_log_error(gSFBAudioDecoderLog, "Error creating MPEG frame indexer: %{public}@", error);
+            return;
+        }
+
+        indexer->_isFrameIndexer = true;
+        indexer->_backgroundFrameIndex = frameIndex;
+        if (![indexer openReturningError:&error]) {
+            os_log_error(gSFBAudioDecoderLog, "Error opening MPEG frame indexer: %{public}@", error);
+            return;
+        }
+
+        // mpg123_scan() reads every frame header, recording offsets in the frame index and counting the frames
+        if (mpg123_scan(indexer->_mpg123) != MPG123_OK) {
+            if (!frameIndex->cancelled_) {
+                os_log_error(gSFBAudioDecoderLog, "mpg123_scan failed: %{public}s",
+                             mpg123_strerror(indexer->_mpg123));
+            }
+            return;
+        }
+
+        int64_t *offsets = NULL;
+        int64_t step = 0;
+        size_t fill = 0;
+        const int64_t length = mpg123_length64(indexer->_mpg123);
+        if (mpg123_index64(indexer->_mpg123, &offsets, &step, &fill) != MPG123_OK || length < 0) {
+            os_log_error(gSFBAudioDecoderLog, "Error reading MPEG frame index: %{public}s",
+                         mpg123_strerror(indexer->_mpg123));
+            return;
+        }
+
+        frameIndex->offsets_.assign(offsets, offsets + fill);
+        frameIndex->step_ = step;
+        frameIndex->frameLength_ = length;
+        frameIndex->complete_ = true;
+
+        indexer->_frameLength = length;
+        [indexer cacheFrameIndex];
+    });
+}
+
+- (void)adoptBackgroundFrameIndex {
+    if (!_backgroundFrameIndex || !_backgroundFrameIndex->complete_) {
+        return;
+    }
+
+    // mpg123 copies the offsets
+    if (mpg123_set_index64(_mpg123, _backgroundFrameIndex->offsets_.data(), _backgroundFrameIndex->step_,
+                           _backgroundFrameIndex->offsets_.size()) != MPG123_OK) {
+        os_log_error(gSFBAudioDecoderLog, "mpg123_set_index64 failed: %{public}s", mpg123_strerror(_mpg123));
+    }
+    _frameLength = _backgroundFrameIndex->frameLength_;
+    _backgroundFrameIndex.reset();
+}
+
+- (BOOL)loadCachedFrameIndex {
+    const auto key = sfb::seekIndexCacheKey(_inputSource.url);
+    const int samplesPerFrame = mpg123_spf(_mpg123);
+    if (!key || samplesPerFrame <= 0) {
+        return NO;
+    }
+
+    try {
+        const auto entry = key->cache_.find(key->identity_, kFrameIndexCacheFormat, 0);
+        if (!entry || entry->index().frameLength() == 0) {
+            return NO;
+        }
+
+        // Points are at multiples of the index step, in audio frames
+        const auto &index = entry->index();
+        const uint64_t step = index.count() > 1 ? index.point(1).frame_ / static_cast<uint64_t>(samplesPerFrame) : 1;
+        if (step == 0) {
+            return NO;
+        }
+
+        std::vector<int64_t> offsets(index.count());
+        for (size_t i = 0; i < offsets.size(); ++i) {
+            const auto point = index.point(i);
+            if (point.frame_ != i * step * static_cast<uint64_t>(samplesPerFrame)) {
+                return NO;
+            }
+            offsets[i] = static_cast<int64_t>(point.offset_);
+        }
+
+        if (mpg123_set_index64(_mpg123, offsets.data(), static_cast<int64_t>(step), offsets.size()) != MPG123_OK) {
+            os_log_error(gSFBAudioDecoderLog, "mpg123_set_index64 failed: %{public}s", mpg123_strerror(_mpg123));
+            return NO;
+        }
+        _frameLength = static_cast<AVAudioFramePosition>(index.frameLength());
+        _frameIndexIsCached = true;
+        return YES;
+    } catch (const std::exception &e) {
+        os_log_error(gSFBAudioDecoderLog, "Error reading cached MPEG frame index: %{public}s", e.what());
+        return NO;
+    }
+}
+
+- (void)cacheFrameIndex {
+    _frameIndexIsCached = true;
+
+    const auto key = sfb::seekIndexCacheKey(_inputSource.url);
+    if (!key || _frameLength == SFBUnknownFrameLength) {
+        return;
+    }
+
+    int64_t *offsets = NULL;
+    int64_t step = 0;
+    size_t fill = 0;
+    const int samplesPerFrame = mpg123_spf(_mpg123);
+    if (mpg123_index64(_mpg123, &offsets, &step, &fill) != MPG123_OK || step <= 0 || samplesPerFrame <= 0) {
+        return;
+    }
+
+    try {
+        sfb::SeekIndexBuilder index{kFrameIndexCacheFormat, 0};
+        for (size_t i = 0; i < fill; ++i) {
+            const auto frame = i * static_cast<uint64_t>(step) * static_cast<uint64_t>(samplesPerFrame);
+            index.append({frame, static_cast<uint64_t>(offsets[i])}, nullptr);
+        }
+        if (!key->cache_.store(key->identity_, index, static_cast<uint64_t>(_frameLength))) {
+            os_log_error(gSFBAudioDecoderLog, "Error caching MPEG frame index");
+        }
+    } catch (const std::exception &e) {
+        os_log_error(gSFBAudioDecoderLog, "Error caching MPEG frame index: %{public}s", e.what());
+    }
+}
+
 @end
@@ -8,6 +8,7 @@
 #import "SFBOggSpeexDecoder.h"
 
 #import "NSData+SFBExtensions.h"
+#import "SFBAudioDecoder+FrameStage.h"
 #import "SFBLocalizedNameForURL.h"
 
 #import <AVFAudioExtensions/AVFAudioExtensions.h>
@@ -42,7 +43,10 @@ SFBAudioDecodingPropertiesKey const SFBAudioDecodingPropertiesKeyOggSpeexExtraHe
 
 @interface SFBOggSpeexDecoder () {
   @private
+    /// Storage for frames not decoded directly into the caller's buffer
     AVAudioPCMBuffer *_buffer;
+    /// Decoded frames awaiting delivery
+    sfb::FrameStage _stagedFrames;
     AVAudioFramePosition _framePosition;
     AVAudioFramePosition _frameLength;
 
@@ -308,12 +312,13 @@ SFBAudioDecodingPropertiesKey const SFBAudioDecodingPropertiesKeyOggSpeexExtraHe
 
     speex_header_free(header);
 
-    // Allocate the buffer list
+    // Allocate the buffer list, which holds every frame in a packet
     spx_int32_t speexFrameSize = 0;
     speex_decoder_ctl(_decoder, SPEEX_GET_FRAME_SIZE, &speexFrameSize);
 
     _buffer = [[AVAudioPCMBuffer alloc] initWithPCMFormat:_processingFormat
-                                            frameCapacity:(AVAudioFrameCount)speexFrameSize];
+                                            frameCapacity:(AVAudioFrameCount)(speexFrameSize * _framesPerOggPacket)];
+    _stagedFrames.clear();
 
     return YES;
 }
@@ -341,6 +346,7 @@ SFBAudioDecodingPropertiesKey const SFBAudioDecodingPropertiesKeyOggSpeexExtraHe
     ogg_sync_clear(&_syncState);
 
     _buffer = nil;
+    _stagedFrames.clear();
 
     return [super closeReturningError:error];
 }
@@ -369,19 +375,11 @@ SFBAudioDecodingPropertiesKey const SFBAudioDecodingPropertiesKeyOggSpeexExtraHe
         return YES;
     }
 
-    AVAudioFrameCount framesProcessed = 0;
-
     for (;;) {
-        AVAudioFrameCount framesRemaining = frameLength - framesProcessed;
-        AVAudioFrameCount framesCopied = [buffer appendFromBuffer:_buffer
-                                                readingFromOffset:0
-                                                      frameLength:framesRemaining];
-        [_buffer trimAtOffset:0 frameLength:framesCopied];
-
-        framesProcessed += framesCopied;
+        sfb::appendStagedFrames(_stagedFrames, buffer, frameLength - buffer.frameLength);
 
         // All requested frames were read
-        if (framesProcessed == frameLength) {
+        if (buffer.frameLength == frameLength) {
             break;
         }
 
@@ -441,13 +439,19 @@ SFBAudioDecodingPropertiesKey const SFBAudioDecodingPropertiesKeyOggSpeexExtraHe
                         // SPEEX_GET_FRAME_SIZE is in samples
                         spx_int32_t speexFrameSize;
                         speex_decoder_ctl(_decoder, SPEEX_GET_FRAME_SIZE, &speexFrameSize);
-                        float buf[speexFrameSize * _processingFormat.channelCount];
 
                         // Copy the Ogg packet to the Speex bitstream
                         speex_bits_read_from(&_bits, (char *)oggPacket.packet, (int)oggPacket.bytes);
 
-                        // Decode each frame in the Speex packet
+                        // Decode each frame in the Speex packet, directly into buffer while frames fit and
+                        // otherwise after any frames staged from the packet
+                        AVAudioFrameCount framesStaged = 0;
                         for (spx_int32_t i = 0; i < _framesPerOggPacket; ++i) {
+                            const bool direct = _stagedFrames.canDeliverDirectly((size_t)speexFrameSize,
+                                                                                 frameLength - buffer.frameLength);
+                            float *buf = (float *)(direct ? sfb::frameAddress(buffer, 0, buffer.frameLength)
+                                                          : sfb::frameAddress(_buffer, 0, framesStaged));
+
                             result = speex_decode(_decoder, &_bits, buf);
 
                             // -1 indicates EOS
@@ -494,14 +498,12 @@ SFBAudioDecodingPropertiesKey const SFBAudioDecodingPropertiesKeyOggSpeexExtraHe
                             vDSP_vsdiv(buf, 1, &maxSampleValue, buf, 1,
                                        (vDSP_Length)speexFrameSize * _processingFormat.channelCount);
 
-                            // Copy the frames from the decoding buffer to the output buffer, skipping over any frames
-                            // already decoded
-
-                            float *output = _buffer.floatChannelData[0] + (_buffer.frameLength * _buffer.stride);
-                            memcpy(output, buf,
-                                   (size_t)speexFrameSize * _processingFormat.channelCount * sizeof(float));
-
-                            _buffer.frameLength = (AVAudioFrameCount)speexFrameSize;
+                            if (direct) {
+                                buffer.frameLength += (AVAudioFrameCount)speexFrameSize;
+                            } else {
+                                framesStaged += (AVAudioFrameCount)speexFrameSize;
+                                sfb::stageFrames(_stagedFrames, _buffer, framesStaged);
+                            }
 
                             // Packet processing finished
                             --packetsDesired;
@@ -557,9 +559,9 @@ SFBAudioDecodingPropertiesKey const SFBAudioDecodingPropertiesKeyOggSpeexExtraHe
         }
     }
 
-    _framePosition += framesProcessed;
+    _framePosition += buffer.frameLength;
 
-    if (framesProcessed == 0 && _eosReached) {
+    if (buffer.frameLength == 0 && _eosReached) {
         _frameLength = _framePosition;
     }
 
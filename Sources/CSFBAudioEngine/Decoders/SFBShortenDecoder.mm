@@ -6,19 +6,29 @@
 //
 
 #import "SFBShortenDecoder.h"
+#import "SFBAudioDecoder+Internal.h"
 
 #import "NSData+SFBExtensions.h"
+#import "SFBAudioDecoder+FrameStage.h"
+#import "SFBAudioDecoder+SeekIndexCache.h"
 #import "SFBLocalizedNameForURL.h"
 
+#import "ShortenBitReader.hpp"
+#import "ShortenPredictor.hpp"
+#import "ShortenSeekTable.hpp"
+
 #import <AVFAudioExtensions/AVFAudioExtensions.h>
 
 #import <libkern/OSByteOrder.h>
 #import <os/log.h>
 
 #import <algorithm>
+#import <atomic>
 #import <cmath>
 #import <cstdlib>
 #import <cstring>
+#import <exception>
+#import <memory>
 #import <ranges>
 #import <vector>
 
@@ -45,7 +55,6 @@ constexpr auto parameterFileType = 4;
 constexpr auto parameterFunction = 2;
 constexpr auto parameterQLPC = 2;
 constexpr auto parameterSkipBytes = 1;
-constexpr auto parameterUInt32 = 2;
 constexpr auto parameterVerbatimChunkSize = 5;
 constexpr auto parameterVerbatimByte = 8;
 
@@ -74,10 +83,36 @@ constexpr auto fileTypeSInt16LE = 5;
 constexpr auto fileTypeUInt16LE = 6;
 
 // Seeking support
-constexpr auto seekTableRevision = 1;
-constexpr auto seekHeaderSizeBytes = 12;
-constexpr auto seekTrailerSizeBytes = 12;
-constexpr auto seekEntrySizeBytes = 80;
+using sfb::shorten::seekEntrySizeBytes;
+using sfb::shorten::seekHeaderSizeBytes;
+using sfb::shorten::seekTableRevision;
+using sfb::shorten::seekTrailerSizeBytes;
+
+using sfb::shorten::SeekPoint;
+using sfb::shorten::SeekTableEntry;
+using sfb::shorten::SeekTableHeader;
+using sfb::shorten::SeekTableTrailer;
+
+using sfb::shorten::makeSeekPoint;
+using sfb::shorten::makeSeekTableEntry;
+using sfb::shorten::parseSeekTableEntry;
+using sfb::shorten::parseSeekTableHeader;
+using sfb::shorten::parseSeekTableTrailer;
+using sfb::shorten::seekTableBitsInWord;
+using sfb::shorten::seekTableEntryBitOffset;
+using sfb::shorten::seekTableInputOffset;
+using sfb::shorten::writeSeekTableEntry;
+using sfb::shorten::writeSeekTableHeader;
+
+/// Whether `SFBShortenDecoder` builds seek indexes in the background
+std::atomic_bool buildsSeekIndexInBackground_ = false;
+/// Whether `SFBShortenDecoder` saves complete seek indexes as seek table files
+std::atomic_bool savesSeekTables_ = false;
+
+/// Seek points recorded while decoding are at least this many frames apart, the spacing used by Shorten seek tables
+constexpr auto seekIndexResolution = 25600;
+/// The format of cached seek indexes, whose points hold a `SeekPoint` as state
+constexpr uint32_t seekIndexCacheFormat = 0x53484e31; // 'SHN1'
 
 constexpr int32_t roundedShiftDown(int32_t x, int k) noexcept { return (k == 0) ? x : (x >> (k - 1)) >> 1; }
 
@@ -94,261 +129,25 @@ template <typename T> T **allocateContiguous2DArray(size_t rows, size_t cols) no
     return result;
 }
 
-/// Variable-length input using Golomb-Rice coding
-class VariableLengthInput {
-  public:
-    // An entry i has the lowest i bits set
-    static constexpr uint32_t maskTable_[] = {
-            0x0,       0x1,       0x3,        0x7,        0xf,        0x1f,      0x3f,     0x7f,      0xff,
-            0x1ff,     0x3ff,     0x7ff,      0xfff,      0x1fff,     0x3fff,    0x7fff,   0xffff,    0x1ffff,
-            0x3ffff,   0x7ffff,   0xfffff,    0x1fffff,   0x3fffff,   0x7fffff,  0xffffff, 0x1ffffff, 0x3ffffff,
-            0x7ffffff, 0xfffffff, 0x1fffffff, 0x3fffffff, 0x7fffffff, 0xffffffff};
-
-    /// Creates an empty `VariableLengthInput` object
-    /// - important: `Allocate()` must be called before using
-    VariableLengthInput() noexcept = default;
-
-    ~VariableLengthInput() { delete[] byteBuffer_; }
-
-    VariableLengthInput(const VariableLengthInput &) = delete;
-    VariableLengthInput(VariableLengthInput &&) = delete;
-    VariableLengthInput &operator=(const VariableLengthInput &) = delete;
-    VariableLengthInput &operator=(VariableLengthInput &&) = delete;
-
-    /// Input callback type
-    using InputBlock = bool (^)(void *buf, size_t len, size_t &read);
-
-    /// Sets the input callback
-    void setInputCallback(InputBlock block) noexcept { inputBlock_ = block; }
-
-    /// Allocates an internal buffer of the specified size
-    /// - warning: Sizes other than `512` will break seeking
-    bool allocate(size_t size = 512) noexcept {
-        if (byteBuffer_) {
-            return false;
-        }
-
-        auto *byteBuffer = new (std::nothrow) unsigned char[size];
-        if (!byteBuffer) {
-            return false;
-        }
-
-        byteBuffer_ = byteBuffer;
-        byteBufferPosition_ = byteBuffer_;
-        size_ = size;
-
-        return true;
-    }
-
-    bool getRiceGolombCode(int32_t &i32, int k) noexcept {
-#if DEBUG
-        assert(k >= 0 && k < 32);
-#endif /* DEBUG */
-        if (k < 0 || k > 31) {
-            return false;
-        }
-
-        if (bitsAvailable_ == 0 && !refillBitBuffer()) {
-            return false;
-        }
-
-        // Calculate unary quotient
-        int32_t result;
-        for (result = 0; !(bitBuffer_ & (1L << --bitsAvailable_)); ++result) {
-            if (bitsAvailable_ == 0 && !refillBitBuffer()) {
-                return false;
-            }
-        }
-
-        while (k != 0) {
-            if (bitsAvailable_ >= k) {
-                result = (result << k) | static_cast<int32_t>((bitBuffer_ >> (bitsAvailable_ - k)) & maskTable_[k]);
-                bitsAvailable_ -= k;
-                k = 0;
-            } else {
-#if DEBUG
-                assert(bitsAvailable_ < 32);
-#endif /* DEBUG */
-                result = (result << bitsAvailable_) | static_cast<int32_t>(bitBuffer_ & maskTable_[bitsAvailable_]);
-                k -= bitsAvailable_;
-                if (!refillBitBuffer()) {
-                    return false;
-                }
-            }
-        }
-
-        i32 = result;
-        return true;
-    }
-
-    bool getInt32(int32_t &i32, int k) noexcept {
-        int32_t var;
-        if (!getRiceGolombCode(var, k + 1)) {
-            return false;
-        }
-
-        uint32_t uvar = static_cast<uint32_t>(var);
-        if (uvar & 1) {
-            i32 = ~(uvar >> 1);
-        } else {
-            i32 = (uvar >> 1);
-        }
-        return true;
-    }
-
-    bool getUInt32(uint32_t &ui32, int version, int k) noexcept {
-        if (version > 0 && !getRiceGolombCode(k, parameterUInt32)) {
-            return false;
-        }
-
-        int32_t i32;
-        if (!getRiceGolombCode(i32, k)) {
-            return false;
-        }
-        ui32 = static_cast<uint32_t>(i32);
-        return true;
-    }
-
-    void reset() noexcept {
-        byteBufferPosition_ = byteBuffer_;
-        bytesAvailable_ = 0;
-        bitsAvailable_ = 0;
-    }
-
-    bool refill() noexcept {
-        size_t bytesRead = 0;
-        if (!inputBlock_ || !inputBlock_(byteBuffer_, size_, bytesRead) || bytesRead < 4) {
-            return false;
-        }
-        bytesAvailable_ += bytesRead;
-        byteBufferPosition_ = byteBuffer_;
-        return true;
-    }
-
-    bool setState(uint16_t byteBufferPosition, uint16_t bytesAvailable, uint32_t bitBuffer,
-                  uint16_t bitsAvailable) noexcept {
-        if (byteBufferPosition > size_ || bytesAvailable > size_ - byteBufferPosition || bitsAvailable > 32) {
-            return false;
-        }
-        byteBufferPosition_ = byteBuffer_ + byteBufferPosition;
-        bytesAvailable_ = bytesAvailable;
-        bitBuffer_ = bitBuffer;
-        bitsAvailable_ = bitsAvailable;
-        return true;
-    }
-
-  private:
-    /// Input callback
-    InputBlock inputBlock_ = nil;
-    /// Size of `byteBuffer_` in bytes
-    size_t size_ = 0;
-    /// Byte buffer
-    unsigned char *byteBuffer_ = nullptr;
-    /// Current position in `byteBuffer_`
-    unsigned char *byteBufferPosition_ = nullptr;
-    /// Bytes available in `byteBuffer_`
-    int bytesAvailable_ = 0;
-    /// Bit buffer
-    uint32_t bitBuffer_ = 0;
-    /// Bits available in `mBitBuffer`
-    int bitsAvailable_ = 0;
-
-    /// Reads a single `uint32_t` from the byte buffer, refilling if necessary
-    bool refillBitBuffer() noexcept {
-        if (bytesAvailable_ < 4 && !refill()) {
-            return false;
-        }
-
-        bitBuffer_ = static_cast<uint32_t>((static_cast<int32_t>(byteBufferPosition_[0]) << 24) |
-                                           (static_cast<int32_t>(byteBufferPosition_[1]) << 16) |
-                                           (static_cast<int32_t>(byteBufferPosition_[2]) << 8) |
-                                           static_cast<int32_t>(byteBufferPosition_[3]));
-
-        byteBufferPosition_ += 4;
-        bytesAvailable_ -= 4;
-        bitsAvailable_ = 32;
-
-        return true;
-    }
-};
-
-/// Shorten seek table header
-struct SeekTableHeader {
-    int8_t signature_[4];
-    uint32_t version_;
-    uint32_t fileSize_;
-};
-
-SeekTableHeader parseSeekTableHeader(const void *buf) {
-    SeekTableHeader header;
-    std::memcpy(header.signature_, buf, 4);
-    header.version_ = OSReadLittleInt32(buf, 4);
-    header.fileSize_ = OSReadLittleInt32(buf, 8);
-
-    return header;
-}
-
-/// Shorten seek table trailer
-struct SeekTableTrailer {
-    uint32_t seekTableSize_;
-    int8_t signature_[8];
+/// A seek index built by a separate decoder
+struct BackgroundSeekIndex {
+    /// The seek points, which may only be accessed by the building decoder until `complete_` is set
+    std::vector<SeekPoint> points_;
+    /// Whether the index is complete
+    std::atomic_bool complete_ = false;
+    /// Whether building the index should stop
+    std::atomic_bool cancelled_ = false;
 };
 
-SeekTableTrailer parseSeekTableTrailer(const void *buf) {
-    SeekTableTrailer trailer;
-    trailer.seekTableSize_ = OSReadLittleInt32(buf, 0);
-    std::memcpy(trailer.signature_, static_cast<const unsigned char *>(buf) + 4, 8);
-
-    return trailer;
-}
-
-/// A Shorten seek table entry
-struct SeekTableEntry {
-    uint32_t frameNumber_;
-    uint32_t byteOffsetInFile_;
-    uint32_t lastBufferReadPosition_;
-    uint16_t bytesAvailable_;
-    uint16_t byteBufferPosition_;
-    uint16_t bitBufferPosition_;
-    uint32_t bitBuffer_;
-    uint16_t bitshift_;
-    int32_t chanBuf0_[3];
-    int32_t chanBuf1_[3];
-    int32_t offset0_[4];
-    int32_t offset1_[4];
-};
-
-SeekTableEntry parseSeekTableEntry(const void *buf) {
-    SeekTableEntry entry;
-    entry.frameNumber_ = OSReadLittleInt32(buf, 0);
-    entry.byteOffsetInFile_ = OSReadLittleInt32(buf, 4);
-    entry.lastBufferReadPosition_ = OSReadLittleInt32(buf, 8);
-    entry.bytesAvailable_ = OSReadLittleInt16(buf, 12);
-    entry.byteBufferPosition_ = OSReadLittleInt16(buf, 14);
-    entry.bitBufferPosition_ = OSReadLittleInt16(buf, 16);
-    entry.bitBuffer_ = OSReadLittleInt32(buf, 18);
-    entry.bitshift_ = OSReadLittleInt16(buf, 22);
-    for (auto i = 0; i < 3; ++i) {
-        entry.chanBuf0_[i] = static_cast<int32_t>(OSReadLittleInt32(buf, 24 + 4 * i));
-    }
-    for (auto i = 0; i < 3; ++i) {
-        entry.chanBuf1_[i] = static_cast<int32_t>(OSReadLittleInt32(buf, 36 + 4 * i));
-    }
-    for (auto i = 0; i < 4; ++i) {
-        entry.offset0_[i] = static_cast<int32_t>(OSReadLittleInt32(buf, 48 + 4 * i));
-    }
-    for (auto i = 0; i < 4; ++i) {
-        entry.offset1_[i] = static_cast<int32_t>(OSReadLittleInt32(buf, 64 + 4 * i));
-    }
-
-    return entry;
-}
-
 } /* namespace */
 
+// Files without a seek table are indexed while decoding, recording the decoder state every 25600 frames. Seeking past
+// the last recorded frame decodes forward from it, extending the index. The entire file is indexed on a background
+// queue when `buildsSeekIndexInBackground` is set. Complete indexes are cached when
+// `SFBAudioDecoder.seekIndexCacheDirectoryURL` is set and saved as seek table files when `savesSeekTables` is set.
 @interface SFBShortenDecoder () {
   @private
-    VariableLengthInput _input;
+    sfb::shorten::BitReader _input;
     int _version;
     int32_t _lpcQuantOffset;
     int _fileType;
@@ -368,9 +167,23 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
     int _bitshift;
 
     bool _eos;
-    std::vector<SeekTableEntry> _seekTableEntries;
-
+    NSInteger _bitstreamOffset;
+    std::vector<SeekPoint> _seekPoints;
+
+    /// Whether seek points are recorded while decoding
+    bool _buildsSeekIndex;
+    /// Whether `_seekPoints` covers the entire stream
+    bool _seekIndexComplete;
+    /// Whether this decoder only builds a seek index and produces no audio
+    bool _isSeekIndexer;
+    /// The frame number of the next block
+    AVAudioFramePosition _blockFramePosition;
+    std::shared_ptr<BackgroundSeekIndex> _backgroundSeekIndex;
+
+    /// Storage for blocks not decoded directly into the caller's buffer
     AVAudioPCMBuffer *_frameBuffer;
+    /// Decoded frames awaiting delivery
+    sfb::FrameStage _stagedFrames;
     AVAudioFramePosition _framePosition;
     AVAudioFramePosition _frameLength;
     uint64_t _blocksDecoded;
@@ -378,10 +191,19 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
 - (bool)parseShortenHeaderReturningError:(NSError **)error;
 - (bool)parseRIFFChunk:(const unsigned char *)chunkData size:(size_t)size error:(NSError **)error;
 - (bool)parseFORMChunk:(const unsigned char *)chunkData size:(size_t)size error:(NSError **)error;
-- (bool)decodeBlockReturningError:(NSError **)error;
+- (bool)decodeBlockIntoBuffer:(AVAudioPCMBuffer *)buffer
+                  frameLength:(AVAudioFrameCount)frameLength
+                        error:(NSError **)error;
 - (bool)scanForSeekTableReturningError:(NSError **)error;
 - (std::vector<SeekTableEntry>)parseExternalSeekTable:(NSURL *)url;
-- (bool)seekTableIsValid:(std::vector<SeekTableEntry>)entries startOffset:(NSInteger)startOffset;
+- (bool)seekTableIsValid:(const std::vector<SeekTableEntry> &)entries startOffset:(NSInteger)startOffset;
+- (void)setSeekTableEntries:(const std::vector<SeekTableEntry> &)entries;
+- (void)recordSeekPoint;
+- (void)buildSeekIndexInBackground;
+- (void)adoptBackgroundSeekIndex;
+- (void)saveSeekIndex;
+- (void)loadCachedSeekIndex;
+- (void)cacheSeekIndex;
 @end
 
 @implementation SFBShortenDecoder
@@ -402,6 +224,22 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
     return SFBAudioDecoderNameShorten;
 }
 
++ (BOOL)buildsSeekIndexInBackground {
+    return buildsSeekIndexInBackground_;
+}
+
++ (void)setBuildsSeekIndexInBackground:(BOOL)buildsSeekIndexInBackground {
+    buildsSeekIndexInBackground_ = buildsSeekIndexInBackground;
+}
+
++ (BOOL)savesSeekTables {
+    return savesSeekTables_;
+}
+
++ (void)setSavesSeekTables:(BOOL)savesSeekTables {
+    savesSeekTables_ = savesSeekTables;
+}
+
 + (BOOL)testInputSource:(SFBInputSource *)inputSource
         formatIsSupported:(SFBTernaryTruthValue *)formatIsSupported
                     error:(NSError **)error {
@@ -594,6 +432,21 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
         }
     }
 
+    // Without a seek table build a seek index while decoding, limited to the state a seek table entry holds
+    _blockFramePosition = 0;
+    _seekIndexComplete = false;
+    if (_seekPoints.empty() && !_isSeekIndexer && _inputSource.supportsSeeking) {
+        [self loadCachedSeekIndex];
+    }
+    _buildsSeekIndex = _seekPoints.empty() && _inputSource.supportsSeeking && _channelCount <= 2 && _maxLPC <= 3 &&
+                       _mean <= 4;
+    if (_buildsSeekIndex) {
+        [self recordSeekPoint];
+        if (!_isSeekIndexer && buildsSeekIndexInBackground_ && _inputSource.url.isFileURL) {
+            [self buildSeekIndexInBackground];
+        }
+    }
+
     return YES;
 }
 
@@ -611,6 +464,15 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
         _qlpc = nullptr;
     }
     _frameBuffer = nil;
+    _stagedFrames.clear();
+
+    if (_backgroundSeekIndex) {
+        _backgroundSeekIndex->cancelled_ = true;
+        _backgroundSeekIndex.reset();
+    }
+    _seekPoints.clear();
+    _buildsSeekIndex = false;
+    _seekIndexComplete = false;
 
     return [super closeReturningError:error];
 }
@@ -639,40 +501,28 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
         return YES;
     }
 
-    AVAudioFrameCount framesDecoded = 0;
-
     for (;;) {
-        if (const auto framesToCopy = std::min(frameLength - framesDecoded, _frameBuffer.frameLength);
-            framesToCopy > 0) {
-            const auto framesCopied = [buffer appendFromBuffer:_frameBuffer
-                                             readingFromOffset:0
-                                                   frameLength:framesToCopy];
-            [[maybe_unused]] const auto framesTrimmed = [_frameBuffer trimAtOffset:0 frameLength:framesCopied];
-#if DEBUG
-            assert(framesTrimmed == framesCopied);
-#endif /* DEBUG */
-            framesDecoded += framesCopied;
-        }
+        sfb::appendStagedFrames(_stagedFrames, buffer, frameLength - buffer.frameLength);
 
         // All requested frames were read or EOS reached
-        if (framesDecoded == frameLength || _eos) {
+        if (buffer.frameLength == frameLength || _eos) {
             break;
         }
 
-        // Decode the next block
-        if (![self decodeBlockReturningError:error]) {
+        // Decode the next block, directly into buffer if it fits
+        if (![self decodeBlockIntoBuffer:buffer frameLength:frameLength - buffer.frameLength error:error]) {
             os_log_error(gSFBAudioDecoderLog, "Error decoding Shorten block");
             return NO;
         }
     }
 
-    _framePosition += framesDecoded;
+    _framePosition += buffer.frameLength;
 
     return YES;
 }
 
 - (BOOL)supportsSeeking {
-    return !_seekTableEntries.empty();
+    return _buildsSeekIndex || !_seekPoints.empty();
 }
 
 - (BOOL)seekToFrame:(AVAudioFramePosition)frame error:(NSError **)error {
@@ -685,8 +535,11 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
         return NO;
     }
 
-    auto entry = std::ranges::upper_bound(_seekTableEntries, frame, {}, &SeekTableEntry::frameNumber_);
-    if (entry == std::begin(_seekTableEntries)) {
+    [self adoptBackgroundSeekIndex];
+
+    // Frames past the last seek point are reached by decoding from it, which extends the seek index if building
+    auto entry = std::ranges::upper_bound(_seekPoints, frame, {}, &SeekPoint::frameNumber_);
+    if (entry == std::begin(_seekPoints)) {
         os_log_error(gSFBAudioDecoderLog, "No seek table entry for frame %lld", frame);
         if (error != nullptr) {
             NSError *seekError = [self genericSeekError];
@@ -701,17 +554,17 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
 
 #if DEBUG
     os_log_debug(gSFBAudioDecoderLog, "Using seek table entry %ld for frame %u to seek to frame %lld",
-                 std::ranges::distance(_seekTableEntries.cbegin(), entry), entry->frameNumber_, frame);
+                 std::ranges::distance(_seekPoints.cbegin(), entry), entry->frameNumber_, frame);
 #endif
 
-    if (![_inputSource seekToOffset:entry->lastBufferReadPosition_ error:error]) {
+    const auto byteOffset = entry->bitOffset_ / 8;
+    if (![_inputSource seekToOffset:static_cast<NSInteger>(byteOffset) error:error]) {
         return NO;
     }
 
     _eos = false;
-    _input.reset();
-    if (!_input.refill() || !_input.setState(entry->byteBufferPosition_, entry->bytesAvailable_, entry->bitBuffer_,
-                                             entry->bitBufferPosition_)) {
+    _input.reset(byteOffset);
+    if (!_input.skipBits(static_cast<int>(entry->bitOffset_ % 8))) {
         if (error != nullptr) {
             NSDictionary *userInfo = nil;
             if (_inputSource.url) {
@@ -741,7 +594,8 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
     _bitshift = entry->bitshift_;
 
     _framePosition = entry->frameNumber_;
-    _frameBuffer.frameLength = 0;
+    _blockFramePosition = entry->frameNumber_;
+    _stagedFrames.clear();
 
     const auto framesToSkip = static_cast<AVAudioFrameCount>(frame - entry->frameNumber_);
     AVAudioFrameCount framesSkipped = 0;
@@ -753,15 +607,12 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
         }
 
         // Decode the next block
-        if (![self decodeBlockReturningError:error]) {
+        if (![self decodeBlockIntoBuffer:nil frameLength:0 error:error]) {
             os_log_error(gSFBAudioDecoderLog, "Error decoding Shorten block");
             return NO;
         }
 
-        if (const auto framesToTrim = std::min(framesToSkip - framesSkipped, _frameBuffer.frameLength);
-            framesToTrim > 0) {
-            framesSkipped += [_frameBuffer trimAtOffset:0 frameLength:framesToTrim];
-        }
+        framesSkipped += static_cast<AVAudioFrameCount>(_stagedFrames.skip(framesToSkip - framesSkipped));
     }
 
     _framePosition += framesSkipped;
@@ -801,6 +652,10 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
     // Default mean
     _mean = _version < 2 ? v0DefaultMean : v2DefaultMean;
 
+    if (![_inputSource getOffset:&_bitstreamOffset error:error]) {
+        return false;
+    }
+
     // Set up variable length input
     if (!_input.allocate()) {
         os_log_error(gSFBAudioDecoderLog, "Unable to allocate variable-length input");
@@ -811,7 +666,7 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
     }
 
     __weak SFBInputSource *inputSource = self->_inputSource;
-    _input.setInputCallback(^bool(void *buf, size_t len, size_t &read) {
+    _input.setInputCallback([inputSource](void *buf, size_t len, size_t &read) -> bool {
         NSInteger bytesRead;
         if (![inputSource readBytes:buf length:static_cast<NSInteger>(len) bytesRead:&bytesRead error:nil]) {
             return false;
@@ -819,6 +674,7 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
         read = static_cast<size_t>(bytesRead);
         return true;
     });
+    _input.reset(static_cast<uint64_t>(_bitstreamOffset));
 
     // Read file type
     uint32_t fileType;
@@ -1194,7 +1050,13 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
     return true;
 }
 
-- (bool)decodeBlockReturningError:(NSError **)error {
+- (bool)decodeBlockIntoBuffer:(AVAudioPCMBuffer *)buffer
+                  frameLength:(AVAudioFrameCount)frameLength
+                        error:(NSError **)error {
+    if (_buildsSeekIndex && !_seekIndexComplete) {
+        [self recordSeekPoint];
+    }
+
     int chan = 0;
     for (;;) {
         int32_t cmd;
@@ -1207,6 +1069,16 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
 
         if (cmd == functionQuit) {
             _eos = true;
+            if (_buildsSeekIndex && !_seekIndexComplete) {
+                _seekIndexComplete = true;
+                // A background index saves and caches itself
+                if (!_backgroundSeekIndex) {
+                    if (savesSeekTables_) {
+                        [self saveSeekIndex];
+                    }
+                    [self cacheSeekIndex];
+                }
+            }
             return true;
         }
 
@@ -1256,55 +1128,20 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
                 }
                 break;
             case functionDiff0:
-                for (auto i = 0; i < _blocksize; ++i) {
-                    int32_t var;
-                    if (!_input.getInt32(var, resn)) {
-                        if (error != nullptr) {
-                            *error = [self genericDecodingError];
-                        }
-                        return false;
-                    }
-                    chanBuffer[i] = var + chanOffset;
-                }
-                break;
             case functionDiff1:
-                for (auto i = 0; i < _blocksize; ++i) {
-                    int32_t var;
-                    if (!_input.getInt32(var, resn)) {
-                        if (error != nullptr) {
-                            *error = [self genericDecodingError];
-                        }
-                        return false;
-                    }
-                    chanBuffer[i] = var + chanBuffer[i - 1];
-                }
-                break;
             case functionDiff2:
-                for (auto i = 0; i < _blocksize; ++i) {
-                    int32_t var;
-                    if (!_input.getInt32(var, resn)) {
-                        if (error != nullptr) {
-                            *error = [self genericDecodingError];
-                        }
-                        return false;
-                    }
-                    chanBuffer[i] = var + (2 * chanBuffer[i - 1] - chanBuffer[i - 2]);
-                }
-                break;
             case functionDiff3:
-                for (auto i = 0; i < _blocksize; ++i) {
-                    int32_t var;
-                    if (!_input.getInt32(var, resn)) {
-                        if (error != nullptr) {
-                            *error = [self genericDecodingError];
-                        }
-                        return false;
+                if (!_input.getInt32s(chanBuffer, static_cast<size_t>(_blocksize), resn)) {
+                    if (error != nullptr) {
+                        *error = [self genericDecodingError];
                     }
-                    chanBuffer[i] = var + (3 * (chanBuffer[i - 1] - chanBuffer[i - 2])) + chanBuffer[i - 3];
+                    return false;
                 }
+                sfb::shorten::restoreFixed(cmd - functionDiff0, chanBuffer, static_cast<size_t>(_blocksize),
+                                           chanOffset);
                 break;
             case functionQLPC:
-                if (!_input.getRiceGolombCode(lpc, parameterQLPC) || lpc > _maxLPC) {
+                if (!_input.getRiceGolombCode(lpc, parameterQLPC) || lpc < 0 || lpc > _maxLPC) {
                     os_log_error(gSFBAudioDecoderLog, "Invalid or unsupported linear predictor order: %d", lpc);
                     if (error != nullptr) {
                         *error = [self genericDecodingError];
@@ -1320,28 +1157,19 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
                         return false;
                     }
                 }
+                if (!_input.getInt32s(chanBuffer, static_cast<size_t>(_blocksize), resn)) {
+                    if (error != nullptr) {
+                        *error = [self genericDecodingError];
+                    }
+                    return false;
+                }
                 for (auto i = 0; i < lpc; ++i) {
                     chanBuffer[i - lpc] -= chanOffset;
                 }
-                for (auto i = 0; i < _blocksize; ++i) {
-                    int32_t sum = _lpcQuantOffset;
-
-                    for (auto j = 0; j < lpc; ++j) {
-                        sum += _qlpc[j] * chanBuffer[i - j - 1];
-                    }
-                    int32_t var;
-                    if (!_input.getInt32(var, resn)) {
-                        if (error != nullptr) {
-                            *error = [self genericDecodingError];
-                        }
-                        return false;
-                    }
-                    chanBuffer[i] = var + (sum >> parameterQLPC);
-                }
+                sfb::shorten::restoreLPC(chanBuffer, static_cast<size_t>(_blocksize), _qlpc, lpc, _lpcQuantOffset,
+                                         parameterQLPC);
                 if (chanOffset != 0) {
-                    for (auto i = 0; i < _blocksize; ++i) {
-                        chanBuffer[i] += chanOffset;
-                    }
+                    sfb::shorten::addOffset(chanBuffer, static_cast<size_t>(_blocksize), chanOffset);
                 }
                 break;
             }
@@ -1367,52 +1195,48 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
                 chanBuffer[i] = chanBuffer[i + _blocksize];
             }
 
+            if (chan == _channelCount - 1 && _isSeekIndexer) {
+                _blockFramePosition += _blocksize;
+                ++_blocksDecoded;
+                return true;
+            }
+
             if (chan == _channelCount - 1) {
-                const auto *abl = _frameBuffer.audioBufferList;
-
-                switch (_fileType) {
-                case fileTypeUInt8:
-                    for (auto channel = 0; channel < _channelCount; ++channel) {
-                        auto *channel_buf = static_cast<uint8_t *>(abl->mBuffers[channel].mData);
-                        for (auto sample = 0; sample < _blocksize; ++sample) {
-                            const auto value = _buffer[channel][sample] << _bitshift;
-                            channel_buf[sample] = static_cast<uint8_t>(std::clamp(value, 0, UINT8_MAX));
-                        }
-                    }
-                    break;
-                case fileTypeSInt8:
-                    for (auto channel = 0; channel < _channelCount; ++channel) {
-                        auto *channel_buf = static_cast<int8_t *>(abl->mBuffers[channel].mData);
-                        for (auto sample = 0; sample < _blocksize; ++sample) {
-                            const auto value = _buffer[channel][sample] << _bitshift;
-                            channel_buf[sample] = static_cast<int8_t>(std::clamp(value, INT8_MIN, INT8_MAX));
-                        }
-                    }
-                    break;
-                case fileTypeUInt16BE:
-                case fileTypeUInt16LE:
-                    for (auto channel = 0; channel < _channelCount; ++channel) {
-                        auto *channel_buf = static_cast<uint16_t *>(abl->mBuffers[channel].mData);
-                        for (auto sample = 0; sample < _blocksize; ++sample) {
-                            const auto value = _buffer[channel][sample] << _bitshift;
-                            channel_buf[sample] = static_cast<uint16_t>(std::clamp(value, 0, UINT16_MAX));
-                        }
+                // Blocks fitting in the frames requested are converted directly into buffer
+                const auto frames = static_cast<size_t>(_blocksize);
+                const bool direct = buffer != nil && _stagedFrames.canDeliverDirectly(frames, frameLength);
+                AVAudioPCMBuffer *output = direct ? buffer : _frameBuffer;
+                const auto outputOffset = direct ? buffer.frameLength : 0;
+
+                for (auto channel = 0; channel < _channelCount; ++channel) {
+                    void *data = sfb::frameAddress(output, static_cast<UInt32>(channel), outputOffset);
+                    switch (_fileType) {
+                    case fileTypeUInt8:
+                        sfb::shorten::convertSamples(_buffer[channel], static_cast<uint8_t *>(data), frames, _bitshift);
+                        break;
+                    case fileTypeSInt8:
+                        sfb::shorten::convertSamples(_buffer[channel], static_cast<int8_t *>(data), frames, _bitshift);
+                        break;
+                    case fileTypeUInt16BE:
+                    case fileTypeUInt16LE:
+                        sfb::shorten::convertSamples(_buffer[channel], static_cast<uint16_t *>(data), frames,
+                                                     _bitshift);
+                        break;
+                    case fileTypeSInt16BE:
+                    case fileTypeSInt16LE:
+                        sfb::shorten::convertSamples(_buffer[channel], static_cast<int16_t *>(data), frames,
+                                                     _bitshift);
+                        break;
                     }
-                    break;
-                case fileTypeSInt16BE:
-                case fileTypeSInt16LE:
-                    for (auto channel = 0; channel < _channelCount; ++channel) {
-                        auto *channel_buf = static_cast<int16_t *>(abl->mBuffers[channel].mData);
-                        for (auto sample = 0; sample < _blocksize; ++sample) {
-                            const auto value = _buffer[channel][sample] << _bitshift;
-                            channel_buf[sample] = static_cast<int16_t>(std::clamp(value, INT16_MIN, INT16_MAX));
-                        }
-                    }
-                    break;
                 }
 
-                _frameBuffer.frameLength = static_cast<AVAudioFrameCount>(_blocksize);
+                if (direct) {
+                    buffer.frameLength += static_cast<AVAudioFrameCount>(_blocksize);
+                } else {
+                    sfb::stageFrames(_stagedFrames, _frameBuffer, static_cast<AVAudioFrameCount>(_blocksize));
+                }
 
+                _blockFramePosition += _blocksize;
                 ++_blocksDecoded;
                 return true;
             }
@@ -1495,6 +1319,10 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
         return false;
     }
 
+    // Seek table entries record the input offset of a decoder reading blocks of `seekTableBufferSizeBytes`
+    const auto seekTableStartOffset =
+            static_cast<NSInteger>(seekTableInputOffset(_input.bitPosition(), _bitstreamOffset, fileLength));
+
     SeekTableTrailer trailer;
     {
         unsigned char buf[seekTrailerSizeBytes];
@@ -1519,8 +1347,8 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
         NSURL *externalSeekTableURL = [_inputSource.url.URLByDeletingPathExtension URLByAppendingPathExtension:@"skt"];
         if ([externalSeekTableURL checkResourceIsReachableAndReturnError:nil]) {
             auto entries = [self parseExternalSeekTable:externalSeekTableURL];
-            if (!entries.empty() && [self seekTableIsValid:entries startOffset:startOffset]) {
-                _seekTableEntries = entries;
+            if (!entries.empty() && [self seekTableIsValid:entries startOffset:seekTableStartOffset]) {
+                [self setSeekTableEntries:entries];
             }
         }
         if (![_inputSource seekToOffset:startOffset error:error]) {
@@ -1596,8 +1424,8 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
         return false;
     }
 
-    if (!entries.empty() && [self seekTableIsValid:entries startOffset:startOffset]) {
-        _seekTableEntries = entries;
+    if (!entries.empty() && [self seekTableIsValid:entries startOffset:seekTableStartOffset]) {
+        [self setSeekTableEntries:entries];
     }
 
     return true;
@@ -1652,7 +1480,7 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
     return entries;
 }
 
-- (bool)seekTableIsValid:(std::vector<SeekTableEntry>)entries startOffset:(NSInteger)startOffset {
+- (bool)seekTableIsValid:(const std::vector<SeekTableEntry> &)entries startOffset:(NSInteger)startOffset {
     if (entries.empty()) {
         return false;
     }
@@ -1681,8 +1509,208 @@ SeekTableEntry parseSeekTableEntry(const void *buf) {
         os_log_error(gSFBAudioDecoderLog, "Seek table error: Invalid mean (%d); [0, 4] required", _mean);
         return false;
     }
+    for (const auto &entry : entries) {
+        if (seekTableEntryBitOffset(entry) < _bitstreamOffset * 8) {
+            os_log_error(gSFBAudioDecoderLog, "Seek table error: Invalid input position in entry for frame %u",
+                         entry.frameNumber_);
+            return false;
+        }
+    }
 
     return true;
 }
 
+- (void)setSeekTableEntries:(const std::vector<SeekTableEntry> &)entries {
+    _seekPoints.clear();
+    _seekPoints.reserve(entries.size());
+    for (const auto &entry : entries) {
+        _seekPoints.push_back(makeSeekPoint(entry));
+    }
+}
+
+- (void)recordSeekPoint {
+    if (!_seekPoints.empty() && _blockFramePosition - _seekPoints.back().frameNumber_ < seekIndexResolution) {
+        return;
+    }
+    if (_blockFramePosition > UINT32_MAX) {
+        return;
+    }
+
+    SeekPoint point{};
+    point.frameNumber_ = static_cast<uint32_t>(_blockFramePosition);
+    point.bitOffset_ = _input.bitPosition();
+
+    // Shorten bitstreams are padded to whole words so the rest of the current word is always present
+    if (const auto bitsInWord = seekTableBitsInWord(point.bitOffset_, _bitstreamOffset);
+        bitsInWord > 0 && !_input.peekBits(point.bitBuffer_, bitsInWord)) {
+        return;
+    }
+
+    point.bitshift_ = static_cast<uint16_t>(_bitshift);
+    for (auto i = 0; i < 3; ++i) {
+        point.chanBuf0_[i] = _buffer[0][-1 - i];
+        if (_channelCount == 2) {
+            point.chanBuf1_[i] = _buffer[1][-1 - i];
+        }
+    }
+    for (auto i = 0; i < std::max(1, _mean); ++i) {
+        point.offset0_[i] = _offset[0][i];
+        if (_channelCount == 2) {
+            point.offset1_[i] = _offset[1][i];
+        }
+    }
+
+    _seekPoints.push_back(point);
+}
+
+- (void)buildSeekIndexInBackground {
+    NSURL *url = _inputSource.url;
+    auto seekIndex = std::make_shared<BackgroundSeekIndex>();
+    _backgroundSeekIndex = seekIndex;
+
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        NSError *error = nil;
+        SFBShortenDecoder *indexer = [[SFBShortenDecoder alloc] initWithURL:url
+                                                                decoderName:SFBAudioDecoderNameShorten
+                                                                      error:&error];
+        if (!indexer) {
+            os_log_error(gSFBAudioDecoderLog, "Error creating Shorten seek indexer: %{public}@", error);
+            return;
+        }
+
+        indexer->_isSeekIndexer = true;
+        if (![indexer openReturningError:&error]) {
+            os_log_error(gSFBAudioDecoderLog, "Error opening Shorten seek indexer: %{public}@", error);
+            return;
+        }
+
+        if (!indexer->_buildsSeekIndex) {
+            return;
+        }
+
+        while (!indexer->_eos) {
+            if (seekIndex->cancelled_) {
+                return;
+            }
+            if (![indexer decodeBlockIntoBuffer:nil frameLength:0 error:&error]) {
+                os_log_error(gSFBAudioDecoderLog, "Error building Shorten seek index: %{public}@", error);
+                return;
+            }
+        }
+
+        seekIndex->points_ = indexer->_seekPoints;
+        seekIndex->complete_ = true;
+    });
+}
+
+- (void)adoptBackgroundSeekIndex {
+    if (!_backgroundSeekIndex || !_backgroundSeekIndex->complete_) {
+        return;
+    }
+
+    if (!_seekIndexComplete) {
+        _seekPoints = std::move(_backgroundSeekIndex->points_);
+        _seekIndexComplete = true;
+    }
+    _backgroundSeekIndex.reset();
+}
+
+- (void)saveSeekIndex {
+    NSURL *url = [_inputSource.url.URLByDeletingPathExtension URLByAppendingPathExtension:@"skt"];
+    if (!url.isFileURL || [url checkResourceIsReachableAndReturnError:nil]) {
+        return;
+    }
+
+    NSError *error = nil;
+    if (![self writeSeekTableToURL:url error:&error]) {
+        os_log_error(gSFBAudioDecoderLog, "Error saving Shorten seek table: %{public}@", error);
+    }
+}
+
+- (void)loadCachedSeekIndex {
+    const auto key = sfb::seekIndexCacheKey(_inputSource.url);
+    if (!key) {
+        return;
+    }
+
+    try {
+        const auto entry = key->cache_.find(key->identity_, seekIndexCacheFormat, sizeof(SeekPoint));
+        if (!entry) {
+            return;
+        }
+
+        const auto &index = entry->index();
+        std::vector<SeekPoint> points(index.count());
+        for (size_t i = 0; i < points.size(); ++i) {
+            std::memcpy(&points[i], index.state(i), sizeof(SeekPoint));
+        }
+        _seekPoints = std::move(points);
+    } catch (const std::exception &e) {
+        os_log_error(gSFBAudioDecoderLog, "Error reading cached Shorten seek index: %{public}s", e.what());
+    }
+}
+
+- (void)cacheSeekIndex {
+    const auto key = sfb::seekIndexCacheKey(_inputSource.url);
+    if (!key) {
+        return;
+    }
+
+    try {
+        sfb::SeekIndexBuilder index{seekIndexCacheFormat, sizeof(SeekPoint)};
+        for (const auto &point : _seekPoints) {
+            index.append({point.frameNumber_, point.bitOffset_}, &point);
+        }
+        if (!key->cache_.store(key->identity_, index, static_cast<uint64_t>(_frameLength))) {
+            os_log_error(gSFBAudioDecoderLog, "Error caching Shorten seek index");
+        }
+    } catch (const std::exception &e) {
+        os_log_error(gSFBAudioDecoderLog, "Error caching Shorten seek index: %{public}s", e.what());
+    }
+}
+
+- (BOOL)writeSeekTableToURL:(NSURL *)url error:(NSError **)error {
+    NSParameterAssert(url != nil);
+
+    NSInteger inputLength;
+    if (![_inputSource getLength:&inputLength error:error]) {
+        return NO;
+    }
+
+    // Seek table entries hold 32-bit file offsets
+    if (_seekPoints.empty() || inputLength > UINT32_MAX) {
+        if (error != nullptr) {
+            *error = [NSError errorWithDomain:NSPOSIXErrorDomain
+                                         code:(_seekPoints.empty() ? EINVAL : EFBIG)
+                                     userInfo:nil];
+        }
+        return NO;
+    }
+
+    const auto length = seekHeaderSizeBytes + (_seekPoints.size() * seekEntrySizeBytes);
+    NSMutableData *data = [NSMutableData dataWithLength:length];
+    if (data == nil) {
+        if (error != nullptr) {
+            *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:ENOMEM userInfo:nil];
+        }
+        return NO;
+    }
+
+    auto *buf = static_cast<unsigned char *>(data.mutableBytes);
+
+    SeekTableHeader header;
+    std::memcpy(header.signature_, "SEEK", 4);
+    header.version_ = seekTableRevision;
+    header.fileSize_ = static_cast<uint32_t>(inputLength);
+    writeSeekTableHeader(header, buf);
+    buf += seekHeaderSizeBytes;
+
+    for (const auto &point : _seekPoints) {
+        writeSeekTableEntry(makeSeekTableEntry(point, _bitstreamOffset, inputLength), buf);
+        buf += seekEntrySizeBytes;
+    }
+
+    return [data writeToURL:url options:NSDataWritingAtomic error:error];
+}
+
 @end
@@ -0,0 +1,309 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#pragma once
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+
+namespace sfb {
+namespace shorten {
+
+// MARK: - Shorten Bit Reader
+
+// Shorten codes nearly everything as Rice-Golomb codes: a unary quotient terminated by a one bit followed by `k` low
+// bits. Bits are consumed most significant first from a 64-bit reservoir holding the next bits of the stream in its
+// high bits, so a unary quotient is found with a single count of leading zeros.
+//
+// The reservoir is topped up eight bytes at a time by or'ing in the next bytes of the byte buffer aligned just below
+// the valid bits. Bits beyond the valid bits are always the following bits of the stream, so reloading bytes that
+// were partially loaded before leaves the reservoir unchanged.
+//
+// Positions are absolute bit offsets in the input, so the size of the byte buffer is independent of any saved state.
+
+/// The Rice-Golomb parameter of the parameter preceding an unsigned value in versions after 0
+constexpr int parameterUInt32 = 2;
+
+/// Variable-length input using Golomb-Rice coding
+class BitReader {
+  public:
+    /// Input callback type, reading at most `len` bytes into `buf` and setting `read` to the number of bytes read
+    using InputCallback = std::function<bool(void *buf, std::size_t len, std::size_t &read)>;
+
+    /// Creates an empty `BitReader` object
+    /// - important: `allocate()` must be called before using
+    BitReader() noexcept = default;
+
+    BitReader(const BitReader &) = delete;
+    BitReader(BitReader &&) = delete;
+    BitReader &operator=(const BitReader &) = delete;
+    BitReader &operator=(BitReader &&) = delete;
+
+    /// Sets the input callback
+    void setInputCallback(InputCallback callback) noexcept { inputCallback_ = std::move(callback); }
+
+    /// The default size of the byte buffer
+    static constexpr std::size_t defaultBufferSize = 64 * 1024;
+
+    /// Allocates an internal buffer of the specified size
+    bool allocate(std::size_t size = defaultBufferSize) noexcept {
+        if (byteBuffer_) {
+            return false;
+        }
+
+        byteBuffer_.reset(new (std::nothrow) unsigned char[size]);
+        if (!byteBuffer_) {
+            return false;
+        }
+
+        size_ = size;
+        reset();
+
+        return true;
+    }
+
+    /// Reads a Rice-Golomb code with `k` low bits
+    bool getRiceGolombCode(int32_t &i32, int k) noexcept {
+#if DEBUG
+        assert(k >= 0 && k < 32);
+#endif /* DEBUG */
+        if (k < 0 || k > 31) {
+            return false;
+        }
+
+        uint32_t value;
+        if (!readRice(value, k)) {
+            return false;
+        }
+        i32 = static_cast<int32_t>(value);
+        return true;
+    }
+
+    /// Reads a signed value with Rice-Golomb parameter `k`
+    bool getInt32(int32_t &i32, int k) noexcept {
+        if (k < -1 || k > 30) {
+            return false;
+        }
+
+        uint32_t value;
+        if (!readRice(value, k + 1)) {
+            return false;
+        }
+        i32 = fold(value);
+        return true;
+    }
+
+    /// Reads `count` signed values with Rice-Golomb parameter `k` into `dst`
+    ///
+    /// This is equivalent to `count` calls to `getInt32()` but decodes directly from the reservoir, only falling back
+    /// to the general path for codes that are not entirely in the reservoir
+    bool getInt32s(int32_t *dst, std::size_t count, int k) noexcept {
+        if (k < -1 || k > 30) {
+            return false;
+        }
+
+        const int bits = k + 1;
+        for (std::size_t i = 0; i < count; ++i) {
+            if (count_ < 40) {
+                topUp();
+            }
+            if (const auto zeros = std::countl_zero(cache_); zeros + 1 + bits <= count_) {
+                // Shift in two steps since `zeros + 1` may be 64
+                const auto cache = (cache_ << zeros) << 1;
+                const auto low = bits == 0 ? 0 : static_cast<uint32_t>(cache >> (64 - bits));
+                cache_ = bits == 0 ? cache : cache << bits;
+                count_ -= zeros + 1 + bits;
+                dst[i] = fold((static_cast<uint32_t>(zeros) << bits) | low);
+            } else {
+                uint32_t value;
+                if (!readRice(value, bits)) {
+                    return false;
+                }
+                dst[i] = fold(value);
+            }
+        }
+        return true;
+    }
+
+    /// Reads an unsigned value with Rice-Golomb parameter `k`, which for versions after 0 is itself read first
+    bool getUInt32(uint32_t &ui32, int version, int k) noexcept {
+        if (version > 0 && !getRiceGolombCode(k, parameterUInt32)) {
+            return false;
+        }
+
+        int32_t i32;
+        if (!getRiceGolombCode(i32, k)) {
+            return false;
+        }
+        ui32 = static_cast<uint32_t>(i32);
+        return true;
+    }
+
+    /// Discards all buffered input
+    /// - parameter byteOffset: The offset in the input of the next byte returned by the input callback
+    void reset(uint64_t byteOffset = 0) noexcept {
+        position_ = byteBuffer_.get();
+        end_ = position_;
+        bufferOffset_ = byteOffset;
+        nextBufferOffset_ = byteOffset;
+        cache_ = 0;
+        count_ = 0;
+    }
+
+    /// Returns the offset in the input of the next unread bit
+    uint64_t bitPosition() const noexcept {
+        return ((bufferOffset_ + static_cast<uint64_t>(position_ - byteBuffer_.get())) * 8) -
+               static_cast<uint64_t>(count_);
+    }
+
+    /// Reads the next `bits` bits without consuming them, which must be in [1, 32]
+    bool peekBits(uint32_t &value, int bits) noexcept {
+#if DEBUG
+        assert(bits > 0 && bits <= 32);
+#endif /* DEBUG */
+        if (!require(bits)) {
+            return false;
+        }
+        value = static_cast<uint32_t>(cache_ >> (64 - bits));
+        return true;
+    }
+
+    /// Discards `bits` bits, which must be less than 57
+    bool skipBits(int bits) noexcept {
+#if DEBUG
+        assert(bits >= 0 && bits < 57);
+#endif /* DEBUG */
+        if (bits == 0) {
+            return true;
+        }
+        if (!require(bits)) {
+            return false;
+        }
+        cache_ <<= bits;
+        count_ -= bits;
+        return true;
+    }
+
+  private:
+    /// Input callback
+    InputCallback inputCallback_;
+    /// Size of `byteBuffer_` in bytes
+    std::size_t size_ = 0;
+    /// Byte buffer
+    std::unique_ptr<unsigned char[]> byteBuffer_;
+    /// Offset in the input of `byteBuffer_`
+    uint64_t bufferOffset_ = 0;
+    /// Offset in the input of the next byte returned by the input callback
+    uint64_t nextBufferOffset_ = 0;
+    /// Next unread byte in `byteBuffer_`
+    const unsigned char *position_ = nullptr;
+    /// End of valid bytes in `byteBuffer_`
+    const unsigned char *end_ = nullptr;
+    /// The next bits of the stream, most significant first
+    uint64_t cache_ = 0;
+    /// Valid bits in `cache_`
+    int count_ = 0;
+
+    /// Returns the signed value folded into `u`
+    static constexpr int32_t fold(uint32_t u) noexcept {
+        return (u & 1) ? static_cast<int32_t>(~(u >> 1)) : static_cast<int32_t>(u >> 1);
+    }
+
+    /// Fills the byte buffer from the input callback
+    bool refill() noexcept {
+        std::size_t bytesRead = 0;
+        if (!inputCallback_ || !inputCallback_(byteBuffer_.get(), size_, bytesRead) || bytesRead == 0 ||
+            bytesRead > size_) {
+            return false;
+        }
+        position_ = byteBuffer_.get();
+        end_ = position_ + bytesRead;
+        bufferOffset_ = nextBufferOffset_;
+        nextBufferOffset_ += bytesRead;
+        return true;
+    }
+
+    /// Moves whole bytes from the byte buffer into `cache_` without reading input
+    /// - important: `count_` must be less than 57
+    void topUp() noexcept {
+#if DEBUG
+        assert(count_ < 57);
+#endif /* DEBUG */
+        if (end_ - position_ >= 8) {
+            uint64_t word;
+            std::memcpy(&word, position_, 8);
+            if constexpr (std::endian::native == std::endian::little) {
+                word = __builtin_bswap64(word);
+            }
+            cache_ |= word >> count_;
+            const auto bytes = (63 - count_) >> 3;
+            position_ += bytes;
+            count_ += bytes * 8;
+        } else {
+            while (count_ <= 56 && position_ != end_) {
+                cache_ |= static_cast<uint64_t>(*position_++) << (56 - count_);
+                count_ += 8;
+            }
+        }
+    }
+
+    /// Ensures at least `bits` bits are available in `cache_`, reading input if necessary
+    /// - important: `bits` must be less than 57
+    bool require(int bits) noexcept {
+        while (count_ < bits) {
+            if (position_ == end_ && !refill()) {
+                return false;
+            }
+            topUp();
+        }
+        return true;
+    }
+
+    /// Reads a Rice-Golomb code with `k` low bits, which must be in [0, 32]
+    bool readRice(uint32_t &value, int k) noexcept {
+        // Calculate unary quotient
+        uint32_t quotient = 0;
+        for (;;) {
+            if (!require(1)) {
+                return false;
+            }
+            if (const auto zeros = std::countl_zero(cache_); zeros < count_) {
+                // Shift in two steps since `zeros + 1` may be 64
+                cache_ = (cache_ << zeros) << 1;
+                count_ -= zeros + 1;
+                quotient += static_cast<uint32_t>(zeros);
+                break;
+            }
+            // All valid bits are zero
+            quotient += static_cast<uint32_t>(count_);
+            cache_ = 0;
+            count_ = 0;
+        }
+
+        if (k == 0) {
+            value = quotient;
+            return true;
+        }
+
+        if (!require(k)) {
+            return false;
+        }
+        value = (quotient << k) | static_cast<uint32_t>(cache_ >> (64 - k));
+        cache_ <<= k;
+        count_ -= k;
+        return true;
+    }
+};
+
+} /* namespace shorten */
+} /* namespace sfb */
@@ -0,0 +1,253 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif /* defined(__SSE4_1__) */
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif /* defined(__SSE2__) */
+
+namespace sfb {
+namespace shorten {
+
+// MARK: - Shorten Prediction
+
+// Samples are reconstructed in place from residuals by adding a prediction from the preceding samples. The samples
+// preceding the first sample of a block are the history carried over from the previous block, so `samples[-1]` through
+// `samples[-order]` must be valid.
+//
+// Prediction is a serial recurrence, so speed comes from keeping the recent samples in registers and unrolling the
+// prediction for each order rather than from vectorization. Each order up to `maxSpecializedLPCOrder` has its own
+// kernel with the coefficients held in registers; higher orders use a general loop.
+//
+// Conversion of reconstructed samples to the output sample format is independent per sample and is vectorized.
+
+/// The highest linear predictor order with a specialized kernel
+constexpr int maxSpecializedLPCOrder = 32;
+
+/// Adds `offset` to `count` samples
+inline void addOffset(int32_t *samples, std::size_t count, int32_t offset) noexcept {
+    for (std::size_t i = 0; i < count; ++i) {
+        samples[i] += offset;
+    }
+}
+
+/// Reconstructs `count` samples from residuals using the fixed polynomial predictor of order `Order`
+template <int Order>
+void restoreFixed(int32_t *samples, std::size_t count) noexcept {
+    static_assert(Order >= 1 && Order <= 3, "Fixed predictor order must be between 1 and 3");
+
+    auto p1 = samples[-1];
+    if constexpr (Order == 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            p1 += samples[i];
+            samples[i] = p1;
+        }
+    } else if constexpr (Order == 2) {
+        auto p2 = samples[-2];
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto value = samples[i] + (2 * p1 - p2);
+            samples[i] = value;
+            p2 = p1;
+            p1 = value;
+        }
+    } else {
+        auto p2 = samples[-2];
+        auto p3 = samples[-3];
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto value = samples[i] + (3 * (p1 - p2)) + p3;
+            samples[i] = value;
+            p3 = p2;
+            p2 = p1;
+            p1 = value;
+        }
+    }
+}
+
+/// Reconstructs `count` samples from residuals using the fixed polynomial predictor of order `order`
+/// - parameter order: The predictor order in [0, 3]; order 0 predicts `offset`
+inline void restoreFixed(int order, int32_t *samples, std::size_t count, int32_t offset) noexcept {
+#if DEBUG
+    assert(order >= 0 && order <= 3);
+#endif /* DEBUG */
+    switch (order) {
+    case 0:
+        addOffset(samples, count, offset);
+        break;
+    case 1:
+        restoreFixed<1>(samples, count);
+        break;
+    case 2:
+        restoreFixed<2>(samples, count);
+        break;
+    case 3:
+        restoreFixed<3>(samples, count);
+        break;
+    }
+}
+
+namespace detail {
+
+/// Reconstructs `count` samples from residuals using the linear predictor `coefficients` of any order
+inline void restoreLPC(int32_t *samples, std::size_t count, const int32_t *coefficients, int order,
+                       int32_t quantOffset, int shift) noexcept {
+    for (std::size_t i = 0; i < count; ++i) {
+        int32_t sum = quantOffset;
+        for (auto j = 0; j < order; ++j) {
+            sum += coefficients[j] * samples[i - j - 1];
+        }
+        samples[i] += (sum >> shift);
+    }
+}
+
+/// Reconstructs `count` samples from residuals using the linear predictor `coefficients` of order `Order`
+template <int Order>
+void restoreLPC(int32_t *samples, std::size_t count, const int32_t *coefficients, int32_t quantOffset,
+                int shift) noexcept {
+    std::array<int32_t, Order> c;
+    std::copy_n(coefficients, Order, c.begin());
+
+    if constexpr (Order <= 4) {
+        // Low orders keep the most recent samples in registers, newest first
+        std::array<int32_t, Order> history;
+        for (auto j = 0; j < Order; ++j) {
+            history[j] = samples[-j - 1];
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            int32_t sum = quantOffset;
+            [&]<std::size_t... J>(std::index_sequence<J...>) {
+                ((sum += c[J] * history[J]), ...);
+            }(std::make_index_sequence<Order>{});
+            const auto value = samples[i] + (sum >> shift);
+            samples[i] = value;
+            for (auto j = Order - 1; j > 0; --j) {
+                history[j] = history[j - 1];
+            }
+            if constexpr (Order > 0) {
+                history[0] = value;
+            }
+        }
+    } else {
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto *previous = samples + i - 1;
+            int32_t sum = quantOffset;
+            [&]<std::size_t... J>(std::index_sequence<J...>) {
+                ((sum += c[J] * previous[-static_cast<std::ptrdiff_t>(J)]), ...);
+            }(std::make_index_sequence<Order>{});
+            samples[i] += (sum >> shift);
+        }
+    }
+}
+
+/// Linear predictor kernel type
+using LPCKernel = void (*)(int32_t *, std::size_t, const int32_t *, int32_t, int) noexcept;
+
+/// Returns the specialized kernels for orders 0 through `maxSpecializedLPCOrder`
+template <std::size_t... Orders>
+constexpr std::array<LPCKernel, sizeof...(Orders)> makeLPCKernels(std::index_sequence<Orders...>) noexcept {
+    return {&restoreLPC<static_cast<int>(Orders)>...};
+}
+
+/// Specialized linear predictor kernels indexed by order
+inline constexpr auto lpcKernels = makeLPCKernels(std::make_index_sequence<maxSpecializedLPCOrder + 1>{});
+
+} /* namespace detail */
+
+/// Reconstructs `count` samples from residuals using the linear predictor `coefficients` of order `order`
+///
+/// Each sample is the residual plus the sum of `quantOffset` and the products of the coefficients and the preceding
+/// samples, shifted right by `shift`
+inline void restoreLPC(int32_t *samples, std::size_t count, const int32_t *coefficients, int order,
+                       int32_t quantOffset, int shift) noexcept {
+#if DEBUG
+    assert(order >= 0);
+#endif /* DEBUG */
+    if (order <= maxSpecializedLPCOrder) {
+        detail::lpcKernels[static_cast<std::size_t>(order)](samples, count, coefficients, quantOffset, shift);
+    } else {
+        detail::restoreLPC(samples, count, coefficients, order, quantOffset, shift);
+    }
+}
+
+namespace detail {
+
+/// Converts `count` samples to `T`, shifting left by `shift` and clamping to the range of `T`
+template <typename T>
+void convertSamples(const int32_t *src, T *dst, std::size_t count, int shift) noexcept {
+    constexpr auto lower = static_cast<int32_t>(std::numeric_limits<T>::min());
+    constexpr auto upper = static_cast<int32_t>(std::numeric_limits<T>::max());
+    for (std::size_t i = 0; i < count; ++i) {
+        dst[i] = static_cast<T>(std::clamp(src[i] << shift, lower, upper));
+    }
+}
+
+} /* namespace detail */
+
+/// Converts `count` samples to `T`, shifting left by `shift` and clamping to the range of `T`
+///
+/// 16-bit conversions use saturating vector narrowing where available
+template <typename T>
+void convertSamples(const int32_t *src, T *dst, std::size_t count, int shift) noexcept {
+    static_assert(std::is_integral_v<T> && sizeof(T) <= 2, "Unsupported sample type");
+
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    constexpr bool vectorized = std::is_same_v<T, int16_t>
+#if defined(__SSE4_1__)
+                                || std::is_same_v<T, uint16_t>
+#endif /* defined(__SSE4_1__) */
+            ;
+    if constexpr (vectorized) {
+        const auto count32 = _mm_cvtsi32_si128(shift);
+        for (; i + 8 <= count; i += 8) {
+            const auto a = _mm_sll_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)), count32);
+            const auto b = _mm_sll_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 4)), count32);
+            __m128i packed;
+            if constexpr (std::is_same_v<T, int16_t>) {
+                packed = _mm_packs_epi32(a, b);
+            } else {
+#if defined(__SSE4_1__)
+                packed = _mm_packus_epi32(a, b);
+#endif /* defined(__SSE4_1__) */
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), packed);
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    if constexpr (sizeof(T) == 2) {
+        const auto shifts = vdupq_n_s32(shift);
+        for (; i + 8 <= count; i += 8) {
+            const auto a = vshlq_s32(vld1q_s32(src + i), shifts);
+            const auto b = vshlq_s32(vld1q_s32(src + i + 4), shifts);
+            if constexpr (std::is_same_v<T, int16_t>) {
+                vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+            } else {
+                vst1q_u16(dst + i, vcombine_u16(vqmovun_s32(a), vqmovun_s32(b)));
+            }
+        }
+    }
+#endif /* defined(__SSE2__) */
+
+    detail::convertSamples(src + i, dst + i, count - i, shift);
+}
+
+} /* namespace shorten */
+} /* namespace sfb */
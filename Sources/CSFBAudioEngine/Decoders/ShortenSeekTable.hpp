@@ -0,0 +1,269 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace sfb {
+namespace shorten {
+
+// MARK: - Shorten Seek Tables
+
+// A Shorten seek table is a header followed by fixed-size entries, each recording the complete state of the reference
+// decoder at a block boundary. Seek tables are stored in separate `skt` files or appended to the audio, in which case
+// a trailer follows the entries. All values are little-endian.
+//
+// An entry records input buffering as the reference decoder performs it: the offset of the last 512-byte block read,
+// the position of the next unread 32-bit word in that block, and the unread bits of the current word. A block is read
+// only once every byte of the previous block is consumed, so the position in a block may equal the block size. Seek
+// points convert entries to absolute bit offsets, which are independent of how input is buffered, and back again.
+//
+// An entry holds three samples of history and four running means for each of at most two channels, so only mono and
+// stereo streams with a maximum linear prediction order of three and at most four means are representable.
+
+/// The seek table revision
+constexpr auto seekTableRevision = 1;
+/// The size of a seek table header in bytes
+constexpr auto seekHeaderSizeBytes = 12;
+/// The size of a seek table trailer in bytes
+constexpr auto seekTrailerSizeBytes = 12;
+/// The size of a seek table entry in bytes
+constexpr auto seekEntrySizeBytes = 80;
+/// Seek table entries record the state of a decoder reading input in blocks of this size
+constexpr auto seekTableBufferSizeBytes = 512;
+
+namespace detail {
+
+/// Returns the little-endian 16-bit value at `offset` in `buf`
+inline uint16_t readLittleUInt16(const void *buf, std::size_t offset) noexcept {
+    const auto *p = static_cast<const unsigned char *>(buf) + offset;
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+/// Returns the little-endian 32-bit value at `offset` in `buf`
+inline uint32_t readLittleUInt32(const void *buf, std::size_t offset) noexcept {
+    const auto *p = static_cast<const unsigned char *>(buf) + offset;
+    return uint32_t{p[0]} | (uint32_t{p[1]} << 8) | (uint32_t{p[2]} << 16) | (uint32_t{p[3]} << 24);
+}
+
+/// Writes `value` as a little-endian 16-bit value at `offset` in `buf`
+inline void writeLittleUInt16(void *buf, std::size_t offset, uint16_t value) noexcept {
+    auto *p = static_cast<unsigned char *>(buf) + offset;
+    p[0] = static_cast<unsigned char>(value);
+    p[1] = static_cast<unsigned char>(value >> 8);
+}
+
+/// Writes `value` as a little-endian 32-bit value at `offset` in `buf`
+inline void writeLittleUInt32(void *buf, std::size_t offset, uint32_t value) noexcept {
+    auto *p = static_cast<unsigned char *>(buf) + offset;
+    for (auto i = 0; i < 4; ++i) {
+        p[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+}
+
+} /* namespace detail */
+
+/// Shorten seek table header
+struct SeekTableHeader {
+    int8_t signature_[4];
+    uint32_t version_;
+    uint32_t fileSize_;
+};
+
+inline SeekTableHeader parseSeekTableHeader(const void *buf) noexcept {
+    SeekTableHeader header;
+    std::memcpy(header.signature_, buf, 4);
+    header.version_ = detail::readLittleUInt32(buf, 4);
+    header.fileSize_ = detail::readLittleUInt32(buf, 8);
+
+    return header;
+}
+
+inline void writeSeekTableHeader(const SeekTableHeader &header, void *buf) noexcept {
+    std::memcpy(buf, header.signature_, 4);
+    detail::writeLittleUInt32(buf, 4, header.version_);
+    detail::writeLittleUInt32(buf, 8, header.fileSize_);
+}
+
+/// Shorten seek table trailer
+struct SeekTableTrailer {
+    uint32_t seekTableSize_;
+    int8_t signature_[8];
+};
+
+inline SeekTableTrailer parseSeekTableTrailer(const void *buf) noexcept {
+    SeekTableTrailer trailer;
+    trailer.seekTableSize_ = detail::readLittleUInt32(buf, 0);
+    std::memcpy(trailer.signature_, static_cast<const unsigned char *>(buf) + 4, 8);
+
+    return trailer;
+}
+
+/// A Shorten seek table entry
+struct SeekTableEntry {
+    uint32_t frameNumber_;
+    uint32_t byteOffsetInFile_;
+    uint32_t lastBufferReadPosition_;
+    uint16_t bytesAvailable_;
+    uint16_t byteBufferPosition_;
+    uint16_t bitBufferPosition_;
+    uint32_t bitBuffer_;
+    uint16_t bitshift_;
+    int32_t chanBuf0_[3];
+    int32_t chanBuf1_[3];
+    int32_t offset0_[4];
+    int32_t offset1_[4];
+};
+
+inline SeekTableEntry parseSeekTableEntry(const void *buf) noexcept {
+    SeekTableEntry entry;
+    entry.frameNumber_ = detail::readLittleUInt32(buf, 0);
+    entry.byteOffsetInFile_ = detail::readLittleUInt32(buf, 4);
+    entry.lastBufferReadPosition_ = detail::readLittleUInt32(buf, 8);
+    entry.bytesAvailable_ = detail::readLittleUInt16(buf, 12);
+    entry.byteBufferPosition_ = detail::readLittleUInt16(buf, 14);
+    entry.bitBufferPosition_ = detail::readLittleUInt16(buf, 16);
+    entry.bitBuffer_ = detail::readLittleUInt32(buf, 18);
+    entry.bitshift_ = detail::readLittleUInt16(buf, 22);
+    for (auto i = 0; i < 3; ++i) {
+        entry.chanBuf0_[i] = static_cast<int32_t>(detail::readLittleUInt32(buf, 24 + 4 * i));
+    }
+    for (auto i = 0; i < 3; ++i) {
+        entry.chanBuf1_[i] = static_cast<int32_t>(detail::readLittleUInt32(buf, 36 + 4 * i));
+    }
+    for (auto i = 0; i < 4; ++i) {
+        entry.offset0_[i] = static_cast<int32_t>(detail::readLittleUInt32(buf, 48 + 4 * i));
+    }
+    for (auto i = 0; i < 4; ++i) {
+        entry.offset1_[i] = static_cast<int32_t>(detail::readLittleUInt32(buf, 64 + 4 * i));
+    }
+
+    return entry;
+}
+
+inline void writeSeekTableEntry(const SeekTableEntry &entry, void *buf) noexcept {
+    detail::writeLittleUInt32(buf, 0, entry.frameNumber_);
+    detail::writeLittleUInt32(buf, 4, entry.byteOffsetInFile_);
+    detail::writeLittleUInt32(buf, 8, entry.lastBufferReadPosition_);
+    detail::writeLittleUInt16(buf, 12, entry.bytesAvailable_);
+    detail::writeLittleUInt16(buf, 14, entry.byteBufferPosition_);
+    detail::writeLittleUInt16(buf, 16, entry.bitBufferPosition_);
+    detail::writeLittleUInt32(buf, 18, entry.bitBuffer_);
+    detail::writeLittleUInt16(buf, 22, entry.bitshift_);
+    for (auto i = 0; i < 3; ++i) {
+        detail::writeLittleUInt32(buf, 24 + 4 * i, static_cast<uint32_t>(entry.chanBuf0_[i]));
+    }
+    for (auto i = 0; i < 3; ++i) {
+        detail::writeLittleUInt32(buf, 36 + 4 * i, static_cast<uint32_t>(entry.chanBuf1_[i]));
+    }
+    for (auto i = 0; i < 4; ++i) {
+        detail::writeLittleUInt32(buf, 48 + 4 * i, static_cast<uint32_t>(entry.offset0_[i]));
+    }
+    for (auto i = 0; i < 4; ++i) {
+        detail::writeLittleUInt32(buf, 64 + 4 * i, static_cast<uint32_t>(entry.offset1_[i]));
+    }
+}
+
+// MARK: - Seek Points
+
+/// A decoder state from which decoding may resume, independent of how input is buffered
+struct SeekPoint {
+    uint32_t frameNumber_;
+    /// The offset in the input of the next unread bit
+    uint64_t bitOffset_;
+    /// The unread bits of the current 32-bit word, the only bits of the word a seek table entry requires
+    uint32_t bitBuffer_;
+    uint16_t bitshift_;
+    int32_t chanBuf0_[3];
+    int32_t chanBuf1_[3];
+    int32_t offset0_[4];
+    int32_t offset1_[4];
+};
+
+/// Returns the offset in the input of the next unread bit in `entry` or `-1` if the entry is inconsistent
+inline int64_t seekTableEntryBitOffset(const SeekTableEntry &entry) noexcept {
+    if (entry.byteBufferPosition_ > seekTableBufferSizeBytes || entry.bitBufferPosition_ > 32) {
+        return -1;
+    }
+    const auto wordEnd = (static_cast<int64_t>(entry.lastBufferReadPosition_) + entry.byteBufferPosition_) * 8;
+    if (wordEnd < entry.bitBufferPosition_) {
+        return -1;
+    }
+    return wordEnd - entry.bitBufferPosition_;
+}
+
+/// Returns a seek point equivalent to `entry`
+/// - important: `seekTableEntryBitOffset(entry)` must not be negative
+inline SeekPoint makeSeekPoint(const SeekTableEntry &entry) noexcept {
+    SeekPoint point;
+    point.frameNumber_ = entry.frameNumber_;
+    point.bitOffset_ = static_cast<uint64_t>(seekTableEntryBitOffset(entry));
+    point.bitBuffer_ = entry.bitBuffer_;
+    point.bitshift_ = entry.bitshift_;
+    std::memcpy(point.chanBuf0_, entry.chanBuf0_, sizeof point.chanBuf0_);
+    std::memcpy(point.chanBuf1_, entry.chanBuf1_, sizeof point.chanBuf1_);
+    std::memcpy(point.offset0_, entry.offset0_, sizeof point.offset0_);
+    std::memcpy(point.offset1_, entry.offset1_, sizeof point.offset1_);
+    return point;
+}
+
+/// Returns the input offset a decoder reading blocks of `seekTableBufferSizeBytes` starting at `bitstreamOffset` has
+/// reached when its next unread bit is at `bitOffset`
+///
+/// Such a decoder reads whole 32-bit words, and reads the next block only when the current one is exhausted.
+inline int64_t seekTableInputOffset(uint64_t bitOffset, int64_t bitstreamOffset, int64_t inputLength) noexcept {
+    const auto bitsConsumed = static_cast<int64_t>(bitOffset) - (bitstreamOffset * 8);
+    const auto bytesConsumed = ((bitsConsumed + 31) / 32) * 4;
+    const auto blocksRead = (bytesConsumed + seekTableBufferSizeBytes - 1) / seekTableBufferSizeBytes;
+    return std::min(bitstreamOffset + (blocksRead * seekTableBufferSizeBytes), inputLength);
+}
+
+/// Returns the number of unread bits in the current 32-bit word of a decoder reading words starting at
+/// `bitstreamOffset` when its next unread bit is at `bitOffset`
+inline int seekTableBitsInWord(uint64_t bitOffset, int64_t bitstreamOffset) noexcept {
+    const auto bitsConsumed = static_cast<int64_t>(bitOffset) - (bitstreamOffset * 8);
+    return static_cast<int>((32 - (bitsConsumed % 32)) % 32);
+}
+
+/// Returns a seek table entry equivalent to `point` for a decoder reading blocks of `seekTableBufferSizeBytes`
+/// starting at `bitstreamOffset`
+/// - important: `inputLength` must be representable in 32 bits
+inline SeekTableEntry makeSeekTableEntry(const SeekPoint &point, int64_t bitstreamOffset,
+                                         int64_t inputLength) noexcept {
+    const auto bitsConsumed = static_cast<int64_t>(point.bitOffset_) - (bitstreamOffset * 8);
+    const auto bytesConsumed = ((bitsConsumed + 31) / 32) * 4;
+    // The block holding the current word, which remains the last block read until all of its bytes are consumed
+    const auto blockIndex =
+            std::max<int64_t>(0, ((bytesConsumed + seekTableBufferSizeBytes - 1) / seekTableBufferSizeBytes) - 1);
+    const auto lastBufferReadPosition = bitstreamOffset + (blockIndex * seekTableBufferSizeBytes);
+    const auto byteBufferPosition = bytesConsumed - (blockIndex * seekTableBufferSizeBytes);
+    const auto blockSize = std::min<int64_t>(seekTableBufferSizeBytes, inputLength - lastBufferReadPosition);
+    const auto bitsInWord = seekTableBitsInWord(point.bitOffset_, bitstreamOffset);
+
+    SeekTableEntry entry;
+    entry.frameNumber_ = point.frameNumber_;
+    entry.byteOffsetInFile_ =
+            static_cast<uint32_t>(seekTableInputOffset(point.bitOffset_, bitstreamOffset, inputLength));
+    entry.lastBufferReadPosition_ = static_cast<uint32_t>(lastBufferReadPosition);
+    entry.bytesAvailable_ = static_cast<uint16_t>(std::max<int64_t>(0, blockSize - byteBufferPosition));
+    entry.byteBufferPosition_ = static_cast<uint16_t>(byteBufferPosition);
+    entry.bitBufferPosition_ = static_cast<uint16_t>(bitsInWord);
+    entry.bitBuffer_ = bitsInWord == 0 ? 0 : point.bitBuffer_ & (UINT32_MAX >> (32 - bitsInWord));
+    entry.bitshift_ = point.bitshift_;
+    std::memcpy(entry.chanBuf0_, point.chanBuf0_, sizeof entry.chanBuf0_);
+    std::memcpy(entry.chanBuf1_, point.chanBuf1_, sizeof entry.chanBuf1_);
+    std::memcpy(entry.offset0_, point.offset0_, sizeof entry.offset0_);
+    std::memcpy(entry.offset1_, point.offset1_, sizeof entry.offset1_);
+    return entry;
+}
+
+} /* namespace shorten */
+} /* namespace sfb */
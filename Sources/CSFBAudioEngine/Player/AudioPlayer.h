@@ -112,6 +112,22 @@ struct TransportSnapshot final {
                                     SFBPlaybackTime *_Nullable time) const noexcept;
 };
 
+/// A snapshot of the most recent loudness meter reading.
+struct LoudnessSnapshot final {
+    /// Decoder sequence number for the measured audio.
+    uint64_t sequenceNumber_{0};
+    /// Decoder frame position immediately following the measured audio.
+    int64_t framePosition_{SFBUnknownFramePosition};
+    /// Momentary loudness in LUFS.
+    float momentaryLoudness_{0};
+    /// Short-term loudness in LUFS.
+    float shortTermLoudness_{0};
+    /// True peak over the momentary window in dBTP.
+    float truePeak_{0};
+    /// Whether this snapshot contains valid data.
+    bool isValid_{false};
+};
+
 /// A seek request.
 struct SeekRequest final {
     /// Decoder sequence number for the request.
@@ -138,6 +154,7 @@ class AudioPlayer final {
 
   private:
     struct DecoderState;
+    struct LoudnessMeter;
 
     using DecoderStateVector = std::vector<std::unique_ptr<DecoderState>>;
 
@@ -189,6 +206,14 @@ class AudioPlayer final {
     static_assert(std::atomic<detail::SeekRequest>::is_always_lock_free,
                   "Lock-free std::atomic<detail::SeekRequest> required");
 
+    /// Loudness meter measuring decoded audio, or `nullptr` if metering is disabled
+    /// - note: This is only accessed from the decoding thread
+    std::unique_ptr<LoudnessMeter> loudnessMeter_;
+    /// Most recent loudness meter reading
+    mutable detail::LoudnessSnapshot currentLoudness_{};
+    /// Seqlock protecting `currentLoudness_`
+    std::atomic_uint64_t loudnessSequence_{0};
+
     /// Decoder currently rendering audio
     Decoder nowPlaying_{nil};
     /// Mutex protecting `nowPlaying_`
@@ -286,6 +311,13 @@ class AudioPlayer final {
     bool setOutputDeviceID(AUAudioObjectID outputDeviceID, NSError **error) noexcept;
 #endif /* !TARGET_OS_IPHONE */
 
+    // MARK: - Loudness Metering
+
+    bool loudnessMeteringEnabled() const noexcept;
+    void setLoudnessMeteringEnabled(bool enabled) noexcept;
+
+    bool getLoudnessReading(SFBAudioPlayerLoudnessReading *_Nonnull reading) const noexcept;
+
     // MARK: - AVAudioEngine
 
     void modifyProcessingGraph(void (^_Nonnull block)(AVAudioEngine *_Nonnull engine)) const noexcept;
@@ -315,6 +347,8 @@ class AudioPlayer final {
         formatChangePending = 1u << 4,
         /// The event message queue had insufficient space to record a render event
         renderEventDropped = 1u << 5,
+        /// Decoded audio is measured by the loudness meter
+        loudnessMetering = 1u << 6,
     };
 
     friend constexpr void is_bitmask_enum(Flags);
@@ -375,6 +409,9 @@ class AudioPlayer final {
     /// Decodes audio from `decoderState` into the ring buffer
     bool decodeIntoRingBuffer(DecoderState *decoderState, AVAudioPCMBuffer *buffer) noexcept;
 
+    /// Measures the loudness of the audio in `buffer` described by `descriptor` if metering is enabled
+    void meterLoudness(const detail::DecodedChunkDescriptor &descriptor, AVAudioPCMBuffer *_Nonnull buffer) noexcept;
+
     /// Returns the appropriate decoding semaphore timeout
     int64_t decodingTimeout(DecoderState *_Nullable decoderState) const noexcept;
 
@@ -454,6 +491,12 @@ class AudioPlayer final {
     /// Reads the most recently published playback snapshot.
     [[nodiscard]] detail::TransportSnapshot loadTransportSnapshot() const noexcept;
 
+    /// Publishes a loudness meter reading.
+    void publishLoudnessSnapshot(const detail::LoudnessSnapshot &snapshot) noexcept;
+
+    /// Reads the most recently published loudness meter reading.
+    [[nodiscard]] detail::LoudnessSnapshot loadLoudnessSnapshot() const noexcept;
+
     // MARK: - Active Decoder Management
 
     /// Cancels all active decoders in sequence
@@ -556,6 +599,18 @@ inline bool AudioPlayer::getPlaybackPositionAndTime(SFBPlaybackPosition *positio
     return snapshot.getPlaybackPositionAndTime(position, time);
 }
 
+inline bool AudioPlayer::loudnessMeteringEnabled() const noexcept {
+    return bits::is_set(loadFlags(), Flags::loudnessMetering);
+}
+
+inline void AudioPlayer::setLoudnessMeteringEnabled(bool enabled) noexcept {
+    if (enabled) {
+        setFlags(Flags::loudnessMetering);
+    } else {
+        clearFlags(Flags::loudnessMetering);
+    }
+}
+
 inline AVAudioSourceNode *_Nonnull AudioPlayer::sourceNode() const noexcept { return sourceNode_; }
 
 inline AVAudioMixerNode *_Nonnull AudioPlayer::mainMixerNode() const noexcept { return engine_.mainMixerNode; }
@@ -13,6 +13,7 @@
 #import "SFBAudioPlayer+Internal.h"
 #import "SFBCStringForOSType.h"
 #import "host_time.hpp"
+#import "loudness_ebur128/ebur128_analyzer.h"
 
 #import <AVFAudioExtensions/AVFAudioExtensions.h>
 
@@ -21,6 +22,7 @@
 #import <objc/runtime.h>
 
 #import <algorithm>
+#import <array>
 #import <atomic>
 #import <cmath>
 #import <concepts>
@@ -521,6 +523,87 @@ inline bool AudioPlayer::DecoderState::seekToFrame(AVAudioFramePosition frame, N
     return true;
 }
 
+// MARK: - Loudness Meter
+
+/// State for measuring the loudness of decoded audio
+struct AudioPlayer::LoudnessMeter final {
+    /// The number of chunk true peaks retained
+    static constexpr std::size_t peakHistoryCapacity = 256;
+
+    /// The format of the measured audio
+    AVAudioFormat *const format_{nil};
+    /// The number of frames in a momentary block
+    const int64_t momentaryBlockFrames_{0};
+    /// The analyzer, which keeps no measurements for integrated loudness or loudness range
+    loudness::EbuR128Analyzer analyzer_;
+
+    /// The most recently measured chunk
+    std::optional<detail::DecodedChunkDescriptor> lastChunk_{};
+
+    /// A chunk's true peak
+    struct ChunkPeak final {
+        /// The true peak, linear
+        float peak_{0};
+        /// The number of frames in the chunk
+        uint32_t frameLength_{0};
+    };
+
+    /// True peaks of recently measured chunks in a circular buffer
+    std::array<ChunkPeak, peakHistoryCapacity> peakHistory_{};
+    /// The index in `peakHistory_` of the next true peak
+    std::size_t nextPeak_{0};
+
+    explicit LoudnessMeter(AVAudioFormat *_Nonnull format);
+
+    /// Returns true if the chunk described by `descriptor` immediately follows the most recently measured chunk
+    bool isContinuation(const detail::DecodedChunkDescriptor &descriptor) const noexcept;
+
+    /// Discards all measurements so unrelated audio in the same format can be measured
+    void reset() noexcept;
+
+    /// Records the true peak of a chunk and returns the largest true peak over the momentary window, linear
+    float addChunkPeak(float peak, uint32_t frameLength) noexcept;
+};
+
+inline AudioPlayer::LoudnessMeter::LoudnessMeter(AVAudioFormat *format)
+  : format_{format}, momentaryBlockFrames_{static_cast<int64_t>(format.sampleRate * 0.4)},
+    analyzer_{static_cast<int32_t>(format.channelCount), loudness::DefaultChannelWeights(),
+              static_cast<int32_t>(std::lround(format.sampleRate)), true, loudness::EbuR128Analyzer::NONE} {}
+
+inline bool
+AudioPlayer::LoudnessMeter::isContinuation(const detail::DecodedChunkDescriptor &descriptor) const noexcept {
+    if (!lastChunk_ || lastChunk_->playbackGeneration_ != descriptor.playbackGeneration_) {
+        return false;
+    }
+    // Gapless transitions are continuous
+    if (lastChunk_->sequenceNumber_ != descriptor.sequenceNumber_) {
+        return lastChunk_->isLast() && descriptor.isFirst();
+    }
+    return lastChunk_->framePosition_ + lastChunk_->frameLength_ == descriptor.framePosition_;
+}
+
+inline void AudioPlayer::LoudnessMeter::reset() noexcept {
+    analyzer_.Reset();
+    lastChunk_.reset();
+    peakHistory_.fill({});
+    nextPeak_ = 0;
+}
+
+inline float AudioPlayer::LoudnessMeter::addChunkPeak(float peak, uint32_t frameLength) noexcept {
+    peakHistory_[nextPeak_] = {.peak_ = peak, .frameLength_ = frameLength};
+    nextPeak_ = (nextPeak_ + 1) % peakHistoryCapacity;
+
+    // Walk backward from the most recent chunk until the momentary window is covered
+    auto maximumPeak = 0.f;
+    int64_t frames = 0;
+    for (std::size_t i = 0; i < peakHistoryCapacity && frames < momentaryBlockFrames_; ++i) {
+        const auto &chunkPeak = peakHistory_[(nextPeak_ + peakHistoryCapacity - 1 - i) % peakHistoryCapacity];
+        maximumPeak = std::max(maximumPeak, chunkPeak.peak_);
+        frames += chunkPeak.frameLength_;
+    }
+    return maximumPeak;
+}
+
 } /* namespace sfb */
 
 // MARK: - AudioPlayer
@@ -977,6 +1060,34 @@ bool sfb::AudioPlayer::seekToFrameInSnapshot(const detail::TransportSnapshot &sn
     return true;
 }
 
+// MARK: - Loudness Metering
+
+bool sfb::AudioPlayer::getLoudnessReading(SFBAudioPlayerLoudnessReading *reading) const noexcept {
+#if DEBUG
+    assert(reading != nullptr);
+#endif /* DEBUG */
+
+    if (!loudnessMeteringEnabled() || !loadTransportSnapshot().isValid_) {
+        return false;
+    }
+
+    const auto snapshot = loadLoudnessSnapshot();
+    if (!snapshot.isValid_) {
+        return false;
+    }
+
+    // The analyzer reports unmeasurable levels as a large negative sentinel
+    const auto level = [](float value) noexcept {
+        return value <= loudness::kMinLKFS ? -std::numeric_limits<float>::infinity() : value;
+    };
+
+    *reading = {.framePosition = snapshot.framePosition_,
+                .momentaryLoudness = level(snapshot.momentaryLoudness_),
+                .shortTermLoudness = level(snapshot.shortTermLoudness_),
+                .truePeak = level(snapshot.truePeak_)};
+    return true;
+}
+
 #if !TARGET_OS_IPHONE
 
 // MARK: - Volume Control
@@ -1554,6 +1665,9 @@ bool sfb::AudioPlayer::decodeIntoRingBuffer(DecoderState *decoderState, AVAudioP
             os_log_fault(log_, "Error writing chunk descriptor: spsc::Queue::push failed");
         }
 
+        // Measure the loudness of the converted audio
+        meterLoudness(descriptor, buffer);
+
         // Write the decoded audio to the audio buffer for rendering
         const auto framesWritten = audioBuffer_.write(*(buffer.audioBufferList), framesDecoded);
         if (framesWritten != framesDecoded) {
@@ -1593,6 +1707,57 @@ bool sfb::AudioPlayer::decodeIntoRingBuffer(DecoderState *decoderState, AVAudioP
     return true;
 }
 
+void sfb::AudioPlayer::meterLoudness(const detail::DecodedChunkDescriptor &descriptor,
+                                     AVAudioPCMBuffer *buffer) noexcept {
+#if DEBUG
+    assert(buffer != nil);
+#endif /* DEBUG */
+
+    if (bits::is_clear(loadFlags(), Flags::loudnessMetering)) [[likely]] {
+        if (loudnessMeter_) {
+            loudnessMeter_.reset();
+            publishLoudnessSnapshot({});
+        }
+        return;
+    }
+
+    // Restart measurement following a format change or a discontinuity such as a seek
+    auto format = buffer.format;
+    if (loudnessMeter_ && ![loudnessMeter_->format_ isEqual:format]) {
+        loudnessMeter_.reset();
+        publishLoudnessSnapshot({});
+    } else if (loudnessMeter_ && !loudnessMeter_->isContinuation(descriptor)) {
+        loudnessMeter_->reset();
+        publishLoudnessSnapshot({});
+    }
+
+    if (!loudnessMeter_) {
+        if (format.sampleRate < loudness::kMinimumSupportedSampleRate) {
+            return;
+        }
+        try {
+            loudnessMeter_ = std::make_unique<LoudnessMeter>(format);
+        } catch (const std::exception &e) {
+            os_log_error(log_, "Unable to allocate loudness meter: %{public}s", e.what());
+            return;
+        }
+    }
+
+    auto &analyzer = loudnessMeter_->analyzer_;
+    analyzer.Process(buffer.floatChannelData, descriptor.frameLength_, loudness::EbuR128Analyzer::FLOAT,
+                     loudness::EbuR128Analyzer::PLANAR_NON_CONTIGUOUS);
+    const auto truePeak = loudnessMeter_->addChunkPeak(analyzer.true_peak(), descriptor.frameLength_);
+    analyzer.ResetPeaks();
+    loudnessMeter_->lastChunk_ = descriptor;
+
+    publishLoudnessSnapshot({.sequenceNumber_ = descriptor.sequenceNumber_,
+                             .framePosition_ = descriptor.framePosition_ + descriptor.frameLength_,
+                             .momentaryLoudness_ = analyzer.momentary_lkfs(),
+                             .shortTermLoudness_ = analyzer.short_term_lkfs(),
+                             .truePeak_ = truePeak > 0 ? 20 * std::log10(truePeak) : loudness::kMinDBFS,
+                             .isValid_ = true});
+}
+
 int64_t sfb::AudioPlayer::decodingTimeout(DecoderState *decoderState) const noexcept {
     if (decoderState == nullptr) {
         // Idling or waiting on a decoder to complete rendering for a pending format change
@@ -2407,6 +2572,57 @@ auto sfb::AudioPlayer::loadTransportSnapshot() const noexcept -> detail::Transpo
     }
 }
 
+// MARK: - Loudness Snapshots
+
+void sfb::AudioPlayer::publishLoudnessSnapshot(const detail::LoudnessSnapshot &snapshot) noexcept {
+    // This is the same seqlock protocol used for transport snapshots
+    const auto seq = loudnessSequence_.load(std::memory_order_relaxed);
+    loudnessSequence_.store(seq + 1, std::memory_order_release);
+#if DEBUG
+    assert(isOdd(loudnessSequence_.load(std::memory_order_relaxed)));
+#endif /* DEBUG */
+
+    static_assert(std::atomic_ref<float>::is_always_lock_free);
+
+    std::atomic_ref{currentLoudness_.sequenceNumber_}.store(snapshot.sequenceNumber_, std::memory_order_relaxed);
+    std::atomic_ref{currentLoudness_.framePosition_}.store(snapshot.framePosition_, std::memory_order_relaxed);
+    std::atomic_ref{currentLoudness_.momentaryLoudness_}.store(snapshot.momentaryLoudness_,
+                                                               std::memory_order_relaxed);
+    std::atomic_ref{currentLoudness_.shortTermLoudness_}.store(snapshot.shortTermLoudness_,
+                                                               std::memory_order_relaxed);
+    std::atomic_ref{currentLoudness_.truePeak_}.store(snapshot.truePeak_, std::memory_order_relaxed);
+    std::atomic_ref{currentLoudness_.isValid_}.store(snapshot.isValid_, std::memory_order_relaxed);
+
+    loudnessSequence_.store(seq + 2, std::memory_order_release);
+}
+
+auto sfb::AudioPlayer::loadLoudnessSnapshot() const noexcept -> detail::LoudnessSnapshot {
+    for (;;) {
+        const auto seq = loudnessSequence_.load(std::memory_order_acquire);
+
+        if (isOdd(seq)) [[unlikely]] {
+            cpuPause();
+            continue;
+        }
+
+        detail::LoudnessSnapshot result{
+                .sequenceNumber_ = std::atomic_ref{currentLoudness_.sequenceNumber_}.load(std::memory_order_relaxed),
+                .framePosition_ = std::atomic_ref{currentLoudness_.framePosition_}.load(std::memory_order_relaxed),
+                .momentaryLoudness_ =
+                        std::atomic_ref{currentLoudness_.momentaryLoudness_}.load(std::memory_order_relaxed),
+                .shortTermLoudness_ =
+                        std::atomic_ref{currentLoudness_.shortTermLoudness_}.load(std::memory_order_relaxed),
+                .truePeak_ = std::atomic_ref{currentLoudness_.truePeak_}.load(std::memory_order_relaxed),
+                .isValid_ = std::atomic_ref{currentLoudness_.isValid_}.load(std::memory_order_relaxed)};
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (loudnessSequence_.load(std::memory_order_relaxed) == seq) {
+            return result;
+        }
+    }
+}
+
 // MARK: - Active Decoder Management
 
 void sfb::AudioPlayer::cancelActiveDecoders() noexcept {
@@ -250,6 +250,21 @@ NSErrorDomain const SFBAudioPlayerErrorDomain = @"org.sbooth.AudioEngine.AudioPl
     return _player->supportsSeeking();
 }
 
+// MARK: - Loudness Metering
+
+- (BOOL)isLoudnessMeteringEnabled {
+    return _player->loudnessMeteringEnabled();
+}
+
+- (void)setLoudnessMeteringEnabled:(BOOL)loudnessMeteringEnabled {
+    _player->setLoudnessMeteringEnabled(loudnessMeteringEnabled);
+}
+
+- (BOOL)getLoudnessReading:(SFBAudioPlayerLoudnessReading *)reading {
+    NSParameterAssert(reading != nullptr);
+    return _player->getLoudnessReading(reading);
+}
+
 #if !TARGET_OS_IPHONE
 // MARK: - Volume Control
 
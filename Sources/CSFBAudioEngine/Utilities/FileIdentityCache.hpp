@@ -0,0 +1,334 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace sfb {
+
+/// Returns a 64-bit hash of `size` bytes at `data`
+///
+/// The hash is FNV-1a applied to 64-bit words. It detects changed or corrupted data but is not cryptographic.
+[[nodiscard]] inline uint64_t hashBytes(const void *data, std::size_t size) noexcept {
+    constexpr uint64_t offsetBasis = 0xcbf29ce484222325;
+    constexpr uint64_t prime = 0x100000001b3;
+
+    auto bytes = static_cast<const unsigned char *>(data);
+    uint64_t hash = offsetBasis ^ size;
+    for (; size >= sizeof(uint64_t); bytes += sizeof(uint64_t), size -= sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, bytes, sizeof word);
+        hash = (hash ^ word) * prime;
+    }
+    for (; size > 0; ++bytes, --size) {
+        hash = (hash ^ *bytes) * prime;
+    }
+    return hash;
+}
+
+/// A read-only memory mapping of an entire file.
+class MappedFile final {
+  public:
+    /// Creates an empty mapping.
+    MappedFile() noexcept = default;
+
+    // This class is non-copyable
+    MappedFile(const MappedFile &) = delete;
+
+    // This class is non-assignable
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /// Move constructor.
+    MappedFile(MappedFile &&other) noexcept
+      : data_{std::exchange(other.data_, nullptr)}, size_{std::exchange(other.size_, 0)} {}
+
+    /// Move assignment operator.
+    MappedFile &operator=(MappedFile &&other) noexcept {
+        reset();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        return *this;
+    }
+
+    /// Unmaps the file.
+    ~MappedFile() noexcept { reset(); }
+
+    /// Maps the file open on `fd`, whose size is `size`. Returns an empty mapping on failure.
+    [[nodiscard]] static MappedFile map(int fd, std::size_t size) noexcept {
+        MappedFile file;
+        if (size > 0) {
+            if (void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0); data != MAP_FAILED) {
+                file.data_ = data;
+                file.size_ = size;
+            }
+        }
+        return file;
+    }
+
+    /// Returns true if a file is mapped.
+    [[nodiscard]] explicit operator bool() const noexcept { return data_ != nullptr; }
+
+    /// Returns the mapped bytes.
+    [[nodiscard]] const unsigned char *data() const noexcept {
+        return static_cast<const unsigned char *>(data_);
+    }
+
+    /// Returns the number of mapped bytes.
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+    /// Unmaps the file.
+    void reset() noexcept {
+        if (data_ != nullptr) {
+            munmap(data_, size_);
+        }
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+  private:
+    /// The mapped bytes.
+    void *data_{nullptr};
+    /// The number of mapped bytes.
+    std::size_t size_{0};
+};
+
+/// The identity of a file's contents as reported by the file system.
+///
+/// A stored identity matches a requested one if the device, inode, size, and modification time are equal and, when the
+/// requested identity has a content hash, the stored identity has the same hash.
+struct FileIdentity final {
+    /// The device containing the file
+    uint64_t device_{0};
+    /// The file's inode number
+    uint64_t inode_{0};
+    /// The file's size in bytes
+    uint64_t size_{0};
+    /// The file's modification time, seconds part
+    int64_t modificationSeconds_{0};
+    /// The file's modification time, nanoseconds part
+    int64_t modificationNanoseconds_{0};
+    /// A hash of the file's contents, or `0` if not computed
+    uint64_t contentHash_{0};
+
+    /// Returns the identity of the file at `path`, or `std::nullopt` on error
+    /// - parameter path: The file's path
+    /// - parameter hashContents: Whether to read the file and compute `contentHash_`
+    [[nodiscard]] static std::optional<FileIdentity> forPath(const char *path, bool hashContents) noexcept {
+        const int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+            return std::nullopt;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            close(fd);
+            return std::nullopt;
+        }
+
+        FileIdentity identity;
+        identity.device_ = static_cast<uint64_t>(st.st_dev);
+        identity.inode_ = static_cast<uint64_t>(st.st_ino);
+        identity.size_ = static_cast<uint64_t>(st.st_size);
+#if defined(__APPLE__)
+        identity.modificationSeconds_ = st.st_mtimespec.tv_sec;
+        identity.modificationNanoseconds_ = st.st_mtimespec.tv_nsec;
+#else
+        identity.modificationSeconds_ = st.st_mtim.tv_sec;
+        identity.modificationNanoseconds_ = st.st_mtim.tv_nsec;
+#endif
+
+        if (hashContents) {
+            auto file = MappedFile::map(fd, static_cast<std::size_t>(st.st_size));
+            if (!file && st.st_size > 0) {
+                close(fd);
+                return std::nullopt;
+            }
+            // Zero means "not computed"
+            identity.contentHash_ = hashBytes(file.data(), file.size()) | 1;
+        }
+
+        close(fd);
+        return identity;
+    }
+
+    /// Returns true if this stored identity identifies the file contents of `requested`
+    ///
+    /// When `requested` has a content hash the contents are verified, so a stored identity without one does not match.
+    [[nodiscard]] bool matches(const FileIdentity &requested) const noexcept {
+        return device_ == requested.device_ && inode_ == requested.inode_ && size_ == requested.size_ &&
+               modificationSeconds_ == requested.modificationSeconds_ &&
+               modificationNanoseconds_ == requested.modificationNanoseconds_ &&
+               (requested.contentHash_ == 0 || contentHash_ == requested.contentHash_);
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<FileIdentity>);
+
+/// A directory of cache entries keyed by file identity.
+///
+/// Each entry is a separate file named for the device and inode of the file it describes, holding a fixed header
+/// followed by an opaque payload. A new or changed entry is written to a temporary file and atomically renamed into
+/// place, so any number of readers and writers, in any number of processes, may use the same directory concurrently:
+/// a reader sees either a complete old entry or a complete new one. Entries are memory mapped for reading and the
+/// payload is used in place.
+///
+/// An entry is returned only if the stored identity matches the requested one, so entries for files that have since
+/// changed are ignored and eventually overwritten.
+class FileIdentityCache final {
+  public:
+    /// A mapped cache entry.
+    class Entry final {
+      public:
+        /// Returns the entry's payload.
+        [[nodiscard]] const unsigned char *data() const noexcept { return file_.data() + headerSize; }
+
+        /// Returns the size of the entry's payload in bytes.
+        [[nodiscard]] std::size_t size() const noexcept { return file_.size() - headerSize; }
+
+      private:
+        friend class FileIdentityCache;
+        explicit Entry(MappedFile &&file) noexcept : file_{std::move(file)} {}
+
+        /// The mapped entry file.
+        MappedFile file_;
+    };
+
+    /// Creates a cache using `directory` for entries of `kind`.
+    /// - parameter directory: The cache directory, which is created if it does not exist
+    /// - parameter kind: A tag identifying the payload format; entries of other kinds are not read
+    /// - parameter extension: The file name extension for entries of `kind`
+    FileIdentityCache(std::string directory, uint32_t kind, std::string extension)
+      : directory_{std::move(directory)}, kind_{kind}, extension_{std::move(extension)} {}
+
+    /// Returns the entry for `identity`, or `std::nullopt` if there is no valid entry
+    [[nodiscard]] std::optional<Entry> find(const FileIdentity &identity) const {
+        const auto path = entryPath(identity);
+        const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+            return std::nullopt;
+        }
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(headerSize)) {
+            close(fd);
+            return std::nullopt;
+        }
+
+        auto file = MappedFile::map(fd, static_cast<std::size_t>(st.st_size));
+        close(fd);
+        if (!file) {
+            return std::nullopt;
+        }
+
+        EntryHeader header;
+        std::memcpy(&header, file.data(), sizeof header);
+        const auto payloadSize = file.size() - headerSize;
+        if (header.magic_ != entryMagic || header.version_ != entryVersion || header.kind_ != kind_ ||
+            header.payloadSize_ != payloadSize || !header.identity_.matches(identity) ||
+            header.payloadHash_ != hashBytes(file.data() + headerSize, payloadSize)) {
+            return std::nullopt;
+        }
+
+        return Entry{std::move(file)};
+    }
+
+    /// Stores `size` bytes at `data` as the entry for `identity`, replacing any existing entry
+    /// - returns: `true` on success
+    bool store(const FileIdentity &identity, const void *data, std::size_t size) const {
+        if (mkdir(directory_.c_str(), 0755) != 0 && errno != EEXIST) {
+            return false;
+        }
+
+        EntryHeader header;
+        header.kind_ = kind_;
+        header.identity_ = identity;
+        header.payloadSize_ = size;
+        header.payloadHash_ = hashBytes(data, size);
+
+        std::string temporaryPath = directory_ + "/.entry-XXXXXX";
+        const int fd = mkstemp(temporaryPath.data());
+        if (fd == -1) {
+            return false;
+        }
+        // mkstemp() creates the file readable by the owner only
+        fchmod(fd, 0644);
+
+        const bool written = writeAll(fd, &header, sizeof header) && writeAll(fd, data, size);
+        if (close(fd) != 0 || !written || rename(temporaryPath.c_str(), entryPath(identity).c_str()) != 0) {
+            unlink(temporaryPath.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+  private:
+    /// The entry file header
+    struct EntryHeader final {
+        uint32_t magic_{entryMagic};
+        uint32_t version_{entryVersion};
+        uint32_t kind_{0};
+        uint32_t reserved_{0};
+        FileIdentity identity_{};
+        uint64_t payloadSize_{0};
+        uint64_t payloadHash_{0};
+    };
+
+    static constexpr uint32_t entryMagic = 0x53464243; // 'SFBC'
+    static constexpr uint32_t entryVersion = 1;
+    /// The payload follows the header and is 8-byte aligned
+    static constexpr std::size_t headerSize = sizeof(EntryHeader);
+    static_assert(headerSize % 8 == 0);
+
+    /// Returns the path of the entry file for `identity`
+    [[nodiscard]] std::string entryPath(const FileIdentity &identity) const {
+        char name[48];
+        std::snprintf(name, sizeof name, "/%016llx-%016llx.", static_cast<unsigned long long>(identity.device_),
+                      static_cast<unsigned long long>(identity.inode_));
+        return directory_ + name + extension_;
+    }
+
+    /// Writes `size` bytes at `data` to `fd`
+    static bool writeAll(int fd, const void *data, std::size_t size) noexcept {
+        auto bytes = static_cast<const unsigned char *>(data);
+        while (size > 0) {
+            const auto count = write(fd, bytes, size);
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            bytes += count;
+            size -= static_cast<std::size_t>(count);
+        }
+        return true;
+    }
+
+    /// The cache directory
+    std::string directory_;
+    /// The kind of entries read and written
+    uint32_t kind_{0};
+    /// The file name extension for entries
+    std::string extension_;
+};
+
+} /* namespace sfb */
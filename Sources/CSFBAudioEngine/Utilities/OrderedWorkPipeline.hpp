@@ -0,0 +1,207 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <semaphore>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#if defined(__APPLE__)
+#include <pthread.h>
+#endif /* defined(__APPLE__) */
+
+namespace sfb {
+
+// MARK: - Ordered Work Pipeline
+
+// A pipeline owns a fixed ring of work items. The consumer fills the next free item and submits it; a pool of
+// persistent worker threads performs submitted items in any order, and the consumer retrieves them in submission
+// order. Items are reused once retrieved, so a pipeline does not allocate after creation unless its items do.
+//
+// The work is described by a task type providing:
+//
+//   - `Item`, the input and output of one unit of work
+//   - `static constexpr const char *threadName`, the name of the worker threads
+//   - `void operator()(Item &item) noexcept`, which performs the work for `item`
+//
+// Each worker thread has a task of its own, so tasks may keep per-thread state such as a decoder.
+
+/// Performs work items concurrently on persistent worker threads and delivers them in submission order
+///
+/// With no worker threads, items are performed synchronously by `submit()`.
+/// - important: All member functions must be called from a single thread
+template <typename Task>
+class OrderedWorkPipeline {
+  public:
+    /// The work item type
+    using Item = typename Task::Item;
+
+    /// Creates a pipeline with `threadCount` worker threads, each with a task constructed from `args`
+    ///
+    /// One task is created for synchronous use when `threadCount` is zero.
+    /// - parameter depth: The maximum number of items submitted but not yet retrieved
+    /// - parameter prototype: The initial value of every item
+    /// - throws: Any exception thrown by constructing a task or item, `std::bad_alloc`, `std::system_error`
+    template <typename... Args>
+    OrderedWorkPipeline(int threadCount, int depth, const Item &prototype, const Args &...args)
+      : slots_(std::max(depth, 1)) {
+        tasks_.reserve(std::max(threadCount, 1));
+        for (int i = 0; i < std::max(threadCount, 1); ++i) {
+            tasks_.push_back(std::make_unique<Task>(args...));
+        }
+        for (auto &slot : slots_) {
+            slot = std::make_unique<Slot>(prototype);
+        }
+
+        try {
+            threads_.reserve(threadCount);
+            for (int i = 0; i < threadCount; ++i) {
+                threads_.emplace_back(std::bind_front(&OrderedWorkPipeline::work, this), tasks_[i].get());
+            }
+        } catch (...) {
+            stopWorkers();
+            throw;
+        }
+    }
+
+    ~OrderedWorkPipeline() noexcept { stopWorkers(); }
+
+    OrderedWorkPipeline(const OrderedWorkPipeline &) = delete;
+    OrderedWorkPipeline &operator=(const OrderedWorkPipeline &) = delete;
+
+    /// Returns `true` if no items are pending
+    bool empty() const noexcept { return submitted_ == retrieved_; }
+
+    /// Returns `true` if an item may be submitted
+    bool canSubmit() const noexcept { return submitted_ - retrieved_ < slots_.size(); }
+
+    /// Returns the item to fill before calling `submit()`
+    /// - important: An item must be submittable
+    Item &next() noexcept { return slots_[submitted_ % slots_.size()]->item; }
+
+    /// Submits the item returned by `next()`
+    void submit() noexcept {
+        if (threads_.empty()) {
+            auto &slot = *slots_[submitted_ % slots_.size()];
+            (*tasks_.front())(slot.item);
+            slot.finished.release();
+            ++submitted_;
+            return;
+        }
+
+        {
+            std::lock_guard lock{mutex_};
+            ++submitted_;
+        }
+        condition_.notify_one();
+    }
+
+    /// Waits for the oldest pending item to be performed and returns it
+    /// - important: The pipeline must not be empty
+    Item &wait() noexcept {
+        auto &slot = *slots_[retrieved_ % slots_.size()];
+        if (!slot.ready) {
+            slot.finished.acquire();
+            slot.ready = true;
+        }
+        return slot.item;
+    }
+
+    /// Returns the oldest pending item, which must have been waited for
+    const Item &front() const noexcept { return slots_[retrieved_ % slots_.size()]->item; }
+
+    /// Releases the oldest pending item
+    void pop() noexcept {
+        wait();
+        slots_[retrieved_ % slots_.size()]->ready = false;
+        ++retrieved_;
+    }
+
+    /// Waits for and discards all pending items
+    void clear() noexcept {
+        while (!empty()) {
+            pop();
+        }
+    }
+
+  private:
+    /// Storage for one item
+    struct Slot {
+        explicit Slot(const Item &prototype) : item{prototype} {}
+
+        /// The work item
+        Item item;
+        /// Signaled when the item is performed
+        std::binary_semaphore finished{0};
+        /// Whether `finished` has been acquired by the consumer
+        bool ready{false};
+    };
+
+    /// Performs submitted items with `task` until stopped
+    void work(std::stop_token stoken, Task *task) noexcept {
+#if defined(__APPLE__)
+        pthread_setname_np(Task::threadName);
+        pthread_set_qos_class_self_np(QOS_CLASS_USER_INITIATED, 0);
+#endif /* defined(__APPLE__) */
+
+        for (;;) {
+            std::size_t index;
+            {
+                std::unique_lock lock{mutex_};
+                condition_.wait(lock, [&] { return stoken.stop_requested() || claimed_ < submitted_; });
+                if (stoken.stop_requested()) {
+                    break;
+                }
+                index = claimed_++;
+            }
+
+            auto &slot = *slots_[index % slots_.size()];
+            (*task)(slot.item);
+            slot.finished.release();
+        }
+    }
+
+    /// Stops and joins the worker threads
+    void stopWorkers() noexcept {
+        {
+            std::lock_guard lock{mutex_};
+            for (auto &thread : threads_) {
+                thread.request_stop();
+            }
+        }
+        condition_.notify_all();
+        // Join before any state used by the workers is destroyed
+        threads_.clear();
+    }
+
+    /// A task for each worker, or for synchronous work
+    std::vector<std::unique_ptr<Task>> tasks_;
+    /// The item slots
+    std::vector<std::unique_ptr<Slot>> slots_;
+    /// The number of items submitted
+    std::size_t submitted_{0};
+    /// The number of items claimed by workers
+    std::size_t claimed_{0};
+    /// The number of items retrieved
+    std::size_t retrieved_{0};
+    /// Mutex protecting `submitted_` and `claimed_` for the workers
+    std::mutex mutex_;
+    /// Signaled when an item is submitted or the workers should stop
+    std::condition_variable condition_;
+    /// The worker threads
+    std::vector<std::jthread> threads_;
+};
+
+} /* namespace sfb */
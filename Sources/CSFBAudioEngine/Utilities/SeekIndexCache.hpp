@@ -0,0 +1,269 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#pragma once
+
+#include "FileIdentityCache.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sfb {
+
+// MARK: - Seek Indexes
+
+// A seek index maps audio frames to the input offsets from which a decoder may resume, each optionally with a fixed
+// size block of decoder state needed to resume there. It is built by a decoder while decoding and serialized as a
+// header followed by the points in increasing frame order and then their states, so a serialized index is searched in
+// place, including when memory mapped from a cache entry.
+//
+// The format of an index identifies the decoder and the meaning of its offsets and states. An index is only used by a
+// decoder expecting the same format and state size.
+
+/// A point from which decoding may resume
+struct SeekIndexPoint final {
+    /// The first audio frame decoded when resuming from the point
+    uint64_t frame_{0};
+    /// The input offset from which decoding resumes, in units defined by the index format
+    uint64_t offset_{0};
+};
+
+static_assert(std::is_trivially_copyable_v<SeekIndexPoint> && sizeof(SeekIndexPoint) == 16);
+
+namespace detail {
+
+/// The header of a serialized seek index
+struct SeekIndexHeader final {
+    uint32_t format_{0};
+    uint32_t stateSize_{0};
+    uint64_t frameLength_{0};
+    uint64_t count_{0};
+};
+
+static_assert(sizeof(SeekIndexHeader) % 8 == 0);
+
+/// Returns `stateSize` rounded up to keep states 8-byte aligned
+constexpr std::size_t seekIndexStateStride(std::size_t stateSize) noexcept { return (stateSize + 7) & ~std::size_t{7}; }
+
+} /* namespace detail */
+
+/// A read-only view of a serialized seek index
+class SeekIndexView final {
+  public:
+    /// Returns a view of the index serialized in `size` bytes at `data`, or `std::nullopt` if the bytes do not hold an
+    /// index of `format` with states of `stateSize` bytes
+    [[nodiscard]] static std::optional<SeekIndexView> make(const unsigned char *data, std::size_t size, uint32_t format,
+                                                           std::size_t stateSize) noexcept {
+        detail::SeekIndexHeader header;
+        if (data == nullptr || size < sizeof header) {
+            return std::nullopt;
+        }
+        std::memcpy(&header, data, sizeof header);
+
+        const auto stride = sizeof(SeekIndexPoint) + detail::seekIndexStateStride(stateSize);
+        if (header.format_ != format || header.stateSize_ != stateSize || header.count_ == 0 ||
+            header.count_ > (size - sizeof header) / stride || sizeof header + (header.count_ * stride) != size) {
+            return std::nullopt;
+        }
+
+        return SeekIndexView{data, header};
+    }
+
+    /// Returns the number of points
+    [[nodiscard]] std::size_t count() const noexcept { return static_cast<std::size_t>(header_.count_); }
+
+    /// Returns the length of the stream in audio frames, or `0` if unknown
+    [[nodiscard]] uint64_t frameLength() const noexcept { return header_.frameLength_; }
+
+    /// Returns the point at `index`
+    [[nodiscard]] SeekIndexPoint point(std::size_t index) const noexcept {
+        SeekIndexPoint point;
+        std::memcpy(&point, points() + (index * sizeof point), sizeof point);
+        return point;
+    }
+
+    /// Returns the state of the point at `index`
+    [[nodiscard]] const unsigned char *state(std::size_t index) const noexcept {
+        return points() + (count() * sizeof(SeekIndexPoint)) +
+               (index * detail::seekIndexStateStride(header_.stateSize_));
+    }
+
+    /// Returns the index of the last point at or before `frame`, or `std::nullopt` if `frame` precedes every point
+    [[nodiscard]] std::optional<std::size_t> find(uint64_t frame) const noexcept {
+        // Find the first point after frame
+        std::size_t low = 0;
+        std::size_t high = count();
+        while (low < high) {
+            const auto middle = low + ((high - low) / 2);
+            if (point(middle).frame_ <= frame) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        if (low == 0) {
+            return std::nullopt;
+        }
+        return low - 1;
+    }
+
+  private:
+    SeekIndexView(const unsigned char *data, const detail::SeekIndexHeader &header) noexcept
+      : data_{data}, header_{header} {}
+
+    /// Returns the serialized points
+    [[nodiscard]] const unsigned char *points() const noexcept {
+        return data_ + sizeof(detail::SeekIndexHeader);
+    }
+
+    /// The serialized index
+    const unsigned char *data_;
+    /// The index header
+    detail::SeekIndexHeader header_;
+};
+
+/// A seek index under construction
+class SeekIndexBuilder final {
+  public:
+    /// Creates an empty index of `format` whose points hold `stateSize` bytes of state
+    SeekIndexBuilder(uint32_t format, std::size_t stateSize) noexcept : format_{format}, stateSize_{stateSize} {}
+
+    /// Returns the number of points
+    [[nodiscard]] std::size_t count() const noexcept { return points_.size(); }
+
+    /// Returns true if there are no points
+    [[nodiscard]] bool empty() const noexcept { return points_.empty(); }
+
+    /// Returns the last point
+    /// - important: The index must not be empty
+    [[nodiscard]] const SeekIndexPoint &back() const noexcept { return points_.back(); }
+
+    /// Appends a point following every existing point
+    /// - parameter point: The point, whose frame must follow that of the last point
+    /// - parameter state: `stateSize` bytes of decoder state, or `nullptr` if the state size is `0`
+    /// - throws: `std::bad_alloc`
+    void append(const SeekIndexPoint &point, const void *state) {
+        if (!points_.empty() && point.frame_ <= points_.back().frame_) {
+            return;
+        }
+        const auto stride = detail::seekIndexStateStride(stateSize_);
+        states_.resize(states_.size() + stride);
+        if (stateSize_ > 0) {
+            std::memcpy(states_.data() + states_.size() - stride, state, stateSize_);
+        }
+        points_.push_back(point);
+    }
+
+    /// Removes every point
+    void clear() noexcept {
+        points_.clear();
+        states_.clear();
+    }
+
+    /// Returns the serialized index
+    /// - parameter frameLength: The length of the stream in audio frames, or `0` if unknown
+    /// - throws: `std::bad_alloc`
+    [[nodiscard]] std::vector<unsigned char> serialize(uint64_t frameLength) const {
+        detail::SeekIndexHeader header;
+        header.format_ = format_;
+        header.stateSize_ = static_cast<uint32_t>(stateSize_);
+        header.frameLength_ = frameLength;
+        header.count_ = points_.size();
+
+        const auto pointsSize = points_.size() * sizeof(SeekIndexPoint);
+        std::vector<unsigned char> data(sizeof header + pointsSize + states_.size());
+        std::memcpy(data.data(), &header, sizeof header);
+        if (!points_.empty()) {
+            std::memcpy(data.data() + sizeof header, points_.data(), pointsSize);
+        }
+        if (!states_.empty()) {
+            std::memcpy(data.data() + sizeof header + pointsSize, states_.data(), states_.size());
+        }
+        return data;
+    }
+
+  private:
+    /// The index format
+    uint32_t format_{0};
+    /// The size of each point's state in bytes
+    std::size_t stateSize_{0};
+    /// The points in increasing frame order
+    std::vector<SeekIndexPoint> points_;
+    /// The states of the points, each padded to a multiple of eight bytes
+    std::vector<unsigned char> states_;
+};
+
+// MARK: - Seek Index Cache
+
+/// A directory of seek indexes keyed by file identity
+///
+/// Indexes are stored as `FileIdentityCache` entries, one per file, so an index for a file that has since changed is
+/// ignored and eventually replaced.
+class SeekIndexCache final {
+  public:
+    /// A seek index mapped from a cache entry
+    class Entry final {
+      public:
+        /// Returns the index
+        [[nodiscard]] const SeekIndexView &index() const noexcept { return index_; }
+
+      private:
+        friend class SeekIndexCache;
+        Entry(FileIdentityCache::Entry &&entry, const SeekIndexView &index) noexcept
+          : entry_{std::move(entry)}, index_{index} {}
+
+        /// The mapped entry, which `index_` views
+        FileIdentityCache::Entry entry_;
+        SeekIndexView index_;
+    };
+
+    /// The `FileIdentityCache` entry kind for seek indexes
+    static constexpr uint32_t entryKind = 0x5345454b; // 'SEEK'
+
+    /// Creates a cache using `directory`, which is created if it does not exist
+    explicit SeekIndexCache(std::string directory) : cache_{std::move(directory), entryKind, "seekindex"} {}
+
+    /// Returns the index of `format` with states of `stateSize` bytes for `identity`, or `std::nullopt` if there is no
+    /// valid index
+    [[nodiscard]] std::optional<Entry> find(const FileIdentity &identity, uint32_t format,
+                                            std::size_t stateSize) const {
+        auto entry = cache_.find(identity);
+        if (!entry) {
+            return std::nullopt;
+        }
+        const auto index = SeekIndexView::make(entry->data(), entry->size(), format, stateSize);
+        if (!index) {
+            return std::nullopt;
+        }
+        // Moving the entry does not move the mapping the view refers to
+        return Entry{std::move(*entry), *index};
+    }
+
+    /// Stores `index` as the seek index for `identity`, replacing any existing index
+    /// - parameter frameLength: The length of the stream in audio frames, or `0` if unknown
+    /// - returns: `true` on success
+    /// - throws: `std::bad_alloc`
+    bool store(const FileIdentity &identity, const SeekIndexBuilder &index, uint64_t frameLength) const {
+        if (index.empty()) {
+            return false;
+        }
+        const auto data = index.serialize(frameLength);
+        return cache_.store(identity, data.data(), data.size());
+    }
+
+  private:
+    /// The cache of entries
+    FileIdentityCache cache_;
+};
+
+} /* namespace sfb */
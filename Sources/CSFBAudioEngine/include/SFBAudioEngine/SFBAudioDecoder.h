@@ -59,6 +59,15 @@ NS_SWIFT_NAME(AudioDecoder)
 /// Tests whether a MIME type is supported
 + (BOOL)handlesMIMEType:(NSString *)mimeType;
 
+// MARK: - Seek Index Caching
+
+/// A directory in which seek indexes built while decoding are cached, or `nil` to disable caching
+///
+/// Decoders for files lacking a usable seek table index them while decoding. Complete indexes are cached keyed by each
+/// file's device, inode, size, and modification time, so later decoders for an unchanged file seek directly to the
+/// nearest indexed frame. The directory may be shared by concurrent decoders and processes. The default is `nil`.
+@property(class, nonatomic, nullable, copy) NSURL *seekIndexCacheDirectoryURL;
+
 // MARK: - Creation
 
 + (instancetype)new NS_UNAVAILABLE;
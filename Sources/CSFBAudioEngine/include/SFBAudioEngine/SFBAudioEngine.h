@@ -27,11 +27,16 @@ FOUNDATION_EXPORT const unsigned char SFBAudioEngineVersionString[];
 #import <SFBAudioEngine/SFBAudioProperties.h>
 #import <SFBAudioEngine/SFBAudioRegionDecoder.h>
 #import <SFBAudioEngine/SFBDSDDecoder.h>
+#import <SFBAudioEngine/SFBDSDIFFDecoder.h>
 #import <SFBAudioEngine/SFBDSDDecoding.h>
 #import <SFBAudioEngine/SFBDSDPCMDecoder.h>
 #import <SFBAudioEngine/SFBDoPDecoder.h>
+#import <SFBAudioEngine/SFBFLACDecoder.h>
 #import <SFBAudioEngine/SFBInputSource.h>
+#import <SFBAudioEngine/SFBMPEGDecoder.h>
 #import <SFBAudioEngine/SFBOutputTarget.h>
 #import <SFBAudioEngine/SFBPCMDecoding.h>
 #import <SFBAudioEngine/SFBPCMEncoding.h>
 #import <SFBAudioEngine/SFBReplayGainAnalyzer.h>
+#import <SFBAudioEngine/SFBReplayGainScanner.h>
+#import <SFBAudioEngine/SFBShortenDecoder.h>
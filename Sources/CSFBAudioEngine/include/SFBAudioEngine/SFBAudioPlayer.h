@@ -34,6 +34,22 @@ typedef NS_ENUM(NSUInteger, SFBAudioPlayerPlaybackState) {
     SFBAudioPlayerPlaybackStatePlaying = 3,
 } NS_SWIFT_NAME(AudioPlayer.PlaybackState);
 
+/// A loudness meter reading for decoded audio
+///
+/// Loudness is measured according to ITU BS.1770 and EBU Tech 3341. Levels too quiet to measure, including those
+/// before the first complete measurement window, are `-INFINITY`.
+struct NS_SWIFT_SENDABLE SFBAudioPlayerLoudnessReading {
+    /// The frame position in the measured decoder immediately following the measured audio
+    AVAudioFramePosition framePosition;
+    /// The momentary (400 ms) loudness in LUFS
+    float momentaryLoudness;
+    /// The short-term (3 s) loudness in LUFS
+    float shortTermLoudness;
+    /// The true peak over the momentary window in dBTP
+    float truePeak;
+} NS_SWIFT_NAME(AudioPlayer.LoudnessReading);
+typedef struct SFBAudioPlayerLoudnessReading SFBAudioPlayerLoudnessReading;
+
 /// An audio player using an `AVAudioEngine` processing graph for playback
 ///
 /// `SFBAudioPlayer` supports gapless playback for audio with the same sample rate and number of channels.
@@ -248,6 +264,21 @@ NS_SWIFT_NAME(AudioPlayer)
 /// Returns `YES` if the current decoder supports seeking
 @property(nonatomic, readonly) BOOL supportsSeeking;
 
+// MARK: - Loudness Metering
+
+/// Whether decoded audio is measured by the loudness meter
+///
+/// Metering is performed on the decoding thread as audio is written for rendering and does not affect the cost of
+/// rendering. Because decoding runs ahead of rendering, readings are timestamped with the frame position of the
+/// measured audio, which may be compared with `playbackPosition` to align readings with what is audible. The meter
+/// restarts after a seek or format change and continues across gapless transitions. The default is `NO`.
+@property(nonatomic, getter=isLoudnessMeteringEnabled) BOOL loudnessMeteringEnabled;
+
+/// Retrieves the most recent loudness meter reading
+/// - parameter reading: A pointer to an `SFBAudioPlayerLoudnessReading` struct to receive the reading
+/// - returns: `NO` if metering is disabled, no audio has been measured, or the current playback snapshot is invalid
+- (BOOL)getLoudnessReading:(SFBAudioPlayerLoudnessReading *)reading NS_REFINED_FOR_SWIFT;
+
 #if !TARGET_OS_IPHONE
 // MARK: - Volume Control
 
@@ -0,0 +1,29 @@
+//
+// SPDX-FileCopyrightText: 2014 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#import <SFBAudioEngine/SFBDSDDecoder.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The `SFBDSDDecoder` subclass decoding DSDIFF (DSD Interchange File Format)
+///
+/// Decoders created by `SFBDSDDecoder` for DSDIFF input are instances of this class.
+/// - seealso: http://www.sonicstudio.com/pdf/dsd/DSDIFF_1.5_Spec.pdf
+NS_SWIFT_NAME(DSDIFFDecoder)
+@interface SFBDSDIFFDecoder : SFBDSDDecoder
+
+/// The maximum number of threads used for DST decoding, or `0` to use up to four (default is `0`)
+///
+/// The number of threads is also limited by the number of active processors. With more than one thread, DST frames
+/// are decoded ahead of the consumer by persistent worker threads. With one thread each frame is decoded on demand by
+/// the caller of `-decodeIntoBuffer:packetCount:error:`.
+/// - note: Changes take effect when a decoder is opened
+@property(class, nonatomic) NSUInteger maximumDSTDecodingThreads;
+
+@end
+
+NS_ASSUME_NONNULL_END
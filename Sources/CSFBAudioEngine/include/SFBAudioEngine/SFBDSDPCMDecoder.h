@@ -10,7 +10,17 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
-/// A decoder supporting DSD64 to PCM conversion
+/// Lowpass filter profiles for DSD to PCM conversion
+typedef NS_ENUM(NSUInteger, SFBDSDPCMFilterProfile) {
+    /// A short filter with a gentle roll-off requiring the least processing, suitable for previews and transcoding
+    SFBDSDPCMFilterProfileShort = 0,
+    /// A 96-tap filter flat to about 48 kHz with high stopband rejection
+    SFBDSDPCMFilterProfileStandard = 1,
+    /// A long filter flat to about 60 kHz with very high stopband rejection requiring the most processing
+    SFBDSDPCMFilterProfileLong = 2,
+} NS_SWIFT_NAME(DSDPCMDecoder.FilterProfile);
+
+/// A decoder supporting DSD64 through DSD512 to PCM conversion
 NS_SWIFT_NAME(DSDPCMDecoder)
 @interface SFBDSDPCMDecoder : NSObject <SFBPCMDecoding>
 
@@ -33,6 +43,26 @@ NS_SWIFT_NAME(DSDPCMDecoder)
 /// - returns: An initialized `SFBDSDPCMDecoder` object for the specified decoder, or `nil` on failure
 - (nullable instancetype)initWithDecoder:(id<SFBDSDDecoding>)decoder error:(NSError **)error NS_DESIGNATED_INITIALIZER;
 
+/// The sample rate of the converted PCM audio in Hz, or `0` for the highest supported rate (default is `0`)
+///
+/// The PCM sample rate must be between 88.2 and 384 kHz and equal the DSD sample rate divided by a power of two.
+/// For example, DSD64 through DSD512 may be converted to 88.2, 176.4, or 352.8 kHz.
+/// - note: Changes take effect when the decoder is opened
+@property(nonatomic) double pcmSampleRate;
+
+/// The lowpass filter profile used for conversion (default is `SFBDSDPCMFilterProfileStandard`)
+/// - note: Changes take effect when the decoder is opened
+@property(nonatomic) SFBDSDPCMFilterProfile filterProfile;
+
+/// The maximum number of threads used for conversion, or `0` to use up to one per channel limited by the number of
+/// active processors (default is `1`)
+///
+/// Channels are converted independently, so multichannel audio may be divided into channel groups converted
+/// concurrently by persistent worker threads. Each call to `-decodeIntoBuffer:frameLength:error:` returns after
+/// every group is converted.
+/// - note: Changes take effect when the decoder is opened
+@property(nonatomic) NSUInteger maximumConversionThreads;
+
 /// The linear gain applied to the converted DSD samples (default is 6 dBFS)
 @property(nonatomic) float linearGain;
 
@@ -38,6 +38,12 @@ NS_SWIFT_NAME(DoPDecoder)
 /// - warning: Do not change any properties of the returned object
 @property(nonatomic, readonly) id<SFBDSDDecoding> decoder;
 
+/// Whether DoP frames are output as interleaved packed 24-bit samples (default is `NO`)
+///
+/// When `NO` each channel is output as a separate buffer of 24-bit samples
+/// - note: Changes take effect when the decoder is opened
+@property(nonatomic) BOOL interleavesOutput;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -0,0 +1,26 @@
+//
+// SPDX-FileCopyrightText: 2006 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#import <SFBAudioEngine/SFBAudioDecoder.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The `SFBAudioDecoder` subclass decoding FLAC
+///
+/// Decoders created by `SFBAudioDecoder` for FLAC and Ogg FLAC input are instances of this class.
+NS_SWIFT_NAME(FLACDecoder)
+@interface SFBFLACDecoder : SFBAudioDecoder
+
+/// Whether decoders opened for seekable input of known length decode ranges of frames in parallel
+///
+/// Ranges of frames are decoded ahead of the consumer by a small pool of threads, each with its own stream decoder.
+/// Ogg FLAC is always decoded sequentially. Changes take effect when a decoder is opened. The default is `NO`.
+@property(class, nonatomic) BOOL decodesFramesInParallel;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,28 @@
+//
+// SPDX-FileCopyrightText: 2006 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#import <SFBAudioEngine/SFBAudioDecoder.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The `SFBAudioDecoder` subclass decoding MPEG 1/2/2.5 Layers I, II, and III
+///
+/// Decoders created by `SFBAudioDecoder` for MPEG input are instances of this class.
+NS_SWIFT_NAME(MPEGDecoder)
+@interface SFBMPEGDecoder : SFBAudioDecoder
+
+/// Whether decoders opened for seekable files scan the entire file for an exact length and frame index on a
+/// background queue
+///
+/// Decoders otherwise open without scanning, estimating the length when the file lacks a Xing, Info, or VBRI frame.
+/// The frame index and exact length are adopted by the next decode or seek. Changes take effect when a decoder is
+/// opened. The default is `NO`.
+@property(class, nonatomic) BOOL buildsFrameIndexInBackground;
+
+@end
+
+NS_ASSUME_NONNULL_END
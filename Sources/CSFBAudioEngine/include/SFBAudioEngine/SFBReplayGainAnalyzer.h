@@ -14,7 +14,10 @@ NS_SWIFT_NAME(ReplayGain)
 @interface SFBReplayGain : NSObject
 /// The replay gain adjustment in dB
 @property(nonatomic, readonly) float gain;
-/// The peak sample amplitude normalized to [-1, 1)
+/// The peak amplitude normalized to [-1, 1)
+///
+/// This is the sample peak unless true peak measurement was enabled for the analysis, in which case it is the ITU
+/// BS.1770 true peak of the 4x oversampled signal and may exceed 1
 @property(nonatomic, readonly) float peak;
 @end
 
@@ -33,6 +36,35 @@ NS_SWIFT_NAME(AlbumReplayGain)
 NS_SWIFT_NAME(ReplayGainAnalyzer)
 @interface SFBReplayGainAnalyzer : NSObject
 
+/// Whether peaks are measured as ITU BS.1770 true peaks instead of sample peaks
+///
+/// True peak measurement oversamples the audio 4x to find inter-sample peaks. The default is `NO`.
+/// - note: This property is only used by the instance methods
+@property(nonatomic) BOOL measuresTruePeak;
+
+/// The maximum number of segments a track may be split into for parallel analysis
+///
+/// Tracks from decoders supporting sample-accurate seeking are divided into adjacent segments that are decoded and
+/// analyzed concurrently, and the results are combined into a single measurement. A value of `0` uses the number of
+/// active processors and `1` disables segmentation. The default is `0`.
+/// - note: This property is only used by the instance methods
+@property(nonatomic) NSUInteger maximumSegmentsPerTrack;
+
+/// A directory in which per-track analysis results are cached, or `nil` to disable caching
+///
+/// Cached results are keyed by each file's device, inode, size, and modification time, so a track is decoded again
+/// only after it changes. Reanalyzing an album after one track changes decodes only that track; the album gain is
+/// computed from the cached results of the others. The directory may be shared by concurrent analyzers and processes.
+/// The default is `nil`.
+/// - note: This property is only used by the instance methods
+@property(nonatomic, nullable, copy) NSURL *cacheDirectoryURL;
+
+/// Whether cached results are also keyed by a hash of each file's contents
+///
+/// Hashing reads the entire file but detects changes that leave the modification time unchanged. The default is `NO`.
+/// - note: This property is only used by the instance methods
+@property(nonatomic) BOOL cacheVerifiesFileContents;
+
 /// Calculates replay gain for a single track
 /// - parameter url: The URL to analyze
 /// - parameter error: An optional pointer to an `NSError` object to receive error information
@@ -0,0 +1,98 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#import <SFBAudioEngine/SFBReplayGainAnalyzer.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// A block called with the result of analyzing one track
+/// - parameter url: The track's URL
+/// - parameter replayGain: The track's replay gain or `nil` on error
+/// - parameter error: An error describing the failure, or `nil` on success
+typedef void (^SFBReplayGainScannerTrackBlock)(NSURL *url, SFBReplayGain *_Nullable replayGain,
+                                               NSError *_Nullable error) NS_SWIFT_NAME(ReplayGainScanner.TrackClosure);
+
+/// A block called with the result of analyzing one album, after all of its tracks
+/// - parameter urls: The album's track URLs
+/// - parameter albumReplayGain: The album's replay gain or `nil` on error
+/// - parameter error: An error describing the failure, or `nil` on success
+typedef void (^SFBReplayGainScannerAlbumBlock)(NSArray<NSURL *> *urls, SFBAlbumReplayGain *_Nullable albumReplayGain,
+                                               NSError *_Nullable error) NS_SWIFT_NAME(ReplayGainScanner.AlbumClosure);
+
+/// A block called once a scan has finished
+/// - parameter cancelled: Whether the scan was cancelled before every track was analyzed
+typedef void (^SFBReplayGainScannerCompletionBlock)(BOOL cancelled) NS_SWIFT_NAME(ReplayGainScanner.CompletionClosure);
+
+/// A class that calculates replay gain for large numbers of tracks and albums
+///
+/// Reading files and decoding and analyzing audio are separate stages with independent concurrency limits. Reads
+/// are limited to avoid thrashing slow storage such as spinning disks and network volumes, while analysis is limited
+/// by processor count. A bounded number of tracks is read ahead of analysis, and the files read into memory are limited
+/// to `maximumReadAheadSize` bytes in total, so memory use does not grow with the number of tracks scanned.
+///
+/// Results are delivered as each track and album completes. Tracks may complete in any order; an album completes when
+/// the last of its tracks does.
+NS_SWIFT_NAME(ReplayGainScanner)
+@interface SFBReplayGainScanner : NSObject
+
+/// Whether peaks are measured as ITU BS.1770 true peaks instead of sample peaks
+///
+/// The default is `NO`.
+@property(nonatomic) BOOL measuresTruePeak;
+
+/// The maximum number of files read concurrently
+///
+/// The default is `2`.
+@property(nonatomic) NSUInteger maximumConcurrentReads;
+
+/// The maximum number of tracks decoded and analyzed concurrently
+///
+/// A value of `0` uses the number of active processors. The default is `0`.
+@property(nonatomic) NSUInteger maximumConcurrentAnalyses;
+
+/// The maximum number of bytes of files read into memory and awaiting or undergoing analysis
+///
+/// Files not fitting in the bytes remaining are read by the decoder during analysis instead. The default is 256 MiB.
+@property(nonatomic) NSUInteger maximumReadAheadSize;
+
+/// A directory in which per-track analysis results are cached, or `nil` to disable caching
+///
+/// See `SFBReplayGainAnalyzer.cacheDirectoryURL`. The default is `nil`.
+@property(nonatomic, nullable, copy) NSURL *cacheDirectoryURL;
+
+/// Whether cached results are also keyed by a hash of each file's contents
+///
+/// The default is `NO`.
+@property(nonatomic) BOOL cacheVerifiesFileContents;
+
+/// Returns `YES` if a scan is in progress
+@property(nonatomic, readonly) BOOL isScanning;
+
+/// Starts calculating replay gain for albums
+///
+/// This method returns immediately. The blocks are called on a private serial queue.
+/// - important: Properties should not be changed while a scan is in progress
+/// - parameter albums: The albums to analyze, each an array of track URLs. An album containing a single track is
+/// treated as a standalone track and `albumBlock` is not called for it.
+/// - parameter trackBlock: A block called as each track completes
+/// - parameter albumBlock: An optional block called as each album completes
+/// - parameter completionBlock: An optional block called once every track has completed or the scan was cancelled
+/// - returns: `NO` if a scan is already in progress
+- (BOOL)scanAlbums:(NSArray<NSArray<NSURL *> *> *)albums
+           trackBlock:(SFBReplayGainScannerTrackBlock)trackBlock
+           albumBlock:(nullable SFBReplayGainScannerAlbumBlock)albumBlock
+      completionBlock:(nullable SFBReplayGainScannerCompletionBlock)completionBlock;
+
+/// Cancels the scan in progress
+///
+/// Tracks already being analyzed complete normally; no other tracks are started. Albums with unanalyzed tracks are
+/// not reported.
+- (void)cancel;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,39 @@
+//
+// SPDX-FileCopyrightText: 2020 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+#import <SFBAudioEngine/SFBAudioDecoder.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The `SFBAudioDecoder` subclass decoding Shorten
+///
+/// Decoders created by `SFBAudioDecoder` for Shorten input are instances of this class. Files without a seek table are
+/// indexed while decoding, and seeking past the last indexed frame decodes forward from it. Only mono and stereo files
+/// with a maximum linear prediction order of three and at most four means are indexed, since seek tables cannot
+/// represent the state of other files.
+NS_SWIFT_NAME(ShortenDecoder)
+@interface SFBShortenDecoder : SFBAudioDecoder
+
+/// Whether decoders opened for files without a seek table index the entire file on a background queue
+///
+/// Changes take effect when a decoder is opened. The default is `NO`.
+@property(class, nonatomic) BOOL buildsSeekIndexInBackground;
+
+/// Whether complete seek indexes are saved as seek table files alongside the audio
+///
+/// Seek tables are written with the extension `skt` and an existing file is never replaced. The default is `NO`.
+@property(class, nonatomic) BOOL savesSeekTables;
+
+/// Writes the seek table or seek index to a Shorten seek table file
+/// - parameter url: The URL of the seek table file
+/// - parameter error: An optional pointer to an `NSError` object to receive error information
+/// - returns: `YES` on success, `NO` otherwise
+- (BOOL)writeSeekTableToURL:(NSURL *)url error:(NSError **)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -55,6 +55,15 @@ extension AudioPlayer {
         }
         return positionAndTime
     }
+
+    /// Returns the most recent loudness meter reading or `nil` if metering is disabled, no audio has been measured, or the current playback snapshot is invalid
+    public var loudnessReading: LoudnessReading? {
+        var reading = LoudnessReading()
+        guard __getLoudnessReading(&reading) else {
+            return nil
+        }
+        return reading
+    }
 }
 
 extension AudioPlayer.PlaybackState: /*@retroactive*/ Swift.CustomDebugStringConvertible {
@@ -0,0 +1,56 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Check counting shared by the accuracy tests and benchmarks built by Tests/CMakeLists.txt.
+//
+// Accuracy tests record every check with `check()`, which prints a PASS or FAIL line, and return `summarize()` from
+// `main()`. Benchmarks report only failures with `fail()` and return `exitStatus()`. The exit status is non-zero if
+// any check failed, which is how CTest judges a test.
+
+#pragma once
+
+#include <cstdarg>
+#include <cstdio>
+
+namespace sfb_test {
+
+/// The number of checks recorded
+inline int checks = 0;
+/// The number of checks failed
+inline int failures = 0;
+
+/// Records a check and prints its result
+inline void check(bool passed, const char *description) {
+    ++checks;
+    if (!passed) {
+        ++failures;
+    }
+    std::printf("%s  %s\n", passed ? "PASS" : "FAIL", description);
+}
+
+/// Records a failed check and prints a description formatted as by `printf`
+__attribute__((format(printf, 1, 2))) inline void fail(const char *format, ...) {
+    ++checks;
+    ++failures;
+    std::fputs("FAIL  ", stdout);
+    std::va_list arguments;
+    va_start(arguments, format);
+    std::vprintf(format, arguments);
+    va_end(arguments);
+    std::fputc('\n', stdout);
+}
+
+/// Returns the exit status for the checks recorded
+inline int exitStatus() { return failures == 0 ? 0 : 1; }
+
+/// Prints the number of checks passed and returns the exit status
+inline int summarize() {
+    std::printf("\n%d of %d checks passed\n", checks - failures, checks);
+    return exitStatus();
+}
+
+} /* namespace sfb_test */
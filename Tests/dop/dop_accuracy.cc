@@ -0,0 +1,147 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Accuracy checks for sfb::dop::packInterleaved and sfb::dop::packPlanar.
+//
+// The DoP packer is plain C++ so this builds anywhere, including Linux, as part of Tests/CMakeLists.txt.
+//
+// On x86 it is also built with -mssse3 to check the vector paths. Every channel count is packed in both layouts, with
+// and without bit reversal, for frame counts covering the vector loops and their scalar tails and starting from either
+// marker. The output is compared with the byte loop formerly used by SFBDoPDecoder, and bytes following the packed
+// frames must be left untouched since SFBDoPDecoder writes directly into the caller's buffer.
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "DoPPacker.hpp"
+#include "test_harness.h"
+
+namespace {
+
+constexpr unsigned char kGuard = 0xA5;
+
+using sfb_test::check;
+
+unsigned char reverseBits(unsigned char byte) {
+    unsigned char reversed = 0;
+    for (int bit = 0; bit < 8; ++bit) {
+        if (byte & (1 << bit)) {
+            reversed |= static_cast<unsigned char>(0x80 >> bit);
+        }
+    }
+    return reversed;
+}
+
+/// The byte loop formerly used by SFBDoPDecoder, writing sample `frame` of `channel` to `output(channel, frame)`
+template <typename Output>
+unsigned char referencePack(const std::vector<unsigned char> &dsd, int channelCount, std::size_t frames, bool reverse,
+                            unsigned char firstMarker, Output output) {
+    unsigned char marker = firstMarker;
+    for (int channel = 0; channel < channelCount; ++channel) {
+        const unsigned char *input = dsd.data() + channel;
+        marker = firstMarker;
+        for (std::size_t i = 0; i < frames; ++i) {
+            unsigned char *sample = output(channel, i);
+            sample[0] = marker;
+            sample[1] = reverse ? reverseBits(*input) : *input;
+            input += channelCount;
+            sample[2] = reverse ? reverseBits(*input) : *input;
+            input += channelCount;
+            marker = marker == 0x05 ? 0xfa : 0x05;
+        }
+    }
+    return marker;
+}
+
+void checkPack(int channelCount, bool reverse) {
+    std::mt19937 generator{static_cast<unsigned>((channelCount * 2) + reverse)};
+    std::uniform_int_distribution<int> byte{0, 255};
+
+    const std::vector<std::size_t> counts{0, 1, 2, 7, 8, 9, 15, 16, 17, 31, 32, 33, 100, 4096};
+
+    bool interleavedIdentical = true;
+    bool interleavedGuarded = true;
+    bool planarIdentical = true;
+    bool planarGuarded = true;
+    bool markers = true;
+
+    for (auto frames : counts) {
+        std::vector<unsigned char> dsd(frames * 2 * channelCount);
+        for (auto &b : dsd) {
+            b = static_cast<unsigned char>(byte(generator));
+        }
+
+        for (unsigned char firstMarker : {sfb::dop::initialMarker, sfb::dop::nextMarker(sfb::dop::initialMarker)}) {
+            const std::size_t frameSize = 3 * channelCount;
+
+            std::vector<unsigned char> expected(frames * frameSize);
+            const auto expectedMarker =
+                    referencePack(dsd, channelCount, frames, reverse, firstMarker, [&](int channel, std::size_t i) {
+                        return expected.data() + (i * frameSize) + (3 * channel);
+                    });
+
+            std::vector<unsigned char> interleaved((frames * frameSize) + 64, kGuard);
+            const auto interleavedMarker = sfb::dop::packInterleaved(dsd.data(), channelCount, frames, reverse,
+                                                                     firstMarker, interleaved.data());
+            for (std::size_t i = 0; i < interleaved.size(); ++i) {
+                if (i < expected.size()) {
+                    interleavedIdentical = interleavedIdentical && interleaved[i] == expected[i];
+                } else {
+                    interleavedGuarded = interleavedGuarded && interleaved[i] == kGuard;
+                }
+            }
+
+            std::vector<std::vector<unsigned char>> planes(channelCount,
+                                                           std::vector<unsigned char>((frames * 3) + 64, kGuard));
+            std::vector<unsigned char *> planePointers;
+            for (auto &plane : planes) {
+                planePointers.push_back(plane.data());
+            }
+            const auto planarMarker = sfb::dop::packPlanar(dsd.data(), channelCount, frames, reverse, firstMarker,
+                                                           planePointers.data());
+            for (int channel = 0; channel < channelCount; ++channel) {
+                for (std::size_t i = 0; i < planes[channel].size(); ++i) {
+                    if (i < frames * 3) {
+                        planarIdentical = planarIdentical &&
+                                          planes[channel][i] == expected[((i / 3) * frameSize) + (3 * channel) + i % 3];
+                    } else {
+                        planarGuarded = planarGuarded && planes[channel][i] == kGuard;
+                    }
+                }
+            }
+
+            markers = markers && interleavedMarker == expectedMarker && planarMarker == expectedMarker;
+        }
+    }
+
+    char description[128];
+    const char *order = reverse ? "bit reversed" : "in order";
+    std::snprintf(description, sizeof description, "interleaved %d ch %s", channelCount, order);
+    check(interleavedIdentical, description);
+    std::snprintf(description, sizeof description, "interleaved %d ch %s writes no further than the last frame",
+                  channelCount, order);
+    check(interleavedGuarded, description);
+    std::snprintf(description, sizeof description, "planar %d ch %s", channelCount, order);
+    check(planarIdentical, description);
+    std::snprintf(description, sizeof description, "planar %d ch %s writes no further than the last frame",
+                  channelCount, order);
+    check(planarGuarded, description);
+    std::snprintf(description, sizeof description, "%d ch %s returns the following marker", channelCount, order);
+    check(markers, description);
+}
+
+} /* namespace */
+
+int main() {
+    for (int channelCount = 1; channelCount <= 8; ++channelCount) {
+        checkPack(channelCount, false);
+        checkPack(channelCount, true);
+    }
+
+    return sfb_test::summarize();
+}
@@ -0,0 +1,189 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Accuracy checks for sfb::DSDPCMFilter and sfb::DSDPCMConverter.
+//
+// The DSD to PCM converter is plain C++ so this builds anywhere, including Linux, as part of Tests/CMakeLists.txt.
+//
+// For each filter profile the multichannel filter must match the original single-channel filter, generalized to the
+// profile's taps, to within 1e-6 for every channel count, bit order, and call size. The decimation chains must
+// preserve the level of an in-band sine; the level is measured by correlation since the modulator's ultrasonic noise
+// remains at the higher output rates. Conversion in concurrent channel groups must be identical to serial
+// conversion.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "DSDPCMConverter.hpp"
+#include "dsd2pcm_reference.h"
+#include "test_signals.h"
+#include "test_harness.h"
+
+namespace {
+
+using sfb_test::check;
+
+/// A filter profile and the second half of its first stage lowpass
+template <std::size_t HalfTaps>
+struct Profile {
+    const char *name;
+    const sfb::dsd2pcm::FilterProfile &profile;
+    const double (&htaps)[HalfTaps];
+};
+
+const Profile shortProfile{"short", sfb::dsd2pcm::shortProfile, sfb::dsd2pcm::detail::shortHalfTaps};
+const Profile standardProfile{"standard", sfb::dsd2pcm::standardProfile, sfb::dsd2pcm::detail::standardHalfTaps};
+const Profile longProfile{"long", sfb::dsd2pcm::longProfile, sfb::dsd2pcm::detail::longHalfTaps};
+
+/// Compares the multichannel filter with the reference filter, converting `callPackets` clustered frames per call
+template <std::size_t HalfTaps>
+void checkFilter(const Profile<HalfTaps> &profile, int channelCount, bool lsbitfirst, std::size_t callPackets) {
+    auto dsd = dsd2pcm_test::modulateSines(2822400, channelCount, 1000, 0.5, 0.05);
+    if (lsbitfirst) {
+        dsd = dsd2pcm_test::reverseBits(std::move(dsd));
+    }
+    const std::size_t packets = dsd.size() / channelCount;
+
+    std::vector<std::vector<float>> expected(channelCount, std::vector<float>(packets));
+    for (int channel = 0; channel < channelCount; ++channel) {
+        dsd2pcm_test::ReferenceFilter reference{profile.htaps};
+        reference.translate(packets, dsd.data() + channel, channelCount, lsbitfirst, expected[channel].data(), 1);
+    }
+
+    std::vector<std::vector<float>> actual(channelCount, std::vector<float>(packets));
+    std::vector<float *> planes(channelCount);
+    sfb::DSDPCMFilter filter{channelCount, profile.profile};
+    for (std::size_t offset = 0; offset < packets; offset += callPackets) {
+        for (int channel = 0; channel < channelCount; ++channel) {
+            planes[channel] = actual[channel].data() + offset;
+        }
+        filter.translate(std::min(callPackets, packets - offset), dsd.data() + (offset * channelCount), lsbitfirst,
+                         planes.data());
+    }
+
+    double error = 0;
+    for (int channel = 0; channel < channelCount; ++channel) {
+        for (std::size_t i = 0; i < packets; ++i) {
+            error = std::max(error, static_cast<double>(std::fabs(actual[channel][i] - expected[channel][i])));
+        }
+    }
+
+    char description[128];
+    std::snprintf(description, sizeof description, "filter %-8s %d ch %s %5zu packets/call  max error %.2g",
+                  profile.name, channelCount, lsbitfirst ? "lsb" : "msb", callPackets, error);
+    check(error <= 1e-6, description);
+}
+
+/// Converts a sine from `dsdSampleRate` to `pcmSampleRate` and checks the output length and level
+template <std::size_t HalfTaps>
+void checkConverter(const Profile<HalfTaps> &profile, double dsdSampleRate, double pcmSampleRate) {
+    constexpr int channelCount = 2;
+    constexpr std::size_t callPackets = 16384;
+    const auto dsd = dsd2pcm_test::modulateSines(dsdSampleRate, channelCount, 1000, 0.5, 0.5);
+    const std::size_t packets = dsd.size() / channelCount;
+    const auto packetsPerFrame = static_cast<std::size_t>(dsdSampleRate / 8 / pcmSampleRate);
+    const int halfBandStages = __builtin_ctzll(packetsPerFrame);
+
+    std::vector<std::vector<float>> pcm(channelCount, std::vector<float>(packets / packetsPerFrame));
+    std::vector<float *> planes(channelCount);
+    sfb::DSDPCMConverter converter{channelCount, halfBandStages, callPackets, profile.profile};
+    std::size_t frames = 0;
+    for (std::size_t offset = 0; offset < packets; offset += callPackets) {
+        for (int channel = 0; channel < channelCount; ++channel) {
+            planes[channel] = pcm[channel].data() + frames;
+        }
+        frames += converter.convert(std::min(callPackets, packets - offset), dsd.data() + (offset * channelCount),
+                                    false, planes.data());
+    }
+
+    // Skip the filter warm up and correlate over whole cycles
+    const auto cycle = static_cast<std::size_t>(pcmSampleRate / 1000);
+    const std::size_t begin = frames - (((frames / 2) / cycle) * cycle);
+    double in = 0;
+    double quadrature = 0;
+    for (std::size_t i = begin; i < frames; ++i) {
+        const double phase = 2 * M_PI * 1000 * static_cast<double>(i) / pcmSampleRate;
+        in += pcm[0][i] * std::sin(phase);
+        quadrature += pcm[0][i] * std::cos(phase);
+    }
+    const double level = 2 * std::hypot(in, quadrature) / static_cast<double>(frames - begin);
+
+    char description[128];
+    std::snprintf(description, sizeof description, "convert %-8s %8.0f Hz to %6.0f Hz  %zu frames  level %.4f",
+                  profile.name, dsdSampleRate, pcmSampleRate, frames, level);
+    check(frames == packets / packetsPerFrame && std::fabs(level - 0.5) < 0.001, description);
+}
+
+/// Converts a multichannel sine from `dsdSampleRate` to `pcmSampleRate` with `channelGroups` concurrent channel groups
+/// and checks that the output is identical to serial conversion
+void checkChannelGroups(double dsdSampleRate, double pcmSampleRate, int channelCount, int channelGroups) {
+    constexpr std::size_t callPackets = 4096;
+    const auto dsd = dsd2pcm_test::modulateSines(dsdSampleRate, channelCount, 1000, 0.5, 0.1);
+    const std::size_t packets = dsd.size() / channelCount;
+    const auto packetsPerFrame = static_cast<std::size_t>(dsdSampleRate / 8 / pcmSampleRate);
+    const int halfBandStages = __builtin_ctzll(packetsPerFrame);
+
+    const auto convert = [&](int groups) {
+        std::vector<std::vector<float>> pcm(channelCount, std::vector<float>(packets / packetsPerFrame));
+        std::vector<float *> planes(channelCount);
+        sfb::DSDPCMConverter converter{channelCount, halfBandStages, callPackets, sfb::dsd2pcm::standardProfile,
+                                       groups};
+        std::size_t frames = 0;
+        for (std::size_t offset = 0; offset < packets; offset += callPackets) {
+            for (int channel = 0; channel < channelCount; ++channel) {
+                planes[channel] = pcm[channel].data() + frames;
+            }
+            frames += converter.convert(std::min(callPackets, packets - offset),
+                                        dsd.data() + (offset * channelCount), true, planes.data());
+        }
+        return pcm;
+    };
+
+    char description[128];
+    std::snprintf(description, sizeof description, "convert %8.0f Hz to %6.0f Hz  %d ch in %d groups", dsdSampleRate,
+                  pcmSampleRate, channelCount, channelGroups);
+    check(convert(channelGroups) == convert(1), description);
+}
+
+/// Runs every check for `profile`
+template <std::size_t HalfTaps>
+void checkProfile(const Profile<HalfTaps> &profile) {
+    for (int channelCount = 1; channelCount <= 8; ++channelCount) {
+        for (bool lsbitfirst : {false, true}) {
+            for (std::size_t callPackets : {1, 7, 1024, 1500, 16384}) {
+                checkFilter(profile, channelCount, lsbitfirst, callPackets);
+            }
+        }
+    }
+
+    for (double dsdSampleRate : {2822400., 5644800., 11289600., 22579200.}) {
+        for (double pcmSampleRate : {88200., 176400., 352800.}) {
+            if (dsdSampleRate / 8 >= pcmSampleRate) {
+                checkConverter(profile, dsdSampleRate, pcmSampleRate);
+            }
+        }
+    }
+}
+
+} /* namespace */
+
+int main() {
+    checkProfile(shortProfile);
+    checkProfile(standardProfile);
+    checkProfile(longProfile);
+
+    for (double pcmSampleRate : {88200., 352800.}) {
+        for (int channelGroups : {2, 3, 4, 6}) {
+            checkChannelGroups(11289600, pcmSampleRate, 6, channelGroups);
+        }
+    }
+    checkChannelGroups(2822400, 352800, 2, 2);
+
+    return sfb_test::summarize();
+}
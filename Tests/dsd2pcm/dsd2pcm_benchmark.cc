@@ -0,0 +1,127 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Throughput benchmark for sfb::DSDPCMFilter and sfb::DSDPCMConverter.
+//
+// The DSD to PCM converter is plain C++ so this builds anywhere, including Linux, as part of Tests/CMakeLists.txt.
+//
+// The filter runs compare the multichannel filter with the original filter called once per channel on the clustered
+// input, as SFBDSDPCMDecoder formerly did. The converter runs include the half-band stages for each filter profile
+// and DSD and PCM sample rate, followed by 5.1 DSD256 converted in concurrent channel groups. Results are reported as
+// multiples of real time and nanoseconds per output sample.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iterator>
+#include <vector>
+
+#include "DSDPCMConverter.hpp"
+#include "dsd2pcm_reference.h"
+#include "test_signals.h"
+
+namespace {
+
+constexpr double kDurationSeconds = 20;
+constexpr std::size_t kCallPackets = 16384;
+
+void report(const char *name, double seconds, double elapsed, double outputSamples) {
+    std::printf("%-44s %8.1fx real time  %6.2f ns/sample\n", name, seconds / elapsed, 1e9 * elapsed / outputSamples);
+}
+
+void runFilterBenchmark(int channelCount) {
+    const auto dsd = dsd2pcm_test::modulateSines(2822400, channelCount, 1000, 0.5, kDurationSeconds);
+    const std::size_t packets = dsd.size() / channelCount;
+    std::vector<std::vector<float>> pcm(channelCount, std::vector<float>(kCallPackets));
+    std::vector<float *> planes(channelCount);
+    for (int channel = 0; channel < channelCount; ++channel) {
+        planes[channel] = pcm[channel].data();
+    }
+
+    char name[64];
+    {
+        std::vector<dsd2pcm_test::ReferenceFilter<std::size(sfb::dsd2pcm::detail::standardHalfTaps)>> reference(
+                channelCount, dsd2pcm_test::ReferenceFilter{sfb::dsd2pcm::detail::standardHalfTaps});
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t offset = 0; offset < packets; offset += kCallPackets) {
+            const auto count = std::min(kCallPackets, packets - offset);
+            for (int channel = 0; channel < channelCount; ++channel) {
+                reference[channel].translate(count, dsd.data() + (offset * channelCount) + channel, channelCount,
+                                             true, planes[channel], 1);
+            }
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::snprintf(name, sizeof name, "DSD64 %d ch original filter", channelCount);
+        report(name, kDurationSeconds, elapsed.count(), static_cast<double>(packets * channelCount));
+    }
+    {
+        sfb::DSDPCMFilter filter{channelCount, sfb::dsd2pcm::standardProfile};
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t offset = 0; offset < packets; offset += kCallPackets) {
+            const auto count = std::min(kCallPackets, packets - offset);
+            filter.translate(count, dsd.data() + (offset * channelCount), true, planes.data());
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::snprintf(name, sizeof name, "DSD64 %d ch multichannel filter", channelCount);
+        report(name, kDurationSeconds, elapsed.count(), static_cast<double>(packets * channelCount));
+    }
+}
+
+void runConverterBenchmark(const char *profileName, const sfb::dsd2pcm::FilterProfile &profile, int channelCount,
+                           int multiple, double pcmSampleRate, int channelGroups = 1) {
+    const double dsdSampleRate = 2822400. * multiple;
+    const auto dsd = dsd2pcm_test::modulateSines(dsdSampleRate, channelCount, 1000, 0.5, kDurationSeconds / multiple);
+    const std::size_t packets = dsd.size() / channelCount;
+    const auto packetsPerFrame = static_cast<std::size_t>(dsdSampleRate / 8 / pcmSampleRate);
+    std::vector<std::vector<float>> pcm(channelCount, std::vector<float>(kCallPackets));
+    std::vector<float *> planes(channelCount);
+    for (int channel = 0; channel < channelCount; ++channel) {
+        planes[channel] = pcm[channel].data();
+    }
+
+    sfb::DSDPCMConverter converter{channelCount, __builtin_ctzll(packetsPerFrame), kCallPackets, profile,
+                                   channelGroups};
+    std::size_t frames = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t offset = 0; offset < packets; offset += kCallPackets) {
+        const auto count = std::min(kCallPackets, packets - offset);
+        frames += converter.convert(count, dsd.data() + (offset * channelCount), true, planes.data());
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    char name[64];
+    if (channelGroups > 1) {
+        std::snprintf(name, sizeof name, "DSD%d %d ch to %.1f kHz %s %d groups", 64 * multiple, channelCount,
+                      pcmSampleRate / 1000, profileName, channelGroups);
+    } else {
+        std::snprintf(name, sizeof name, "DSD%d %d ch to %.1f kHz %s", 64 * multiple, channelCount,
+                      pcmSampleRate / 1000, profileName);
+    }
+    report(name, kDurationSeconds / multiple, elapsed.count(), static_cast<double>(frames * channelCount));
+}
+
+} /* namespace */
+
+int main() {
+    for (int channelCount : {2, 6}) {
+        runFilterBenchmark(channelCount);
+    }
+
+    for (int multiple : {1, 2, 4, 8}) {
+        for (double pcmSampleRate : {88200., 176400., 352800.}) {
+            runConverterBenchmark("short", sfb::dsd2pcm::shortProfile, 2, multiple, pcmSampleRate);
+            runConverterBenchmark("standard", sfb::dsd2pcm::standardProfile, 2, multiple, pcmSampleRate);
+            runConverterBenchmark("long", sfb::dsd2pcm::longProfile, 2, multiple, pcmSampleRate);
+        }
+    }
+
+    for (int channelGroups : {1, 2, 3, 6}) {
+        runConverterBenchmark("standard", sfb::dsd2pcm::standardProfile, 6, 4, 176400., channelGroups);
+    }
+
+    return 0;
+}
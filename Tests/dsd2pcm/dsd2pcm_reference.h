@@ -0,0 +1,80 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// The original single-channel DSD2PCM filter, used as the reference for accuracy and speed.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+#include "DSDPCMConverter.hpp"
+
+namespace dsd2pcm_test {
+
+// SPDX-SnippetCopyrightText: 2009,2011 Sebastian Gesemann
+// SPDX-SnippetLicenseIdentifier: BSD-2-Clause-Views
+// SPDX-SnippetComment: Adapted from 'dsd2pcm.c'
+
+/// One channel of the original filter generalized to any symmetric lowpass whose second half is `htaps`
+template <std::size_t HalfTaps>
+class ReferenceFilter {
+  public:
+    explicit ReferenceFilter(const double (&htaps)[HalfTaps]) noexcept {
+        for (int t = 0; t < CTABLES; ++t) {
+            const int k = std::min(static_cast<int>(HalfTaps) - (t * 8), 8);
+            for (int e = 0; e < 256; ++e) {
+                double acc = 0.0;
+                for (int m = 0; m < k; ++m) {
+                    acc += (((e >> (7 - m)) & 1) * 2 - 1) * htaps[(t * 8) + m];
+                }
+                ctables_[CTABLES - 1 - t][e] = static_cast<float>(acc);
+            }
+        }
+        for (auto &byte : fifo_) {
+            byte = 0x69;
+        }
+    }
+
+    void translate(std::size_t samples, const unsigned char *src, std::ptrdiff_t src_stride, bool lsbf, float *dst,
+                   std::ptrdiff_t dst_stride) noexcept {
+        const auto *bitReverse = sfb::dsd2pcm::bitReverseTable256;
+        unsigned ffp = fifopos_;
+        while (samples-- > 0) {
+            unsigned bite1 = *src & 0xFFU;
+            if (lsbf) {
+                bite1 = bitReverse[bite1];
+            }
+            fifo_[ffp] = static_cast<unsigned char>(bite1);
+            src += src_stride;
+            unsigned char *p = fifo_ + ((ffp - CTABLES) & FIFOMASK);
+            *p = bitReverse[*p & 0xFF];
+            double acc = 0;
+            for (int i = 0; i < CTABLES; ++i) {
+                bite1 = fifo_[(ffp - i) & FIFOMASK] & 0xFF;
+                const unsigned bite2 = fifo_[(ffp - (CTABLES * 2 - 1) + i) & FIFOMASK] & 0xFF;
+                acc += ctables_[i][bite1] + ctables_[i][bite2];
+            }
+            *dst = static_cast<float>(acc);
+            dst += dst_stride;
+            ffp = (ffp + 1) & FIFOMASK;
+        }
+        fifopos_ = ffp;
+    }
+
+  private:
+    static constexpr int CTABLES = (HalfTaps + 7) / 8;
+    static constexpr int FIFOSIZE = 32;
+    static constexpr int FIFOMASK = FIFOSIZE - 1;
+    static_assert(FIFOSIZE >= 2 * CTABLES);
+
+    float ctables_[CTABLES][256];
+    unsigned char fifo_[FIFOSIZE];
+    unsigned fifopos_{0};
+};
+
+} /* namespace dsd2pcm_test */
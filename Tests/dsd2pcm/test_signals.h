@@ -0,0 +1,57 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// DSD test signal generation shared by the DSD to PCM benchmark and accuracy checks.
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "DSDPCMConverter.hpp"
+
+namespace dsd2pcm_test {
+
+/// Returns `seconds` of clustered most-significant-bit-first DSD at `sampleRate` for `channelCount` channels
+///
+/// Each channel is a sine of `frequency` Hz, offset by 100 Hz per channel, at `amplitude` encoded by a second-order
+/// sigma-delta modulator.
+inline std::vector<unsigned char> modulateSines(double sampleRate, int channelCount, double frequency,
+                                                double amplitude, double seconds) {
+    const auto packets = static_cast<std::size_t>(sampleRate * seconds / 8);
+    std::vector<unsigned char> dsd(packets * channelCount);
+    for (int channel = 0; channel < channelCount; ++channel) {
+        const double f = frequency + (100 * channel);
+        double i1 = 0;
+        double i2 = 0;
+        double y = 0;
+        for (std::size_t packet = 0; packet < packets; ++packet) {
+            unsigned char byte = 0;
+            for (int bit = 0; bit < 8; ++bit) {
+                const double x = amplitude * std::sin(2 * M_PI * f * static_cast<double>((packet * 8) + bit) /
+                                                      sampleRate);
+                i1 += x - y;
+                i2 += i1 - y;
+                y = i2 >= 0 ? 1 : -1;
+                byte = static_cast<unsigned char>((byte << 1) | (y > 0 ? 1 : 0));
+            }
+            dsd[(packet * channelCount) + channel] = byte;
+        }
+    }
+    return dsd;
+}
+
+/// Returns `dsd` with the bit order of every byte reversed
+inline std::vector<unsigned char> reverseBits(std::vector<unsigned char> dsd) {
+    for (auto &byte : dsd) {
+        byte = sfb::dsd2pcm::bitReverseTable256[byte];
+    }
+    return dsd;
+}
+
+} /* namespace dsd2pcm_test */
@@ -0,0 +1,84 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Accuracy checks for sfb::dsf::interleave.
+//
+// The DSF block interleaver is plain C++ so this builds anywhere, including Linux, as part of Tests/CMakeLists.txt.
+//
+// Every channel count is interleaved from many cursor positions and column counts, covering the vector loops and
+// their scalar tails, and compared with a plain transposition. Bytes following the interleaved frames must be left
+// untouched since SFBDSFDecoder writes directly into the caller's buffer.
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "DSFBlockInterleaver.hpp"
+#include "test_harness.h"
+
+namespace {
+
+constexpr std::size_t kBlockSize = 4096;
+constexpr unsigned char kGuard = 0xA5;
+
+using sfb_test::check;
+
+/// Interleaves `count` columns starting at `first` for every cursor position in `firsts` and every count in `counts`
+void checkInterleave(int channelCount) {
+    std::mt19937 generator{static_cast<unsigned>(channelCount)};
+    std::uniform_int_distribution<int> byte{0, 255};
+    std::vector<unsigned char> block(kBlockSize * channelCount);
+    for (auto &b : block) {
+        b = static_cast<unsigned char>(byte(generator));
+    }
+
+    std::vector<std::size_t> firsts{0, 1, 7, 15, 16, 17, 100, kBlockSize - 33, kBlockSize - 17, kBlockSize - 1};
+    std::vector<std::size_t> counts{0, 1, 2, 15, 16, 17, 31, 32, 33, 47, 48, 49, 255};
+
+    bool identical = true;
+    bool guarded = true;
+    std::vector<unsigned char> output;
+    const auto run = [&](std::size_t first, std::size_t count) {
+        output.assign((count * channelCount) + 16, kGuard);
+        sfb::dsf::interleave(block.data() + first, kBlockSize, channelCount, count, output.data());
+        for (std::size_t i = 0; i < count; ++i) {
+            for (int channel = 0; channel < channelCount; ++channel) {
+                identical = identical &&
+                            output[(i * channelCount) + channel] == block[(channel * kBlockSize) + first + i];
+            }
+        }
+        for (std::size_t i = count * channelCount; i < output.size(); ++i) {
+            guarded = guarded && output[i] == kGuard;
+        }
+    };
+
+    for (auto first : firsts) {
+        for (auto count : counts) {
+            if (first + count <= kBlockSize) {
+                run(first, count);
+            }
+        }
+        run(first, kBlockSize - first);
+    }
+
+    char description[128];
+    std::snprintf(description, sizeof description, "interleave %d ch", channelCount);
+    check(identical, description);
+    std::snprintf(description, sizeof description, "interleave %d ch writes no further than the last frame",
+                  channelCount);
+    check(guarded, description);
+}
+
+} /* namespace */
+
+int main() {
+    for (int channelCount = 1; channelCount <= 8; ++channelCount) {
+        checkInterleave(channelCount);
+    }
+
+    return sfb_test::summarize();
+}
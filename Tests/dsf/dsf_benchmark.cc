@@ -0,0 +1,135 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Throughput benchmark for sfb::dsf::interleave.
+//
+// The DSF block interleaver is plain C++ so this builds anywhere, including Linux, as part of Tests/CMakeLists.txt.
+//
+// Blocks are delivered in reads of 1000 packets. The original path transposes each block into a temporary, copies it
+// back, copies each read to the output and moves the remainder to the front of the block. The block cursor path
+// interleaves each read from the block straight into the output. Results are reported as multiples of DSD64 real time
+// and bytes per nanosecond.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "DSFBlockInterleaver.hpp"
+
+namespace {
+
+constexpr std::size_t kBlockSize = 4096;
+constexpr std::size_t kReadPackets = 1000;
+constexpr std::size_t kBlocks = 20000;
+constexpr double kPacketsPerSecond = 2822400.0 / 8;
+
+/// The blocked transposition formerly used by SFBDSFDecoder
+void matrixTranspose(const unsigned char *A, unsigned char *B, std::size_t rows, std::size_t columns) {
+    constexpr std::size_t blockSize = 64;
+    for (std::size_t r = 0; r < rows; r += blockSize) {
+        for (std::size_t c = 0; c < columns; c += blockSize) {
+            const auto rEnd = std::min(r + blockSize, rows);
+            const auto cEnd = std::min(c + blockSize, columns);
+            for (std::size_t i = r; i < rEnd; ++i) {
+                for (std::size_t j = c; j < cEnd; ++j) {
+                    B[(j * rows) + i] = A[(i * columns) + j];
+                }
+            }
+        }
+    }
+}
+
+void report(const char *name, double elapsed, double bytes) {
+    const double seconds = kBlocks * kBlockSize / kPacketsPerSecond;
+    std::printf("%-32s %10.1fx real time  %6.2f bytes/ns\n", name, seconds / elapsed, bytes / (1e9 * elapsed));
+}
+
+void runBenchmark(int channelCount) {
+    const std::size_t blockBytes = kBlockSize * channelCount;
+    std::vector<unsigned char> source(blockBytes);
+    for (std::size_t i = 0; i < source.size(); ++i) {
+        source[i] = static_cast<unsigned char>(i * 131);
+    }
+    std::vector<unsigned char> block(blockBytes);
+    std::vector<unsigned char> temporary(blockBytes);
+    std::vector<unsigned char> output(kReadPackets * channelCount);
+    unsigned checksum = 0;
+
+    std::printf("%d ch\n", channelCount);
+    {
+        const auto start = std::chrono::steady_clock::now();
+        std::size_t buffered = 0;
+        std::size_t blocks = 0;
+        while (blocks < kBlocks || buffered > 0) {
+            std::size_t produced = 0;
+            while (produced < kReadPackets) {
+                if (buffered == 0) {
+                    if (blocks == kBlocks) {
+                        break;
+                    }
+                    std::memcpy(block.data(), source.data(), blockBytes);
+                    matrixTranspose(block.data(), temporary.data(), channelCount, kBlockSize);
+                    std::memcpy(block.data(), temporary.data(), blockBytes);
+                    buffered = kBlockSize;
+                    ++blocks;
+                }
+                const auto count = std::min(buffered, kReadPackets - produced);
+                std::memcpy(output.data() + (produced * channelCount), block.data(), count * channelCount);
+                if (count != buffered) {
+                    std::memmove(block.data(), block.data() + (count * channelCount),
+                                 (buffered - count) * channelCount);
+                }
+                buffered -= count;
+                produced += count;
+            }
+            checksum += output[0];
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        report("  transpose, copy and move", elapsed.count(), static_cast<double>(kBlocks * blockBytes));
+    }
+
+    {
+        const auto start = std::chrono::steady_clock::now();
+        std::size_t cursor = kBlockSize;
+        std::size_t blocks = 0;
+        while (blocks < kBlocks || cursor < kBlockSize) {
+            std::size_t produced = 0;
+            while (produced < kReadPackets) {
+                if (cursor == kBlockSize) {
+                    if (blocks == kBlocks) {
+                        break;
+                    }
+                    std::memcpy(block.data(), source.data(), blockBytes);
+                    cursor = 0;
+                    ++blocks;
+                }
+                const auto count = std::min(kBlockSize - cursor, kReadPackets - produced);
+                sfb::dsf::interleave(block.data() + cursor, kBlockSize, channelCount, count,
+                                     output.data() + (produced * channelCount));
+                cursor += count;
+                produced += count;
+            }
+            checksum += output[0];
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        report("  block cursor", elapsed.count(), static_cast<double>(kBlocks * blockBytes));
+    }
+
+    // Keep the interleaved output observable
+    std::printf("  checksum %u\n", checksum);
+}
+
+} /* namespace */
+
+int main() {
+    for (int channelCount : {1, 2, 5, 6}) {
+        runBenchmark(channelCount);
+    }
+    return 0;
+}
@@ -0,0 +1,178 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Round trip checks for sfb::DSTFrameDecoder and sfb::DSTFramePipeline.
+//
+// The DST decoder is plain C++ so this builds anywhere, including Linux, as part of Tests/CMakeLists.txt.
+//
+// Frames produced by the test encoder with each combination of uncompressed data, shared and per-channel filters,
+// plain and coded coefficient tables, and half probability must decode to the original DSD. Pipelined decoding with
+// any number of threads must deliver the same frames in order, including after the pipeline is cleared as for a
+// seek, and malformed frames must be rejected without reading out of bounds.
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../dsd2pcm/test_signals.h"
+#include "DSTDecoder.hpp"
+#include "dst_encoder.h"
+#include "test_harness.h"
+
+namespace {
+
+constexpr std::uint32_t kSampleRate = 2822400;
+constexpr std::size_t kSamplesPerFrame = sfb::dst::samplesPerFrame(kSampleRate);
+
+using sfb_test::check;
+
+/// Encodes and decodes four frames of `channelCount` channels using `options`
+void checkFrames(int channelCount, const dst_test::FrameOptions &options, const char *name) {
+    const auto dsd = dsd2pcm_test::modulateSines(kSampleRate, channelCount, 1000, 0.5, 4.0 / sfb::dst::framesPerSecond);
+    const auto frames = dst_test::encodeStream(dsd, channelCount, kSamplesPerFrame, options);
+
+    sfb::DSTFrameDecoder decoder{channelCount, kSamplesPerFrame};
+    std::vector<unsigned char> decoded(decoder.frameSize());
+    bool identical = frames.size() == 4;
+    std::size_t compressed = 0;
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        compressed += frames[i].size();
+        const auto status = decoder.decode(frames[i].data(), frames[i].size(), decoded.data());
+        identical = identical && status == sfb::DSTFrameDecoder::Status::success &&
+                    std::equal(decoded.begin(), decoded.end(), dsd.begin() + (i * decoder.frameSize()));
+    }
+
+    char description[128];
+    std::snprintf(description, sizeof description, "decode %d ch %-28s ratio %.2f", channelCount, name,
+                  static_cast<double>(dsd.size()) / static_cast<double>(compressed));
+    check(identical, description);
+}
+
+/// Decodes a stream of `channelCount` channels with `threadCount` threads, clearing the pipeline partway through
+void checkPipeline(int channelCount, int threadCount, int depth) {
+    constexpr std::size_t frameCount = 24;
+    const auto dsd = dsd2pcm_test::modulateSines(kSampleRate, channelCount, 1000, 0.5,
+                                                 static_cast<double>(frameCount) / sfb::dst::framesPerSecond);
+    const auto frames = dst_test::encodeStream(dsd, channelCount, kSamplesPerFrame, {});
+
+    sfb::DSTFramePipeline pipeline{channelCount, kSamplesPerFrame, threadCount, depth};
+    const auto frameSize = pipeline.frameSize();
+
+    bool identical = frames.size() == frameCount;
+    const auto decodeRange = [&](std::size_t first, std::size_t last, std::size_t stop) {
+        std::size_t next = first;
+        for (std::size_t expected = first; expected < stop; ++expected) {
+            while (next < last && pipeline.canSubmit()) {
+                auto *data = pipeline.prepare(frames[next].size());
+                std::copy(frames[next].begin(), frames[next].end(), data);
+                pipeline.submit();
+                ++next;
+            }
+            const auto &frame = pipeline.wait();
+            identical = identical && frame.status == sfb::DSTFrameDecoder::Status::success &&
+                        std::equal(frame.frame.begin(), frame.frame.end(), dsd.begin() + (expected * frameSize));
+            pipeline.pop();
+        }
+    };
+
+    // Abandon the first range with frames in flight, then resume elsewhere as a seek would
+    decodeRange(0, frameCount, 5);
+    pipeline.clear();
+    decodeRange(12, frameCount, frameCount);
+    identical = identical && pipeline.empty();
+
+    char description[128];
+    std::snprintf(description, sizeof description, "pipeline %d ch %d threads depth %d", channelCount, threadCount,
+                  depth);
+    check(identical, description);
+}
+
+/// Decodes truncated and random frames
+void checkMalformed() {
+    constexpr int channelCount = 2;
+    const auto dsd = dsd2pcm_test::modulateSines(kSampleRate, channelCount, 1000, 0.5, 1.0 / sfb::dst::framesPerSecond);
+    dst_test::FrameOptions options;
+    options.filterCodingMethod = 1;
+    options.probabilityCodingMethod = 2;
+    const auto frames = dst_test::encodeStream(dsd, channelCount, kSamplesPerFrame, options);
+
+    sfb::DSTFrameDecoder decoder{channelCount, kSamplesPerFrame};
+    std::vector<unsigned char> decoded(decoder.frameSize());
+
+    // Truncated frames either fail or decode to the right length without reading past the data
+    for (std::size_t size : {std::size_t{0}, std::size_t{1}, std::size_t{2}, std::size_t{16}, frames[0].size() / 2}) {
+        std::vector<unsigned char> truncated(frames[0].begin(), frames[0].begin() + size);
+        truncated.shrink_to_fit();
+        decoder.decode(truncated.data(), truncated.size(), decoded.data());
+    }
+    check(decoder.decode(frames[0].data(), 0, decoded.data()) == sfb::DSTFrameDecoder::Status::invalid,
+          "reject empty frame");
+
+    std::mt19937 generator{75};
+    std::uniform_int_distribution<int> byte{0, 255};
+    int rejected = 0;
+    for (int i = 0; i < 200; ++i) {
+        std::vector<unsigned char> random(1 + (i * 37));
+        for (auto &b : random) {
+            b = static_cast<unsigned char>(byte(generator));
+        }
+        random[0] |= 0x80;
+        if (decoder.decode(random.data(), random.size(), decoded.data()) != sfb::DSTFrameDecoder::Status::success) {
+            ++rejected;
+        }
+    }
+    char description[128];
+    std::snprintf(description, sizeof description, "decode random frames  %d of 200 rejected", rejected);
+    check(rejected > 0, description);
+
+    // Segmentation other than one segment per channel
+    std::vector<unsigned char> segmented{0x80, 0x00};
+    check(decoder.decode(segmented.data(), segmented.size(), decoded.data()) ==
+                  sfb::DSTFrameDecoder::Status::unsupported,
+          "reject unsupported segmentation");
+}
+
+} /* namespace */
+
+int main() {
+    for (int channelCount : {1, 2, 5, 6}) {
+        dst_test::FrameOptions options;
+        checkFrames(channelCount, options, "plain tables");
+
+        options.uncompressed = true;
+        checkFrames(channelCount, options, "uncompressed");
+        options.uncompressed = false;
+
+        options.sharedElements = true;
+        checkFrames(channelCount, options, "shared elements");
+        options.sharedElements = false;
+
+        for (int method : {0, 1, 2}) {
+            options.filterCodingMethod = method;
+            options.probabilityCodingMethod = method;
+            char name[64];
+            std::snprintf(name, sizeof name, "coded tables method %d", method);
+            checkFrames(channelCount, options, name);
+        }
+
+        options.halfProbability = true;
+        options.filterLength = 128;
+        checkFrames(channelCount, options, "half probability 128 taps");
+    }
+
+    for (int threadCount : {0, 1, 2, 4}) {
+        for (int depth : {1, 3, 8}) {
+            checkPipeline(2, threadCount, depth);
+        }
+    }
+    checkPipeline(6, 3, 6);
+
+    checkMalformed();
+
+    return sfb_test::summarize();
+}
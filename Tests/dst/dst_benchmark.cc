@@ -0,0 +1,102 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Throughput benchmark for sfb::DSTFrameDecoder and sfb::DSTFramePipeline.
+//
+// The DST decoder is plain C++ so this builds anywhere, including Linux, as part of Tests/CMakeLists.txt.
+//
+// Stereo and 5.1 DSD64 streams are encoded with the test encoder and decoded serially and through the pipeline with
+// increasing numbers of worker threads, as SFBDSDIFFDecoder does. Results are reported as multiples of real time and
+// microseconds per frame.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "../dsd2pcm/test_signals.h"
+#include "DSTDecoder.hpp"
+#include "dst_encoder.h"
+
+namespace {
+
+constexpr std::uint32_t kSampleRate = 2822400;
+constexpr std::size_t kSamplesPerFrame = sfb::dst::samplesPerFrame(kSampleRate);
+constexpr double kDurationSeconds = 4;
+constexpr int kPasses = 3;
+
+void report(const char *name, double seconds, double elapsed, double frames) {
+    std::printf("%-36s %8.1fx real time  %8.1f us/frame\n", name, seconds / elapsed, 1e6 * elapsed / frames);
+}
+
+void runBenchmark(int channelCount) {
+    const auto dsd = dsd2pcm_test::modulateSines(kSampleRate, channelCount, 1000, 0.5, kDurationSeconds);
+    dst_test::FrameOptions options;
+    options.filterCodingMethod = 1;
+    options.probabilityCodingMethod = 1;
+    const auto frames = dst_test::encodeStream(dsd, channelCount, kSamplesPerFrame, options);
+
+    std::size_t compressed = 0;
+    for (const auto &frame : frames) {
+        compressed += frame.size();
+    }
+    std::printf("%d ch DSD64, %zu frames, compression ratio %.2f\n", channelCount, frames.size(),
+                static_cast<double>(dsd.size()) / static_cast<double>(compressed));
+
+    const double seconds = kPasses * static_cast<double>(frames.size()) / sfb::dst::framesPerSecond;
+    const double frameCount = kPasses * static_cast<double>(frames.size());
+    unsigned checksum = 0;
+
+    {
+        sfb::DSTFrameDecoder decoder{channelCount, kSamplesPerFrame};
+        std::vector<unsigned char> decoded(decoder.frameSize());
+        const auto start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < kPasses; ++pass) {
+            for (const auto &frame : frames) {
+                decoder.decode(frame.data(), frame.size(), decoded.data());
+                checksum += decoded[0];
+            }
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        report("  serial", seconds, elapsed.count(), frameCount);
+    }
+
+    const int maximumThreads = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+    for (int threadCount = 1; threadCount <= std::min(maximumThreads, 8); threadCount *= 2) {
+        sfb::DSTFramePipeline pipeline{channelCount, kSamplesPerFrame, threadCount, (2 * threadCount) + 1};
+        const auto start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < kPasses; ++pass) {
+            std::size_t next = 0;
+            for (std::size_t i = 0; i < frames.size(); ++i) {
+                while (next < frames.size() && pipeline.canSubmit()) {
+                    auto *data = pipeline.prepare(frames[next].size());
+                    std::copy(frames[next].begin(), frames[next].end(), data);
+                    pipeline.submit();
+                    ++next;
+                }
+                checksum += pipeline.wait().frame[0];
+                pipeline.pop();
+            }
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        char name[64];
+        std::snprintf(name, sizeof name, "  pipeline, %d thread%s", threadCount, threadCount == 1 ? "" : "s");
+        report(name, seconds, elapsed.count(), frameCount);
+    }
+
+    // Keep the decoded output observable
+    std::printf("  checksum %u\n", checksum);
+}
+
+} /* namespace */
+
+int main() {
+    runBenchmark(2);
+    runBenchmark(6);
+    return 0;
+}
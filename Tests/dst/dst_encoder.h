@@ -0,0 +1,367 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// A minimal DST frame encoder producing every frame feature sfb::DSTFrameDecoder supports, used to generate test
+// streams for the DST round trip checks and benchmark.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include "DSTDecoder.hpp"
+
+namespace dst_test {
+
+/// A most-significant-bit-first bit writer
+class BitWriter {
+  public:
+    void write(std::uint32_t value, int count) {
+        for (int i = count - 1; i >= 0; --i) {
+            writeBit((value >> i) & 1);
+        }
+    }
+
+    void writeBit(unsigned bit) {
+        if ((bits_ & 7) == 0) {
+            data_.push_back(0);
+        }
+        if (bit) {
+            data_.back() |= static_cast<unsigned char>(0x80 >> (bits_ & 7));
+        }
+        ++bits_;
+    }
+
+    void writeSigned(int value, int count) { write(static_cast<std::uint32_t>(value) & ((1U << count) - 1), count); }
+
+    /// Writes `value` as the signed Rice code read by `BitReader::readSignedRice`
+    void writeSignedRice(int value, int k) {
+        const auto magnitude = static_cast<std::uint32_t>(std::abs(value));
+        for (std::uint32_t i = 0; i < (magnitude >> k); ++i) {
+            writeBit(0);
+        }
+        writeBit(1);
+        write(magnitude & ((1U << k) - 1), k);
+        if (value != 0) {
+            writeBit(value < 0 ? 1 : 0);
+        }
+    }
+
+    /// Adds one to the written bits as a binary number
+    void propagateCarry() {
+        for (std::size_t i = bits_; i-- > 0;) {
+            const auto mask = static_cast<unsigned char>(0x80 >> (i & 7));
+            data_[i >> 3] ^= mask;
+            if ((data_[i >> 3] & mask) != 0) {
+                return;
+            }
+        }
+    }
+
+    std::vector<unsigned char> take() { return std::move(data_); }
+
+  private:
+    std::vector<unsigned char> data_;
+    std::size_t bits_{0};
+};
+
+/// The arithmetic encoder matching `sfb::dst::detail::ArithmeticDecoder`
+///
+/// `low_` holds the 12 code bits the decoder's window covers; earlier bits are already written and receive carries.
+class ArithmeticEncoder {
+  public:
+    explicit ArithmeticEncoder(BitWriter &writer) : writer_{writer} {}
+
+    void encode(unsigned bit, unsigned p) {
+        const unsigned k = (a_ >> 8) | ((a_ >> 7) & 1);
+        const unsigned q = k * p;
+        const unsigned aq = a_ - q;
+        if (bit) {
+            a_ = aq;
+        } else {
+            low_ += aq;
+            if (low_ >= 4096) {
+                writer_.propagateCarry();
+                low_ -= 4096;
+            }
+            a_ = q;
+        }
+        while (a_ < 2048) {
+            a_ <<= 1;
+            shift();
+        }
+    }
+
+    /// Writes the remaining code bits
+    void flush() {
+        for (int i = 0; i < 12; ++i) {
+            shift();
+        }
+    }
+
+  private:
+    void shift() {
+        writer_.writeBit((low_ >> 11) & 1);
+        low_ = (low_ << 1) & 0xFFF;
+    }
+
+    BitWriter &writer_;
+    unsigned a_{4095};
+    unsigned low_{0};
+};
+
+/// Frame encoding choices exercising the decoder's syntax
+struct FrameOptions {
+    /// Store the frame uncompressed
+    bool uncompressed{false};
+    /// Use one filter and probability table for every channel
+    bool sharedElements{false};
+    /// Code the filter coefficients using prediction method 0, 1, or 2, or store them plainly if negative
+    int filterCodingMethod{-1};
+    /// Code the probability tables using prediction method 0, 1, or 2, or store them plainly if negative
+    int probabilityCodingMethod{-1};
+    /// Use half probability for the first samples of odd channels
+    bool halfProbability{false};
+    /// The prediction filter length
+    int filterLength{64};
+};
+
+/// Returns a least squares prediction filter of `length` taps for the first `samples` bits of `channel`, scaled to
+/// nine bit coefficients
+inline std::vector<int> designFilter(const unsigned char *dsd, int channelCount, int channel, std::size_t samples,
+                                     int length) {
+    const auto sample = [&](std::size_t i) {
+        return ((dsd[((i >> 3) * channelCount) + channel] >> (7 - (i & 7))) & 1) != 0 ? 1.0 : -1.0;
+    };
+
+    // Normal equations R h = r for predicting x[n] from x[n - 1 - j]
+    std::vector<double> autocorrelation(length + 1);
+    for (std::size_t n = length; n < samples; ++n) {
+        const double x = sample(n);
+        for (int lag = 0; lag <= length; ++lag) {
+            autocorrelation[lag] += x * sample(n - lag);
+        }
+    }
+    std::vector<double> matrix(length * length);
+    std::vector<double> h(length);
+    for (int i = 0; i < length; ++i) {
+        for (int j = 0; j < length; ++j) {
+            matrix[(i * length) + j] = autocorrelation[std::abs(i - j)] + (i == j ? 1e-3 * autocorrelation[0] : 0);
+        }
+        h[i] = autocorrelation[i + 1];
+    }
+
+    // Cholesky factorization and solution
+    for (int i = 0; i < length; ++i) {
+        for (int j = 0; j <= i; ++j) {
+            double sum = matrix[(i * length) + j];
+            for (int k = 0; k < j; ++k) {
+                sum -= matrix[(i * length) + k] * matrix[(j * length) + k];
+            }
+            matrix[(i * length) + j] = i == j ? std::sqrt(sum) : sum / matrix[(j * length) + j];
+        }
+    }
+    for (int i = 0; i < length; ++i) {
+        for (int k = 0; k < i; ++k) {
+            h[i] -= matrix[(i * length) + k] * h[k];
+        }
+        h[i] /= matrix[(i * length) + i];
+    }
+    for (int i = length - 1; i >= 0; --i) {
+        for (int k = i + 1; k < length; ++k) {
+            h[i] -= matrix[(k * length) + i] * h[k];
+        }
+        h[i] /= matrix[(i * length) + i];
+    }
+
+    double peak = 0;
+    for (double v : h) {
+        peak = std::max(peak, std::fabs(v));
+    }
+    std::vector<int> coefficients(length);
+    for (int i = 0; i < length; ++i) {
+        coefficients[i] = std::clamp(static_cast<int>(std::lround(h[i] * 255 / peak)), -256, 255);
+    }
+    return coefficients;
+}
+
+/// Writes the elements of a filter or probability table
+inline void writeTable(BitWriter &writer, const std::vector<std::vector<int>> &elements,
+                       const int (&predictionCoefficients)[3][3], int lengthBits, int coefficientBits, int offset,
+                       int method) {
+    for (const auto &coefficients : elements) {
+        const int length = static_cast<int>(coefficients.size());
+        writer.write(length - 1, lengthBits);
+        if (method < 0 || length <= method + 1) {
+            writer.writeBit(0);
+            for (int c : coefficients) {
+                writer.writeSigned(c - offset, coefficientBits);
+            }
+            continue;
+        }
+
+        writer.writeBit(1);
+        writer.write(method, 2);
+        for (int j = 0; j <= method; ++j) {
+            writer.writeSigned(coefficients[j] - offset, coefficientBits);
+        }
+        std::vector<int> residuals;
+        double mean = 0;
+        for (int j = method + 1; j < length; ++j) {
+            int x = 0;
+            for (int m = 0; m <= method; ++m) {
+                x += predictionCoefficients[method][m] * coefficients[j - m - 1];
+            }
+            const int prediction = x >= 0 ? -((x + 4) / 8) : (-x + 3) / 8;
+            residuals.push_back(coefficients[j] - prediction);
+            mean += std::abs(residuals.back());
+        }
+        mean /= static_cast<double>(residuals.size());
+        const int k = std::clamp(static_cast<int>(std::log2(mean + 1)), 0, 7);
+        writer.write(k, 3);
+        for (int r : residuals) {
+            writer.writeSignedRice(r, k);
+        }
+    }
+}
+
+/// Encodes one frame of `samplesPerFrame` one bit samples per channel of clustered most-significant-bit-first DSD
+inline std::vector<unsigned char> encodeFrame(const unsigned char *dsd, int channelCount, std::size_t samplesPerFrame,
+                                              const std::vector<std::vector<int>> &filters,
+                                              const FrameOptions &options) {
+    BitWriter writer;
+    if (options.uncompressed) {
+        writer.write(0, 8);
+        auto frame = writer.take();
+        frame.insert(frame.end(), dsd, dsd + ((samplesPerFrame / 8) * channelCount));
+        return frame;
+    }
+
+    const int elements = options.sharedElements ? 1 : channelCount;
+    const auto elementForChannel = [&](int channel) { return options.sharedElements ? 0 : channel; };
+
+    // First pass: compute the predictions and the probability tables
+    std::vector<std::vector<std::int16_t>> predictions(channelCount, std::vector<std::int16_t>(samplesPerFrame));
+    for (int channel = 0; channel < channelCount; ++channel) {
+        const auto &h = filters[elementForChannel(channel)];
+        std::vector<int> history(h.size());
+        // The initial status is alternating ones and zeros, most recent zero
+        for (std::size_t j = 0; j < history.size(); ++j) {
+            history[j] = (j & 1) != 0 ? 1 : -1;
+        }
+        for (std::size_t i = 0; i < samplesPerFrame; ++i) {
+            int sum = 0;
+            for (std::size_t j = 0; j < h.size(); ++j) {
+                sum += h[j] * history[j];
+            }
+            predictions[channel][i] = static_cast<std::int16_t>(sum);
+            const int bit = (dsd[((i >> 3) * channelCount) + channel] >> (7 - (i & 7))) & 1;
+            std::rotate(history.rbegin(), history.rbegin() + 1, history.rend());
+            history[0] = bit ? 1 : -1;
+        }
+    }
+
+    constexpr int probabilityLength = sfb::dst::maximumProbabilityLength;
+    std::vector<std::vector<double>> errors(elements, std::vector<double>(probabilityLength, 0.5));
+    std::vector<std::vector<double>> totals(elements, std::vector<double>(probabilityLength, 1));
+    for (int channel = 0; channel < channelCount; ++channel) {
+        for (std::size_t i = 0; i < samplesPerFrame; ++i) {
+            const int bit = (dsd[((i >> 3) * channelCount) + channel] >> (7 - (i & 7))) & 1;
+            const auto predict = predictions[channel][i];
+            const int predicted = predict < 0 ? 0 : 1;
+            const int index = std::min(std::abs(predict) >> 3, probabilityLength - 1);
+            errors[elementForChannel(channel)][index] += bit != predicted ? 1 : 0;
+            totals[elementForChannel(channel)][index] += 1;
+        }
+    }
+    std::vector<std::vector<int>> probabilities(elements, std::vector<int>(probabilityLength));
+    for (int e = 0; e < elements; ++e) {
+        for (int i = 0; i < probabilityLength; ++i) {
+            probabilities[e][i] = std::clamp(static_cast<int>(std::lround(256 * errors[e][i] / totals[e][i])), 1, 128);
+        }
+    }
+
+    // Header: DST coded, one segment per channel, same mapping for filters and probabilities
+    writer.writeBit(1);
+    writer.write(0b111, 3);
+    writer.writeBit(1);
+    if (options.sharedElements) {
+        writer.writeBit(1);
+    } else {
+        writer.writeBit(0);
+        for (int channel = 1; channel < channelCount; ++channel) {
+            writer.write(channel, 32 - __builtin_clz(static_cast<unsigned>(channel)));
+        }
+    }
+    std::vector<bool> halfProbability(channelCount);
+    for (int channel = 0; channel < channelCount; ++channel) {
+        halfProbability[channel] = options.halfProbability && (channel & 1) != 0;
+        writer.writeBit(halfProbability[channel] ? 1 : 0);
+    }
+
+    writeTable(writer, std::vector<std::vector<int>>(filters.begin(), filters.begin() + elements),
+               sfb::dst::detail::filterPredictionCoefficients, 7, 9, 0, options.filterCodingMethod);
+    writeTable(writer, probabilities, sfb::dst::detail::probabilityPredictionCoefficients, 6, 7, 1,
+               options.probabilityCodingMethod);
+    writer.writeBit(0);
+
+    ArithmeticEncoder encoder{writer};
+    // The reserved bit
+    {
+        const auto c = static_cast<unsigned>(filters[0][0]) & 0x7F;
+        unsigned reversed = 0;
+        for (int bit = 0; bit < 8; ++bit) {
+            reversed |= ((c >> bit) & 1) << (7 - bit);
+        }
+        encoder.encode(0, (reversed >> 1) + 1);
+    }
+    for (std::size_t i = 0; i < samplesPerFrame; ++i) {
+        for (int channel = 0; channel < channelCount; ++channel) {
+            const int element = elementForChannel(channel);
+            const int bit = (dsd[((i >> 3) * channelCount) + channel] >> (7 - (i & 7))) & 1;
+            const auto predict = predictions[channel][i];
+            const unsigned residual = (static_cast<unsigned>(predict >> 15) ^ bit) & 1;
+            unsigned p = 128;
+            if (!halfProbability[channel] || i >= filters[element].size()) {
+                p = probabilities[element][std::min(std::abs(predict) >> 3, probabilityLength - 1)];
+            }
+            encoder.encode(residual, p);
+        }
+    }
+    encoder.flush();
+
+    return writer.take();
+}
+
+/// Returns a prediction filter for each channel of `dsd`, designed from its first frame
+inline std::vector<std::vector<int>> designFilters(const std::vector<unsigned char> &dsd, int channelCount,
+                                                   std::size_t samplesPerFrame, int length) {
+    std::vector<std::vector<int>> filters;
+    for (int channel = 0; channel < channelCount; ++channel) {
+        filters.push_back(designFilter(dsd.data(), channelCount, channel, samplesPerFrame, length));
+    }
+    return filters;
+}
+
+/// Encodes `dsd` as a sequence of DST frames
+inline std::vector<std::vector<unsigned char>> encodeStream(const std::vector<unsigned char> &dsd, int channelCount,
+                                                            std::size_t samplesPerFrame, const FrameOptions &options) {
+    const auto filters = designFilters(dsd, channelCount, samplesPerFrame, options.filterLength);
+    const std::size_t frameSize = (samplesPerFrame / 8) * channelCount;
+    std::vector<std::vector<unsigned char>> frames;
+    for (std::size_t offset = 0; offset + frameSize <= dsd.size(); offset += frameSize) {
+        frames.push_back(encodeFrame(dsd.data() + offset, channelCount, samplesPerFrame, filters, options));
+    }
+    return frames;
+}
+
+} /* namespace dst_test */
@@ -0,0 +1,211 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Checks for the FLAC frame scanning used to split streams into ranges of frames for parallel decoding.
+//
+// The frame scanner is plain C++ so this builds anywhere, including Linux, as part of Tests/CMakeLists.txt.
+//
+// Every frame of streams written by the test encoder with each block size and sample rate coding, fixed and variable
+// block sizes and 36-bit sample numbers must be found by scanning with the correct first sample. Corrupt, reserved
+// and inconsistent headers must be rejected, and ranges must tile the stream at frame boundaries within the limits.
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "FLACFrameScanner.hpp"
+#include "flac_encoder.h"
+#include "test_harness.h"
+
+namespace {
+
+using sfb_test::check;
+
+/// Returns a stream of `channels` channels of `length` samples
+flac_test::Stream makeStream(int channels, std::size_t length, std::uint32_t bitsPerSample, std::uint32_t sampleRate,
+                             const flac_test::StreamOptions &options) {
+    sfb::flac::StreamParameters parameters;
+    parameters.sampleRate = sampleRate;
+    parameters.bitsPerSample = bitsPerSample;
+    return flac_test::encodeStream(
+            flac_test::makeSignal(channels, length, static_cast<int>(bitsPerSample), sampleRate), parameters,
+            options);
+}
+
+/// Checks that every frame of `stream` parses and is found by scanning
+void checkFrames(const flac_test::Stream &stream, std::uint32_t blocksize, const char *name) {
+    const auto *data = stream.data.data();
+    const auto size = stream.data.size();
+
+    bool parsed = true;
+    for (std::size_t i = 0; i < stream.frameOffsets.size(); ++i) {
+        const auto header = sfb::flac::parseFrameHeader(data + stream.frameOffsets[i], size - stream.frameOffsets[i]);
+        const auto expectedBlocksize =
+                i + 1 < stream.frameOffsets.size()
+                        ? blocksize
+                        : static_cast<std::uint32_t>(stream.parameters.totalSamples - stream.frameSamples[i]);
+        parsed = parsed && header && header->channels == stream.parameters.channels &&
+                 header->blocksize == expectedBlocksize &&
+                 sfb::flac::firstSample(*header, stream.parameters) == stream.frameSamples[i] &&
+                 sfb::flac::isConsistent(*header, stream.parameters);
+    }
+    std::printf("      %s: %zu frames, %zu bytes\n", name, stream.frameOffsets.size(), size);
+    check(parsed, "frame headers parse with the written fields");
+
+    std::vector<std::size_t> found;
+    sfb::flac::FrameHeader header;
+    for (std::size_t offset = 0;;) {
+        const auto frame = offset + sfb::flac::findFrame(data + offset, size - offset, stream.parameters, header);
+        if (frame == size) {
+            break;
+        }
+        found.push_back(frame);
+        offset = frame + 1;
+    }
+    check(found == stream.frameOffsets, "scanning finds every frame and nothing else");
+}
+
+/// Checks that ranges found by `findRangeEnd()` tile `stream` at frame boundaries
+void checkRanges(const flac_test::Stream &stream, std::size_t targetSize, std::uint64_t maximumSamples,
+                 const char *description) {
+    const auto *data = stream.data.data();
+    const auto size = stream.data.size();
+
+    bool tiled = true;
+    std::size_t ranges = 0;
+    std::size_t offset = stream.frameOffsets.front();
+    std::uint64_t sample = stream.frameSamples.front();
+    while (tiled && offset < size) {
+        sfb::flac::FrameHeader header;
+        auto end = offset + sfb::flac::findRangeEnd(data + offset, size - offset, stream.parameters, sample,
+                                                    targetSize, maximumSamples, header);
+        // The last range runs to the end of the stream
+        const auto next = end == size ? stream.parameters.totalSamples
+                                      : sfb::flac::firstSample(header, stream.parameters);
+        if (end == size && stream.parameters.totalSamples - sample > maximumSamples) {
+            tiled = false;
+            break;
+        }
+
+        const auto frame = std::lower_bound(stream.frameOffsets.begin(), stream.frameOffsets.end(), end);
+        const auto index = static_cast<std::size_t>(frame - stream.frameOffsets.begin());
+        tiled = next > sample && next - sample <= maximumSamples &&
+                (end == size || (frame != stream.frameOffsets.end() && *frame == end &&
+                                 stream.frameSamples[index] == next));
+        // A range ends at the first frame past the target unless limited by samples
+        if (tiled && end != size && end - offset < targetSize) {
+            tiled = index + 1 == stream.frameOffsets.size() ||
+                    stream.frameSamples[index + 1] - sample > maximumSamples;
+        }
+
+        offset = end;
+        sample = next;
+        ++ranges;
+    }
+    tiled = tiled && sample == stream.parameters.totalSamples;
+    std::printf("      %zu ranges\n", ranges);
+    check(tiled, description);
+}
+
+} /* namespace */
+
+int main() {
+    {
+        const unsigned char message[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+        check(sfb::flac::crc8(message, sizeof message) == 0xF4, "CRC-8 of \"123456789\" is 0xF4");
+    }
+
+    flac_test::StreamOptions options;
+    const auto stereo = makeStream(2, 44100 * 4, 16, 44100, options);
+    checkFrames(stereo, options.blocksize, "stereo 16-bit 44.1 kHz, 4096 samples");
+
+    options.blocksize = 1152;
+    checkFrames(makeStream(1, 50000, 8, 8000, options), options.blocksize, "mono 8-bit 8 kHz, 1152 samples");
+
+    options.blocksize = 1000;
+    checkFrames(makeStream(3, 50000, 20, 22050, options), options.blocksize,
+                "3 channel 20-bit 22.05 kHz, 1000 samples");
+
+    options.blocksize = 100;
+    options.predict = false;
+    checkFrames(makeStream(2, 20000, 12, 12345, options), options.blocksize, "stereo 12-bit 12345 Hz, 100 samples");
+
+    options.blocksize = 2048;
+    options.predict = true;
+    options.variableBlocksize = true;
+    options.firstSample = 1ull << 34;
+    const auto variable = makeStream(6, 96000 * 2, 24, 96000, options);
+    checkFrames(variable, options.blocksize, "5.1 24-bit 96 kHz, variable numbering from 2^34");
+
+    // Corruption
+    {
+        const auto offset = stereo.frameOffsets[5];
+        const auto header = sfb::flac::parseFrameHeader(stereo.data.data() + offset, stereo.data.size() - offset);
+        bool rejected = header.has_value();
+        for (std::size_t bit = 0; header && bit < header->size * 8; ++bit) {
+            auto frame = std::vector<unsigned char>(stereo.data.begin() + static_cast<std::ptrdiff_t>(offset),
+                                                    stereo.data.begin() + static_cast<std::ptrdiff_t>(offset + 32));
+            frame[bit / 8] ^= static_cast<unsigned char>(0x80 >> (bit % 8));
+            const auto corrupt = sfb::flac::parseFrameHeader(frame.data(), frame.size());
+            rejected = rejected && (!corrupt || !sfb::flac::isConsistent(*corrupt, stereo.parameters));
+        }
+        check(rejected, "every single bit error in a frame header is rejected");
+
+        std::vector<unsigned char> reserved = {0xFF, 0xF8, 0x09, 0x18, 0x00, 0x00};
+        reserved[5] = sfb::flac::crc8(reserved.data(), 5);
+        check(!sfb::flac::parseFrameHeader(reserved.data(), reserved.size()), "reserved block size code is rejected");
+
+        std::vector<unsigned char> mono = {0xFF, 0xF8, 0xC9, 0x08, 0x00, 0x00};
+        mono[5] = sfb::flac::crc8(mono.data(), 5);
+        const auto monoHeader = sfb::flac::parseFrameHeader(mono.data(), mono.size());
+        check(monoHeader && monoHeader->channels == 1 && !sfb::flac::isConsistent(*monoHeader, stereo.parameters),
+              "valid header with a different channel count is inconsistent");
+
+        check(!sfb::flac::parseFrameHeader(stereo.data.data() + offset, 5), "truncated frame header is rejected");
+    }
+
+    {
+        std::mt19937 generator{42};
+        std::vector<unsigned char> noise(1 << 20);
+        for (auto &byte : noise) {
+            byte = static_cast<unsigned char>(generator());
+        }
+        std::size_t falseSyncs = 0;
+        sfb::flac::FrameHeader header;
+        for (std::size_t offset = 0; offset < noise.size();) {
+            offset += sfb::flac::findFrame(noise.data() + offset, noise.size() - offset, stereo.parameters, header);
+            if (offset < noise.size()) {
+                ++falseSyncs;
+                ++offset;
+            }
+        }
+        std::printf("      %zu false frame syncs in 1 MiB of noise\n", falseSyncs);
+        check(falseSyncs == 0, "no frames are found in noise");
+    }
+
+    {
+        const auto header = sfb::flac::makeStreamHeader(variable.parameters);
+        const auto *info = header.data() + 8;
+        const std::uint64_t packed = (std::uint64_t{info[10]} << 56) | (std::uint64_t{info[11]} << 48) |
+                                     (std::uint64_t{info[12]} << 40) | (std::uint64_t{info[13]} << 32) |
+                                     (std::uint64_t{info[14]} << 24) | (std::uint64_t{info[15]} << 16) |
+                                     (std::uint64_t{info[16]} << 8) | std::uint64_t{info[17]};
+        check(std::equal(header.begin(), header.begin() + 4, "fLaC") && header[4] == 0x80 && header[7] == 34 &&
+                      ((info[0] << 8) | info[1]) == 2048 && ((info[2] << 8) | info[3]) == 2048 &&
+                      (packed >> 44) == 96000 && ((packed >> 41) & 7) == 5 && ((packed >> 36) & 31) == 23 &&
+                      (packed & 0xFFFFFFFFFull) == variable.parameters.totalSamples,
+              "STREAMINFO fields round trip");
+    }
+
+    checkRanges(stereo, 64 * 1024, 1 << 20, "ranges of 64 KiB tile the stream");
+    checkRanges(stereo, 1, 1 << 20, "ranges with a one byte target hold one frame");
+    checkRanges(stereo, 256 * 1024, 3 * 4096, "ranges limited to three frames tile the stream");
+    checkRanges(variable, 100 * 1024, 8 * 2048, "ranges of a variable block size stream tile the stream");
+
+    return sfb_test::summarize();
+}
@@ -0,0 +1,121 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Throughput benchmark for sfb::FLACFramePipeline against sequential decoding.
+//
+// The pipeline decodes with libFLAC, so Tests/CMakeLists.txt builds this only if libFLAC is installed.
+//
+// Stereo 16-bit and 5.1 24-bit streams are written by the test encoder and decoded by a single stream decoder, as
+// SFBFLACDecoder does by default, and through the pipeline with increasing numbers of worker threads using ranges
+// found by scanning as SFBFLACDecoder does when decoding a stream without a seek table in parallel. The pipeline
+// output must match the sequential output. Results are reported as multiples of real time.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "FLACFramePipeline.hpp"
+#include "FLACFrameScanner.hpp"
+#include "flac_encoder.h"
+#include "test_harness.h"
+
+namespace {
+
+constexpr double kDurationSeconds = 30;
+constexpr int kPasses = 3;
+constexpr std::size_t kRangeSize = 256 * 1024;
+constexpr std::uint64_t kMaximumRangeSamples = 128 * 1024;
+
+void report(const char *name, double seconds, double elapsed) {
+    std::printf("%-36s %8.1fx real time\n", name, seconds / elapsed);
+}
+
+void runBenchmark(int channels, std::uint32_t bitsPerSample, std::uint32_t sampleRate) {
+    sfb::flac::StreamParameters parameters;
+    parameters.sampleRate = sampleRate;
+    parameters.bitsPerSample = bitsPerSample;
+    const auto length = static_cast<std::size_t>(kDurationSeconds * sampleRate);
+    const auto stream = flac_test::encodeStream(
+            flac_test::makeSignal(channels, length, static_cast<int>(bitsPerSample), sampleRate), parameters);
+
+    std::printf("%d ch %u-bit %g kHz, %zu frames, compression ratio %.2f\n", channels, bitsPerSample,
+                sampleRate / 1000.0, stream.frameOffsets.size(),
+                static_cast<double>(length * channels * bitsPerSample / 8) / static_cast<double>(stream.data.size()));
+
+    const double seconds = kPasses * kDurationSeconds;
+    const auto *frames = stream.data.data() + stream.frameOffsets.front();
+    const auto size = stream.data.size() - stream.frameOffsets.front();
+
+    std::vector<std::vector<uint32_t>> sequential;
+    {
+        sfb::FLACRangeDecoder decoder{stream.parameters};
+        const auto start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < kPasses; ++pass) {
+            if (decoder.decode(frames, size, 0, stream.parameters.totalSamples, sequential) !=
+                sfb::FLACRangeDecoder::Status::success) {
+                sfb_test::fail("sequential decoding");
+                return;
+            }
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        report("  sequential", seconds, elapsed.count());
+    }
+
+    const int maximumThreads = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+    for (int threadCount = 1; threadCount <= std::min(maximumThreads, 8); threadCount *= 2) {
+        sfb::FLACFramePipeline pipeline{stream.parameters, threadCount, (2 * threadCount) + 1};
+        bool identical = true;
+        const auto start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < kPasses; ++pass) {
+            std::size_t offset = 0;
+            std::uint64_t sample = 0;
+            std::uint64_t delivered = 0;
+            while (delivered < stream.parameters.totalSamples) {
+                while (offset < size && pipeline.canSubmit()) {
+                    sfb::flac::FrameHeader header;
+                    const auto rangeSize = sfb::flac::findRangeEnd(frames + offset, size - offset, stream.parameters,
+                                                                   sample, kRangeSize, kMaximumRangeSamples, header);
+                    const auto next = offset + rangeSize == size ? stream.parameters.totalSamples
+                                                                 : sfb::flac::firstSample(header, stream.parameters);
+                    std::copy_n(frames + offset, rangeSize, pipeline.prepare(rangeSize));
+                    pipeline.submit(rangeSize, sample, next);
+                    offset += rangeSize;
+                    sample = next;
+                }
+
+                const auto &range = pipeline.wait();
+                identical = identical && range.status == sfb::FLACRangeDecoder::Status::success;
+                const auto first = range.startSample;
+                const auto count = range.frameLength();
+                for (int channel = 0; identical && channel < channels; ++channel) {
+                    const auto *samples = range.samples[channel].data();
+                    identical = std::equal(samples, samples + count,
+                                           sequential[channel].begin() + static_cast<std::ptrdiff_t>(first));
+                }
+                delivered += count;
+                pipeline.pop();
+            }
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        char name[64];
+        std::snprintf(name, sizeof name, "  pipeline, %d thread%s", threadCount, threadCount == 1 ? "" : "s");
+        report(name, seconds, elapsed.count());
+        if (!identical) {
+            sfb_test::fail("pipeline output differs from sequential output");
+        }
+    }
+}
+
+} /* namespace */
+
+int main() {
+    runBenchmark(2, 16, 44100);
+    runBenchmark(6, 24, 96000);
+    return sfb_test::exitStatus();
+}
@@ -0,0 +1,270 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// A minimal FLAC encoder writing verbatim or second order fixed predictor subframes, used to generate test streams
+// for the FLAC frame scanning checks and the parallel decoding benchmark.
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "FLACFrameScanner.hpp"
+
+namespace flac_test {
+
+/// A most-significant-bit-first bit writer
+class BitWriter {
+  public:
+    void write(std::uint64_t value, int count) {
+        for (int i = count - 1; i >= 0; --i) {
+            writeBit((value >> i) & 1);
+        }
+    }
+
+    void writeBit(unsigned bit) {
+        if ((bits_ & 7) == 0) {
+            data_.push_back(0);
+        }
+        if (bit) {
+            data_.back() |= static_cast<unsigned char>(0x80 >> (bits_ & 7));
+        }
+        ++bits_;
+    }
+
+    void writeSigned(std::int32_t value, int count) {
+        write(static_cast<std::uint64_t>(static_cast<std::uint32_t>(value)) & ((1ull << count) - 1), count);
+    }
+
+    /// Writes `value` as a zigzag Rice code with parameter `k`
+    void writeRice(std::int32_t value, int k) {
+        const auto folded = value < 0 ? (static_cast<std::uint32_t>(-(value + 1)) << 1) | 1
+                                      : static_cast<std::uint32_t>(value) << 1;
+        for (std::uint32_t i = 0; i < (folded >> k); ++i) {
+            writeBit(0);
+        }
+        writeBit(1);
+        write(folded & ((1u << k) - 1), k);
+    }
+
+    void alignToByte() {
+        bits_ = (bits_ + 7) & ~std::size_t{7};
+    }
+
+    const std::vector<unsigned char> &data() const noexcept { return data_; }
+
+  private:
+    std::vector<unsigned char> data_;
+    std::size_t bits_{0};
+};
+
+/// Returns the CRC-16 of `size` bytes at `data` for the polynomial x^16 + x^15 + x^2 + x^0
+inline std::uint16_t crc16(const unsigned char *data, std::size_t size) {
+    unsigned crc = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        crc ^= static_cast<unsigned>(data[i]) << 8;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x8005) : (crc << 1);
+        }
+    }
+    return static_cast<std::uint16_t>(crc);
+}
+
+/// Options for generated streams
+struct StreamOptions {
+    /// The number of samples per channel in each frame except the last
+    std::uint32_t blocksize{4096};
+    /// Whether frames are numbered by sample as in variable block size streams
+    bool variableBlocksize{false};
+    /// Whether subframes use the second order fixed predictor instead of verbatim samples
+    bool predict{true};
+    /// The sample number of the first frame in variable block size streams
+    std::uint64_t firstSample{0};
+};
+
+/// A generated stream
+struct Stream {
+    /// The stream parameters
+    sfb::flac::StreamParameters parameters;
+    /// The stream marker, STREAMINFO and frames
+    std::vector<unsigned char> data;
+    /// The offset of each frame in `data`
+    std::vector<std::size_t> frameOffsets;
+    /// The first sample of each frame
+    std::vector<std::uint64_t> frameSamples;
+};
+
+/// Writes a frame header for `blocksize` samples of `parameters` numbered `number`
+inline void writeFrameHeader(BitWriter &writer, const sfb::flac::StreamParameters &parameters, bool variableBlocksize,
+                             std::uint64_t number, std::uint32_t blocksize) {
+    BitWriter header;
+    header.write(0x3FFE, 14);
+    header.write(0, 1);
+    header.write(variableBlocksize ? 1 : 0, 1);
+
+    int blocksizeCode;
+    if (blocksize == 192) {
+        blocksizeCode = 1;
+    } else if (blocksize >= 576 && blocksize <= 4608 && blocksize % 576 == 0 &&
+               std::has_single_bit(blocksize / 576)) {
+        blocksizeCode = 2 + std::countr_zero(blocksize / 576);
+    } else if (blocksize >= 256 && blocksize <= 32768 && std::has_single_bit(blocksize)) {
+        blocksizeCode = 8 + std::countr_zero(blocksize / 256);
+    } else {
+        blocksizeCode = blocksize <= 256 ? 6 : 7;
+    }
+    header.write(static_cast<unsigned>(blocksizeCode), 4);
+
+    int sampleRateCode;
+    if (parameters.sampleRate == 44100) {
+        sampleRateCode = 9;
+    } else if (parameters.sampleRate == 48000) {
+        sampleRateCode = 10;
+    } else if (parameters.sampleRate <= 65535) {
+        sampleRateCode = 13;
+    } else {
+        sampleRateCode = 12;
+    }
+    header.write(static_cast<unsigned>(sampleRateCode), 4);
+
+    header.write(parameters.channels - 1, 4);
+    constexpr int sampleSizeCodes[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 2, 0, 0, 0, 4,
+                                       0, 0, 0, 5, 0, 0, 0, 6, 0, 0, 0, 0, 0, 0, 0, 7};
+    header.write(static_cast<unsigned>(sampleSizeCodes[parameters.bitsPerSample]), 3);
+    header.write(0, 1);
+
+    // UTF-8 coded number
+    if (number < 0x80) {
+        header.write(number, 8);
+    } else {
+        int continuationBytes = 1;
+        while (number >= (1ull << (5 * continuationBytes + 6))) {
+            ++continuationBytes;
+        }
+        const auto lead = continuationBytes == 6 ? 0xFEu : ((0xFF00u >> (continuationBytes + 1)) & 0xFF);
+        header.write(lead | static_cast<unsigned>(number >> (6 * continuationBytes)), 8);
+        for (int i = continuationBytes - 1; i >= 0; --i) {
+            header.write(0x80 | ((number >> (6 * i)) & 0x3F), 8);
+        }
+    }
+
+    if (blocksizeCode == 6) {
+        header.write(blocksize - 1, 8);
+    } else if (blocksizeCode == 7) {
+        header.write(blocksize - 1, 16);
+    }
+    if (sampleRateCode == 13) {
+        header.write(parameters.sampleRate, 16);
+    } else if (sampleRateCode == 12) {
+        header.write(parameters.sampleRate / 1000, 8);
+    }
+
+    const auto &bytes = header.data();
+    for (auto byte : bytes) {
+        writer.write(byte, 8);
+    }
+    writer.write(sfb::flac::crc8(bytes.data(), bytes.size()), 8);
+}
+
+/// Writes a subframe of `count` samples
+inline void writeSubframe(BitWriter &writer, const std::int32_t *samples, std::uint32_t count, int bitsPerSample,
+                          bool predict) {
+    if (!predict || count < 3) {
+        writer.write(0x02, 8);
+        for (std::uint32_t i = 0; i < count; ++i) {
+            writer.writeSigned(samples[i], bitsPerSample);
+        }
+        return;
+    }
+
+    // Second order fixed predictor with a single Rice partition
+    writer.write(0x14, 8);
+    writer.writeSigned(samples[0], bitsPerSample);
+    writer.writeSigned(samples[1], bitsPerSample);
+
+    std::vector<std::int32_t> residuals(count - 2);
+    std::uint64_t sum = 0;
+    for (std::uint32_t i = 2; i < count; ++i) {
+        residuals[i - 2] = samples[i] - (2 * samples[i - 1] - samples[i - 2]);
+        sum += static_cast<std::uint64_t>(std::abs(residuals[i - 2]));
+    }
+    const auto mean = sum / residuals.size();
+    const auto k = std::min(mean > 0 ? static_cast<int>(std::bit_width(mean)) - 1 : 0, 14);
+
+    writer.write(0, 2);
+    writer.write(0, 4);
+    writer.write(static_cast<unsigned>(k), 4);
+    for (auto residual : residuals) {
+        writer.writeRice(residual, k);
+    }
+}
+
+/// Encodes `samples`, one vector per channel, as a FLAC stream of `parameters`
+inline Stream encodeStream(const std::vector<std::vector<std::int32_t>> &samples,
+                           sfb::flac::StreamParameters parameters, const StreamOptions &options = {}) {
+    parameters.channels = static_cast<std::uint32_t>(samples.size());
+    parameters.minBlocksize = options.blocksize;
+    parameters.maxBlocksize = options.blocksize;
+    parameters.totalSamples = options.firstSample + samples.front().size();
+
+    Stream stream;
+    stream.parameters = parameters;
+    const auto header = sfb::flac::makeStreamHeader(parameters);
+    stream.data.assign(header.begin(), header.end());
+
+    const auto length = samples.front().size();
+    std::uint64_t frameNumber = 0;
+    for (std::size_t start = 0; start < length; start += options.blocksize, ++frameNumber) {
+        const auto blocksize = static_cast<std::uint32_t>(std::min<std::size_t>(options.blocksize, length - start));
+        const auto firstSample = options.firstSample + start;
+
+        BitWriter writer;
+        writeFrameHeader(writer, parameters, options.variableBlocksize,
+                         options.variableBlocksize ? firstSample : frameNumber, blocksize);
+        for (const auto &channel : samples) {
+            writeSubframe(writer, channel.data() + start, blocksize, static_cast<int>(parameters.bitsPerSample),
+                          options.predict);
+        }
+        writer.alignToByte();
+        auto frame = writer.data();
+        const auto crc = crc16(frame.data(), frame.size());
+        frame.push_back(static_cast<unsigned char>(crc >> 8));
+        frame.push_back(static_cast<unsigned char>(crc));
+
+        stream.frameOffsets.push_back(stream.data.size());
+        stream.frameSamples.push_back(firstSample);
+        stream.data.insert(stream.data.end(), frame.begin(), frame.end());
+    }
+
+    return stream;
+}
+
+/// Returns `channels` channels of `length` samples of a sine sweep with a little noise at `bitsPerSample` bits
+inline std::vector<std::vector<std::int32_t>> makeSignal(int channels, std::size_t length, int bitsPerSample,
+                                                         std::uint32_t sampleRate) {
+    std::vector<std::vector<std::int32_t>> samples(static_cast<std::size_t>(channels),
+                                                   std::vector<std::int32_t>(length));
+    const double amplitude = 0.5 * static_cast<double>((1 << (bitsPerSample - 1)) - 1);
+    std::uint32_t seed = 1;
+    for (int channel = 0; channel < channels; ++channel) {
+        double phase = 0;
+        for (std::size_t i = 0; i < length; ++i) {
+            const double frequency = 220.0 * (1 + channel) + (4000.0 * static_cast<double>(i) / length);
+            phase += 2 * M_PI * frequency / sampleRate;
+            seed = (seed * 1664525) + 1013904223;
+            const auto noise = static_cast<std::int32_t>(seed >> 28) - 8;
+            samples[channel][i] = static_cast<std::int32_t>(amplitude * std::sin(phase)) + noise;
+        }
+    }
+    return samples;
+}
+
+} /* namespace flac_test */
@@ -0,0 +1,222 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Checks for sfb::FrameStage, the read cursor block-based decoders use to deliver decoded frames.
+//
+// The stage is plain C++ so this builds anywhere, including Linux, as part of Tests/CMakeLists.txt.
+//
+// Staged frames must be read in order across reads of any length, into planar and interleaved buffers at any offset,
+// and skipped frames must not be read. Streams of blocks delivered as the decoders deliver them, directly into the
+// output when a block fits and staged otherwise, must reproduce the stream with every frame copied at most once.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "FrameStage.hpp"
+#include "test_harness.h"
+
+namespace {
+
+using sfb_test::check;
+
+/// Returns the sample of `channel` at `frame`
+int32_t sampleAt(std::size_t channel, std::size_t frame) noexcept {
+    return static_cast<int32_t>((frame * 8) + channel);
+}
+
+/// Counts of frames delivered by `deliverStream`
+struct Delivery {
+    /// Frames decoded directly into the output
+    std::size_t direct_{0};
+    /// Frames copied from the stage
+    std::size_t staged_{0};
+};
+
+/// Delivers `frameLength` frames of `channels` planar channels decoded in blocks of `blockSize` frames to `output`,
+/// reading between `minimumRead` and `maximumRead` frames at a time
+Delivery deliverStream(std::size_t channels, std::size_t frameLength, std::size_t blockSize, std::size_t minimumRead,
+                       std::size_t maximumRead, std::vector<std::vector<int32_t>> &output) {
+    std::mt19937 generator{static_cast<std::mt19937::result_type>(blockSize + maximumRead)};
+    std::uniform_int_distribution<std::size_t> readLengths{minimumRead, maximumRead};
+
+    std::vector<std::vector<int32_t>> storage(channels, std::vector<int32_t>(blockSize));
+    std::vector<std::vector<int32_t>> readBuffer(channels, std::vector<int32_t>(maximumRead));
+    output.assign(channels, {});
+
+    sfb::FrameStage stage;
+    Delivery delivery;
+    std::size_t decoded = 0;
+
+    // Decodes the next block into `buffers` at `offset` and returns its length
+    const auto decodeBlock = [&](std::vector<std::vector<int32_t>> &buffers, std::size_t offset) {
+        const auto blockFrameLength = std::min(blockSize, frameLength - decoded);
+        for (std::size_t channel = 0; channel < channels; ++channel) {
+            for (std::size_t frame = 0; frame < blockFrameLength; ++frame) {
+                buffers[channel][offset + frame] = sampleAt(channel, decoded + frame);
+            }
+        }
+        decoded += blockFrameLength;
+        return blockFrameLength;
+    };
+
+    for (;;) {
+        const auto readLength = readLengths(generator);
+        std::size_t framesRead = 0;
+        void *destinations[sfb::FrameStage::maximumBufferCount];
+        for (std::size_t channel = 0; channel < channels; ++channel) {
+            destinations[channel] = readBuffer[channel].data();
+        }
+
+        for (;;) {
+            const auto framesCopied = stage.read(destinations, framesRead, readLength - framesRead);
+            delivery.staged_ += framesCopied;
+            framesRead += framesCopied;
+            if (framesRead == readLength || decoded == frameLength) {
+                break;
+            }
+
+            const auto blockFrameLength = std::min(blockSize, frameLength - decoded);
+            if (stage.canDeliverDirectly(blockFrameLength, readLength - framesRead)) {
+                framesRead += decodeBlock(readBuffer, framesRead);
+                delivery.direct_ += blockFrameLength;
+            } else {
+                decodeBlock(storage, 0);
+                const void *buffers[sfb::FrameStage::maximumBufferCount];
+                for (std::size_t channel = 0; channel < channels; ++channel) {
+                    buffers[channel] = storage[channel].data();
+                }
+                stage.stage(buffers, channels, sizeof(int32_t), blockFrameLength);
+            }
+        }
+
+        if (framesRead == 0) {
+            return delivery;
+        }
+        for (std::size_t channel = 0; channel < channels; ++channel) {
+            output[channel].insert(output[channel].end(), readBuffer[channel].begin(),
+                                   readBuffer[channel].begin() + static_cast<std::ptrdiff_t>(framesRead));
+        }
+    }
+}
+
+/// Returns true if `output` holds `frameLength` frames of `channels` channels in order
+bool holdsStream(const std::vector<std::vector<int32_t>> &output, std::size_t channels, std::size_t frameLength) {
+    if (output.size() != channels) {
+        return false;
+    }
+    for (std::size_t channel = 0; channel < channels; ++channel) {
+        if (output[channel].size() != frameLength) {
+            return false;
+        }
+        for (std::size_t frame = 0; frame < frameLength; ++frame) {
+            if (output[channel][frame] != sampleAt(channel, frame)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} /* namespace */
+
+int main() {
+    {
+        sfb::FrameStage stage;
+        check(stage.empty() && stage.frameLength() == 0, "new stage is empty");
+        check(stage.canDeliverDirectly(4096, 4096) && !stage.canDeliverDirectly(4097, 4096),
+              "empty stage delivers blocks directly only when they fit");
+
+        // Interleaved stereo float frames
+        std::vector<float> block(2 * 100);
+        for (std::size_t i = 0; i < block.size(); ++i) {
+            block[i] = static_cast<float>(i);
+        }
+        const void *buffers[] = {block.data()};
+        stage.stage(buffers, 1, 2 * sizeof(float), 100);
+        check(stage.frameLength() == 100 && !stage.canDeliverDirectly(1, 4096),
+              "stage holding frames does not deliver blocks directly");
+
+        std::vector<float> output(2 * 200, -1.0f);
+        void *destinations[] = {output.data()};
+        const auto first = stage.read(destinations, 10, 30);
+        const auto second = stage.read(destinations, 40, 200);
+        bool inOrder = first == 30 && second == 70 && stage.empty();
+        for (std::size_t i = 0; i < 2 * 100; ++i) {
+            inOrder = inOrder && output[(2 * 10) + i] == static_cast<float>(i);
+        }
+        check(inOrder, "interleaved frames are read in order at the requested offsets");
+        check(output[(2 * 10) - 1] == -1.0f && output[2 * 110] == -1.0f, "frames outside the reads are untouched");
+        check(stage.read(destinations, 0, 10) == 0, "empty stage reads no frames");
+    }
+
+    {
+        sfb::FrameStage stage;
+        std::vector<std::vector<int32_t>> planes(6, std::vector<int32_t>(50));
+        const void *buffers[6];
+        for (std::size_t channel = 0; channel < 6; ++channel) {
+            for (std::size_t frame = 0; frame < 50; ++frame) {
+                planes[channel][frame] = sampleAt(channel, frame);
+            }
+            buffers[channel] = planes[channel].data();
+        }
+        stage.stage(buffers, 6, sizeof(int32_t), 50);
+
+        check(stage.skip(20) == 20 && stage.frameLength() == 30, "frames are skipped");
+
+        std::vector<std::vector<int32_t>> output(6, std::vector<int32_t>(30));
+        void *destinations[6];
+        for (std::size_t channel = 0; channel < 6; ++channel) {
+            destinations[channel] = output[channel].data();
+        }
+        bool afterSkip = stage.read(destinations, 0, 30) == 30;
+        for (std::size_t channel = 0; channel < 6; ++channel) {
+            for (std::size_t frame = 0; frame < 30; ++frame) {
+                afterSkip = afterSkip && output[channel][frame] == sampleAt(channel, frame + 20);
+            }
+        }
+        check(afterSkip, "planar frames following skipped frames are read from every plane");
+        check(stage.skip(10) == 0, "empty stage skips no frames");
+
+        stage.stage(buffers, 6, sizeof(int32_t), 50);
+        stage.read(destinations, 0, 5);
+        stage.stage(buffers, 6, sizeof(int32_t), 40);
+        check(stage.frameLength() == 40, "staging a block discards frames remaining from the previous block");
+        stage.clear();
+        check(stage.empty() && stage.read(destinations, 0, 10) == 0, "cleared stage reads no frames");
+    }
+
+    {
+        constexpr std::size_t frameLength = 1000003;
+        std::vector<std::vector<int32_t>> output;
+
+        auto delivery = deliverStream(2, frameLength, 4096, 1, 8192, output);
+        check(holdsStream(output, 2, frameLength) && delivery.direct_ + delivery.staged_ == frameLength,
+              "blocks read in random lengths are delivered in order, each frame once");
+
+        delivery = deliverStream(2, frameLength, 1152, 4096, 8192, output);
+        check(holdsStream(output, 2, frameLength) && delivery.direct_ + delivery.staged_ == frameLength,
+              "blocks smaller than reads are delivered in order, each frame once");
+        check(delivery.direct_ > 3 * delivery.staged_, "most frames are decoded directly when reads exceed blocks");
+
+        delivery = deliverStream(2, frameLength, 4608, 256, 512, output);
+        check(holdsStream(output, 2, frameLength) && delivery.direct_ == 0 && delivery.staged_ == frameLength,
+              "blocks larger than reads are staged and delivered in order, each frame once");
+
+        delivery = deliverStream(8, frameLength, 1152, 1152, 1152, output);
+        check(holdsStream(output, 8, frameLength) && delivery.staged_ == 0,
+              "eight channel blocks the length of reads are all decoded directly");
+
+        delivery = deliverStream(1, 100, 4096, 4096, 4096, output);
+        check(holdsStream(output, 1, 100), "stream shorter than a block is delivered");
+    }
+
+    return sfb_test::summarize();
+}
@@ -0,0 +1,208 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Benchmark for delivering decoded blocks through sfb::FrameStage against the staging buffer it replaced.
+//
+// The stage is plain C++ so this builds anywhere, including Linux, as part of Tests/CMakeLists.txt.
+//
+// One hour of 44.1 kHz audio is decoded in blocks and read in fixed lengths. Formerly every block was decoded into a
+// staging buffer, copied to the output, and the frames remaining were moved to the start of the staging buffer after
+// each read, as `-[AVAudioPCMBuffer trimAtOffset:frameLength:]` does. Now blocks fitting in a read are decoded directly
+// into the output and others are staged and read by advancing a cursor. Decoding a block is modeled by converting
+// samples from a block owned by the codec, a cost both approaches share. Both must deliver the same samples.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "FrameStage.hpp"
+#include "test_harness.h"
+
+namespace {
+
+constexpr std::size_t kFrameLength = 3600 * 44100;
+constexpr int kPasses = 3;
+
+/// A stream of planar 32-bit blocks
+///
+/// Each block is decoded by converting samples from a block owned by the codec, as libFLAC's output is shifted to
+/// high alignment.
+class Stream final {
+  public:
+    Stream(std::size_t channels, std::size_t blockSize) : source_(channels, std::vector<int32_t>(blockSize)) {
+        for (std::size_t channel = 0; channel < channels; ++channel) {
+            for (std::size_t frame = 0; frame < blockSize; ++frame) {
+                source_[channel][frame] = static_cast<int32_t>((frame * channels) + channel);
+            }
+        }
+    }
+
+    /// Returns the length of the next block
+    [[nodiscard]] std::size_t blockFrameLength() const noexcept {
+        return std::min(source_.front().size(), kFrameLength - decoded_);
+    }
+
+    /// Returns true if every block was decoded
+    [[nodiscard]] bool atEnd() const noexcept { return decoded_ == kFrameLength; }
+
+    /// Decodes the next block to `buffers` at frame `offset` and returns its length
+    std::size_t decode(int32_t *const *buffers, std::size_t offset) noexcept {
+        const auto frameLength = blockFrameLength();
+        for (std::size_t channel = 0; channel < source_.size(); ++channel) {
+            const auto *src = source_[channel].data();
+            auto *dst = buffers[channel] + offset;
+            for (std::size_t frame = 0; frame < frameLength; ++frame) {
+                dst[frame] = static_cast<int32_t>(static_cast<uint32_t>(src[frame]) << 8);
+            }
+        }
+        decoded_ += frameLength;
+        return frameLength;
+    }
+
+  private:
+    /// The block owned by the codec
+    std::vector<std::vector<int32_t>> source_;
+    /// The number of frames decoded
+    std::size_t decoded_{0};
+};
+
+/// Returns a checksum of the first `frameLength` frames in `buffers`
+uint64_t checksum(int32_t *const *buffers, std::size_t channels, std::size_t frameLength) noexcept {
+    uint64_t sum = 0;
+    for (std::size_t channel = 0; channel < channels; ++channel) {
+        for (std::size_t frame = 0; frame < frameLength; ++frame) {
+            sum = (sum * 31) + static_cast<uint32_t>(buffers[channel][frame]);
+        }
+    }
+    return sum;
+}
+
+/// Delivers the stream through a staging buffer trimmed after each read and returns a checksum of the reads, or of
+/// the last sample of each read if `Verify` is `false`
+template <bool Verify>
+uint64_t deliverTrimming(std::size_t channels, std::size_t blockSize, std::size_t readLength) {
+    std::vector<std::vector<int32_t>> staging(channels, std::vector<int32_t>(blockSize));
+    std::vector<std::vector<int32_t>> output(channels, std::vector<int32_t>(readLength));
+    std::vector<int32_t *> stagingBuffers(channels);
+    std::vector<int32_t *> outputBuffers(channels);
+    for (std::size_t channel = 0; channel < channels; ++channel) {
+        stagingBuffers[channel] = staging[channel].data();
+        outputBuffers[channel] = output[channel].data();
+    }
+
+    Stream stream{channels, blockSize};
+    std::size_t staged = 0;
+    uint64_t sum = 0;
+    for (;;) {
+        std::size_t framesRead = 0;
+        for (;;) {
+            const auto framesCopied = std::min(staged, readLength - framesRead);
+            for (std::size_t channel = 0; channel < channels; ++channel) {
+                std::memcpy(outputBuffers[channel] + framesRead, stagingBuffers[channel],
+                            framesCopied * sizeof(int32_t));
+                std::memmove(stagingBuffers[channel], stagingBuffers[channel] + framesCopied,
+                             (staged - framesCopied) * sizeof(int32_t));
+            }
+            staged -= framesCopied;
+            framesRead += framesCopied;
+            if (framesRead == readLength || stream.atEnd()) {
+                break;
+            }
+            staged = stream.decode(stagingBuffers.data(), 0);
+        }
+        if (framesRead == 0) {
+            return sum;
+        }
+        if constexpr (Verify) {
+            sum += checksum(outputBuffers.data(), channels, framesRead);
+        } else {
+            sum += static_cast<uint32_t>(outputBuffers[channels - 1][framesRead - 1]);
+        }
+    }
+}
+
+/// Delivers the stream directly or through `sfb::FrameStage` and returns a checksum of the reads, or of the last
+/// sample of each read if `Verify` is `false`
+template <bool Verify>
+uint64_t deliverStaging(std::size_t channels, std::size_t blockSize, std::size_t readLength) {
+    std::vector<std::vector<int32_t>> storage(channels, std::vector<int32_t>(blockSize));
+    std::vector<std::vector<int32_t>> output(channels, std::vector<int32_t>(readLength));
+    std::vector<int32_t *> storageBuffers(channels);
+    std::vector<int32_t *> outputBuffers(channels);
+    for (std::size_t channel = 0; channel < channels; ++channel) {
+        storageBuffers[channel] = storage[channel].data();
+        outputBuffers[channel] = output[channel].data();
+    }
+    std::vector<const void *> stagedBuffers(storageBuffers.begin(), storageBuffers.end());
+    std::vector<void *> destinations(outputBuffers.begin(), outputBuffers.end());
+
+    Stream stream{channels, blockSize};
+    sfb::FrameStage stage;
+    uint64_t sum = 0;
+    for (;;) {
+        std::size_t framesRead = 0;
+        for (;;) {
+            framesRead += stage.read(destinations.data(), framesRead, readLength - framesRead);
+            if (framesRead == readLength || stream.atEnd()) {
+                break;
+            }
+            if (stage.canDeliverDirectly(stream.blockFrameLength(), readLength - framesRead)) {
+                framesRead += stream.decode(outputBuffers.data(), framesRead);
+            } else {
+                stage.stage(stagedBuffers.data(), channels, sizeof(int32_t), stream.decode(storageBuffers.data(), 0));
+            }
+        }
+        if (framesRead == 0) {
+            return sum;
+        }
+        if constexpr (Verify) {
+            sum += checksum(outputBuffers.data(), channels, framesRead);
+        } else {
+            sum += static_cast<uint32_t>(outputBuffers[channels - 1][framesRead - 1]);
+        }
+    }
+}
+
+void runBenchmark(std::size_t channels, std::size_t blockSize, std::size_t readLength, const char *name) {
+    std::printf("%s, blocks of %zu frames read %zu frames at a time\n", name, blockSize, readLength);
+
+    uint64_t trimmedSum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < kPasses; ++pass) {
+        trimmedSum += deliverTrimming<false>(channels, blockSize, readLength);
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("  %-24s %12.1f ms\n", "trimmed staging buffer", elapsed.count() / kPasses);
+
+    uint64_t stagedSum = 0;
+    start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < kPasses; ++pass) {
+        stagedSum += deliverStaging<false>(channels, blockSize, readLength);
+    }
+    elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("  %-24s %12.1f ms\n", "frame stage", elapsed.count() / kPasses);
+
+    if (trimmedSum != stagedSum || deliverTrimming<true>(channels, blockSize, readLength) !=
+                                           deliverStaging<true>(channels, blockSize, readLength)) {
+        sfb_test::fail("delivered samples differ");
+    }
+}
+
+} /* namespace */
+
+int main() {
+    runBenchmark(2, 4096, 512, "FLAC stereo");
+    runBenchmark(2, 4096, 4096, "FLAC stereo");
+    runBenchmark(2, 256, 4096, "Shorten stereo");
+    runBenchmark(1, 1152, 4096, "MPEG mono");
+    runBenchmark(6, 4608, 1000, "FLAC 5.1");
+    return sfb_test::exitStatus();
+}
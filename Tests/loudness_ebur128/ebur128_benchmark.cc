@@ -0,0 +1,192 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Throughput benchmark for loudness::EbuR128Analyzer.
+//
+// The loudness sources are plain C++ so this builds anywhere, including
+// Linux, as part of Tests/CMakeLists.txt.
+//
+// Results are reported as multiples of real time. The segmented runs split
+// the signal across one thread per core the way SFBReplayGainAnalyzer splits
+// long tracks, so they show the analysis side of that speedup; decoding
+// scales the same way since each segment has its own decoder. The format runs
+// report throughput in samples per second for each sample format and layout.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "ebur128_analyzer.h"
+#include "test_signals.h"
+
+namespace {
+
+constexpr int32_t kSampleRate = 48000;
+constexpr int64_t kDurationSeconds = 600;
+constexpr int64_t kChunkFrames = 2048;
+
+// Band-limited noise with a slow amplitude envelope, so gating and LRA have
+// something to do.
+std::vector<float> MakeInterleavedSignal(int32_t num_channels,
+                                         int64_t num_frames) {
+  std::mt19937 generator(1770);
+  std::normal_distribution<float> noise(0.0f, 0.1f);
+  std::vector<float> signal(num_frames * num_channels);
+  for (int64_t i = 0; i < num_frames; ++i) {
+    const float envelope = 0.5f + 0.5f * std::sin(i * 2e-5f);
+    for (int32_t c = 0; c < num_channels; ++c) {
+      signal[i * num_channels + c] = envelope * noise(generator);
+    }
+  }
+  return signal;
+}
+
+void ProcessFrames(loudness::EbuR128Analyzer& analyzer,
+                   const std::vector<float>& signal, int32_t num_channels,
+                   int64_t first_frame, int64_t end_frame) {
+  for (int64_t i = first_frame; i < end_frame; i += kChunkFrames) {
+    const int64_t count = std::min(kChunkFrames, end_frame - i);
+    analyzer.Process(signal.data() + i * num_channels, count,
+                     loudness::EbuR128Analyzer::FLOAT,
+                     loudness::EbuR128Analyzer::INTERLEAVED);
+  }
+}
+
+void PrintResult(const char* label, double elapsed_seconds,
+                 const loudness::EbuR128Analyzer& analyzer) {
+  std::printf("%-30s %8.1fx realtime  I = %7.2f LUFS  TP = %.4f\n", label,
+              kDurationSeconds / elapsed_seconds,
+              analyzer.GetRelativeGatedIntegratedLoudness().value_or(
+                  loudness::kMinLKFS),
+              analyzer.true_peak());
+}
+
+void RunBenchmark(const char* label, int32_t num_channels,
+                  bool enable_true_peak) {
+  const int64_t num_frames = kSampleRate * kDurationSeconds;
+  const std::vector<float> signal =
+      MakeInterleavedSignal(num_channels, num_frames);
+
+  loudness::EbuR128Analyzer analyzer(num_channels,
+                                     loudness::DefaultChannelWeights(),
+                                     kSampleRate, enable_true_peak);
+
+  const auto start = std::chrono::steady_clock::now();
+  ProcessFrames(analyzer, signal, num_channels, 0, num_frames);
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  PrintResult(label, elapsed.count(), analyzer);
+}
+
+// Analyzes adjacent segments concurrently, each preceded by pre-roll, and
+// merges them. The result should match RunBenchmark().
+void RunSegmentedBenchmark(const char* label, int32_t num_channels,
+                           bool enable_true_peak) {
+  const int64_t num_frames = kSampleRate * kDurationSeconds;
+  const std::vector<float> signal =
+      MakeInterleavedSignal(num_channels, num_frames);
+  const int num_segments =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+  std::vector<std::unique_ptr<loudness::EbuR128Analyzer>> analyzers;
+  for (int i = 0; i < num_segments; ++i) {
+    analyzers.push_back(std::make_unique<loudness::EbuR128Analyzer>(
+        num_channels, loudness::DefaultChannelWeights(), kSampleRate,
+        enable_true_peak));
+  }
+  const int64_t step = analyzers[0]->num_samples_per_step();
+  const int64_t segment_frames = num_frames / num_segments / step * step;
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_segments; ++i) {
+    threads.emplace_back([&, i] {
+      loudness::EbuR128Analyzer& analyzer = *analyzers[i];
+      const int64_t first_frame = i * segment_frames;
+      const int64_t end_frame =
+          i + 1 < num_segments ? first_frame + segment_frames : num_frames;
+      if (first_frame > 0) {
+        const int64_t pre_roll =
+            std::min(first_frame, analyzer.segment_pre_roll_samples());
+        ProcessFrames(analyzer, signal, num_channels, first_frame - pre_roll,
+                      first_frame);
+        analyzer.StartSegment(first_frame);
+      }
+      ProcessFrames(analyzer, signal, num_channels, first_frame, end_frame);
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  for (int i = 1; i < num_segments; ++i) {
+    analyzers[0]->Merge(*analyzers[i]);
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  char segmented_label[64];
+  std::snprintf(segmented_label, sizeof(segmented_label), "%s (%d segments)",
+                label, num_segments);
+  PrintResult(segmented_label, elapsed.count(), *analyzers[0]);
+}
+
+// Reports samples (frames times channels) per second for one format and
+// layout. The signal is encoded before timing starts.
+void RunFormatBenchmark(int32_t num_channels,
+                        loudness::EbuR128Analyzer::SampleFormat format,
+                        loudness::EbuR128Analyzer::SampleLayout layout) {
+  constexpr int64_t kFormatDurationSeconds = 60;
+  const int64_t num_frames = kSampleRate * kFormatDurationSeconds;
+  const std::vector<loudness_test::EncodedBlock> blocks =
+      loudness_test::EncodeSignal(
+          MakeInterleavedSignal(num_channels, num_frames), num_channels,
+          kChunkFrames, format, layout);
+
+  loudness::EbuR128Analyzer analyzer(
+      num_channels, loudness::DefaultChannelWeights(), kSampleRate);
+
+  const auto start = std::chrono::steady_clock::now();
+  loudness_test::ProcessBlocks(analyzer, blocks, format, layout);
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  std::printf("%d ch %-6s %-11s %8.1f Msamples/s %8.1fx realtime\n",
+              num_channels, loudness_test::FormatName(format),
+              loudness_test::LayoutName(layout),
+              num_frames * num_channels / elapsed.count() / 1e6,
+              kFormatDurationSeconds / elapsed.count());
+}
+
+}  // namespace
+
+int main() {
+  RunBenchmark("stereo", 2, false);
+  RunBenchmark("5.1", 6, false);
+  RunBenchmark("stereo + true peak", 2, true);
+  RunBenchmark("5.1 + true peak", 6, true);
+  RunSegmentedBenchmark("stereo", 2, false);
+  RunSegmentedBenchmark("stereo + true peak", 2, true);
+  using loudness_test::Analyzer;
+  for (const int32_t num_channels : {2, 6}) {
+    for (const auto format : {Analyzer::S16, Analyzer::S24, Analyzer::S32,
+                              Analyzer::FLOAT, Analyzer::DOUBLE}) {
+      for (const auto layout :
+           {Analyzer::INTERLEAVED, Analyzer::PLANAR_CONTIGUOUS,
+            Analyzer::PLANAR_NON_CONTIGUOUS}) {
+        RunFormatBenchmark(num_channels, format, layout);
+      }
+    }
+  }
+  return 0;
+}
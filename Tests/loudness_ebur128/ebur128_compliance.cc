@@ -0,0 +1,508 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Compliance suite for loudness::EbuR128Analyzer.
+//
+// The EBU Tech 3341 and Tech 3342 minimum requirement test signals that are
+// defined as sine sequences are generated here, so no test files are needed.
+// Cases using authentic programme material are not covered. Each signal is
+// measured in every supported sample format and layout and both gating modes
+// where relevant, and at several sample rates.
+//
+// Built as part of Tests/CMakeLists.txt.
+//
+// The exit status is non-zero if any measurement is out of tolerance.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "test_harness.h"
+#include "test_signals.h"
+
+namespace {
+
+using loudness_test::Analyzer;
+using loudness_test::Section;
+using loudness_test::SineSection;
+
+constexpr Analyzer::SampleFormat kFormats[] = {
+    Analyzer::S16, Analyzer::S24, Analyzer::S32, Analyzer::FLOAT,
+    Analyzer::DOUBLE};
+constexpr Analyzer::SampleLayout kLayouts[] = {
+    Analyzer::INTERLEAVED, Analyzer::PLANAR_CONTIGUOUS,
+    Analyzer::PLANAR_NON_CONTIGUOUS};
+constexpr int32_t kSampleRates[] = {32000, 44100, 48000, 88200, 96000, 192000};
+
+// Deliberately not a multiple of the 100 ms step at any tested rate
+constexpr int64_t kBlockFrames = 1021;
+
+// Records a check that `measured` is within [expected - below,
+// expected + above].
+void Check(const std::string& name, const char* quantity, double measured,
+           double expected, double below, double above) {
+  char description[160];
+  std::snprintf(description, sizeof description,
+                "%-44s %-4s %8.3f  (expected %.1f +%.1f/-%.1f)",
+                name.c_str(), quantity, measured, expected, above, below);
+  sfb_test::check(measured >= expected - below && measured <= expected + above,
+                  description);
+}
+
+struct Measurement {
+  std::unique_ptr<Analyzer> analyzer;
+  double integrated = loudness::kMinLKFS;
+  double loudness_range = 0;
+};
+
+Measurement Measure(const std::vector<float>& signal, int32_t num_channels,
+                    int32_t sample_rate, Analyzer::SampleFormat format,
+                    Analyzer::SampleLayout layout, Analyzer::GatingMode gating,
+                    bool true_peak = false) {
+  Measurement m;
+  m.analyzer = std::make_unique<Analyzer>(
+      num_channels, loudness::DefaultChannelWeights(), sample_rate, true_peak,
+      gating, /*enable_block_history=*/true);
+  loudness_test::ProcessBlocks(
+      *m.analyzer,
+      loudness_test::EncodeSignal(signal, num_channels, kBlockFrames, format,
+                                  layout),
+      format, layout);
+  m.integrated = m.analyzer->GetRelativeGatedIntegratedLoudness().value_or(
+      loudness::kMinLKFS);
+  bool is_stable;
+  if (const auto lra = m.analyzer->GetLoudnessRangeStats(&is_stable); lra) {
+    m.loudness_range = lra->loudness_range_lu;
+  }
+  return m;
+}
+
+std::string Name(const char* test_case, int32_t sample_rate,
+                 Analyzer::SampleFormat format, Analyzer::SampleLayout layout,
+                 Analyzer::GatingMode gating) {
+  char name[128];
+  std::snprintf(name, sizeof(name), "%s %d %s %s%s", test_case, sample_rate,
+                loudness_test::FormatName(format),
+                loudness_test::LayoutName(layout),
+                gating == Analyzer::HISTOGRAM ? " hist" : "");
+  return name;
+}
+
+// Tech 3341 cases 1-5: integrated loudness of stereo 1 kHz sine sequences,
+// tolerance +/-0.1 LU. Case 1 is also measured in every format and layout,
+// at every rate, and in both gating modes.
+void TestIntegratedLoudness() {
+  struct TestCase {
+    const char* name;
+    std::vector<SineSection> sections;
+    double expected;
+  };
+  const std::vector<TestCase> test_cases = {
+      {"3341-1", {Section(2, -23, 20)}, -23},
+      {"3341-2", {Section(2, -33, 20)}, -33},
+      {"3341-3",
+       {Section(2, -36, 10), Section(2, -23, 60), Section(2, -36, 10)},
+       -23},
+      {"3341-4",
+       {Section(2, -72, 10), Section(2, -36, 10), Section(2, -23, 60),
+        Section(2, -36, 10), Section(2, -72, 10)},
+       -23},
+      {"3341-5",
+       {Section(2, -26, 20), Section(2, -20, 20.1), Section(2, -26, 20)},
+       -23},
+  };
+
+  for (const TestCase& test_case : test_cases) {
+    for (const auto gating : {Analyzer::EXACT, Analyzer::HISTOGRAM}) {
+      const std::vector<float> signal =
+          loudness_test::MakeSineSequence(48000, 2, 1000, test_case.sections);
+      const Measurement m = Measure(signal, 2, 48000, Analyzer::FLOAT,
+                                    Analyzer::INTERLEAVED, gating);
+      Check(Name(test_case.name, 48000, Analyzer::FLOAT, Analyzer::INTERLEAVED,
+                 gating),
+            "I", m.integrated, test_case.expected, 0.1, 0.1);
+    }
+  }
+
+  for (const int32_t sample_rate : kSampleRates) {
+    const std::vector<float> signal = loudness_test::MakeSineSequence(
+        sample_rate, 2, 1000, test_cases[0].sections);
+    for (const auto format : kFormats) {
+      for (const auto layout : kLayouts) {
+        for (const auto gating : {Analyzer::EXACT, Analyzer::HISTOGRAM}) {
+          const Measurement m =
+              Measure(signal, 2, sample_rate, format, layout, gating);
+          Check(Name("3341-1", sample_rate, format, layout, gating), "I",
+                m.integrated, -23, 0.1, 0.1);
+        }
+      }
+    }
+  }
+}
+
+// Multichannel weighting. The 1 kHz sine levels are chosen so the ITU BS.1770
+// weighted sum of L, R, C, Ls and Rs is -23 LUFS; the loud LFE must be
+// ignored.
+void TestMultichannel() {
+  // Each surround channel carries the power of the remaining -23 LUFS budget,
+  // weighted by 1.41.
+  const double front = std::pow(10.0, -28.0 / 10.0) / 2;
+  const double surround =
+      (std::pow(10.0, -23.0 / 10.0) - 3 * front) / (2 * 1.41);
+  const double surround_dbfs = 10.0 * std::log10(2 * surround);
+  const std::vector<SineSection> sections = {
+      {{-28, -28, -28, -6, surround_dbfs, surround_dbfs}, 20}};
+
+  for (const int32_t sample_rate : {44100, 48000, 96000}) {
+    const std::vector<float> signal =
+        loudness_test::MakeSineSequence(sample_rate, 6, 1000, sections);
+    for (const auto format : {Analyzer::S24, Analyzer::FLOAT}) {
+      for (const auto layout : kLayouts) {
+        const Measurement m =
+            Measure(signal, 6, sample_rate, format, layout, Analyzer::EXACT);
+        Check(Name("5.1", sample_rate, format, layout, Analyzer::EXACT), "I",
+              m.integrated, -23, 0.1, 0.1);
+      }
+    }
+  }
+}
+
+// Tech 3341 cases 9 and 12: alternating levels whose 3 s and 400 ms averages
+// are constant at -23 LUFS, tolerance +/-0.1 LU once the window is full.
+void TestShortTermAndMomentary() {
+  std::vector<SineSection> short_term;
+  for (int i = 0; i < 5; ++i) {
+    short_term.push_back(Section(2, -20, 1.34));
+    short_term.push_back(Section(2, -30, 1.66));
+  }
+  std::vector<SineSection> momentary;
+  for (int i = 0; i < 25; ++i) {
+    momentary.push_back(Section(2, -20, 0.18));
+    momentary.push_back(Section(2, -30, 0.22));
+  }
+
+  for (const int32_t sample_rate : {44100, 48000}) {
+    const Measurement s = Measure(
+        loudness_test::MakeSineSequence(sample_rate, 2, 1000, short_term), 2,
+        sample_rate, Analyzer::FLOAT, Analyzer::INTERLEAVED, Analyzer::EXACT);
+    const auto& short_term_lkfs = s.analyzer->ungated_short_term_lkfs();
+    const auto [s_min, s_max] =
+        std::minmax_element(short_term_lkfs.begin(), short_term_lkfs.end());
+    const std::string s_name = Name("3341-9", sample_rate, Analyzer::FLOAT,
+                                    Analyzer::INTERLEAVED, Analyzer::EXACT);
+    Check(s_name, "Smin", *s_min, -23, 0.1, 0.1);
+    Check(s_name, "Smax", *s_max, -23, 0.1, 0.1);
+
+    const Measurement m = Measure(
+        loudness_test::MakeSineSequence(sample_rate, 2, 1000, momentary), 2,
+        sample_rate, Analyzer::FLOAT, Analyzer::INTERLEAVED, Analyzer::EXACT);
+    const auto& momentary_lkfs = m.analyzer->ungated_momentary_lkfs();
+    const auto [m_min, m_max] =
+        std::minmax_element(momentary_lkfs.begin(), momentary_lkfs.end());
+    const std::string m_name = Name("3341-12", sample_rate, Analyzer::FLOAT,
+                                    Analyzer::INTERLEAVED, Analyzer::EXACT);
+    Check(m_name, "Mmin", *m_min, -23, 0.1, 0.1);
+    Check(m_name, "Mmax", *m_max, -23, 0.1, 0.1);
+  }
+}
+
+// Tech 3341 cases 15-19: true peak of 48 kHz sines at fractions of the sample
+// rate with phase offsets that put the peak between samples, tolerance
+// +0.2/-0.4 dB. The sines fade in over 100 ms so only their steady state is
+// measured.
+void TestTruePeak() {
+  struct TestCase {
+    const char* name;
+    double frequency;
+    double phase_degrees;
+    double level_dbfs;
+    double expected;
+  };
+  const TestCase test_cases[] = {
+      {"3341-15", 12000, 0, -6, -6},
+      {"3341-16", 12000, 45, -6, -6},
+      {"3341-17", 8000, 60, -6, -6},
+      {"3341-18", 6000, 67.5, -6, -6},
+      {"3341-19", 12000, 45, 20 * std::log10(std::sqrt(2.0)), 3},
+  };
+
+  for (const TestCase& test_case : test_cases) {
+    std::vector<float> signal = loudness_test::MakeSineSequence(
+        48000, 2, test_case.frequency, {Section(2, test_case.level_dbfs, 5)},
+        test_case.phase_degrees * M_PI / 180);
+    loudness_test::FadeIn(signal, 2, 4800);
+    for (const auto layout :
+         {Analyzer::INTERLEAVED, Analyzer::PLANAR_CONTIGUOUS}) {
+      const Measurement m = Measure(signal, 2, 48000, Analyzer::FLOAT, layout,
+                                    Analyzer::EXACT, /*true_peak=*/true);
+      Check(Name(test_case.name, 48000, Analyzer::FLOAT, layout,
+                 Analyzer::EXACT),
+            "TP", m.analyzer->true_peak_dbfs(), test_case.expected, 0.4, 0.2);
+    }
+  }
+}
+
+// Tech 3342 cases 1-4: loudness range of stereo 1 kHz sine sequences,
+// tolerance +/-1 LU.
+void TestLoudnessRange() {
+  struct TestCase {
+    const char* name;
+    std::vector<SineSection> sections;
+    double expected;
+  };
+  const std::vector<TestCase> test_cases = {
+      {"3342-1", {Section(2, -20, 20), Section(2, -30, 20)}, 10},
+      {"3342-2", {Section(2, -20, 20), Section(2, -15, 20)}, 5},
+      {"3342-3", {Section(2, -40, 20), Section(2, -20, 20)}, 20},
+      {"3342-4",
+       {Section(2, -50, 20), Section(2, -35, 20), Section(2, -20, 20),
+        Section(2, -35, 20), Section(2, -50, 20)},
+       15},
+  };
+
+  for (const TestCase& test_case : test_cases) {
+    const std::vector<float> signal =
+        loudness_test::MakeSineSequence(48000, 2, 1000, test_case.sections);
+    for (const auto format : {Analyzer::S16, Analyzer::FLOAT}) {
+      for (const auto gating : {Analyzer::EXACT, Analyzer::HISTOGRAM}) {
+        const Measurement m =
+            Measure(signal, 2, 48000, format, Analyzer::INTERLEAVED, gating);
+        Check(Name(test_case.name, 48000, format, Analyzer::INTERLEAVED,
+                   gating),
+              "LRA", m.loudness_range, test_case.expected, 1, 1);
+      }
+    }
+  }
+}
+
+// Segment-parallel analysis must match a single pass exactly.
+void TestSegmentedAnalysis() {
+  const std::vector<float> signal = loudness_test::MakeSineSequence(
+      48000, 2, 1000,
+      {Section(2, -50, 20), Section(2, -35, 20), Section(2, -20, 20),
+       Section(2, -35, 20), Section(2, -50, 20)});
+  const int64_t num_frames = signal.size() / 2;
+
+  for (const auto gating : {Analyzer::EXACT, Analyzer::HISTOGRAM}) {
+    const Measurement whole = Measure(signal, 2, 48000, Analyzer::FLOAT,
+                                      Analyzer::INTERLEAVED, gating, true);
+
+    constexpr int kNumSegments = 3;
+    std::vector<std::unique_ptr<Analyzer>> segments;
+    for (int i = 0; i < kNumSegments; ++i) {
+      segments.push_back(std::make_unique<Analyzer>(
+          2, loudness::DefaultChannelWeights(), 48000, true, gating, true));
+    }
+    const int64_t step = segments[0]->num_samples_per_step();
+    const int64_t segment_frames = num_frames / kNumSegments / step * step;
+    for (int i = 0; i < kNumSegments; ++i) {
+      Analyzer& analyzer = *segments[i];
+      const int64_t first_frame = i * segment_frames;
+      const int64_t end_frame =
+          i + 1 < kNumSegments ? first_frame + segment_frames : num_frames;
+      const int64_t begin_frame =
+          first_frame -
+          std::min(first_frame, analyzer.segment_pre_roll_samples());
+      if (begin_frame < first_frame) {
+        analyzer.Process(signal.data() + begin_frame * 2,
+                         first_frame - begin_frame, Analyzer::FLOAT,
+                         Analyzer::INTERLEAVED);
+        analyzer.StartSegment(first_frame);
+      }
+      analyzer.Process(signal.data() + first_frame * 2,
+                       end_frame - first_frame, Analyzer::FLOAT,
+                       Analyzer::INTERLEAVED);
+    }
+    for (int i = 1; i < kNumSegments; ++i) {
+      segments[0]->Merge(*segments[i]);
+    }
+
+    // A copy restored from serialized state must match too
+    Analyzer restored(2, loudness::DefaultChannelWeights(), 48000, true,
+                      gating, true);
+    restored.RestoreState(segments[0]->SerializeState());
+
+    const char* suffix = gating == Analyzer::HISTOGRAM ? " hist" : "";
+    bool is_stable;
+    for (const Analyzer* analyzer : {segments[0].get(), &restored}) {
+      const std::string name =
+          std::string(analyzer == &restored ? "restored" : "merged") + suffix;
+      Check(name, "dI",
+            analyzer->GetRelativeGatedIntegratedLoudness().value_or(0) -
+                whole.integrated,
+            0, 0, 0);
+      Check(name, "dLRA",
+            analyzer->GetLoudnessRangeStats(&is_stable)->loudness_range_lu -
+                whole.loudness_range,
+            0, 0, 0);
+      Check(name, "dTP",
+            analyzer->true_peak() - whole.analyzer->true_peak(), 0, 0, 0);
+    }
+  }
+}
+
+// A state that cannot be restored must leave the analyzer as it was.
+void TestRejectedState() {
+  const std::vector<float> first = loudness_test::MakeSineSequence(
+      48000, 2, 1000, {Section(2, -23, 5)});
+  const std::vector<float> second = loudness_test::MakeSineSequence(
+      48000, 2, 1000, {Section(2, -33, 7)});
+
+  for (const auto gating : {Analyzer::EXACT, Analyzer::HISTOGRAM}) {
+    const Measurement source = Measure(second, 2, 48000, Analyzer::FLOAT,
+                                       Analyzer::INTERLEAVED, gating, true);
+    const Measurement target = Measure(first, 2, 48000, Analyzer::FLOAT,
+                                       Analyzer::INTERLEAVED, gating, true);
+    const std::string before = target.analyzer->SerializeState();
+    const std::string state = source.analyzer->SerializeState();
+
+    const std::string name =
+        std::string("rejected") + (gating == Analyzer::HISTOGRAM ? " hist" : "");
+    bool unchanged = true;
+    for (const size_t length :
+         {state.size() - 1, state.size() / 2, state.size() / 4, size_t{64}}) {
+      unchanged = unchanged &&
+                  !target.analyzer->RestoreState(state.substr(0, length)) &&
+                  target.analyzer->SerializeState() == before;
+    }
+    Check(name, "cut", unchanged ? 0 : 1, 0, 0, 0);
+    Check(name, "dI",
+          target.analyzer->GetRelativeGatedIntegratedLoudness().value_or(0) -
+              target.integrated,
+          0, 0, 0);
+  }
+}
+
+// Restored results must reproduce integrated loudness, alone and as part of
+// an album, and the peaks, in a fraction of the space of the full state.
+void TestSerializedResults() {
+  const std::vector<float> track = loudness_test::MakeSineSequence(
+      48000, 2, 1000,
+      {Section(2, -80, 20), Section(2, -35, 20), Section(2, -20, 20),
+       Section(2, -80, 20)});
+  const std::vector<float> other_track = loudness_test::MakeSineSequence(
+      48000, 2, 1000, {Section(2, -30, 20), Section(2, -25, 20)});
+
+  for (const auto gating : {Analyzer::EXACT, Analyzer::HISTOGRAM}) {
+    const Measurement whole = Measure(track, 2, 48000, Analyzer::FLOAT,
+                                      Analyzer::INTERLEAVED, gating, true);
+    const Measurement other = Measure(other_track, 2, 48000, Analyzer::FLOAT,
+                                      Analyzer::INTERLEAVED, gating, true);
+
+    const auto restore = [gating](const Analyzer& analyzer) {
+      auto restored = std::make_unique<Analyzer>(
+          2, loudness::DefaultChannelWeights(), 48000, true, gating, true);
+      const bool ok = restored->RestoreResults(analyzer.SerializeResults());
+      return ok ? std::move(restored) : nullptr;
+    };
+    const auto restored = restore(*whole.analyzer);
+    const auto restored_other = restore(*other.analyzer);
+
+    const std::string name =
+        std::string("results") + (gating == Analyzer::HISTOGRAM ? " hist" : "");
+    Check(name, "ok", restored && restored_other ? 1 : 0, 1, 0, 0);
+    if (!restored || !restored_other) {
+      continue;
+    }
+    Check(name, "dI",
+          restored->GetRelativeGatedIntegratedLoudness().value_or(0) -
+              whole.integrated,
+          0, 0, 0);
+    const auto album = Analyzer::GetRelativeGatedIntegratedLoudness(
+        {whole.analyzer.get(), other.analyzer.get()});
+    const auto restored_album = Analyzer::GetRelativeGatedIntegratedLoudness(
+        {restored.get(), restored_other.get()});
+    Check(name, "dAI", restored_album.value_or(0) - album.value_or(0), 0, 0,
+          0);
+    Check(name, "dSP",
+          restored->digital_peak() - whole.analyzer->digital_peak(), 0, 0, 0);
+    Check(name, "dTP", restored->true_peak() - whole.analyzer->true_peak(), 0,
+          0, 0);
+    Check(name, "dN",
+          restored->NumSamplesProcessed() -
+              whole.analyzer->NumSamplesProcessed(),
+          0, 0, 0);
+
+    // Silent blocks and the short-term and per-block loudness history are
+    // omitted, so the results are at most a third of the full state
+    const std::string results = whole.analyzer->SerializeResults();
+    Check(name, "size",
+          static_cast<double>(results.size()) /
+              whole.analyzer->SerializeState().size(),
+          0, 0, 1.0 / 3);
+
+    // A truncated record is rejected without changing the analyzer
+    Analyzer truncated(2, loudness::DefaultChannelWeights(), 48000, true,
+                       gating, true);
+    Check(name, "cut",
+          truncated.RestoreResults(results.substr(0, results.size() - 1)) ||
+                  truncated.GetRelativeGatedIntegratedLoudness().has_value()
+              ? 1
+              : 0,
+          0, 0, 0);
+  }
+}
+
+// A meter built without gating storage and reset between signals reads
+// exactly what a new analyzer does
+void TestMeterReset() {
+  const std::vector<float> first = loudness_test::MakeSineSequence(
+      48000, 2, 1000, {Section(5, -10, 20)});
+  const std::vector<float> second = loudness_test::MakeSineSequence(
+      48000, 2, 1000, {Section(2, -40, 20), Section(2, -25, 20)});
+  const auto process = [](Analyzer& analyzer,
+                           const std::vector<float>& signal) {
+    analyzer.Process(signal.data(), static_cast<int64_t>(signal.size() / 2),
+                     Analyzer::FLOAT, Analyzer::INTERLEAVED);
+  };
+
+  Analyzer meter(2, loudness::DefaultChannelWeights(), 48000, true,
+                 Analyzer::NONE);
+  process(meter, first);
+  meter.Reset();
+  process(meter, second);
+
+  Analyzer fresh(2, loudness::DefaultChannelWeights(), 48000, true,
+                 Analyzer::HISTOGRAM);
+  process(fresh, second);
+
+  const std::string name = "meter reset";
+  Check(name, "dM", meter.momentary_lkfs() - fresh.momentary_lkfs(), 0, 0, 0);
+  Check(name, "dS", meter.short_term_lkfs() - fresh.short_term_lkfs(), 0, 0,
+        0);
+  Check(name, "dTP", meter.true_peak() - fresh.true_peak(), 0, 0, 0);
+  Check(name, "dN", meter.NumSamplesProcessed() - fresh.NumSamplesProcessed(),
+        0, 0, 0);
+
+  bool is_stable = true;
+  Check(name, "none",
+        meter.GetRelativeGatedIntegratedLoudness().has_value() ||
+                meter.GetLoudnessRangeStats(&is_stable).has_value() ||
+                meter.GetRms100msStats().has_value()
+            ? 1
+            : 0,
+        0, 0, 0);
+}
+
+}  // namespace
+
+int main() {
+  TestIntegratedLoudness();
+  TestMultichannel();
+  TestShortTermAndMomentary();
+  TestTruePeak();
+  TestLoudnessRange();
+  TestSegmentedAnalysis();
+  TestRejectedState();
+  TestSerializedResults();
+  TestMeterReset();
+  return sfb_test::summarize();
+}
@@ -0,0 +1,313 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Regression test for the block-processing path of loudness::EbuR128Analyzer.
+//
+// The analyzer filters runs of audio with several channels per vector lane
+// (see float_lanes.h). ReferenceMeter below is the per-sample, per-channel
+// scalar algorithm that the vector path replaced, with the same step-level
+// bookkeeping. Each signal is fed through both in irregular chunks, and the
+// momentary and short-term loudness after every chunk, the integrated
+// loudness, and the true peak must agree within the tolerances below. The
+// operations are ordered identically, so any difference comes from floating
+// point contraction by the compiler.
+//
+// Built as part of Tests/CMakeLists.txt.
+//
+// The exit status is non-zero if any value is out of tolerance.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ebur128_constants.h"
+#include "k_weighting.h"
+#include "test_harness.h"
+#include "test_signals.h"
+
+namespace {
+
+using loudness_test::Analyzer;
+using loudness_test::Section;
+
+// Largest allowed difference in momentary, short-term and integrated
+// loudness
+constexpr double kLoudnessToleranceLU = 0.001;
+// Largest allowed difference in true peak
+constexpr double kTruePeakToleranceDB = 0.001;
+
+// Chunk lengths in frames, used in turn. They include single frames, runs
+// shorter and longer than the kernel's block, and runs spanning several
+// steps.
+constexpr int64_t kChunkFrames[] = {1, 7, 256, 1021, 4410, 3, 9600, 255};
+
+// Records a check that `measured` is within [expected - below,
+// expected + above].
+void Check(const std::string& name, const char* quantity, double measured,
+           double expected, double below, double above) {
+  char description[160];
+  std::snprintf(description, sizeof description,
+                "%-44s %-4s %8.5f  (expected %.1f +%.3f/-%.3f)",
+                name.c_str(), quantity, measured, expected, above, below);
+  sfb_test::check(measured >= expected - below && measured <= expected + above,
+                  description);
+}
+
+// The scalar per-sample loudness algorithm
+class ReferenceMeter {
+ public:
+  ReferenceMeter(int32_t num_channels, std::vector<float> weights,
+                 int32_t sample_rate)
+      : num_channels_(num_channels),
+        weights_(std::move(weights)),
+        samples_per_step_(loudness::kStepLengthSeconds * sample_rate),
+        momentary_block_samples_(sample_rate *
+                                 loudness::kMomentaryBlockSizeSeconds),
+        short_term_block_samples_(sample_rate *
+                                  loudness::kShortTermBlockSizeSeconds),
+        channels_(num_channels) {
+    loudness::InitKWeightingFilter(sample_rate, stage1_, stage2_);
+  }
+
+  void Process(const float* interleaved, int64_t num_frames) {
+    for (int64_t i = 0; i < num_frames; ++i) {
+      for (int32_t c = 0; c < num_channels_; ++c) {
+        ProcessSample(interleaved[i * num_channels_ + c], channels_[c]);
+      }
+      if (++samples_this_step_ == samples_per_step_) {
+        samples_this_step_ = 0;
+        UpdatePerStep();
+      }
+    }
+  }
+
+  float momentary_lkfs() const { return momentary_lkfs_; }
+  float short_term_lkfs() const { return short_term_lkfs_; }
+  float true_peak() const { return true_peak_; }
+
+  // Integrated loudness with the absolute and relative gates of ITU 1770
+  float IntegratedLoudness() const {
+    float sum = 0.0f;
+    int64_t count = 0;
+    for (float power : momentary_powers_) {
+      if (power > loudness::kPowerAbsoluteThreshold) {
+        sum += power;
+        ++count;
+      }
+    }
+    if (count == 0) {
+      return loudness::kMinLKFS;
+    }
+    const float threshold = std::max(
+        loudness::kPowerAbsoluteThreshold,
+        Analyzer::GetPowerForLoudness(Analyzer::GetLoudnessForPower(
+                                          sum / count) +
+                                      loudness::k1770RelativeThresholdLU));
+    float gated_sum = 0.0f;
+    int64_t gated_count = 0;
+    for (float power : momentary_powers_) {
+      if (power > threshold) {
+        gated_sum += power;
+        ++gated_count;
+      }
+    }
+    return Analyzer::GetLoudnessForPower(gated_sum / gated_count);
+  }
+
+ private:
+  struct Channel {
+    std::array<float, 4> filter_state{};
+    float sst_accumulator = 0.0f;
+    std::array<float, loudness::kTruePeakFilterLength> history{};
+    std::array<float, loudness::kStepsPerMomentaryBlock> momentary_sums{};
+    std::array<float, loudness::kStepsPerShortTermBlock> short_term_sums{};
+    float momentary_sst = 0.0f;
+    float short_term_sst = 0.0f;
+  };
+
+  void ProcessSample(float x, Channel& channel) {
+    auto& w = channel.filter_state;
+    const float s1_wn = x - stage1_[0] * w[0] - stage1_[1] * w[1];
+    const float s1_yn = stage1_[2] * s1_wn + stage1_[3] * w[0] +
+                        stage1_[4] * w[1];
+    const float s2_wn = s1_yn - stage2_[0] * w[2] - stage2_[1] * w[3];
+    const float k_weighted = s2_wn + -2 * w[2] + w[3];
+    w = {s1_wn, w[0], s2_wn, w[2]};
+    channel.sst_accumulator += k_weighted * k_weighted;
+
+    // The history holds the most recent samples, oldest first
+    std::copy(channel.history.begin() + 1, channel.history.end(),
+              channel.history.begin());
+    channel.history.back() = x;
+    constexpr int kLast = loudness::kTruePeakFilterLength - 1;
+    for (const float* phase :
+         {loudness::kTruePeakFilterPhase0, loudness::kTruePeakFilterPhase1,
+          loudness::kTruePeakFilterPhase2, loudness::kTruePeakFilterPhase3}) {
+      float upsampled = 0.0f;
+      for (int j = 0; j < loudness::kTruePeakFilterLength; ++j) {
+        upsampled += channel.history[j] * phase[kLast - j];
+      }
+      true_peak_ = std::fmax(true_peak_, std::fabs(upsampled));
+    }
+    true_peak_ = std::fmax(true_peak_, std::fabs(x));
+  }
+
+  void UpdatePerStep() {
+    float momentary_sum = 0.0f;
+    float short_term_sum = 0.0f;
+    for (int32_t c = 0; c < num_channels_; ++c) {
+      Channel& channel = channels_[c];
+      const int momentary_index =
+          num_steps_ % loudness::kStepsPerMomentaryBlock;
+      const int short_term_index =
+          num_steps_ % loudness::kStepsPerShortTermBlock;
+      channel.momentary_sst -= channel.momentary_sums[momentary_index];
+      channel.momentary_sst += channel.sst_accumulator;
+      channel.momentary_sums[momentary_index] = channel.sst_accumulator;
+      channel.short_term_sst -= channel.short_term_sums[short_term_index];
+      channel.short_term_sst += channel.sst_accumulator;
+      channel.short_term_sums[short_term_index] = channel.sst_accumulator;
+      channel.sst_accumulator = 0.0f;
+      momentary_sum += weights_[c] * channel.momentary_sst;
+      short_term_sum += weights_[c] * channel.short_term_sst;
+    }
+    ++num_steps_;
+
+    if (num_steps_ * samples_per_step_ >= momentary_block_samples_) {
+      const float power =
+          momentary_sum * (1.0f / static_cast<float>(momentary_block_samples_));
+      momentary_lkfs_ = Analyzer::GetLoudnessForPower(power);
+      momentary_powers_.push_back(power);
+    }
+    if (num_steps_ * samples_per_step_ >= short_term_block_samples_) {
+      short_term_lkfs_ = Analyzer::GetLoudnessForPower(
+          short_term_sum *
+          (1.0f / static_cast<float>(short_term_block_samples_)));
+    }
+  }
+
+  const int32_t num_channels_;
+  const std::vector<float> weights_;
+  const int64_t samples_per_step_;
+  const int64_t momentary_block_samples_;
+  const int64_t short_term_block_samples_;
+  loudness::BiquadCoeffs stage1_;
+  loudness::BiquadCoeffs stage2_;
+  std::vector<Channel> channels_;
+  int64_t samples_this_step_ = 0;
+  int64_t num_steps_ = 0;
+  std::vector<float> momentary_powers_;
+  float momentary_lkfs_ = loudness::kMinLKFS;
+  float short_term_lkfs_ = loudness::kMinLKFS;
+  float true_peak_ = 0.0f;
+};
+
+// Returns the difference between two loudness values, treating values below
+// the absolute gate as equal
+double LoudnessDifference(double a, double b) {
+  if (a < loudness::kAbsoluteThresholdLKFS &&
+      b < loudness::kAbsoluteThresholdLKFS) {
+    return 0;
+  }
+  return a - b;
+}
+
+// Measures `signal` with the analyzer and the reference and compares them
+void Compare(const std::string& name, const std::vector<float>& signal,
+             int32_t num_channels, int32_t sample_rate,
+             const std::vector<float>& weights) {
+  Analyzer analyzer(num_channels, weights, sample_rate, true, Analyzer::EXACT);
+  ReferenceMeter reference(num_channels, weights, sample_rate);
+
+  double momentary_difference = 0;
+  double short_term_difference = 0;
+  const auto num_frames = static_cast<int64_t>(signal.size()) / num_channels;
+  for (int64_t frame = 0, i = 0; frame < num_frames; ++i) {
+    const int64_t chunk_frames =
+        std::min(kChunkFrames[i % std::size(kChunkFrames)], num_frames - frame);
+    const float* chunk = signal.data() + frame * num_channels;
+    analyzer.Process(chunk, chunk_frames, Analyzer::FLOAT,
+                     Analyzer::INTERLEAVED);
+    reference.Process(chunk, chunk_frames);
+    frame += chunk_frames;
+
+    const double momentary = LoudnessDifference(analyzer.momentary_lkfs(),
+                                                reference.momentary_lkfs());
+    const double short_term = LoudnessDifference(analyzer.short_term_lkfs(),
+                                                 reference.short_term_lkfs());
+    if (std::fabs(momentary) > std::fabs(momentary_difference) ||
+        std::isnan(momentary)) {
+      momentary_difference = momentary;
+    }
+    if (std::fabs(short_term) > std::fabs(short_term_difference) ||
+        std::isnan(short_term)) {
+      short_term_difference = short_term;
+    }
+  }
+
+  Check(name, "dM", momentary_difference, 0, kLoudnessToleranceLU,
+        kLoudnessToleranceLU);
+  Check(name, "dS", short_term_difference, 0, kLoudnessToleranceLU,
+        kLoudnessToleranceLU);
+  Check(name, "dI",
+        analyzer.GetRelativeGatedIntegratedLoudness().value_or(
+            loudness::kMinLKFS) -
+            reference.IntegratedLoudness(),
+        0, kLoudnessToleranceLU, kLoudnessToleranceLU);
+  Check(name, "dTP",
+        20 * std::log10(analyzer.true_peak() / reference.true_peak()), 0,
+        kTruePeakToleranceDB, kTruePeakToleranceDB);
+}
+
+// Noise with a slow amplitude envelope and a different level per channel
+std::vector<float> MakeNoise(int32_t num_channels, int32_t sample_rate,
+                             double seconds) {
+  std::mt19937 generator(1770);
+  std::normal_distribution<float> noise(0.0f, 0.1f);
+  const auto num_frames = static_cast<int64_t>(seconds * sample_rate);
+  std::vector<float> signal(num_frames * num_channels);
+  for (int64_t i = 0; i < num_frames; ++i) {
+    const float envelope = 0.55f + 0.45f * std::sin(i * 4e-5f);
+    for (int32_t c = 0; c < num_channels; ++c) {
+      signal[i * num_channels + c] =
+          envelope * noise(generator) / static_cast<float>(1 + c);
+    }
+  }
+  return signal;
+}
+
+}  // namespace
+
+int main() {
+  // Level changes across the gates
+  Compare("sine stereo 44100",
+          loudness_test::MakeSineSequence(
+              44100, 2, 1000,
+              {Section(2, -36, 5), Section(2, -23, 10), Section(2, -60, 5)}),
+          2, 44100, loudness::DefaultChannelWeights());
+
+  // A full group and a partial group of lanes, with a zero weight
+  Compare("noise 5.1 48000", MakeNoise(6, 48000, 20), 6, 48000,
+          loudness::DefaultChannelWeights());
+
+  // More channels than the widest vector has lanes
+  Compare("noise 9ch 96000", MakeNoise(9, 96000, 8), 9, 96000,
+          std::vector<float>(9, 1.0f));
+
+  // A quarter-rate sine at 45 degrees, whose true peak lies between samples
+  Compare("intersample mono 32000",
+          loudness_test::MakeSineSequence(32000, 1, 8000, {Section(1, -1, 6)},
+                                          M_PI / 4),
+          1, 32000, {1.0f});
+
+  return sfb_test::summarize();
+}
@@ -0,0 +1,252 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Test signal generation and sample format encoding shared by the loudness
+// benchmark and compliance suite.
+
+#ifndef LOUDNESS_EBUR128_TESTS_TEST_SIGNALS_H_
+#define LOUDNESS_EBUR128_TESTS_TEST_SIGNALS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "ebur128_analyzer.h"
+
+namespace loudness_test {
+
+using Analyzer = loudness::EbuR128Analyzer;
+
+// One section of a sine sequence: the peak level of each channel in dBFS for
+// a duration. A level of -infinity is silence.
+struct SineSection {
+  std::vector<double> levels_dbfs;
+  double seconds;
+};
+
+// Returns interleaved sines of `frequency` Hz following `sections`. Phase is
+// continuous across sections, as in the EBU test sequences.
+inline std::vector<float> MakeSineSequence(
+    int32_t sample_rate, int32_t num_channels, double frequency,
+    const std::vector<SineSection>& sections, double phase = 0.0) {
+  std::vector<float> signal;
+  int64_t n = 0;
+  for (const SineSection& section : sections) {
+    const auto num_frames =
+        static_cast<int64_t>(std::llround(section.seconds * sample_rate));
+    std::vector<double> amplitudes(num_channels);
+    for (int32_t c = 0; c < num_channels; ++c) {
+      amplitudes[c] = std::pow(10.0, section.levels_dbfs[c] / 20.0);
+    }
+    for (int64_t i = 0; i < num_frames; ++i, ++n) {
+      const double s =
+          std::sin(2.0 * M_PI * frequency * n / sample_rate + phase);
+      for (int32_t c = 0; c < num_channels; ++c) {
+        signal.push_back(static_cast<float>(amplitudes[c] * s));
+      }
+    }
+  }
+  return signal;
+}
+
+// Applies a raised cosine fade-in over the first `num_frames` frames, so a
+// signal starting mid-cycle has no onset step whose overshoot would be
+// measured as a true peak.
+inline void FadeIn(std::vector<float>& signal, int32_t num_channels,
+                   int64_t num_frames) {
+  for (int64_t i = 0; i < num_frames; ++i) {
+    const auto gain =
+        static_cast<float>(0.5 - 0.5 * std::cos(M_PI * i / num_frames));
+    for (int32_t c = 0; c < num_channels; ++c) {
+      signal[i * num_channels + c] *= gain;
+    }
+  }
+}
+
+// Convenience for sections with the same level on every channel.
+inline SineSection Section(int32_t num_channels, double level_dbfs,
+                           double seconds) {
+  return {std::vector<double>(num_channels, level_dbfs), seconds};
+}
+
+// Returns the size in bytes of one sample in `format`.
+inline std::size_t BytesPerSample(Analyzer::SampleFormat format) {
+  switch (format) {
+    case Analyzer::S16:
+      return 2;
+    case Analyzer::S24:
+      return 3;
+    case Analyzer::S32:
+    case Analyzer::FLOAT:
+      return 4;
+    case Analyzer::DOUBLE:
+      return 8;
+  }
+  return 0;
+}
+
+inline const char* FormatName(Analyzer::SampleFormat format) {
+  switch (format) {
+    case Analyzer::S16:
+      return "s16";
+    case Analyzer::S24:
+      return "s24";
+    case Analyzer::S32:
+      return "s32";
+    case Analyzer::FLOAT:
+      return "float";
+    case Analyzer::DOUBLE:
+      return "double";
+  }
+  return "?";
+}
+
+inline const char* LayoutName(Analyzer::SampleLayout layout) {
+  switch (layout) {
+    case Analyzer::INTERLEAVED:
+      return "interleaved";
+    case Analyzer::PLANAR_CONTIGUOUS:
+      return "planar";
+    case Analyzer::PLANAR_NON_CONTIGUOUS:
+      return "planes";
+  }
+  return "?";
+}
+
+// Writes `value`, nominally in [-1, 1), to `out` in `format`.
+inline void EncodeSample(float value, Analyzer::SampleFormat format,
+                         unsigned char* out) {
+  const auto quantize = [value](double scale, double min, double max) {
+    return std::clamp(std::nearbyint(value * scale), min, max);
+  };
+  switch (format) {
+    case Analyzer::S16: {
+      const auto sample = static_cast<int16_t>(quantize(
+          std::numeric_limits<int16_t>::max(),
+          std::numeric_limits<int16_t>::min(),
+          std::numeric_limits<int16_t>::max()));
+      std::memcpy(out, &sample, sizeof sample);
+      break;
+    }
+    case Analyzer::S24: {
+      const auto sample = static_cast<int32_t>(
+          quantize((1 << 23) - 1, -(1 << 23), (1 << 23) - 1));
+      // Packed in native byte order
+      const auto bits = static_cast<uint32_t>(sample);
+      const unsigned char bytes[3] = {static_cast<unsigned char>(bits),
+                                      static_cast<unsigned char>(bits >> 8),
+                                      static_cast<unsigned char>(bits >> 16)};
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+      out[0] = bytes[2];
+      out[1] = bytes[1];
+      out[2] = bytes[0];
+#else
+      std::memcpy(out, bytes, 3);
+#endif
+      break;
+    }
+    case Analyzer::S32: {
+      const auto sample = static_cast<int32_t>(quantize(
+          std::numeric_limits<int32_t>::max(),
+          std::numeric_limits<int32_t>::min(),
+          std::numeric_limits<int32_t>::max()));
+      std::memcpy(out, &sample, sizeof sample);
+      break;
+    }
+    case Analyzer::FLOAT:
+      std::memcpy(out, &value, sizeof value);
+      break;
+    case Analyzer::DOUBLE: {
+      const double sample = value;
+      std::memcpy(out, &sample, sizeof sample);
+      break;
+    }
+  }
+}
+
+// A block of audio encoded for Analyzer::Process().
+class EncodedBlock {
+ public:
+  // Encodes `num_frames` frames of interleaved float `frames`.
+  EncodedBlock(const float* frames, int64_t num_frames, int32_t num_channels,
+               Analyzer::SampleFormat format, Analyzer::SampleLayout layout)
+      : num_frames_(num_frames), layout_(layout) {
+    const std::size_t sample_size = BytesPerSample(format);
+    bytes_.resize(num_frames * num_channels * sample_size);
+    for (int64_t i = 0; i < num_frames; ++i) {
+      for (int32_t c = 0; c < num_channels; ++c) {
+        const int64_t index = layout == Analyzer::INTERLEAVED
+                                  ? i * num_channels + c
+                                  : c * num_frames + i;
+        EncodeSample(frames[i * num_channels + c], format,
+                     bytes_.data() + index * sample_size);
+      }
+    }
+    if (layout == Analyzer::PLANAR_NON_CONTIGUOUS) {
+      for (int32_t c = 0; c < num_channels; ++c) {
+        planes_.push_back(bytes_.data() + c * num_frames * sample_size);
+      }
+    }
+  }
+
+  EncodedBlock(EncodedBlock&& other) noexcept
+      : bytes_(std::move(other.bytes_)),
+        planes_(std::move(other.planes_)),
+        num_frames_(other.num_frames_),
+        layout_(other.layout_) {}
+
+  EncodedBlock(const EncodedBlock&) = delete;
+  EncodedBlock& operator=(const EncodedBlock&) = delete;
+
+  // Returns the argument for Analyzer::Process().
+  const void* data() const {
+    return layout_ == Analyzer::PLANAR_NON_CONTIGUOUS
+               ? static_cast<const void*>(planes_.data())
+               : static_cast<const void*>(bytes_.data());
+  }
+
+  int64_t num_frames() const { return num_frames_; }
+
+ private:
+  std::vector<unsigned char> bytes_;
+  std::vector<const void*> planes_;
+  int64_t num_frames_;
+  Analyzer::SampleLayout layout_;
+};
+
+// Splits interleaved float `signal` into blocks of at most `block_frames`.
+inline std::vector<EncodedBlock> EncodeSignal(const std::vector<float>& signal,
+                                              int32_t num_channels,
+                                              int64_t block_frames,
+                                              Analyzer::SampleFormat format,
+                                              Analyzer::SampleLayout layout) {
+  std::vector<EncodedBlock> blocks;
+  const int64_t num_frames = signal.size() / num_channels;
+  for (int64_t i = 0; i < num_frames; i += block_frames) {
+    blocks.emplace_back(signal.data() + i * num_channels,
+                        std::min(block_frames, num_frames - i), num_channels,
+                        format, layout);
+  }
+  return blocks;
+}
+
+inline void ProcessBlocks(Analyzer& analyzer,
+                          const std::vector<EncodedBlock>& blocks,
+                          Analyzer::SampleFormat format,
+                          Analyzer::SampleLayout layout) {
+  for (const EncodedBlock& block : blocks) {
+    analyzer.Process(block.data(), block.num_frames(), format, layout);
+  }
+}
+
+}  // namespace loudness_test
+
+#endif  // LOUDNESS_EBUR128_TESTS_TEST_SIGNALS_H_
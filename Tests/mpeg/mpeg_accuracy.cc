@@ -0,0 +1,206 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Checks for the MPEG audio frame header and info frame parsing used to find the length of MP3 streams when opened.
+//
+// The parser is plain C++ so this builds anywhere, including Linux, as part of Tests/CMakeLists.txt.
+//
+// Frame sizes and durations must match the values given by the standards for every version and layer, and reserved
+// fields must be rejected. The first frame of streams written by the test writer must be found past ID3v2 tags and
+// leading garbage, and Xing, Info and VBRI frames must give the number of frames and the gapless length.
+
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "MPEGInfoFrame.hpp"
+#include "mpeg_stream.h"
+#include "test_harness.h"
+
+namespace {
+
+using sfb_test::check;
+
+/// Returns the parsed header with `fields`
+std::optional<sfb::mpeg::FrameHeader> parse(const mpeg_test::HeaderFields &fields, bool padding = false) {
+    const auto header = mpeg_test::makeFrameHeader(fields, padding);
+    return sfb::mpeg::parseFrameHeader(header.data(), header.size());
+}
+
+/// Returns true if the header with `fields` has the given size, duration and sample rate
+bool hasFrameSize(const mpeg_test::HeaderFields &fields, bool padding, std::uint32_t size,
+                  std::uint32_t samplesPerFrame, std::uint32_t sampleRate) {
+    const auto header = parse(fields, padding);
+    return header && header->size == size && header->samplesPerFrame == samplesPerFrame &&
+           header->sampleRate == sampleRate;
+}
+
+/// Checks that the first frame and the info frame of a stream written with `options` are found
+void checkStream(const mpeg_test::StreamOptions &options, std::size_t frames, const char *description) {
+    const auto stream = mpeg_test::writeStream(frames, options);
+    const auto *data = stream.data.data();
+    const auto size = stream.data.size();
+
+    sfb::mpeg::FrameHeader header;
+    const auto offset = sfb::mpeg::findFrame(data, size, header);
+    bool passed = offset == stream.frameOffsets.front();
+
+    const auto info = sfb::mpeg::parseInfoFrame(data + offset, size - offset, header);
+    if (options.infoFrame == mpeg_test::InfoFrameKind::none) {
+        passed = passed && !info;
+    } else {
+        const bool gapless = options.infoFrame != mpeg_test::InfoFrameKind::vbri && options.lameExtension;
+        const std::uint64_t trimmed = gapless ? options.encoderDelay + options.encoderPadding : 0;
+        const auto length = info ? sfb::mpeg::audioFrameCount(*info, header) : std::nullopt;
+        passed = passed && info && info->frames == frames && info->bytes == size - offset &&
+                 info->hasGaplessInfo == gapless &&
+                 (info->kind == sfb::mpeg::InfoFrame::Kind::vbri) ==
+                         (options.infoFrame == mpeg_test::InfoFrameKind::vbri) &&
+                 length == frames * header.samplesPerFrame - trimmed;
+    }
+    check(passed, description);
+}
+
+} /* namespace */
+
+int main() {
+    // Sizes from ISO/IEC 11172-3 and 13818-3
+    mpeg_test::HeaderFields fields;
+    check(hasFrameSize(fields, false, 417, 1152, 44100) && hasFrameSize(fields, true, 418, 1152, 44100),
+          "MPEG-1 layer III 128 kbps 44.1 kHz frames are 417 or 418 bytes");
+    fields.bitrateIndex = 14;
+    fields.sampleRateIndex = 2;
+    check(hasFrameSize(fields, false, 1440, 1152, 32000), "MPEG-1 layer III 320 kbps 32 kHz frames are 1440 bytes");
+    fields.layer = 2;
+    fields.bitrateIndex = 10;
+    fields.sampleRateIndex = 1;
+    check(hasFrameSize(fields, false, 576, 1152, 48000), "MPEG-1 layer II 192 kbps 48 kHz frames are 576 bytes");
+    fields.layer = 1;
+    fields.bitrateIndex = 12;
+    check(hasFrameSize(fields, false, 384, 384, 48000) && hasFrameSize(fields, true, 388, 384, 48000),
+          "MPEG-1 layer I 384 kbps 48 kHz frames are 384 or 388 bytes");
+    fields = {};
+    fields.versionBits = 2;
+    fields.bitrateIndex = 8;
+    check(hasFrameSize(fields, false, 208, 576, 22050), "MPEG-2 layer III 64 kbps 22.05 kHz frames are 208 bytes");
+    fields.layer = 2;
+    check(hasFrameSize(fields, false, 417, 1152, 22050), "MPEG-2 layer II 64 kbps 22.05 kHz frames are 417 bytes");
+    fields = {};
+    fields.versionBits = 0;
+    fields.bitrateIndex = 1;
+    fields.sampleRateIndex = 2;
+    check(hasFrameSize(fields, false, 72, 576, 8000), "MPEG-2.5 layer III 8 kbps 8 kHz frames are 72 bytes");
+
+    {
+        bool parsed = true;
+        for (unsigned versionBits : {0u, 2u, 3u}) {
+            for (unsigned layer = 1; layer <= 3; ++layer) {
+                for (unsigned bitrateIndex = 1; bitrateIndex < 15; ++bitrateIndex) {
+                    for (unsigned sampleRateIndex = 0; sampleRateIndex < 3; ++sampleRateIndex) {
+                        const auto header = parse({versionBits, layer, false, bitrateIndex, sampleRateIndex, true});
+                        parsed = parsed && header && header->layer == layer && header->channels == 1 &&
+                                 header->protection == false && header->size > sfb::mpeg::xingOffset(*header);
+                    }
+                }
+            }
+        }
+        check(parsed, "every valid combination of version, layer, bitrate and sample rate parses");
+    }
+
+    {
+        const auto reject = [](unsigned char b1, unsigned char b2, unsigned char b3) {
+            const unsigned char header[] = {0xFF, b1, b2, b3};
+            return !sfb::mpeg::parseFrameHeader(header, sizeof header);
+        };
+        check(reject(0xEB, 0x90, 0x40), "reserved version is rejected");
+        check(reject(0xF9, 0x90, 0x40), "reserved layer is rejected");
+        check(reject(0xFB, 0xF0, 0x40), "bad bitrate index is rejected");
+        check(reject(0xFB, 0x0C | 0x90, 0x40), "reserved sample rate is rejected");
+        check(reject(0xFB, 0x90, 0x42), "reserved emphasis is rejected");
+        check(reject(0xFB, 0x00, 0x40), "free format is not handled");
+        const unsigned char header[] = {0xFF, 0xFB, 0x90};
+        check(!sfb::mpeg::parseFrameHeader(header, sizeof header), "truncated frame header is rejected");
+    }
+
+    {
+        mpeg_test::StreamOptions options;
+        checkStream(options, 100, "first frame of a stream without an info frame is found and has no info frame");
+        options.id3v2Size = 4096;
+        checkStream(options, 100, "first frame is found past an ID3v2 tag holding false syncs");
+
+        options.infoFrame = mpeg_test::InfoFrameKind::xing;
+        checkStream(options, 1000, "Xing frame with a LAME extension gives the gapless length");
+        options.lameExtension = false;
+        checkStream(options, 1000, "Xing frame without a LAME extension gives the length");
+        options.lameExtension = true;
+        options.infoFrame = mpeg_test::InfoFrameKind::info;
+        options.encoderDelay = 1105;
+        options.encoderPadding = 4095;
+        checkStream(options, 1000, "Info frame with a LAME extension gives the gapless length");
+
+        options.fields.mono = true;
+        options.fields.protection = true;
+        checkStream(options, 1000, "Info frame in a mono frame with a CRC is found after the side information");
+        options.fields = {};
+        options.fields.versionBits = 2;
+        options.fields.bitrateIndex = 8;
+        checkStream(options, 1000, "Info frame in an MPEG-2 frame is found after the side information");
+        options.fields.mono = true;
+        checkStream(options, 1000, "Info frame in an MPEG-2 mono frame is found after the side information");
+
+        options.fields = {};
+        options.infoFrame = mpeg_test::InfoFrameKind::vbri;
+        checkStream(options, 1000, "VBRI frame gives the length");
+    }
+
+    {
+        mpeg_test::StreamOptions options;
+        options.infoFrame = mpeg_test::InfoFrameKind::xing;
+        const auto stream = mpeg_test::writeStream(10, options);
+        const auto header = sfb::mpeg::parseFrameHeader(stream.data.data(), stream.data.size());
+        const auto truncated = sfb::mpeg::xingOffset(*header) + 10;
+        check(header && !sfb::mpeg::parseInfoFrame(stream.data.data(), truncated, *header),
+              "truncated Xing frame is rejected");
+
+        sfb::mpeg::InfoFrame info;
+        info.frames = 2;
+        info.hasGaplessInfo = true;
+        info.encoderDelay = 2000;
+        info.encoderPadding = 304;
+        check(!sfb::mpeg::audioFrameCount(info, *header), "gapless information longer than the stream is rejected");
+        info.frames = 0;
+        check(!sfb::mpeg::audioFrameCount(info, *header), "Xing frame without a frame count gives no length");
+
+        options.fields.layer = 2;
+        const auto layer2 = mpeg_test::writeStream(10, options);
+        const auto layer2Header = sfb::mpeg::parseFrameHeader(layer2.data.data(), layer2.data.size());
+        check(layer2Header && !sfb::mpeg::parseInfoFrame(layer2.data.data(), layer2.data.size(), *layer2Header),
+              "layer II frames are not info frames");
+    }
+
+    {
+        std::mt19937 generator{42};
+        std::vector<unsigned char> noise(1 << 20);
+        for (auto &byte : noise) {
+            byte = static_cast<unsigned char>(generator());
+        }
+        std::size_t falseSyncs = 0;
+        sfb::mpeg::FrameHeader header;
+        for (std::size_t offset = 0; offset < noise.size();) {
+            offset += sfb::mpeg::findFrame(noise.data() + offset, noise.size() - offset, header);
+            if (offset < noise.size()) {
+                ++falseSyncs;
+                ++offset;
+            }
+        }
+        std::printf("      %zu false frame syncs in 1 MiB of noise\n", falseSyncs);
+        check(falseSyncs == 0, "no frames are found in noise");
+    }
+
+    return sfb_test::summarize();
+}
@@ -0,0 +1,87 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Benchmark for finding the length of MP3 streams from the info frame against scanning every frame header.
+//
+// The parser is plain C++ so this builds anywhere, including Linux, as part of Tests/CMakeLists.txt.
+//
+// Streams of one hour are written by the test writer with a Xing frame. The length is found by parsing the info frame,
+// as SFBMPEGDecoder does when opened, and by walking every frame header in memory, a lower bound on the cost of the
+// scan previously performed when opening, which also reads the entire file. Both lengths must agree.
+
+#include <chrono>
+#include <cstdio>
+
+#include "MPEGInfoFrame.hpp"
+#include "mpeg_stream.h"
+#include "test_harness.h"
+
+namespace {
+
+constexpr double kDurationSeconds = 3600;
+constexpr int kPasses = 5;
+
+void runBenchmark(const mpeg_test::HeaderFields &fields, const char *name) {
+    mpeg_test::StreamOptions options;
+    options.fields = fields;
+    options.infoFrame = mpeg_test::InfoFrameKind::xing;
+    options.id3v2Size = 64 * 1024;
+
+    const auto first = mpeg_test::makeFrameHeader(fields, false);
+    const auto parameters = *sfb::mpeg::parseFrameHeader(first.data(), first.size());
+    const auto frames = static_cast<std::size_t>(kDurationSeconds * parameters.sampleRate / parameters.samplesPerFrame);
+    const auto stream = mpeg_test::writeStream(frames, options);
+    const auto *data = stream.data.data();
+    const auto size = stream.data.size();
+
+    std::printf("%s, %zu frames, %.1f MiB\n", name, frames, static_cast<double>(size) / (1024 * 1024));
+
+    std::uint64_t infoLength = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < kPasses; ++pass) {
+        sfb::mpeg::FrameHeader header;
+        const auto offset = sfb::mpeg::findFrame(data + options.id3v2Size, size - options.id3v2Size, header) +
+                            options.id3v2Size;
+        const auto info = sfb::mpeg::parseInfoFrame(data + offset, size - offset, header);
+        infoLength = info ? sfb::mpeg::audioFrameCount(*info, header).value_or(0) : 0;
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("  %-24s %12.1f µs\n", "info frame", elapsed.count() / kPasses);
+
+    std::uint64_t scannedLength = 0;
+    start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < kPasses; ++pass) {
+        std::uint64_t samples = 0;
+        auto offset = stream.frameOffsets.front();
+        // Skip the info frame
+        offset += sfb::mpeg::parseFrameHeader(data + offset, size - offset)->size;
+        while (offset < size) {
+            const auto header = sfb::mpeg::parseFrameHeader(data + offset, size - offset);
+            if (!header) {
+                break;
+            }
+            samples += header->samplesPerFrame;
+            offset += header->size;
+        }
+        scannedLength = samples - options.encoderDelay - options.encoderPadding;
+    }
+    elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("  %-24s %12.1f µs\n", "scanning frame headers", elapsed.count() / kPasses);
+
+    if (infoLength == 0 || infoLength != scannedLength) {
+        sfb_test::fail("info frame length %llu differs from scanned length %llu",
+                       static_cast<unsigned long long>(infoLength), static_cast<unsigned long long>(scannedLength));
+    }
+}
+
+} /* namespace */
+
+int main() {
+    runBenchmark({}, "MPEG-1 layer III 128 kbps 44.1 kHz");
+    runBenchmark({2, 3, false, 8, 0, true}, "MPEG-2 layer III 64 kbps 22.05 kHz mono");
+    return sfb_test::exitStatus();
+}
@@ -0,0 +1,171 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Writes MPEG audio streams of frames holding random data, optionally preceded by an ID3v2 tag and a Xing, Info or
+// VBRI frame, used to generate test streams for the MPEG info frame checks and the length benchmark.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "MPEGInfoFrame.hpp"
+
+namespace mpeg_test {
+
+/// The fields of a frame header
+struct HeaderFields {
+    /// `3` for MPEG-1, `2` for MPEG-2 and `0` for MPEG-2.5
+    unsigned versionBits{3};
+    unsigned layer{3};
+    bool protection{false};
+    unsigned bitrateIndex{9};
+    unsigned sampleRateIndex{0};
+    bool mono{false};
+};
+
+/// Returns the frame header with `fields`
+inline std::vector<unsigned char> makeFrameHeader(const HeaderFields &fields, bool padding) {
+    return {0xFF,
+            static_cast<unsigned char>(0xE0 | (fields.versionBits << 3) | ((4 - fields.layer) << 1) |
+                                       (fields.protection ? 0 : 1)),
+            static_cast<unsigned char>((fields.bitrateIndex << 4) | (fields.sampleRateIndex << 2) | (padding ? 2 : 0)),
+            static_cast<unsigned char>(fields.mono ? 0xC0 : 0x40)};
+}
+
+/// The info frame written at the start of a stream
+enum class InfoFrameKind { none, xing, info, vbri };
+
+/// Stream options
+struct StreamOptions {
+    HeaderFields fields;
+    InfoFrameKind infoFrame{InfoFrameKind::none};
+    /// Whether a Xing or Info frame holds a LAME extension
+    bool lameExtension{true};
+    std::uint32_t encoderDelay{576};
+    std::uint32_t encoderPadding{1000};
+    /// The size of the ID3v2 tag preceding the stream, or `0` for none
+    std::size_t id3v2Size{0};
+    unsigned seed{1};
+};
+
+/// A written stream
+struct Stream {
+    std::vector<unsigned char> data;
+    /// The offset of each frame, including any info frame
+    std::vector<std::size_t> frameOffsets;
+};
+
+namespace detail {
+
+inline void putUInt32(unsigned char *p, std::uint32_t value) {
+    p[0] = static_cast<unsigned char>(value >> 24);
+    p[1] = static_cast<unsigned char>(value >> 16);
+    p[2] = static_cast<unsigned char>(value >> 8);
+    p[3] = static_cast<unsigned char>(value);
+}
+
+/// Appends a frame with `fields` and `padding` filled with random bytes and returns its offset
+inline std::size_t appendFrame(Stream &stream, const HeaderFields &fields, bool padding, std::mt19937 &generator) {
+    const auto header = makeFrameHeader(fields, padding);
+    const auto parsed = sfb::mpeg::parseFrameHeader(header.data(), header.size());
+    const auto offset = stream.data.size();
+    stream.data.insert(stream.data.end(), header.begin(), header.end());
+    for (auto i = header.size(); i < parsed->size; ++i) {
+        stream.data.push_back(static_cast<unsigned char>(generator()));
+    }
+    stream.frameOffsets.push_back(offset);
+    return offset;
+}
+
+} /* namespace detail */
+
+/// Writes a stream of `frames` audio frames with `options`
+inline Stream writeStream(std::size_t frames, const StreamOptions &options) {
+    std::mt19937 generator{options.seed};
+    Stream stream;
+
+    if (options.id3v2Size > 0) {
+        const auto size = options.id3v2Size - 10;
+        stream.data = {'I',
+                       'D',
+                       '3',
+                       4,
+                       0,
+                       0,
+                       static_cast<unsigned char>((size >> 21) & 0x7F),
+                       static_cast<unsigned char>((size >> 14) & 0x7F),
+                       static_cast<unsigned char>((size >> 7) & 0x7F),
+                       static_cast<unsigned char>(size & 0x7F)};
+        // Tag data may hold false frame syncs
+        for (std::size_t i = 0; i < size; ++i) {
+            stream.data.push_back(i % 7 == 0 ? 0xFF : static_cast<unsigned char>(generator()));
+        }
+    }
+
+    std::size_t infoOffset = 0;
+    if (options.infoFrame != InfoFrameKind::none) {
+        infoOffset = detail::appendFrame(stream, options.fields, false, generator);
+        std::fill(stream.data.begin() + static_cast<std::ptrdiff_t>(infoOffset + 4), stream.data.end(), 0);
+    }
+
+    // Pad frames as an encoder would to hold the mean frame size to the bitrate
+    const auto header = makeFrameHeader(options.fields, false);
+    const auto parsed = *sfb::mpeg::parseFrameHeader(header.data(), header.size());
+    const auto numerator = parsed.layer == 1 ? std::uint64_t{12} * parsed.bitrate
+                                             : std::uint64_t{parsed.samplesPerFrame} / 8 * parsed.bitrate;
+    std::uint64_t remainder = 0;
+    for (std::size_t i = 0; i < frames; ++i) {
+        remainder += numerator % parsed.sampleRate;
+        const bool padding = remainder >= parsed.sampleRate;
+        if (padding) {
+            remainder -= parsed.sampleRate;
+        }
+        detail::appendFrame(stream, options.fields, padding, generator);
+    }
+
+    if (options.infoFrame == InfoFrameKind::none) {
+        return stream;
+    }
+
+    auto *frame = stream.data.data() + infoOffset;
+    const auto bytes = static_cast<std::uint32_t>(stream.data.size() - infoOffset);
+    if (options.infoFrame == InfoFrameKind::vbri) {
+        auto *vbri = frame + sfb::mpeg::vbriOffset;
+        std::copy_n("VBRI", 4, vbri);
+        vbri[5] = 1;
+        detail::putUInt32(vbri + 10, bytes);
+        detail::putUInt32(vbri + 14, static_cast<std::uint32_t>(frames));
+        return stream;
+    }
+
+    auto *xing = frame + sfb::mpeg::xingOffset(parsed);
+    std::copy_n(options.infoFrame == InfoFrameKind::xing ? "Xing" : "Info", 4, xing);
+    // Frames, bytes, seek table and quality
+    detail::putUInt32(xing + 4, 0xF);
+    detail::putUInt32(xing + 8, static_cast<std::uint32_t>(frames));
+    detail::putUInt32(xing + 12, bytes);
+    for (int i = 0; i < 100; ++i) {
+        xing[16 + i] = static_cast<unsigned char>(i * 256 / 100);
+    }
+    detail::putUInt32(xing + 116, 57);
+
+    if (options.lameExtension) {
+        auto *lame = xing + 120;
+        std::copy_n("LAME3.100", 9, lame);
+        lame[21] = static_cast<unsigned char>(options.encoderDelay >> 4);
+        lame[22] = static_cast<unsigned char>(((options.encoderDelay & 0xF) << 4) | (options.encoderPadding >> 8));
+        lame[23] = static_cast<unsigned char>(options.encoderPadding);
+    }
+
+    return stream;
+}
+
+} /* namespace mpeg_test */
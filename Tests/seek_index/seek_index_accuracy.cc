@@ -0,0 +1,186 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Checks for the seek indexes decoders build while decoding and the cache persisting them.
+//
+// The index and cache are plain C++ over POSIX so this builds anywhere, including Linux, as part of
+// Tests/CMakeLists.txt.
+//
+// Serialized indexes must round trip points and states and find the last point at or before any frame. Indexes of
+// another format or state size, and truncated or padded indexes, must be rejected. Cached indexes must be found only
+// for the file identity they were stored for, and when contents are verified only if stored with the same hash.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "SeekIndexCache.hpp"
+#include "test_harness.h"
+
+namespace {
+
+using sfb_test::check;
+
+constexpr uint32_t kFormat = 0x54455354; // 'TEST'
+
+/// Decoder state of a size that is not a multiple of eight bytes
+struct State {
+    uint32_t words[5];
+};
+
+/// Returns an index of `count` points every 4096 frames with offsets and states derived from the frame
+sfb::SeekIndexBuilder makeIndex(std::size_t count) {
+    sfb::SeekIndexBuilder index{kFormat, sizeof(State)};
+    for (std::size_t i = 0; i < count; ++i) {
+        const uint64_t frame = i * 4096;
+        State state;
+        for (uint32_t j = 0; j < 5; ++j) {
+            state.words[j] = static_cast<uint32_t>(frame) + j;
+        }
+        index.append({frame, (frame * 3) + 100}, &state);
+    }
+    return index;
+}
+
+/// Returns true if `index` holds the points and states written by `makeIndex(count)`
+bool holdsIndex(const sfb::SeekIndexView &index, std::size_t count) {
+    if (index.count() != count) {
+        return false;
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto point = index.point(i);
+        State state;
+        std::memcpy(&state, index.state(i), sizeof state);
+        if (point.frame_ != i * 4096 || point.offset_ != (point.frame_ * 3) + 100 ||
+            state.words[4] != static_cast<uint32_t>(point.frame_) + 4) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Writes `size` bytes to the file at `path`
+bool writeFile(const std::string &path, std::size_t size) {
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    const std::vector<unsigned char> data(size, 0x5A);
+    const bool written = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    return std::fclose(file) == 0 && written;
+}
+
+} /* namespace */
+
+int main() {
+    {
+        const auto data = makeIndex(1000).serialize(4096000);
+        const auto index = sfb::SeekIndexView::make(data.data(), data.size(), kFormat, sizeof(State));
+        check(index && holdsIndex(*index, 1000) && index->frameLength() == 4096000,
+              "serialized index holds every point and state and the frame length");
+
+        const auto statePadding = reinterpret_cast<std::uintptr_t>(index->state(1)) -
+                                  reinterpret_cast<std::uintptr_t>(index->state(0));
+        check(statePadding == 24, "states are padded to multiples of eight bytes");
+
+        check(index->find(0) == 0, "frame 0 is found at the first point");
+        check(index->find(4095) == 0 && index->find(4096) == 1 && index->find(4097) == 1,
+              "frames are found at the last point at or before them");
+        check(index->find(UINT64_MAX) == 999, "frames past the last point are found at the last point");
+    }
+
+    {
+        sfb::SeekIndexBuilder index{kFormat, 0};
+        index.append({100, 1}, nullptr);
+        index.append({100, 2}, nullptr);
+        index.append({50, 3}, nullptr);
+        index.append({200, 4}, nullptr);
+        const auto data = index.serialize(0);
+        const auto view = sfb::SeekIndexView::make(data.data(), data.size(), kFormat, 0);
+        check(view && view->count() == 2 && view->point(1).offset_ == 4,
+              "points not following the last point are ignored");
+        check(view && !view->find(99) && view->find(100) == 0, "frames before the first point are not found");
+    }
+
+    {
+        auto data = makeIndex(10).serialize(0);
+        check(!sfb::SeekIndexView::make(data.data(), data.size(), kFormat + 1, sizeof(State)),
+              "index of another format is rejected");
+        check(!sfb::SeekIndexView::make(data.data(), data.size(), kFormat, sizeof(State) + 1),
+              "index with another state size is rejected");
+        check(!sfb::SeekIndexView::make(data.data(), data.size() - 8, kFormat, sizeof(State)),
+              "truncated index is rejected");
+        data.resize(data.size() + 8);
+        check(!sfb::SeekIndexView::make(data.data(), data.size(), kFormat, sizeof(State)),
+              "index followed by extra bytes is rejected");
+        const auto empty = sfb::SeekIndexBuilder{kFormat, sizeof(State)}.serialize(0);
+        check(!sfb::SeekIndexView::make(empty.data(), empty.size(), kFormat, sizeof(State)),
+              "empty index is rejected");
+        check(!sfb::SeekIndexView::make(data.data(), 16, kFormat, sizeof(State)), "partial header is rejected");
+    }
+
+    {
+        char directoryTemplate[] = "/tmp/seek_index_XXXXXX";
+        const char *directory = mkdtemp(directoryTemplate);
+        check(directory != nullptr, "temporary directory is created");
+        if (directory == nullptr) {
+            return sfb_test::summarize();
+        }
+
+        const std::string audioPath = std::string{directory} + "/audio";
+        const std::string cachePath = std::string{directory} + "/cache";
+        writeFile(audioPath, 1000);
+        const auto identity = sfb::FileIdentity::forPath(audioPath.c_str(), false);
+
+        const sfb::SeekIndexCache cache{cachePath};
+        check(identity && !cache.find(*identity, kFormat, sizeof(State)), "no index is found before one is stored");
+        check(identity && !cache.store(*identity, sfb::SeekIndexBuilder{kFormat, sizeof(State)}, 0),
+              "empty index is not stored");
+        check(identity && cache.store(*identity, makeIndex(500), 2048000), "index is stored");
+
+        const auto entry = cache.find(*identity, kFormat, sizeof(State));
+        check(entry && holdsIndex(entry->index(), 500) && entry->index().frameLength() == 2048000,
+              "stored index is found for the same file");
+        check(entry && reinterpret_cast<std::uintptr_t>(entry->index().state(0)) % 8 == 0,
+              "states of a cached index are eight byte aligned");
+        check(!cache.find(*identity, kFormat + 1, sizeof(State)), "stored index is not found for another format");
+
+        check(identity && cache.store(*identity, makeIndex(20), 81920), "index is replaced");
+        const auto replaced = cache.find(*identity, kFormat, sizeof(State));
+        check(replaced && holdsIndex(replaced->index(), 20), "replaced index is found");
+        check(entry && holdsIndex(entry->index(), 500), "index found before replacement remains valid");
+
+        const auto hashed = sfb::FileIdentity::forPath(audioPath.c_str(), true);
+        check(hashed && !cache.find(*hashed, kFormat, sizeof(State)),
+              "index stored without a content hash is not found when contents are verified");
+        check(hashed && cache.store(*hashed, makeIndex(30), 122880), "index is stored with a content hash");
+        const auto verified = cache.find(*hashed, kFormat, sizeof(State));
+        check(verified && holdsIndex(verified->index(), 30), "index stored with a content hash is found when verified");
+        check(identity && cache.find(*identity, kFormat, sizeof(State)),
+              "index stored with a content hash is found when contents are not verified");
+        auto otherContents = *hashed;
+        otherContents.contentHash_ ^= 2;
+        check(!cache.find(otherContents, kFormat, sizeof(State)), "index is not found for a different content hash");
+
+        writeFile(audioPath, 2000);
+        const auto changed = sfb::FileIdentity::forPath(audioPath.c_str(), false);
+        check(changed && !cache.find(*changed, kFormat, sizeof(State)),
+              "stored index is not found once the file changes");
+
+        std::string command = "rm -rf '" + std::string{directory} + "'";
+        if (std::system(command.c_str()) != 0) {
+            std::printf("      unable to remove %s\n", directory);
+        }
+    }
+
+    return sfb_test::summarize();
+}
@@ -0,0 +1,113 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Benchmark for storing, opening and searching cached seek indexes.
+//
+// The index and cache are plain C++ over POSIX so this builds anywhere, including Linux, as part of
+// Tests/CMakeLists.txt.
+//
+// Indexes for one hour of 44.1 kHz audio are built with the spacing and state size used by the Shorten decoder, with
+// the spacing used by the FLAC decoder, and with a point per MPEG frame. Opening a cached index maps it and verifies
+// its hash, the cost paid once when a decoder is opened; searching it is the cost paid by each seek.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "SeekIndexCache.hpp"
+#include "test_harness.h"
+
+namespace {
+
+constexpr uint64_t kFrameLength = 3600 * 44100;
+constexpr uint32_t kFormat = 0x54455354; // 'TEST'
+constexpr int kOpenPasses = 100;
+constexpr int kSeeks = 1000000;
+
+void runBenchmark(const sfb::SeekIndexCache &cache, const sfb::FileIdentity &identity, uint64_t spacing,
+                  std::size_t stateSize, const char *name) {
+    sfb::SeekIndexBuilder builder{kFormat, stateSize};
+    const std::vector<unsigned char> state(stateSize, 0xA5);
+    for (uint64_t frame = 0; frame < kFrameLength; frame += spacing) {
+        builder.append({frame, frame / 2}, state.data());
+    }
+
+    std::printf("%s, %zu points\n", name, builder.count());
+
+    auto start = std::chrono::steady_clock::now();
+    const bool stored = cache.store(identity, builder, kFrameLength);
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("  %-24s %12.1f µs\n", "store", elapsed.count());
+
+    start = std::chrono::steady_clock::now();
+    std::size_t found = 0;
+    for (int pass = 0; pass < kOpenPasses; ++pass) {
+        found += cache.find(identity, kFormat, stateSize) ? 1 : 0;
+    }
+    elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("  %-24s %12.1f µs\n", "open", elapsed.count() / kOpenPasses);
+
+    const auto entry = cache.find(identity, kFormat, stateSize);
+    if (!stored || !entry || found != kOpenPasses) {
+        sfb_test::fail("%s index was not cached", name);
+        return;
+    }
+
+    std::mt19937_64 generator{1};
+    std::uniform_int_distribution<uint64_t> frames{0, kFrameLength - 1};
+    uint64_t mismatches = 0;
+    start = std::chrono::steady_clock::now();
+    for (int seek = 0; seek < kSeeks; ++seek) {
+        const auto frame = frames(generator);
+        const auto point = entry->index().point(*entry->index().find(frame));
+        mismatches += point.frame_ != frame - (frame % spacing) ? 1 : 0;
+    }
+    elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("  %-24s %12.3f µs\n", "find", elapsed.count() / kSeeks);
+
+    if (mismatches != 0) {
+        sfb_test::fail("%llu seeks found the wrong point", static_cast<unsigned long long>(mismatches));
+    }
+}
+
+} /* namespace */
+
+int main() {
+    char directoryTemplate[] = "/tmp/seek_index_XXXXXX";
+    const char *directory = mkdtemp(directoryTemplate);
+    if (directory == nullptr) {
+        sfb_test::fail("unable to create a temporary directory");
+        return sfb_test::exitStatus();
+    }
+
+    const std::string audioPath = std::string{directory} + "/audio";
+    if (std::FILE *file = std::fopen(audioPath.c_str(), "wb"); file != nullptr) {
+        std::fputs("audio", file);
+        std::fclose(file);
+    }
+    const auto identity = sfb::FileIdentity::forPath(audioPath.c_str(), false);
+    if (!identity) {
+        sfb_test::fail("unable to identify %s", audioPath.c_str());
+        return sfb_test::exitStatus();
+    }
+
+    const sfb::SeekIndexCache cache{std::string{directory} + "/cache"};
+    runBenchmark(cache, *identity, 25600, 80, "Shorten, 80 byte states every 25600 frames");
+    runBenchmark(cache, *identity, 16384, 0, "FLAC, a point every 16384 frames");
+    runBenchmark(cache, *identity, 1152, 0, "MPEG, a point every frame");
+
+    const std::string command = "rm -rf '" + std::string{directory} + "'";
+    if (std::system(command.c_str()) != 0) {
+        std::printf("      unable to remove %s\n", directory);
+    }
+
+    return sfb_test::exitStatus();
+}
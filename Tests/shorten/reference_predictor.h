@@ -0,0 +1,68 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// The sample reconstruction and conversion loops formerly used by SFBShortenDecoder.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace reference {
+
+/// Reconstructs samples with the fixed predictor of `order`, as formerly done for the DIFF0 through DIFF3 commands
+inline void restoreFixed(int order, int32_t *chanBuffer, int blocksize, int32_t chanOffset) {
+    switch (order) {
+    case 0:
+        for (auto i = 0; i < blocksize; ++i) {
+            chanBuffer[i] += chanOffset;
+        }
+        break;
+    case 1:
+        for (auto i = 0; i < blocksize; ++i) {
+            chanBuffer[i] += chanBuffer[i - 1];
+        }
+        break;
+    case 2:
+        for (auto i = 0; i < blocksize; ++i) {
+            chanBuffer[i] += (2 * chanBuffer[i - 1] - chanBuffer[i - 2]);
+        }
+        break;
+    case 3:
+        for (auto i = 0; i < blocksize; ++i) {
+            chanBuffer[i] += (3 * (chanBuffer[i - 1] - chanBuffer[i - 2])) + chanBuffer[i - 3];
+        }
+        break;
+    }
+}
+
+/// Reconstructs samples with a linear predictor, as formerly done for the QLPC command
+inline void restoreLPC(int32_t *chanBuffer, int blocksize, const int *qlpc, int lpc, int32_t lpcQuantOffset,
+                       int shift) {
+    for (auto i = 0; i < blocksize; ++i) {
+        int32_t sum = lpcQuantOffset;
+
+        for (auto j = 0; j < lpc; ++j) {
+            sum += qlpc[j] * chanBuffer[i - j - 1];
+        }
+        chanBuffer[i] += (sum >> shift);
+    }
+}
+
+/// Converts samples to `T`, as formerly done for each file type
+template <typename T>
+void convertSamples(const int32_t *buffer, T *channel_buf, int blocksize, int bitshift) {
+    for (auto sample = 0; sample < blocksize; ++sample) {
+        const auto value = buffer[sample] << bitshift;
+        channel_buf[sample] = static_cast<T>(std::clamp(value, static_cast<int32_t>(std::numeric_limits<T>::min()),
+                                                        static_cast<int32_t>(std::numeric_limits<T>::max())));
+    }
+}
+
+} /* namespace reference */
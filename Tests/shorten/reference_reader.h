@@ -0,0 +1,202 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// The variable-length input formerly used by SFBShortenDecoder, with the Objective-C block callback replaced by
+// std::function, and a Rice-Golomb writer producing Shorten bitstreams.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace reference {
+
+/// The 32-bit variable-length input formerly used by SFBShortenDecoder
+class VariableLengthInput {
+  public:
+    static constexpr uint32_t maskTable_[] = {
+            0x0,       0x1,       0x3,        0x7,        0xf,        0x1f,      0x3f,     0x7f,      0xff,
+            0x1ff,     0x3ff,     0x7ff,      0xfff,      0x1fff,     0x3fff,    0x7fff,   0xffff,    0x1ffff,
+            0x3ffff,   0x7ffff,   0xfffff,    0x1fffff,   0x3fffff,   0x7fffff,  0xffffff, 0x1ffffff, 0x3ffffff,
+            0x7ffffff, 0xfffffff, 0x1fffffff, 0x3fffffff, 0x7fffffff, 0xffffffff};
+
+    using InputCallback = std::function<bool(void *buf, std::size_t len, std::size_t &read)>;
+
+    ~VariableLengthInput() { delete[] byteBuffer_; }
+
+    void setInputCallback(InputCallback callback) { inputCallback_ = std::move(callback); }
+
+    bool allocate(std::size_t size = 512) {
+        byteBuffer_ = new unsigned char[size];
+        byteBufferPosition_ = byteBuffer_;
+        size_ = size;
+        return true;
+    }
+
+    bool getRiceGolombCode(int32_t &i32, int k) {
+        if (k < 0 || k > 31) {
+            return false;
+        }
+
+        if (bitsAvailable_ == 0 && !refillBitBuffer()) {
+            return false;
+        }
+
+        int32_t result;
+        for (result = 0; !(bitBuffer_ & (1L << --bitsAvailable_)); ++result) {
+            if (bitsAvailable_ == 0 && !refillBitBuffer()) {
+                return false;
+            }
+        }
+
+        while (k != 0) {
+            if (bitsAvailable_ >= k) {
+                result = (result << k) | static_cast<int32_t>((bitBuffer_ >> (bitsAvailable_ - k)) & maskTable_[k]);
+                bitsAvailable_ -= k;
+                k = 0;
+            } else {
+                result = (result << bitsAvailable_) | static_cast<int32_t>(bitBuffer_ & maskTable_[bitsAvailable_]);
+                k -= bitsAvailable_;
+                if (!refillBitBuffer()) {
+                    return false;
+                }
+            }
+        }
+
+        i32 = result;
+        return true;
+    }
+
+    bool getInt32(int32_t &i32, int k) {
+        int32_t var;
+        if (!getRiceGolombCode(var, k + 1)) {
+            return false;
+        }
+
+        uint32_t uvar = static_cast<uint32_t>(var);
+        if (uvar & 1) {
+            i32 = ~(uvar >> 1);
+        } else {
+            i32 = (uvar >> 1);
+        }
+        return true;
+    }
+
+    bool getUInt32(uint32_t &ui32, int version, int k) {
+        if (version > 0 && !getRiceGolombCode(k, 2)) {
+            return false;
+        }
+
+        int32_t i32;
+        if (!getRiceGolombCode(i32, k)) {
+            return false;
+        }
+        ui32 = static_cast<uint32_t>(i32);
+        return true;
+    }
+
+    bool refill() {
+        std::size_t bytesRead = 0;
+        if (!inputCallback_ || !inputCallback_(byteBuffer_, size_, bytesRead) || bytesRead < 4) {
+            return false;
+        }
+        bytesAvailable_ += bytesRead;
+        byteBufferPosition_ = byteBuffer_;
+        return true;
+    }
+
+    InputCallback inputCallback_;
+    std::size_t size_ = 0;
+    unsigned char *byteBuffer_ = nullptr;
+    unsigned char *byteBufferPosition_ = nullptr;
+    int bytesAvailable_ = 0;
+    uint32_t bitBuffer_ = 0;
+    int bitsAvailable_ = 0;
+
+    bool refillBitBuffer() {
+        if (bytesAvailable_ < 4 && !refill()) {
+            return false;
+        }
+
+        bitBuffer_ = static_cast<uint32_t>((static_cast<int32_t>(byteBufferPosition_[0]) << 24) |
+                                           (static_cast<int32_t>(byteBufferPosition_[1]) << 16) |
+                                           (static_cast<int32_t>(byteBufferPosition_[2]) << 8) |
+                                           static_cast<int32_t>(byteBufferPosition_[3]));
+
+        byteBufferPosition_ += 4;
+        bytesAvailable_ -= 4;
+        bitsAvailable_ = 32;
+
+        return true;
+    }
+};
+
+/// Writes Shorten Rice-Golomb codes most significant bit first, padded to 32-bit words like the Shorten encoder
+class RiceWriter {
+  public:
+    void putBits(uint32_t value, int count) {
+        for (int bit = count - 1; bit >= 0; --bit) {
+            putBit((value >> bit) & 1);
+        }
+    }
+
+    void putRiceGolombCode(uint32_t value, int k) {
+        for (uint32_t quotient = k == 32 ? 0 : value >> k; quotient > 0; --quotient) {
+            putBit(0);
+        }
+        putBit(1);
+        putBits(value, k);
+    }
+
+    void putInt32(int32_t value, int k) {
+        const auto u = static_cast<uint32_t>(value);
+        putRiceGolombCode(value < 0 ? ((~u) << 1) | 1 : u << 1, k + 1);
+    }
+
+    void putUInt32(uint32_t value, int version, int k) {
+        if (version > 0) {
+            putRiceGolombCode(static_cast<uint32_t>(k), 2);
+        }
+        putRiceGolombCode(value, k);
+    }
+
+    /// Returns the stream padded to a whole number of words
+    std::vector<unsigned char> finish() {
+        while (bitCount_ % 32 != 0) {
+            putBit(0);
+        }
+        return bytes_;
+    }
+
+  private:
+    std::vector<unsigned char> bytes_;
+    std::size_t bitCount_ = 0;
+
+    void putBit(uint32_t bit) {
+        if (bitCount_ % 8 == 0) {
+            bytes_.push_back(0);
+        }
+        bytes_.back() |= static_cast<unsigned char>(bit << (7 - (bitCount_ % 8)));
+        ++bitCount_;
+    }
+};
+
+/// Returns an input callback reading `bytes` starting at `offset`
+inline std::function<bool(void *, std::size_t, std::size_t &)> makeInput(const std::vector<unsigned char> &bytes,
+                                                                         std::size_t &offset) {
+    return [&bytes, &offset](void *buf, std::size_t len, std::size_t &read) {
+        read = std::min(len, bytes.size() - offset);
+        std::copy_n(bytes.data() + offset, read, static_cast<unsigned char *>(buf));
+        offset += read;
+        return true;
+    };
+}
+
+} /* namespace reference */
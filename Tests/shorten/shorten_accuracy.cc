@@ -0,0 +1,516 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Accuracy checks for sfb::shorten::BitReader and the Shorten predictors.
+//
+// The Shorten bit reader and predictors are plain C++ so this builds anywhere, including Linux, as part of
+// Tests/CMakeLists.txt.
+//
+// Random sequences of Shorten codes covering every Rice-Golomb parameter, unary quotients longer than the reservoir
+// and codes straddling buffer boundaries are written and read back with the reader formerly used by SFBShortenDecoder
+// and the new one. States saved by the former reader, as stored in Shorten seek tables, must translate to the bit
+// positions reported by the new reader, which must resume from those positions with any buffer size. The new reader
+// must also fail cleanly on truncated input. Peeking at bits, as done when recording seek points, must not consume
+// them.
+//
+// Seek table entries written from seek points recorded with the new reader must match the states of the former reader
+// reading blocks of the seek table buffer size, including states at the end of a block, and must parse back to the
+// same seek points.
+//
+// Samples reconstructed by every fixed predictor and by linear predictors of every specialized order and beyond must
+// match the loops formerly used by SFBShortenDecoder, as must conversion to each sample format for block sizes covering
+// the vector loops and their scalar tails. Nothing outside the block may be written.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "ShortenBitReader.hpp"
+#include "ShortenPredictor.hpp"
+#include "ShortenSeekTable.hpp"
+#include "reference_predictor.h"
+#include "reference_reader.h"
+#include "test_harness.h"
+
+namespace {
+
+using sfb_test::check;
+
+/// A read of one or more values
+struct Operation {
+    enum class Kind { riceGolombCode, int32, int32s, uint32 } kind;
+    int k;
+    std::vector<int32_t> values;
+};
+
+/// Returns `count` random operations and writes them to `writer`
+std::vector<Operation> makeOperations(std::mt19937 &generator, std::size_t count, reference::RiceWriter &writer) {
+    std::uniform_int_distribution<int> kind{0, 3};
+    std::uniform_int_distribution<int> percent{0, 99};
+    std::vector<Operation> operations;
+
+    // Values are mostly near 2^k with occasional outliers producing long unary quotients
+    const auto magnitude = [&](int k) {
+        const auto extra = percent(generator) < 3 ? 200 : 4;
+        return std::uniform_int_distribution<uint32_t>{0, (static_cast<uint32_t>(extra) << k) - 1}(generator);
+    };
+
+    for (std::size_t i = 0; i < count; ++i) {
+        Operation operation;
+        switch (kind(generator)) {
+        case 0: {
+            operation.kind = Operation::Kind::riceGolombCode;
+            operation.k = std::uniform_int_distribution<int>{0, 31}(generator);
+            // Large parameters use the full range of the value instead of a short quotient
+            auto value = magnitude(std::min(operation.k, 23));
+            if (operation.k > 23) {
+                value = std::uniform_int_distribution<uint32_t>{0, 0x7FFFFFFF}(generator) >> (31 - operation.k);
+            }
+            operation.values.push_back(static_cast<int32_t>(value));
+            writer.putRiceGolombCode(value, operation.k);
+            break;
+        }
+        case 1:
+        case 2: {
+            const bool batch = kind(generator) < 2;
+            operation.kind = batch ? Operation::Kind::int32s : Operation::Kind::int32;
+            operation.k = std::uniform_int_distribution<int>{-1, 20}(generator);
+            const auto n = batch ? std::uniform_int_distribution<std::size_t>{1, 600}(generator) : 1;
+            for (std::size_t j = 0; j < n; ++j) {
+                const auto u = magnitude(operation.k + 1);
+                const auto value = (u & 1) ? static_cast<int32_t>(~(u >> 1)) : static_cast<int32_t>(u >> 1);
+                operation.values.push_back(value);
+                writer.putInt32(value, operation.k);
+            }
+            break;
+        }
+        default: {
+            operation.kind = Operation::Kind::uint32;
+            operation.k = std::uniform_int_distribution<int>{0, 16}(generator);
+            const auto value = magnitude(operation.k);
+            operation.values.push_back(static_cast<int32_t>(value));
+            writer.putUInt32(value, 2, operation.k);
+            break;
+        }
+        }
+        operations.push_back(std::move(operation));
+    }
+    return operations;
+}
+
+/// Performs `operation` with `reader` and returns whether the expected values were read
+template <typename Reader>
+bool perform(Reader &reader, const Operation &operation) {
+    std::vector<int32_t> values(operation.values.size());
+    bool ok = true;
+    switch (operation.kind) {
+    case Operation::Kind::riceGolombCode:
+        ok = reader.getRiceGolombCode(values[0], operation.k);
+        break;
+    case Operation::Kind::int32:
+        ok = reader.getInt32(values[0], operation.k);
+        break;
+    case Operation::Kind::int32s:
+        if constexpr (requires { reader.getInt32s(values.data(), values.size(), operation.k); }) {
+            ok = reader.getInt32s(values.data(), values.size(), operation.k);
+        } else {
+            for (auto &value : values) {
+                ok = ok && reader.getInt32(value, operation.k);
+            }
+        }
+        break;
+    case Operation::Kind::uint32: {
+        uint32_t u = 0;
+        ok = reader.getUInt32(u, 2, operation.k);
+        values[0] = static_cast<int32_t>(u);
+        break;
+    }
+    }
+    return ok && values == operation.values;
+}
+
+void checkSequences() {
+    bool referenceIdentical = true;
+    bool identical = true;
+    bool positioned = true;
+    bool peeked = true;
+    bool resumed = true;
+    bool truncated = true;
+
+    for (unsigned seed = 0; seed < 20; ++seed) {
+        std::mt19937 generator{seed};
+        reference::RiceWriter writer;
+        const auto operations = makeOperations(generator, 2000, writer);
+        const auto bytes = writer.finish();
+
+        // Read with the former reader, saving its state before every tenth operation
+        struct SavedState {
+            std::size_t operation;
+            std::size_t lastBufferReadPosition;
+            uint16_t byteBufferPosition;
+            uint16_t bytesAvailable;
+            uint32_t bitBuffer;
+            uint16_t bitsAvailable;
+        };
+        std::vector<SavedState> states;
+        {
+            std::size_t offset = 0;
+            std::size_t lastBufferReadPosition = 0;
+            reference::VariableLengthInput input;
+            input.allocate();
+            const auto read = reference::makeInput(bytes, offset);
+            input.setInputCallback([&](void *buf, std::size_t len, std::size_t &n) {
+                lastBufferReadPosition = offset;
+                return read(buf, len, n);
+            });
+            for (std::size_t i = 0; i < operations.size(); ++i) {
+                if (i % 10 == 0) {
+                    states.push_back({i, lastBufferReadPosition,
+                                      static_cast<uint16_t>(input.byteBufferPosition_ - input.byteBuffer_),
+                                      static_cast<uint16_t>(input.bytesAvailable_), input.bitBuffer_,
+                                      static_cast<uint16_t>(input.bitsAvailable_)});
+                }
+                referenceIdentical = referenceIdentical && perform(input, operations[i]);
+            }
+        }
+
+        // The offset of the next unread bit in a saved state
+        const auto bitOffset = [](const SavedState &state) {
+            return ((state.lastBufferReadPosition + state.byteBufferPosition) * 8) - state.bitsAvailable;
+        };
+
+        // Read with the new reader from the start
+        {
+            std::size_t offset = 0;
+            sfb::shorten::BitReader reader;
+            reader.allocate();
+            reader.setInputCallback(reference::makeInput(bytes, offset));
+            for (std::size_t i = 0; i < operations.size(); ++i) {
+                if (i % 10 == 0) {
+                    positioned = positioned && reader.bitPosition() == bitOffset(states[i / 10]);
+                }
+                if (const auto position = reader.bitPosition(); position + 32 <= bytes.size() * 8) {
+                    const auto bits = static_cast<int>(1 + (i % 32));
+                    uint32_t expected = 0;
+                    for (auto bit = position; bit < position + bits; ++bit) {
+                        expected = (expected << 1) | ((bytes[bit / 8] >> (7 - (bit % 8))) & 1);
+                    }
+                    uint32_t value = 0;
+                    peeked = peeked && reader.peekBits(value, bits) && value == expected &&
+                             reader.bitPosition() == position;
+                }
+                identical = identical && perform(reader, operations[i]);
+            }
+        }
+
+        // Resume the new reader from the saved states, translated to bit offsets, with various buffer sizes
+        for (std::size_t bufferSize : {std::size_t{13}, std::size_t{512}, std::size_t{4096}, std::size_t{65536}}) {
+            for (const auto &state : states) {
+                const auto bit = bitOffset(state);
+                std::size_t offset = bit / 8;
+                sfb::shorten::BitReader reader;
+                reader.allocate(bufferSize);
+                reader.setInputCallback(reference::makeInput(bytes, offset));
+                reader.reset(offset);
+                if (!reader.skipBits(static_cast<int>(bit % 8)) || reader.bitPosition() != bit) {
+                    resumed = false;
+                    continue;
+                }
+                for (auto i = state.operation; i < std::min(state.operation + 20, operations.size()); ++i) {
+                    resumed = resumed && perform(reader, operations[i]);
+                }
+            }
+        }
+
+        // Every operation must fail or succeed cleanly once the input runs out
+        {
+            const std::vector<unsigned char> prefix(bytes.begin(), bytes.begin() + (bytes.size() / 2) + seed);
+            std::size_t offset = 0;
+            sfb::shorten::BitReader reader;
+            reader.allocate();
+            reader.setInputCallback(reference::makeInput(prefix, offset));
+            std::size_t i = 0;
+            while (i < operations.size() && perform(reader, operations[i])) {
+                ++i;
+            }
+            truncated = truncated && i < operations.size();
+            for (; i < operations.size(); ++i) {
+                perform(reader, operations[i]);
+            }
+        }
+    }
+
+    check(referenceIdentical, "former reader reads the written codes");
+    check(identical, "reader matches the written codes");
+    check(positioned, "reader reports the positions saved by the former reader");
+    check(peeked, "reader peeks at bits without consuming them");
+    check(resumed, "reader resumes at bit offsets of states saved by the former reader");
+    check(truncated, "reader fails on truncated input");
+}
+
+/// Returns true if `a` and `b` hold the same state
+bool sameSeekPoint(const sfb::shorten::SeekPoint &a, const sfb::shorten::SeekPoint &b) {
+    return a.frameNumber_ == b.frameNumber_ && a.bitOffset_ == b.bitOffset_ && a.bitBuffer_ == b.bitBuffer_ &&
+           a.bitshift_ == b.bitshift_ && std::equal(a.chanBuf0_, a.chanBuf0_ + 3, b.chanBuf0_) &&
+           std::equal(a.chanBuf1_, a.chanBuf1_ + 3, b.chanBuf1_) &&
+           std::equal(a.offset0_, a.offset0_ + 4, b.offset0_) && std::equal(a.offset1_, a.offset1_ + 4, b.offset1_);
+}
+
+void checkSeekTables() {
+    bool matchesFormer = true;
+    bool roundTrips = true;
+    bool blockEndsRoundTrip = true;
+    std::size_t blockEnds = 0;
+
+    for (unsigned seed = 0; seed < 10; ++seed) {
+        std::mt19937 generator{100 + seed};
+        reference::RiceWriter writer;
+        const auto operations = makeOperations(generator, 2000, writer);
+        const auto stream = writer.finish();
+        std::uniform_int_distribution<int32_t> sample{INT32_MIN, INT32_MAX};
+
+        // Shorten bitstreams follow a five-byte header
+        for (std::size_t bitstreamOffset : {std::size_t{0}, std::size_t{5}}) {
+            std::vector<unsigned char> bytes(bitstreamOffset, 0xA5);
+            bytes.insert(bytes.end(), stream.begin(), stream.end());
+            const auto inputLength = static_cast<int64_t>(bytes.size());
+
+            // The former reader reads blocks of the seek table buffer size, as seek table entries record
+            std::size_t formerOffset = bitstreamOffset;
+            std::size_t lastBufferReadPosition = bitstreamOffset;
+            reference::VariableLengthInput input;
+            input.allocate(sfb::shorten::seekTableBufferSizeBytes);
+            const auto read = reference::makeInput(bytes, formerOffset);
+            input.setInputCallback([&](void *buf, std::size_t len, std::size_t &n) {
+                lastBufferReadPosition = formerOffset;
+                return read(buf, len, n);
+            });
+
+            std::size_t offset = bitstreamOffset;
+            sfb::shorten::BitReader reader;
+            reader.allocate();
+            reader.setInputCallback(reference::makeInput(bytes, offset));
+            reader.reset(bitstreamOffset);
+
+            for (std::size_t i = 0; i < operations.size(); ++i) {
+                // Record a seek point as SFBShortenDecoder does
+                sfb::shorten::SeekPoint point{};
+                point.frameNumber_ = static_cast<uint32_t>(i * 256);
+                point.bitOffset_ = reader.bitPosition();
+                if (const auto bitsInWord = sfb::shorten::seekTableBitsInWord(point.bitOffset_,
+                                                                              static_cast<int64_t>(bitstreamOffset));
+                    bitsInWord > 0 && !reader.peekBits(point.bitBuffer_, bitsInWord)) {
+                    roundTrips = false;
+                }
+                point.bitshift_ = static_cast<uint16_t>(i % 32);
+                std::generate_n(point.chanBuf0_, 3, [&] { return sample(generator); });
+                std::generate_n(point.chanBuf1_, 3, [&] { return sample(generator); });
+                std::generate_n(point.offset0_, 4, [&] { return sample(generator); });
+                std::generate_n(point.offset1_, 4, [&] { return sample(generator); });
+
+                unsigned char buf[sfb::shorten::seekEntrySizeBytes];
+                sfb::shorten::writeSeekTableEntry(
+                        sfb::shorten::makeSeekTableEntry(point, static_cast<int64_t>(bitstreamOffset), inputLength),
+                        buf);
+                const auto entry = sfb::shorten::parseSeekTableEntry(buf);
+
+                // The former reader has no state to compare until it reads its first block
+                if (formerOffset > bitstreamOffset) {
+                    const auto bitsAvailable = input.bitsAvailable_;
+                    const auto bitBuffer =
+                            bitsAvailable == 0 ? 0 : input.bitBuffer_ & (UINT32_MAX >> (32 - bitsAvailable));
+                    matchesFormer = matchesFormer && entry.byteOffsetInFile_ == formerOffset &&
+                                    entry.lastBufferReadPosition_ == lastBufferReadPosition &&
+                                    entry.byteBufferPosition_ == input.byteBufferPosition_ - input.byteBuffer_ &&
+                                    entry.bytesAvailable_ == input.bytesAvailable_ &&
+                                    entry.bitBufferPosition_ == bitsAvailable && entry.bitBuffer_ == bitBuffer;
+                }
+
+                const auto parsed = sfb::shorten::makeSeekPoint(entry);
+                const auto roundTripped = sfb::shorten::seekTableEntryBitOffset(entry) ==
+                                                  static_cast<int64_t>(point.bitOffset_) &&
+                                          sameSeekPoint(parsed, point);
+                roundTrips = roundTrips && roundTripped;
+                if (entry.byteBufferPosition_ == sfb::shorten::seekTableBufferSizeBytes) {
+                    ++blockEnds;
+                    blockEndsRoundTrip = blockEndsRoundTrip && roundTripped;
+                }
+
+                roundTrips = roundTrips && perform(reader, operations[i]) && perform(input, operations[i]);
+            }
+        }
+    }
+
+    sfb::shorten::SeekTableHeader header{{'S', 'E', 'E', 'K'}, sfb::shorten::seekTableRevision, 0x89ABCDEF};
+    unsigned char buf[sfb::shorten::seekHeaderSizeBytes];
+    sfb::shorten::writeSeekTableHeader(header, buf);
+    const auto parsedHeader = sfb::shorten::parseSeekTableHeader(buf);
+    const unsigned char expectedHeader[] = {'S', 'E', 'E', 'K', 1, 0, 0, 0, 0xEF, 0xCD, 0xAB, 0x89};
+
+    check(matchesFormer, "seek table entries match the states of the former reader");
+    check(roundTrips, "seek table entries parse back to the seek points they were written from");
+    check(blockEnds > 0 && blockEndsRoundTrip, "seek table entries at the end of a block parse back");
+    check(std::equal(buf, buf + sizeof buf, expectedHeader) && parsedHeader.version_ == header.version_ &&
+                  parsedHeader.fileSize_ == header.fileSize_,
+          "seek table headers are little-endian and parse back");
+}
+
+void checkLongQuotients() {
+    // Unary quotients spanning several reservoirs and buffers
+    reference::RiceWriter writer;
+    const std::vector<uint32_t> values{0, 63, 64, 65, 127, 128, 4095, 4096, 100000, 1, 0};
+    for (auto value : values) {
+        writer.putRiceGolombCode(value, 0);
+    }
+    for (auto value : values) {
+        writer.putRiceGolombCode(value << 3 | 5, 3);
+    }
+    const auto bytes = writer.finish();
+
+    std::size_t offset = 0;
+    sfb::shorten::BitReader reader;
+    reader.allocate();
+    reader.setInputCallback(reference::makeInput(bytes, offset));
+    bool identical = true;
+    for (int k : {0, 3}) {
+        for (auto value : values) {
+            int32_t i32;
+            identical = identical && reader.getRiceGolombCode(i32, k) &&
+                        static_cast<uint32_t>(i32) == (k == 0 ? value : (value << 3 | 5));
+        }
+    }
+    check(identical, "unary quotients longer than the reservoir");
+}
+
+void checkParameters() {
+    sfb::shorten::BitReader reader;
+    reader.allocate();
+    int32_t i32;
+    check(!reader.getRiceGolombCode(i32, 32) && !reader.getInt32(i32, 31) && !reader.getInt32s(&i32, 1, -2),
+          "out of range parameters are rejected");
+}
+
+constexpr int32_t kGuard = 0x5A5A5A5A;
+
+/// Samples preceded by history and followed by a guard
+struct Block {
+    static constexpr std::size_t history = 40;
+
+    std::vector<int32_t> storage;
+
+    Block(std::mt19937 &generator, std::size_t count, int32_t magnitude) : storage(history + count + 8, kGuard) {
+        std::uniform_int_distribution<int32_t> value{-magnitude, magnitude};
+        std::generate_n(storage.begin(), history + count, [&] { return value(generator); });
+    }
+
+    int32_t *samples() { return storage.data() + history; }
+};
+
+const std::vector<std::size_t> kBlockSizes{1, 3, 7, 8, 9, 15, 16, 17, 256, 1000};
+
+void checkFixedPredictors() {
+    std::mt19937 generator{21};
+    bool identical = true;
+    bool guarded = true;
+
+    for (int order = 0; order <= 3; ++order) {
+        for (auto count : kBlockSizes) {
+            // Small residuals and shorter blocks keep the thrice-integrated signal in range
+            const auto n = std::min<std::size_t>(count, 300);
+            Block block{generator, n, 8};
+            auto expected = block;
+            reference::restoreFixed(order, expected.samples(), static_cast<int>(n), 1234);
+            sfb::shorten::restoreFixed(order, block.samples(), n, 1234);
+            identical = identical && block.storage == expected.storage;
+            guarded = guarded && block.storage.back() == kGuard;
+        }
+    }
+
+    check(identical, "fixed predictors of order 0 through 3");
+    check(guarded, "fixed predictors write no further than the last sample");
+}
+
+void checkLinearPredictors() {
+    std::mt19937 generator{22};
+    bool specialized = true;
+    bool general = true;
+    bool guarded = true;
+
+    for (int order = 0; order <= static_cast<int>(Block::history); ++order) {
+        for (auto count : kBlockSizes) {
+            // Coefficients with magnitudes summing to at most 1 << shift keep the signal in range
+            std::vector<int> coefficients(static_cast<std::size_t>(order));
+            std::uniform_int_distribution<int> coefficient{-2, 2};
+            int total = 0;
+            for (auto &c : coefficients) {
+                c = coefficient(generator);
+                if (total + std::abs(c) > 4) {
+                    c = 0;
+                }
+                total += std::abs(c);
+            }
+            std::shuffle(coefficients.begin(), coefficients.end(), generator);
+
+            for (int32_t quantOffset : {0, 4}) {
+                Block block{generator, count, 1 << 10};
+                auto expected = block;
+                reference::restoreLPC(expected.samples(), static_cast<int>(count), coefficients.data(), order,
+                                      quantOffset, 2);
+                sfb::shorten::restoreLPC(block.samples(), count, coefficients.data(), order, quantOffset, 2);
+                auto &result = order <= sfb::shorten::maxSpecializedLPCOrder ? specialized : general;
+                result = result && block.storage == expected.storage;
+                guarded = guarded && block.storage.back() == kGuard;
+            }
+        }
+    }
+
+    check(specialized, "linear predictors of specialized orders");
+    check(general, "linear predictors of orders above the specialized orders");
+    check(guarded, "linear predictors write no further than the last sample");
+}
+
+template <typename T>
+void checkConversion(const char *description) {
+    std::mt19937 generator{23};
+    bool identical = true;
+
+    for (auto count : kBlockSizes) {
+        for (int shift = 0; shift <= 4; ++shift) {
+            // Shifted values span twice the range of `T` in each direction so both bounds are clamped
+            const auto limit = (int32_t{1} << (8 * sizeof(T))) >> shift;
+            std::uniform_int_distribution<int32_t> value{-limit, limit};
+            std::vector<int32_t> samples(count);
+            std::generate(samples.begin(), samples.end(), [&] { return value(generator); });
+            std::vector<T> expected(count + 8, static_cast<T>(0x5A));
+            std::vector<T> converted(count + 8, static_cast<T>(0x5A));
+            reference::convertSamples(samples.data(), expected.data(), static_cast<int>(count), shift);
+            sfb::shorten::convertSamples(samples.data(), converted.data(), count, shift);
+            identical = identical && converted == expected;
+        }
+    }
+
+    check(identical, description);
+}
+
+} /* namespace */
+
+int main() {
+    checkSequences();
+    checkSeekTables();
+    checkLongQuotients();
+    checkParameters();
+    checkFixedPredictors();
+    checkLinearPredictors();
+    checkConversion<int8_t>("conversion to signed 8-bit samples");
+    checkConversion<uint8_t>("conversion to unsigned 8-bit samples");
+    checkConversion<int16_t>("conversion to signed 16-bit samples");
+    checkConversion<uint16_t>("conversion to unsigned 16-bit samples");
+
+    return sfb_test::summarize();
+}
@@ -0,0 +1,235 @@
+//
+// SPDX-FileCopyrightText: 2026 Stephen F. Booth <contact@sbooth.dev>
+// SPDX-License-Identifier: MIT
+//
+// Part of https://github.com/sbooth/SFBAudioEngine
+//
+
+// Throughput benchmark for sfb::shorten::BitReader and the Shorten predictors.
+//
+// The Shorten bit reader and predictors are plain C++ so this builds anywhere, including Linux, as part of
+// Tests/CMakeLists.txt.
+//
+// Blocks of 256 residuals are coded as Shorten writes them, with an energy parameter per block. The reader formerly
+// used by SFBShortenDecoder, which reads input 512 bytes at a time, is compared with the new reader reading 64 KiB of
+// input at a time and decoding one residual at a time or a block at a time.
+//
+// Blocks of 256 samples are then reconstructed with each fixed predictor and linear predictors of typical orders and
+// converted to 16-bit samples, using the loops formerly used by SFBShortenDecoder and the new kernels. Finally whole
+// blocks are decoded by reading residuals, reconstructing with a linear predictor and converting, as SFBShortenDecoder
+// does. Results are reported as multiples of real time for 16-bit stereo at 44.1 kHz and millions of samples per
+// second.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "ShortenBitReader.hpp"
+#include "ShortenPredictor.hpp"
+#include "reference_predictor.h"
+#include "reference_reader.h"
+
+namespace {
+
+constexpr std::size_t kBlockSize = 256;
+constexpr std::size_t kBlocks = 40000;
+constexpr int kPasses = 5;
+constexpr double kSamplesPerSecond = 44100.0 * 2;
+
+struct Stream {
+    std::vector<unsigned char> bytes;
+    std::vector<int> energies;
+};
+
+/// Returns blocks of Laplacian residuals with a spread typical of `energy`
+Stream makeStream(int meanEnergy) {
+    std::mt19937 generator{static_cast<unsigned>(meanEnergy)};
+    std::uniform_int_distribution<int> jitter{-2, 2};
+    std::uniform_real_distribution<double> uniform{0.0, 1.0};
+
+    Stream stream;
+    reference::RiceWriter writer;
+    for (std::size_t block = 0; block < kBlocks; ++block) {
+        const auto energy = std::max(0, meanEnergy + jitter(generator));
+        stream.energies.push_back(energy);
+        writer.putRiceGolombCode(static_cast<uint32_t>(energy), 3);
+        const double scale = std::ldexp(1.0, energy) / std::log(2.0);
+        for (std::size_t i = 0; i < kBlockSize; ++i) {
+            const auto magnitude = static_cast<int32_t>(-scale * std::log(1.0 - uniform(generator)));
+            writer.putInt32(uniform(generator) < 0.5 ? magnitude : -magnitude - 1, energy);
+        }
+    }
+    stream.bytes = writer.finish();
+    return stream;
+}
+
+void report(const char *name, double elapsed) {
+    const double values = static_cast<double>(kPasses) * kBlocks * kBlockSize;
+    std::printf("%-32s %8.1fx real time  %7.1f M samples/s\n", name, values / kSamplesPerSecond / elapsed,
+                values / (1e6 * elapsed));
+}
+
+template <typename Reader, typename ReadBlock>
+void run(const char *name, const Stream &stream, ReadBlock readBlock) {
+    std::vector<int32_t> residuals(kBlockSize);
+    long long checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < kPasses; ++pass) {
+        std::size_t offset = 0;
+        Reader reader;
+        reader.allocate();
+        reader.setInputCallback(reference::makeInput(stream.bytes, offset));
+        for (std::size_t block = 0; block < kBlocks; ++block) {
+            int32_t energy;
+            if (!reader.getRiceGolombCode(energy, 3) || !readBlock(reader, residuals.data(), energy)) {
+                std::printf("%s: read failed\n", name);
+                return;
+            }
+            checksum += residuals[block % kBlockSize];
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    report(name, elapsed.count());
+    // Keep the residuals observable
+    std::printf("  checksum %lld\n", checksum);
+}
+
+void runBenchmark(int meanEnergy) {
+    const auto stream = makeStream(meanEnergy);
+    std::printf("energy %d (%.2f bits per residual)\n", meanEnergy,
+                8.0 * stream.bytes.size() / (static_cast<double>(kBlocks) * kBlockSize));
+
+    const auto oneAtATime = [](auto &reader, int32_t *residuals, int energy) {
+        for (std::size_t i = 0; i < kBlockSize; ++i) {
+            if (!reader.getInt32(residuals[i], energy)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    run<reference::VariableLengthInput>("  32-bit reader", stream, oneAtATime);
+    run<sfb::shorten::BitReader>("  64-bit reader", stream, oneAtATime);
+    run<sfb::shorten::BitReader>("  64-bit reader, whole blocks", stream,
+                                 [](sfb::shorten::BitReader &reader, int32_t *residuals, int energy) {
+                                     return reader.getInt32s(residuals, kBlockSize, energy);
+                                 });
+}
+
+/// Times `kPasses` passes of `process` over `kBlocks` blocks of `kBlockSize` samples preceded by history
+template <typename Process>
+void time(const char *name, Process process) {
+    constexpr std::size_t history = 32;
+    std::vector<int32_t> residuals(kBlockSize);
+    std::mt19937 generator{7};
+    std::uniform_int_distribution<int32_t> residual{-64, 64};
+    std::generate(residuals.begin(), residuals.end(), [&] { return residual(generator); });
+
+    std::vector<int32_t> buffer(history + kBlockSize);
+    std::vector<int16_t> output(kBlockSize);
+    long long checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < kPasses; ++pass) {
+        for (std::size_t block = 0; block < kBlocks; ++block) {
+            // Carry history over as Shorten does, restarting from silence periodically to keep the signal bounded
+            if (block % 64 == 0) {
+                std::fill_n(buffer.begin(), history, 0);
+            } else {
+                std::copy_n(buffer.end() - history, history, buffer.begin());
+            }
+            std::copy(residuals.begin(), residuals.end(), buffer.begin() + history);
+            process(buffer.data() + history, output.data());
+            checksum += output[block % kBlockSize];
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    report(name, elapsed.count());
+    std::printf("  checksum %lld\n", checksum);
+}
+
+void runPredictorBenchmark() {
+    constexpr int blocksize = static_cast<int>(kBlockSize);
+    std::printf("fixed predictors\n");
+    for (int order = 1; order <= 3; ++order) {
+        char name[64];
+        std::snprintf(name, sizeof name, "  order %d, former", order);
+        time(name, [&](int32_t *samples, int16_t *) { reference::restoreFixed(order, samples, blocksize, 0); });
+        std::snprintf(name, sizeof name, "  order %d, specialized", order);
+        time(name, [&](int32_t *samples, int16_t *) { sfb::shorten::restoreFixed(order, samples, kBlockSize, 0); });
+    }
+
+    // Coefficients of a smooth predictor scaled by 1 << 2, as stored by Shorten
+    std::printf("linear predictors\n");
+    for (int order : {1, 2, 3, 4, 8, 16, 32}) {
+        std::vector<int> coefficients(static_cast<std::size_t>(order), 0);
+        coefficients[0] = 3;
+        if (order > 1) {
+            coefficients[1] = 1;
+        }
+        char name[64];
+        std::snprintf(name, sizeof name, "  order %d, former", order);
+        time(name, [&](int32_t *samples, int16_t *) {
+            reference::restoreLPC(samples, blocksize, coefficients.data(), order, 4, 2);
+        });
+        std::snprintf(name, sizeof name, "  order %d, specialized", order);
+        time(name, [&](int32_t *samples, int16_t *) {
+            sfb::shorten::restoreLPC(samples, kBlockSize, coefficients.data(), order, 4, 2);
+        });
+    }
+
+    std::printf("conversion to 16-bit samples\n");
+    time("  former", [&](int32_t *samples, int16_t *output) {
+        reference::convertSamples(samples, output, blocksize, 1);
+    });
+    time("  vectorized", [&](int32_t *samples, int16_t *output) {
+        sfb::shorten::convertSamples(samples, output, kBlockSize, 1);
+    });
+}
+
+void runDecodeBenchmark() {
+    // Blocks as Shorten writes them for 16-bit audio, with third-order linear prediction
+    const auto stream = makeStream(6);
+    const std::vector<int> coefficients{3, 1, 0};
+    std::printf("decoding\n");
+
+    run<reference::VariableLengthInput>("  former", stream, [&](auto &reader, int32_t *residuals, int energy) {
+        static std::vector<int32_t> buffer(3 + kBlockSize);
+        static std::vector<int16_t> output(kBlockSize);
+        auto *samples = buffer.data() + 3;
+        for (std::size_t i = 0; i < kBlockSize; ++i) {
+            if (!reader.getInt32(samples[i], energy)) {
+                return false;
+            }
+        }
+        reference::restoreLPC(samples, static_cast<int>(kBlockSize), coefficients.data(), 3, 4, 2);
+        reference::convertSamples(samples, output.data(), static_cast<int>(kBlockSize), 0);
+        std::copy_n(samples + kBlockSize - 3, 3, buffer.begin());
+        residuals[0] = output[0];
+        return true;
+    });
+    run<sfb::shorten::BitReader>("  new", stream, [&](auto &reader, int32_t *residuals, int energy) {
+        static std::vector<int32_t> buffer(3 + kBlockSize);
+        static std::vector<int16_t> output(kBlockSize);
+        auto *samples = buffer.data() + 3;
+        if (!reader.getInt32s(samples, kBlockSize, energy)) {
+            return false;
+        }
+        sfb::shorten::restoreLPC(samples, kBlockSize, coefficients.data(), 3, 4, 2);
+        sfb::shorten::convertSamples(samples, output.data(), kBlockSize, 0);
+        std::copy_n(samples + kBlockSize - 3, 3, buffer.begin());
+        residuals[0] = output[0];
+        return true;
+    });
+}
+
+} /* namespace */
+
+int main() {
+    for (int energy : {2, 6, 10}) {
+        runBenchmark(energy);
+    }
+    runPredictorBenchmark();
+    runDecodeBenchmark();
+    return 0;
+}